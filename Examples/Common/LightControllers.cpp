@@ -246,14 +246,14 @@ void LightProcess::Process(const double deltaSeconds) {
     }
 }
 
-void LightProcess::EntitiesAdded(const std::unordered_set<stratus::EntityPtr>& e) {
+void LightProcess::EntitiesAdded(const stratus::EntityList& e) {
     for (auto entity : e) {
         if ( !EntityIsRelevant(entity) ) continue;
         ConvertHandlerToLightDelete(input)->entities.push_back(entity);
     }
 }
 
-void LightProcess::EntitiesRemoved(const std::unordered_set<stratus::EntityPtr>& e) {
+void LightProcess::EntitiesRemoved(const stratus::EntityList& e) {
     for (auto entity : e) {
         if ( !EntityIsRelevant(entity) ) continue;
         auto lightDelete = ConvertHandlerToLightDelete(input);
@@ -265,14 +265,19 @@ void LightProcess::EntitiesRemoved(const std::unordered_set<stratus::EntityPtr>&
     }
 }
 
-void LightProcess::EntityComponentsAdded(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent*>>& added) {
+void LightProcess::EntityComponentsAdded(const stratus::EntityComponentsAddedList& added) {
     // Do nothing
 }
 
-void LightProcess::EntityComponentsEnabledDisabled(const std::unordered_set<stratus::EntityPtr>& changed) {
+void LightProcess::EntityComponentsEnabledDisabled(const stratus::EntityList& changed) {
     // Do nothing
 }
 
+// Removing lights and cubes goes through the renderer and entity manager, which are both thread safe
+stratus::EntityComponentAccess LightProcess::GetComponentAccess() const {
+    return stratus::EntityComponentAccess().Reads<LightComponent, LightCubeComponent>();
+}
+
 void RandomLightMoverProcess::Process(const double deltaSeconds) {
     static const glm::vec3 speed(5.0f);
     for (auto ptr : entities_) {
@@ -294,7 +299,7 @@ void RandomLightMoverProcess::Process(const double deltaSeconds) {
     }
 }
 
-void RandomLightMoverProcess::EntitiesAdded(const std::unordered_set<stratus::EntityPtr>& e) {
+void RandomLightMoverProcess::EntitiesAdded(const stratus::EntityList& e) {
     for (auto ptr : e) {
         if (IsEntityRelevant_(ptr)) {
             entities_.insert(ptr);
@@ -303,18 +308,25 @@ void RandomLightMoverProcess::EntitiesAdded(const std::unordered_set<stratus::En
     }
 }
 
-void RandomLightMoverProcess::EntitiesRemoved(const std::unordered_set<stratus::EntityPtr>& e) {
+void RandomLightMoverProcess::EntitiesRemoved(const stratus::EntityList& e) {
     for (auto ptr : e) {
         entities_.erase(ptr);
     }
 }
 
-void RandomLightMoverProcess::EntityComponentsAdded(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent*>>& added) {
+void RandomLightMoverProcess::EntityComponentsAdded(const stratus::EntityComponentsAddedList& added) {
 
 }
 
-void RandomLightMoverProcess::EntityComponentsEnabledDisabled(const std::unordered_set<stratus::EntityPtr>& changed) {
+void RandomLightMoverProcess::EntityComponentsEnabledDisabled(const stratus::EntityList& changed) {
+
+}
 
+// Moving the light counts as writing its LightComponent
+stratus::EntityComponentAccess RandomLightMoverProcess::GetComponentAccess() const {
+    return stratus::EntityComponentAccess()
+        .Reads<LightCubeComponent>()
+        .Writes<LightComponent, RandomLightMoverComponent, stratus::LocalTransformComponent>();
 }
 
 bool RandomLightMoverProcess::IsEntityRelevant_(const stratus::EntityPtr& e) {
@@ -66,25 +66,25 @@ public:
         //INSTANCE(RendererFrontend)->SetAtmosphericShadowing(0.3f, 0.8f);
 
         // For textures see https://3dtextures.me/
-        textures.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Substance_graph_BaseColor.jpg", stratus::ColorSpace::SRGB));
-        textures.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Bark_06_basecolor.jpg", stratus::ColorSpace::SRGB));
-        textures.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Wood_Wall_003_basecolor.jpg", stratus::ColorSpace::SRGB));
-        textures.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Rock_Moss_001_basecolor.jpg", stratus::ColorSpace::SRGB));
+        textures.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Substance_graph_BaseColor.jpg", stratus::ColorSpace::SRGB, stratus::TextureUsage::COLOR));
+        textures.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Bark_06_basecolor.jpg", stratus::ColorSpace::SRGB, stratus::TextureUsage::COLOR));
+        textures.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Wood_Wall_003_basecolor.jpg", stratus::ColorSpace::SRGB, stratus::TextureUsage::COLOR));
+        textures.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Rock_Moss_001_basecolor.jpg", stratus::ColorSpace::SRGB, stratus::TextureUsage::COLOR));
 
-        normalMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Substance_graph_Normal.jpg", stratus::ColorSpace::NONE));
-        normalMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Bark_06_normal.jpg", stratus::ColorSpace::NONE));
-        normalMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Wood_Wall_003_normal.jpg", stratus::ColorSpace::NONE));
-        normalMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Rock_Moss_001_normal.jpg", stratus::ColorSpace::NONE));
+        normalMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Substance_graph_Normal.jpg", stratus::ColorSpace::NONE, stratus::TextureUsage::NORMAL_MAP));
+        normalMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Bark_06_normal.jpg", stratus::ColorSpace::NONE, stratus::TextureUsage::NORMAL_MAP));
+        normalMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Wood_Wall_003_normal.jpg", stratus::ColorSpace::NONE, stratus::TextureUsage::NORMAL_MAP));
+        normalMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Rock_Moss_001_normal.jpg", stratus::ColorSpace::NONE, stratus::TextureUsage::NORMAL_MAP));
 
         depthMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Substance_graph_Height.png", stratus::ColorSpace::NONE));
         depthMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Bark_06_height.png", stratus::ColorSpace::NONE));
         depthMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Wood_Wall_003_height.png", stratus::ColorSpace::NONE));
         depthMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Rock_Moss_001_height.png", stratus::ColorSpace::NONE));
 
-        roughnessMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Substance_graph_Roughness.jpg", stratus::ColorSpace::NONE));
-        roughnessMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Bark_06_roughness.jpg", stratus::ColorSpace::NONE));
-        roughnessMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Wood_Wall_003_roughness.jpg", stratus::ColorSpace::NONE));
-        roughnessMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Rock_Moss_001_roughness.jpg", stratus::ColorSpace::NONE));
+        roughnessMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Substance_graph_Roughness.jpg", stratus::ColorSpace::NONE, stratus::TextureUsage::SINGLE_CHANNEL));
+        roughnessMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Bark_06_roughness.jpg", stratus::ColorSpace::NONE, stratus::TextureUsage::SINGLE_CHANNEL));
+        roughnessMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Wood_Wall_003_roughness.jpg", stratus::ColorSpace::NONE, stratus::TextureUsage::SINGLE_CHANNEL));
+        roughnessMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Rock_Moss_001_roughness.jpg", stratus::ColorSpace::NONE, stratus::TextureUsage::SINGLE_CHANNEL));
 
         environmentMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Substance_graph_AmbientOcclusion.jpg", stratus::ColorSpace::SRGB));
         environmentMaps.push_back(INSTANCE(ResourceManager)->LoadTexture("../Resources/resources/textures/Bark_06_ambientOcclusion.jpg", stratus::ColorSpace::SRGB));
@@ -0,0 +1,233 @@
+#include "StratusAffine.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(STRATUS_SIMD_SSE)
+#include <immintrin.h>
+#elif defined(STRATUS_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace stratus {
+    namespace {
+#if defined(STRATUS_SIMD_SSE)
+        typedef __m128 Vec4_;
+
+        inline Vec4_ Load_(const float * v) { return _mm_loadu_ps(v); }
+        inline void Store_(float * out, const Vec4_ v) { _mm_storeu_ps(out, v); }
+        inline Vec4_ Set_(const float x, const float y, const float z, const float w) { return _mm_setr_ps(x, y, z, w); }
+        inline Vec4_ Splat_(const float f) { return _mm_set1_ps(f); }
+        inline Vec4_ Add_(const Vec4_ a, const Vec4_ b) { return _mm_add_ps(a, b); }
+        inline Vec4_ Mul_(const Vec4_ a, const Vec4_ b) { return _mm_mul_ps(a, b); }
+        inline Vec4_ Min_(const Vec4_ a, const Vec4_ b) { return _mm_min_ps(a, b); }
+        inline Vec4_ Max_(const Vec4_ a, const Vec4_ b) { return _mm_max_ps(a, b); }
+
+        // a * b + c - fused when available, so only use where the result doesn't need to match glm exactly
+        inline Vec4_ MulAdd_(const Vec4_ a, const Vec4_ b, const Vec4_ c) {
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+            return _mm_fmadd_ps(a, b, c);
+#else
+            return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+        }
+
+        inline void Transpose_(Vec4_& a, Vec4_& b, Vec4_& c, Vec4_& d) {
+            _MM_TRANSPOSE4_PS(a, b, c, d);
+        }
+#elif defined(STRATUS_SIMD_NEON)
+        typedef float32x4_t Vec4_;
+
+        inline Vec4_ Load_(const float * v) { return vld1q_f32(v); }
+        inline void Store_(float * out, const Vec4_ v) { vst1q_f32(out, v); }
+        inline Vec4_ Set_(const float x, const float y, const float z, const float w) {
+            const float v[4] = {x, y, z, w};
+            return vld1q_f32(v);
+        }
+        inline Vec4_ Splat_(const float f) { return vdupq_n_f32(f); }
+        inline Vec4_ Add_(const Vec4_ a, const Vec4_ b) { return vaddq_f32(a, b); }
+        inline Vec4_ Mul_(const Vec4_ a, const Vec4_ b) { return vmulq_f32(a, b); }
+        inline Vec4_ Min_(const Vec4_ a, const Vec4_ b) { return vminq_f32(a, b); }
+        inline Vec4_ Max_(const Vec4_ a, const Vec4_ b) { return vmaxq_f32(a, b); }
+
+        inline Vec4_ MulAdd_(const Vec4_ a, const Vec4_ b, const Vec4_ c) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+            return vfmaq_f32(c, a, b);
+#else
+            return vmlaq_f32(c, a, b);
+#endif
+        }
+#else
+        struct Vec4_ {
+            float v[4];
+        };
+
+        inline Vec4_ Set_(const float x, const float y, const float z, const float w) { return Vec4_{{x, y, z, w}}; }
+        inline Vec4_ Load_(const float * v) { return Set_(v[0], v[1], v[2], v[3]); }
+        inline void Store_(float * out, const Vec4_ v) { for (int i = 0; i < 4; ++i) out[i] = v.v[i]; }
+        inline Vec4_ Splat_(const float f) { return Set_(f, f, f, f); }
+        inline Vec4_ Add_(const Vec4_ a, const Vec4_ b) { return Set_(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+        inline Vec4_ Mul_(const Vec4_ a, const Vec4_ b) { return Set_(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+        inline Vec4_ Min_(const Vec4_ a, const Vec4_ b) { return Set_(std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3])); }
+        inline Vec4_ Max_(const Vec4_ a, const Vec4_ b) { return Set_(std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3])); }
+        inline Vec4_ MulAdd_(const Vec4_ a, const Vec4_ b, const Vec4_ c) { return Add_(Mul_(a, b), c); }
+#endif
+
+#if !defined(STRATUS_SIMD_SSE)
+        inline void Transpose_(Vec4_& a, Vec4_& b, Vec4_& c, Vec4_& d) {
+            float m[4][4];
+            Store_(m[0], a);
+            Store_(m[1], b);
+            Store_(m[2], c);
+            Store_(m[3], d);
+            a = Set_(m[0][0], m[1][0], m[2][0], m[3][0]);
+            b = Set_(m[0][1], m[1][1], m[2][1], m[3][1]);
+            c = Set_(m[0][2], m[1][2], m[2][2], m[3][2]);
+            d = Set_(m[0][3], m[1][3], m[2][3], m[3][3]);
+        }
+#endif
+
+        // Columns of the full 4x4 matrix - c[3] holds the translation with w = 1
+        struct Columns_ {
+            Vec4_ c[4];
+
+            explicit Columns_(const Affine3x4& a) {
+                c[0] = Load_(a.rows[0]);
+                c[1] = Load_(a.rows[1]);
+                c[2] = Load_(a.rows[2]);
+                c[3] = Set_(0.0f, 0.0f, 0.0f, 1.0f);
+                Transpose_(c[0], c[1], c[2], c[3]);
+            }
+        };
+
+        inline void TransformAabb_(const Columns_& m, const GpuAABB& in, GpuAABB& out) {
+            Vec4_ vmin = m.c[3];
+            Vec4_ vmax = m.c[3];
+            for (int i = 0; i < 3; ++i) {
+                const Vec4_ a = Mul_(m.c[i], Splat_(in.vmin.v[i]));
+                const Vec4_ b = Mul_(m.c[i], Splat_(in.vmax.v[i]));
+                vmin = Add_(vmin, Min_(a, b));
+                vmax = Add_(vmax, Max_(a, b));
+            }
+
+            // GpuVec is packed so its members can't be stored to directly. w ends up as 1 for both.
+            alignas(16) float result[4];
+            Store_(result, vmin);
+            std::memcpy(out.vmin.v, result, sizeof(result));
+            Store_(result, vmax);
+            std::memcpy(out.vmax.v, result, sizeof(result));
+        }
+
+        inline Vec4_ TransformPoint_(const Columns_& m, const glm::vec3& p) {
+            return MulAdd_(m.c[0], Splat_(p.x), MulAdd_(m.c[1], Splat_(p.y), MulAdd_(m.c[2], Splat_(p.z), m.c[3])));
+        }
+    }
+
+    Affine3x4::Affine3x4()
+        : rows{{1.0f, 0.0f, 0.0f, 0.0f},
+               {0.0f, 1.0f, 0.0f, 0.0f},
+               {0.0f, 0.0f, 1.0f, 0.0f}} {}
+
+    Affine3x4 Affine3x4::FromMat4(const glm::mat4& m) {
+        Vec4_ c0 = Load_(&m[0][0]);
+        Vec4_ c1 = Load_(&m[1][0]);
+        Vec4_ c2 = Load_(&m[2][0]);
+        Vec4_ c3 = Load_(&m[3][0]);
+        Transpose_(c0, c1, c2, c3);
+
+        Affine3x4 result;
+        Store_(result.rows[0], c0);
+        Store_(result.rows[1], c1);
+        Store_(result.rows[2], c2);
+        return result;
+    }
+
+    Affine3x4 Affine3x4::FromTRS(const glm::vec3& scale, const glm::mat3& rotation, const glm::vec3& position) {
+        // Scaling the columns of the rotation gives R * S, and translation only fills in the last column
+        Affine3x4 result;
+        for (int i = 0; i < 3; ++i) {
+            result.rows[i][0] = rotation[0][i] * scale.x;
+            result.rows[i][1] = rotation[1][i] * scale.y;
+            result.rows[i][2] = rotation[2][i] * scale.z;
+            result.rows[i][3] = position[i];
+        }
+        return result;
+    }
+
+    glm::mat4 Affine3x4::ToMat4() const {
+        glm::mat4 result;
+        ToMat4(result);
+        return result;
+    }
+
+    void Affine3x4::ToMat4(glm::mat4& out) const {
+        Vec4_ c0 = Load_(rows[0]);
+        Vec4_ c1 = Load_(rows[1]);
+        Vec4_ c2 = Load_(rows[2]);
+        Vec4_ c3 = Set_(0.0f, 0.0f, 0.0f, 1.0f);
+        Transpose_(c0, c1, c2, c3);
+
+        Store_(&out[0][0], c0);
+        Store_(&out[1][0], c1);
+        Store_(&out[2][0], c2);
+        Store_(&out[3][0], c3);
+    }
+
+    Affine3x4 Affine3x4::operator*(const Affine3x4& other) const {
+        const Vec4_ b0 = Load_(other.rows[0]);
+        const Vec4_ b1 = Load_(other.rows[1]);
+        const Vec4_ b2 = Load_(other.rows[2]);
+        const Vec4_ b3 = Set_(0.0f, 0.0f, 0.0f, 1.0f);
+
+        // Same order of operations as glm's mat4 multiply (and no fused multiply-add) so the results match
+        Affine3x4 result;
+        for (int i = 0; i < 3; ++i) {
+            const float * a = rows[i];
+            Vec4_ row = Add_(Mul_(Splat_(a[0]), b0), Mul_(Splat_(a[1]), b1));
+            row = Add_(row, Mul_(Splat_(a[2]), b2));
+            row = Add_(row, Mul_(Splat_(a[3]), b3));
+            Store_(result.rows[i], row);
+        }
+        return result;
+    }
+
+    glm::vec3 Affine3x4::TransformPoint(const glm::vec3& p) const {
+        // Not worth transposing for a single point
+        return glm::vec3(
+            rows[0][0] * p.x + rows[0][1] * p.y + rows[0][2] * p.z + rows[0][3],
+            rows[1][0] * p.x + rows[1][1] * p.y + rows[1][2] * p.z + rows[1][3],
+            rows[2][0] * p.x + rows[2][1] * p.y + rows[2][2] * p.z + rows[2][3]
+        );
+    }
+
+    GpuAABB TransformAabb(const Affine3x4& transform, const GpuAABB& aabb) {
+        GpuAABB result;
+        TransformAabb_(Columns_(transform), aabb, result);
+        return result;
+    }
+
+    void TransformAabbs(const Affine3x4& transform, const GpuAABB * in, GpuAABB * out, const size_t count) {
+        const Columns_ columns(transform);
+        for (size_t i = 0; i < count; ++i) {
+            TransformAabb_(columns, in[i], out[i]);
+        }
+    }
+
+    void CalculateTransformedBounds(const Affine3x4& transform, const glm::vec3 * points, const uint32_t * indices, const size_t numIndices,
+                                    glm::vec3& vmin, glm::vec3& vmax) {
+        const Columns_ columns(transform);
+        Vec4_ lo = TransformPoint_(columns, points[indices[0]]);
+        Vec4_ hi = lo;
+        for (size_t i = 1; i < numIndices; ++i) {
+            const Vec4_ p = TransformPoint_(columns, points[indices[i]]);
+            lo = Min_(lo, p);
+            hi = Max_(hi, p);
+        }
+
+        float result[4];
+        Store_(result, lo);
+        vmin = glm::vec3(result[0], result[1], result[2]);
+        Store_(result, hi);
+        vmax = glm::vec3(result[0], result[1], result[2]);
+    }
+}
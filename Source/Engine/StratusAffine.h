@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "glm/glm.hpp"
+#include "StratusGpuCommon.h"
+
+// SSE is always available on x86-64. AVX2 builds (STRATUS_ENABLE_AVX2) additionally use FMA for the
+// bounds kernels. Anything else with NEON uses that, otherwise there is a scalar fallback.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STRATUS_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define STRATUS_SIMD_NEON 1
+#endif
+
+namespace stratus {
+    // Affine transform stored as the top three rows of a 4x4 matrix - the bottom row is always (0, 0, 0, 1)
+    // so it never needs to be stored or multiplied. Each row is loaded as a single SIMD register.
+    //
+    // Multiplying two of these gives exactly the same result as multiplying the equivalent glm::mat4s.
+    struct alignas(16) Affine3x4 {
+        float rows[3][4];
+
+        // Identity
+        Affine3x4();
+
+        // Anything in the bottom row of the matrix is ignored
+        static Affine3x4 FromMat4(const glm::mat4&);
+        // Same as T * R * S
+        static Affine3x4 FromTRS(const glm::vec3& scale, const glm::mat3& rotation, const glm::vec3& position);
+
+        glm::mat4 ToMat4() const;
+        void ToMat4(glm::mat4& out) const;
+
+        Affine3x4 operator*(const Affine3x4&) const;
+
+        glm::vec3 TransformPoint(const glm::vec3&) const;
+    };
+
+    // Bounds of the transformed box. Uses Arvo's method so only the min/max extents are transformed instead of all 8 corners.
+    GpuAABB TransformAabb(const Affine3x4&, const GpuAABB&);
+    // in and out can be the same array
+    void TransformAabbs(const Affine3x4&, const GpuAABB * in, GpuAABB * out, const size_t count);
+
+    // Bounds of points[indices[i]] for i in [0, numIndices) after being transformed. numIndices must be > 0.
+    void CalculateTransformedBounds(const Affine3x4&, const glm::vec3 * points, const uint32_t * indices, const size_t numIndices,
+                                    glm::vec3& vmin, glm::vec3& vmax);
+}
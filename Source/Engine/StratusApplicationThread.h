@@ -3,8 +3,6 @@
 #include "StratusSystemModule.h"
 #include "StratusThread.h"
 #include <vector>
-#include <list>
-#include <mutex>
 
 void EnsureIsApplicationThread();
 #define CHECK_IS_APPLICATION_THREAD() EnsureIsApplicationThread()
@@ -24,32 +22,26 @@ namespace stratus {
 
         virtual ~ApplicationThread();
 
-        // Queue functions
-        void Queue(const Thread::ThreadFunction& function) {
-            QueueMany<std::vector<Thread::ThreadFunction>>({function});
+        // Queue functions (lock-free, see Thread::Queue). They will run on the next frame.
+        template<typename F>
+        void Queue(F&& function) {
+            thread_->Queue(std::forward<F>(function));
         }
 
         template<typename E>
         void QueueMany(const E& functions) {
-            auto ul = LockWrite_();
-            for (const Thread::ThreadFunction& function : functions) {
-                queue_.push_back(function);
-            }
+            thread_->QueueMany(functions);
         }
 
         // Checks if current executing thread is the same as the renderer thread
         bool CurrentIsApplicationThread() const;
 
     private:
-        std::unique_lock<std::mutex> LockWrite_() const { return std::unique_lock<std::mutex>(mutex_); }
-        void QueueFront_(const Thread::ThreadFunction&);
         void Dispatch_();
         void Synchronize_();
         void DispatchAndSynchronize_();
 
     private:
-        mutable std::mutex mutex_;
-        std::list<Thread::ThreadFunction> queue_;
         std::unique_ptr<Thread> thread_;
     };
 }
\ No newline at end of file
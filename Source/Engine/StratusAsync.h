@@ -1,102 +1,221 @@
 #pragma once
 
 #include "StratusThread.h"
+#include "StratusPoolAllocator.h"
+#include <type_traits>
+
+namespace stratus {
+    // Decides where and when an Async compute function runs. By default this is done by queueing
+    // onto a Thread, but an executor (such as the TaskSystem) can run it immediately instead.
+    typedef std::function<void (Thread::QueuedFunction&&)> AsyncExecutor;
+
+    template<typename E>
+    class Async;
+
+    template<typename E>
+    class AsyncPromise;
+
+    // Shared state for every Async regardless of its result type. Completion status lives in atomics so that
+    // checking it never takes a lock, and continuations are kept in a lock-free list which is closed off
+    // once the Async completes.
+    //
+    // States (and continuations) come from pools so that creating an Async does not go to the heap.
+    class AsyncStateBase_ {
+    protected:
+        struct Continuation_ {
+            Thread::QueuedFunction function;
+            // If null the function runs on whichever thread completes the Async, otherwise it is queued here
+            Thread * thread = nullptr;
+            Continuation_ * next = nullptr;
+        };
+
+        enum Status_ : uint8_t {
+            Pending_,
+            Succeeded_,
+            Failed_
+        };
+
+    public:
+        AsyncStateBase_() = default;
+
+        AsyncStateBase_(const AsyncStateBase_&) = delete;
+        AsyncStateBase_(AsyncStateBase_&&) = delete;
+        AsyncStateBase_& operator=(const AsyncStateBase_&) = delete;
+        AsyncStateBase_& operator=(AsyncStateBase_&&) = delete;
+
+        ~AsyncStateBase_() {
+            // Continuations are only left behind if the Async never completed
+            Continuation_ * list = continuations_.load(std::memory_order_acquire);
+            while (list != nullptr && list != Closed_()) {
+                Continuation_ * next = list->next;
+                ContinuationPool_().DestroyDeallocate(list);
+                list = next;
+            }
+        }
+
+        // Getters for checking internal state
+        bool Failed()                  const { return status_.load(std::memory_order_acquire) == Failed_; }
+        bool Completed()               const { return status_.load(std::memory_order_acquire) != Pending_; }
+        bool CompleteAndValid()        const { return status_.load(std::memory_order_acquire) == Succeeded_; }
+        bool CompleteAndInvalid()      const { return Failed(); }
+        // The message is written before the status is published so it is only safe to read once complete
+        std::string ExceptionMessage() const { return Completed() ? exceptionMessage_ : std::string(); }
+
+        void AddRef() {
+            refs_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Returns true if this was the last reference
+        bool ReleaseRef() {
+            return refs_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+
+        // Adds function to run once the Async completes. If it has already completed the function
+        // runs (or is queued onto thread) immediately.
+        void AddContinuation(Thread * thread, Thread::QueuedFunction&& function) {
+            Continuation_ * head = continuations_.load(std::memory_order_acquire);
+            if (head != Closed_()) {
+                Continuation_ * continuation = ContinuationPool_().AllocateConstruct();
+                continuation->function = std::move(function);
+                continuation->thread = thread;
+                while (head != Closed_()) {
+                    continuation->next = head;
+                    if (continuations_.compare_exchange_weak(head, continuation, std::memory_order_release, std::memory_order_acquire)) {
+                        return;
+                    }
+                }
+
+                // Completed while we were trying to add ourselves to the list
+                function = std::move(continuation->function);
+                ContinuationPool_().DestroyDeallocate(continuation);
+            }
+
+            Run_(thread, std::move(function));
+        }
+
+        // Same behavior as before continuations existed: callbacks go to the current thread and
+        // are dropped if the Async had already failed by the time they were added
+        void AddCallback(Thread::QueuedFunction&& callback) {
+            Thread * thread = &Thread::Current();
+            if (Completed()) {
+                if (!Failed()) thread->Queue(std::move(callback));
+                return;
+            }
+            AddContinuation(thread, std::move(callback));
+        }
+
+        // Used by WhenAll - the state completes once count dependencies have each called DependencyFinished
+        void SetDependencies(const size_t count) {
+            dependencies_.store(count, std::memory_order_relaxed);
+        }
+
+        void DependencyFinished(const bool failed, const std::string& message) {
+            // Only the first failure gets to record its message
+            if (failed && !dependencyFailed_.exchange(true)) {
+                exceptionMessage_ = message.size() > 0 ? message : "Async dependency failed";
+            }
+            if (dependencies_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                Finish_(dependencyFailed_.load());
+            }
+        }
+
+    protected:
+        // exceptionMessage_ must already be set if failed is true
+        void Finish_(const bool failed) {
+            status_.store(failed ? Failed_ : Succeeded_, std::memory_order_release);
+
+            // Closing the list means anyone who tries to add a continuation from here on runs it themselves
+            Continuation_ * list = continuations_.exchange(Closed_(), std::memory_order_acq_rel);
+
+            // The list was built by pushing to the front so reverse it to run in the order things were added
+            Continuation_ * ordered = nullptr;
+            while (list != nullptr) {
+                Continuation_ * next = list->next;
+                list->next = ordered;
+                ordered = list;
+                list = next;
+            }
+
+            while (ordered != nullptr) {
+                Continuation_ * next = ordered->next;
+                Thread * thread = ordered->thread;
+                Thread::QueuedFunction function = std::move(ordered->function);
+                ContinuationPool_().DestroyDeallocate(ordered);
+                Run_(thread, std::move(function));
+                ordered = next;
+            }
+        }
+
+        static void Run_(Thread * thread, Thread::QueuedFunction&& function) {
+            if (thread != nullptr) thread->Queue(std::move(function));
+            else function();
+        }
+
+        static Continuation_ * Closed_() {
+            return reinterpret_cast<Continuation_ *>(uintptr_t(1));
+        }
+
+        // Never destroyed since Async objects can outlive static destruction order
+        static ConcurrentPoolAllocator<Continuation_>& ContinuationPool_() {
+            static auto * pool = new ConcurrentPoolAllocator<Continuation_>();
+            return *pool;
+        }
+
+    protected:
+        std::atomic<uint32_t> refs_{1};
+        std::atomic<uint8_t> status_{Pending_};
+        std::atomic<bool> dependencyFailed_{false};
+        std::atomic<size_t> dependencies_{0};
+        std::atomic<Continuation_ *> continuations_{nullptr};
+        std::string exceptionMessage_;
+    };
 
-namespace stratus { 
     // Thread for managing Async operations (Note: only safe to use within the context of a valid stratus::Thread,
     // so a raw pthread or std::thread are not useable).
     //
     // It's important to know that whatever thread calls AddCallback will be the same thread that is executes
     // the callback to let you know it completed.
     template<typename E>
-    class AsyncImpl_ : public std::enable_shared_from_this<AsyncImpl_<E>> {
-    public:        
+    class AsyncImpl_ : public AsyncStateBase_ {
+    public:
+        AsyncImpl_() = default;
+
         AsyncImpl_(const std::shared_ptr<E>& result) {
             result_ = result;
-            complete_ = true;
-            failed_ = result == nullptr;
+            status_.store(result == nullptr ? Failed_ : Succeeded_);
         }
 
-        AsyncImpl_(Thread& context, std::function<E *(void)> compute) 
-            : AsyncImpl_(context, [compute]() { return std::shared_ptr<E>(compute()); }) {}
-
-        AsyncImpl_(Thread& context, std::function<std::shared_ptr<E> (void)> compute)
-            : context_(&context),
-              compute_(compute) {}
-
-        AsyncImpl_(const AsyncImpl_&) = delete;
-        AsyncImpl_(AsyncImpl_&&) = delete;
-        AsyncImpl_& operator=(const AsyncImpl_&) = delete;
-        AsyncImpl_& operator=(AsyncImpl_&&) = delete;
         ~AsyncImpl_() = default;
 
-        // Should only be called by the wrapper class Async
-        void Start() {
-            if (Completed()) return;
-
-            std::shared_ptr<AsyncImpl_> shared = this->shared_from_this();
-            context_->Queue([this, shared]() {
-                bool failed = false;
-                try {
-                    std::shared_ptr<E> result = this->compute_();
-                    auto ul = this->LockWrite_();
-                    this->result_ = result;
-                    this->complete_ = true;
-                    this->failed_ = this->result_ == nullptr;
-                    failed = this->failed_;
-                    if (failed) {
-                        this->exceptionMessage_ = "Async function returned nullptr";
-                    }
-                }
-                catch (const std::exception& e) {
-                    auto ul = this->LockWrite_();
-                    this->complete_ = true;
-                    this->failed_ = true;
-                    this->exceptionMessage_ = e.what();
-                    failed = true;
-                }
-
-                // End early to prevent waiting callbacks from receiving null pointers
-                //if (failed) return;
-
-                // Notify everyone that we're done
-                this->ProcessCallbacks_();
-            });
+        void Complete(std::shared_ptr<E>&& result) {
+            result_ = std::move(result);
+            if (result_ == nullptr) exceptionMessage_ = "Async function returned nullptr";
+            Finish_(result_ == nullptr);
         }
 
-        // Getters for checking internal state
-        bool Failed()                  const { auto sl = LockRead_(); return failed_; }
-        bool Completed()               const { auto sl = LockRead_(); return complete_; }
-        bool CompleteAndValid()        const { auto sl = LockRead_(); return complete_ && !failed_; }
-        bool CompleteAndInvalid()      const { auto sl = LockRead_(); return complete_ && failed_; }
-        std::string ExceptionMessage() const { auto sl = LockRead_(); return exceptionMessage_; }
+        void Fail(const std::string& message) {
+            exceptionMessage_ = message;
+            Finish_(true);
+        }
 
         // Getters for retrieving result
         const E& Get() const {
-            if (!Completed()) {
-                throw std::runtime_error("stratus::Async::Get called before completion");
-            }
-
-            if (Failed()) {
-                throw std::runtime_error("Get() called on a failed Async operation");
-            }
-
+            CheckValid_();
             return *result_;
         }
 
         E& Get() {
-            if (!Completed()) {
-                throw std::runtime_error("stratus::Async::Get called before completion");
-            }
-
-            if (Failed()) {
-                throw std::runtime_error("Get() called on a failed Async operation");
-            }
-
+            CheckValid_();
             return *result_;
         }
 
         std::shared_ptr<E> GetPtr() const {
+            CheckValid_();
+            return result_;
+        }
+
+    private:
+        void CheckValid_() const {
             if (!Completed()) {
                 throw std::runtime_error("stratus::Async::Get called before completion");
             }
@@ -104,148 +223,204 @@ namespace stratus {
             if (Failed()) {
                 throw std::runtime_error("Get() called on a failed Async operation");
             }
-
-            return result_;
-        }
-
-        void AddCallback(const Thread::ThreadFunction & callback) {
-            Thread * thread = &Thread::Current();
-            // If completed then schedule it immediately
-            if (Completed() && !Failed()) {
-                thread->Queue(callback);
-            }
-            else {
-                auto ul = LockWrite_();
-                if (callbacks_.find(thread) == callbacks_.end()) {
-                    callbacks_.insert(std::make_pair(thread, std::vector<Thread::ThreadFunction>()));
-                }
-                callbacks_.find(thread)->second.push_back(callback);
-            }
-        }
-
-    private:
-        std::unique_lock<std::shared_mutex> LockWrite_() const { return std::unique_lock<std::shared_mutex>(mutex_); }
-        std::shared_lock<std::shared_mutex> LockRead_()  const { return std::shared_lock<std::shared_mutex>(mutex_); }
-
-        void ProcessCallbacks_() {
-            std::unordered_map<Thread *, std::vector<Thread::ThreadFunction>> callbacks;
-            {
-                auto ul = LockWrite_();
-                callbacks = std::move(callbacks_);
-            }
-            for (auto entry : callbacks) {
-                entry.first->QueueMany(entry.second);
-            }
         }
 
     private:
         std::shared_ptr<E> result_ = nullptr;
-        Thread * context_;
-        std::function<std::shared_ptr<E> (void)> compute_;
-        mutable std::shared_mutex mutex_;
-        std::string exceptionMessage_;
-        bool failed_ = false;
-        bool complete_ = false;
-        std::unordered_map<Thread *, std::vector<Thread::ThreadFunction>> callbacks_;
     };
 
     // Explicit specialization for void
     template<>
-    class AsyncImpl_<void> : public std::enable_shared_from_this<AsyncImpl_<void>> {
+    class AsyncImpl_<void> : public AsyncStateBase_ {
     public:
-        AsyncImpl_() {
-            complete_ = true;
-            failed_ = false;
+        AsyncImpl_() = default;
+        ~AsyncImpl_() = default;
+
+        void Complete() {
+            Finish_(false);
         }
 
-        AsyncImpl_(Thread& context, const std::function<void(void)>& compute) {
-            compute_ = compute;
-            complete_ = false;
-            failed_ = false;
-            context_ = &context;
+        void Fail(const std::string& message) {
+            exceptionMessage_ = message;
+            Finish_(true);
         }
+    };
 
-        AsyncImpl_(const AsyncImpl_&) = delete;
-        AsyncImpl_(AsyncImpl_&&) = delete;
-        AsyncImpl_& operator=(const AsyncImpl_&) = delete;
-        AsyncImpl_& operator=(AsyncImpl_&&) = delete;
-        ~AsyncImpl_() = default;
+    // Maps the return type of a Then continuation onto the resulting Async type
+    template<typename R>
+    struct AsyncResult_;
 
-        // Should only be called by the wrapper class Async
-        void Start() {
-            if (Completed()) return;
-
-            std::shared_ptr<AsyncImpl_> shared = this->shared_from_this();
-            context_->Queue([this, shared]() {
-                bool failed = false;
-                try {
-                    this->compute_();
-                    auto ul = this->LockWrite_();
-                    this->complete_ = true;
-                    this->failed_ = false;
-                    failed = this->failed_;
-                }
-                catch (const std::exception& e) {
-                    auto ul = this->LockWrite_();
-                    this->complete_ = true;
-                    this->failed_ = true;
-                    this->exceptionMessage_ = e.what();
-                    failed = true;
-                }
+    template<>
+    struct AsyncResult_<void> {
+        typedef Async<void> type;
+    };
+
+    template<typename E>
+    struct AsyncResult_<E *> {
+        typedef Async<E> type;
+    };
+
+    template<typename E>
+    struct AsyncResult_<std::shared_ptr<E>> {
+        typedef Async<E> type;
+    };
+
+    // Functionality shared between Async<E> and Async<void>. This acts as an intrusive reference counted
+    // pointer to pooled shared state.
+    template<typename E>
+    class AsyncBase_ {
+        template<typename T>
+        friend class AsyncBase_;
+
+        template<typename T>
+        friend Async<void> WhenAll(const std::vector<Async<T>>&);
+
+        template<typename T>
+        friend class AsyncPromise;
+
+    protected:
+        typedef AsyncImpl_<E> Impl_;
+
+        AsyncBase_() {}
+
+    public:
+        AsyncBase_(const AsyncBase_& other)
+            : impl_(other.impl_) {
+            if (impl_ != nullptr) impl_->AddRef();
+        }
 
-                // End early to prevent waiting callbacks from receiving null pointers
-                //if (failed) return;
+        AsyncBase_(AsyncBase_&& other)
+            : impl_(other.impl_) {
+            other.impl_ = nullptr;
+        }
+
+        AsyncBase_& operator=(const AsyncBase_& other) {
+            if (other.impl_ != nullptr) other.impl_->AddRef();
+            Release_();
+            impl_ = other.impl_;
+            return *this;
+        }
 
-                // Notify everyone that we're done
-                this->ProcessCallbacks_();
-                });
+        AsyncBase_& operator=(AsyncBase_&& other) {
+            if (this != &other) {
+                Release_();
+                impl_ = other.impl_;
+                other.impl_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~AsyncBase_() {
+            Release_();
         }
 
         // Getters for checking internal state
-        bool Failed()                  const { auto sl = LockRead_(); return failed_; }
-        bool Completed()               const { auto sl = LockRead_(); return complete_; }
-        bool CompleteAndValid()        const { auto sl = LockRead_(); return complete_ && !failed_; }
-        bool CompleteAndInvalid()      const { auto sl = LockRead_(); return complete_ && failed_; }
-        std::string ExceptionMessage() const { auto sl = LockRead_(); return exceptionMessage_; }
-
-        void AddCallback(const Thread::ThreadFunction& callback) {
-            Thread* thread = &Thread::Current();
-            // If completed then schedule it immediately
-            if (Completed() && !Failed()) {
-                thread->Queue(callback);
+        bool Failed()                  const { return impl_ == nullptr || impl_->Failed(); }
+        bool Completed()               const { return impl_ == nullptr || impl_->Completed(); }
+        bool CompleteAndValid()        const { return impl_ != nullptr && impl_->CompleteAndValid(); }
+        bool CompleteAndInvalid()      const { return impl_ == nullptr || impl_->CompleteAndInvalid(); }
+        std::string ExceptionMessage() const { return impl_ == nullptr ? "" : impl_->ExceptionMessage(); }
+
+        // Callback support
+        void AddCallback(const std::function<void(Async<E>)>& callback) {
+            Async<E> copy = Self_();
+            impl_->AddCallback([copy, callback]() { callback(copy); });
+        }
+
+        // Runs function once this completes (successfully or not) on whichever thread completes it. This is
+        // the cheapest way to be notified since unlike Then it does not create another Async.
+        void OnComplete(Thread::QueuedFunction&& function) {
+            if (impl_ == nullptr) function();
+            else impl_->AddContinuation(nullptr, std::move(function));
+        }
+
+        // Runs continuation(Async<E>) once this completes (successfully or not). There is no polling and no
+        // queueing involved: the continuation runs on whichever thread completes this Async, or immediately
+        // on the calling thread if it has already completed, so keep continuations short or have them
+        // schedule more work.
+        //
+        // The continuation's return type decides the type of the returned Async: void gives Async<void>,
+        // while T* or std::shared_ptr<T> give Async<T>. An exception thrown by the continuation fails the
+        // returned Async.
+        template<typename F>
+        auto Then(F continuation) -> typename AsyncResult_<std::invoke_result_t<F, Async<E>>>::type {
+            typedef typename AsyncResult_<std::invoke_result_t<F, Async<E>>>::type Result;
+            Result result = Result::Pending_();
+            if (impl_ == nullptr) {
+                result.Run_(continuation, Self_());
+                return result;
             }
-            else {
-                auto ul = LockWrite_();
-                if (callbacks_.find(thread) == callbacks_.end()) {
-                    callbacks_.insert(std::make_pair(thread, std::vector<Thread::ThreadFunction>()));
+
+            Async<E> self = Self_();
+            impl_->AddContinuation(nullptr, [self, result, continuation]() mutable {
+                result.Run_(continuation, self);
+            });
+            return result;
+        }
+
+    protected:
+        template<typename ... Types>
+        void Allocate_(const Types&... args) {
+            Release_();
+            impl_ = Pool_().AllocateConstruct(args...);
+        }
+
+        // Creates an Async which will be completed manually
+        static Async<E> Pending_() {
+            Async<E> result;
+            result.Allocate_();
+            return result;
+        }
+
+        // Schedules function to compute the result of this Async
+        template<typename F>
+        void Start_(Thread& context, F function) {
+            Async<E> self = Self_();
+            context.Queue([self, function]() mutable { self.Run_(function); });
+        }
+
+        template<typename F>
+        void Start_(const AsyncExecutor& executor, F function) {
+            Async<E> self = Self_();
+            executor([self, function]() mutable { self.Run_(function); });
+        }
+
+        // Calls function(args...) and completes this Async with the result
+        template<typename F, typename ... Types>
+        void Run_(F& function, Types&&... args) {
+            try {
+                if constexpr (std::is_void<E>::value) {
+                    function(std::forward<Types>(args)...);
+                    impl_->Complete();
                 }
-                callbacks_.find(thread)->second.push_back(callback);
+                else {
+                    impl_->Complete(std::shared_ptr<E>(function(std::forward<Types>(args)...)));
+                }
+            }
+            catch (const std::exception& e) {
+                impl_->Fail(e.what());
             }
         }
 
-    private:
-        std::unique_lock<std::shared_mutex> LockWrite_() const { return std::unique_lock<std::shared_mutex>(mutex_); }
-        std::shared_lock<std::shared_mutex> LockRead_()  const { return std::shared_lock<std::shared_mutex>(mutex_); }
-
-        void ProcessCallbacks_() {
-            std::unordered_map<Thread*, std::vector<Thread::ThreadFunction>> callbacks;
-            {
-                auto ul = LockWrite_();
-                callbacks = std::move(callbacks_);
-            }
-            for (auto entry : callbacks) {
-                entry.first->QueueMany(entry.second);
+        Async<E> Self_() const {
+            return static_cast<const Async<E>&>(*this);
+        }
+
+        void Release_() {
+            if (impl_ != nullptr && impl_->ReleaseRef()) {
+                Pool_().DestroyDeallocate(impl_);
             }
+            impl_ = nullptr;
         }
 
-    private:
-        Thread* context_ = nullptr;
-        std::function<void (void)> compute_;
-        mutable std::shared_mutex mutex_;
-        std::string exceptionMessage_;
-        bool failed_ = false;
-        bool complete_ = false;
-        std::unordered_map<Thread*, std::vector<Thread::ThreadFunction>> callbacks_;
+        // Never destroyed since Async objects can outlive static destruction order
+        static ConcurrentPoolAllocator<Impl_>& Pool_() {
+            static auto * pool = new ConcurrentPoolAllocator<Impl_>();
+            return *pool;
+        }
+
+    protected:
+        Impl_ * impl_ = nullptr;
     };
 
     // To use this class, do something like the following:
@@ -254,23 +429,40 @@ namespace stratus {
     // while (!compute.Complete())
     //      ;
     // if (!compute.Failed()) std::cout << compute.Get() << std::endl;
+    //
+    // Or to avoid polling, chain a continuation:
+    // compute.Then([](Async<int> result) { std::cout << result.Get() << std::endl; });
     template<typename E>
-    class Async {
+    class Async : public AsyncBase_<E> {
+        template<typename T>
+        friend class AsyncBase_;
+
     public:
         typedef std::function<void(Async<E>)> AsyncCallback;
 
         Async() {}
-        Async(const std::shared_ptr<E>& result)
-            : impl_(std::make_shared<AsyncImpl_<E>>(result)) {}
+        Async(const std::shared_ptr<E>& result) {
+            this->Allocate_(result);
+        }
 
-        Async(Thread& context, std::function<E *(void)> function)
-            : impl_(std::make_shared<AsyncImpl_<E>>(context, function)) {
-            impl_->Start();
+        Async(Thread& context, std::function<E *(void)> function) {
+            this->Allocate_();
+            this->Start_(context, std::move(function));
         }
 
-        Async(Thread& context, std::function<std::shared_ptr<E> (void)> function)
-            : impl_(std::make_shared<AsyncImpl_<E>>(context, function)) {
-            impl_->Start();
+        Async(Thread& context, std::function<std::shared_ptr<E> (void)> function) {
+            this->Allocate_();
+            this->Start_(context, std::move(function));
+        }
+
+        Async(const AsyncExecutor& executor, std::function<E *(void)> function) {
+            this->Allocate_();
+            this->Start_(executor, std::move(function));
+        }
+
+        Async(const AsyncExecutor& executor, std::function<std::shared_ptr<E> (void)> function) {
+            this->Allocate_();
+            this->Start_(executor, std::move(function));
         }
 
         Async(const Async&) = default;
@@ -279,39 +471,34 @@ namespace stratus {
         Async& operator=(Async&&) = default;
         ~Async() = default;
 
-        // Getters for checking internal state
-        bool Failed()                  const { return impl_ == nullptr || impl_->Failed(); }
-        bool Completed()               const { return impl_ == nullptr || impl_->Completed(); }
-        bool CompleteAndValid()        const { return impl_ != nullptr && impl_->CompleteAndValid(); }
-        bool CompleteAndInvalid()      const { return impl_ == nullptr || impl_->CompleteAndInvalid(); }
-        std::string ExceptionMessage() const { return impl_ == nullptr ? "" : impl_->ExceptionMessage(); }
-
         // Getters for retrieving result
-        const E& Get()              const { return impl_->Get(); }
-        E& Get()                          { return impl_->Get(); }
-        std::shared_ptr<E> GetPtr() const { return impl_->GetPtr(); }
-
-        // Callback support
-        void AddCallback(const AsyncCallback & callback) {
-            Async<E> copy = *this;
-            impl_->AddCallback([copy, callback]() { callback(copy); });
-        }
-
-    private:
-        std::shared_ptr<AsyncImpl_<E>> impl_;
+        const E& Get()              const { return this->impl_->Get(); }
+        E& Get()                          { return this->impl_->Get(); }
+        std::shared_ptr<E> GetPtr() const { return this->impl_->GetPtr(); }
     };
 
     // Explicit specialization for void
     template<>
-    class Async<void> {
+    class Async<void> : public AsyncBase_<void> {
+        template<typename T>
+        friend class AsyncBase_;
+
+        template<typename T>
+        friend Async<void> WhenAll(const std::vector<Async<T>>&);
+
     public:
         typedef std::function<void(Async<void>)> AsyncCallback;
 
         Async() {}
 
-        Async(Thread& context, std::function<void (void)> function)
-            : impl_(std::make_shared<AsyncImpl_<void>>(context, function)) {
-            impl_->Start();
+        Async(Thread& context, std::function<void (void)> function) {
+            Allocate_();
+            Start_(context, std::move(function));
+        }
+
+        Async(const AsyncExecutor& executor, std::function<void (void)> function) {
+            Allocate_();
+            Start_(executor, std::move(function));
         }
 
         Async(const Async&) = default;
@@ -319,21 +506,64 @@ namespace stratus {
         Async& operator=(const Async&) = default;
         Async& operator=(Async&&) = default;
         ~Async() = default;
+    };
 
-        // Getters for checking internal state
-        bool Failed()                  const { return impl_ == nullptr || impl_->Failed(); }
-        bool Completed()               const { return impl_ == nullptr || impl_->Completed(); }
-        bool CompleteAndValid()        const { return impl_ != nullptr && impl_->CompleteAndValid(); }
-        bool CompleteAndInvalid()      const { return impl_ == nullptr || impl_->CompleteAndInvalid(); }
-        std::string ExceptionMessage() const { return impl_ == nullptr ? "" : impl_->ExceptionMessage(); }
+    // Returns an Async which completes once every Async in group has completed. It fails if any of
+    // them failed (a default constructed Async counts as failed).
+    template<typename E>
+    Async<void> WhenAll(const std::vector<Async<E>>& group) {
+        Async<void> result = Async<void>::Pending_();
+        if (group.size() == 0) {
+            result.impl_->Complete();
+            return result;
+        }
 
-        // Callback support
-        void AddCallback(const AsyncCallback& callback) {
-            Async<void> copy = *this;
-            impl_->AddCallback([copy, callback]() { callback(copy); });
+        result.impl_->SetDependencies(group.size());
+        for (const Async<E>& dependency : group) {
+            if (dependency.impl_ == nullptr) {
+                result.impl_->DependencyFinished(true, "");
+                continue;
+            }
+
+            Async<E> copy = dependency;
+            dependency.impl_->AddContinuation(nullptr, [result, copy]() {
+                result.impl_->DependencyFinished(copy.Failed(), copy.ExceptionMessage());
+            });
+        }
+
+        return result;
+    }
+
+    // Write end of an Async which is completed by hand rather than by a compute function. Useful
+    // when the result is produced by something that isn't a single function call (such as a coroutine).
+    template<typename E>
+    class AsyncPromise {
+    public:
+        AsyncPromise()
+            : async_(Async<E>::Pending_()) {}
+
+        const Async<E>& GetAsync() const {
+            return async_;
+        }
+
+        // Only one of SetValue/SetFailed should be called, and only once
+        template<typename T = E>
+        void SetValue(const std::shared_ptr<T>& value) {
+            static_assert(!std::is_void<E>::value, "Use SetValue() with no arguments for Async<void>");
+            std::shared_ptr<E> copy = value;
+            async_.impl_->Complete(std::move(copy));
+        }
+
+        void SetValue() {
+            static_assert(std::is_void<E>::value, "SetValue() requires a result for non-void Async");
+            async_.impl_->Complete();
+        }
+
+        void SetFailed(const std::string& message) {
+            async_.impl_->Fail(message);
         }
 
     private:
-        std::shared_ptr<AsyncImpl_<void>> impl_;
+        Async<E> async_;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,342 @@
+#include "StratusBlockCompression.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace stratus {
+    bool IsBlockCompressed(const TextureComponentFormat format) {
+        switch (format) {
+            case TextureComponentFormat::BC1_RGB:
+            case TextureComponentFormat::BC1_SRGB:
+            case TextureComponentFormat::BC3_RGBA:
+            case TextureComponentFormat::BC3_SRGB_ALPHA:
+            case TextureComponentFormat::BC4_RED:
+            case TextureComponentFormat::BC5_RG:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static size_t BlockBytes_(const TextureComponentFormat format) {
+        switch (format) {
+            case TextureComponentFormat::BC1_RGB:
+            case TextureComponentFormat::BC1_SRGB:
+            case TextureComponentFormat::BC4_RED:
+                return 8;
+            case TextureComponentFormat::BC3_RGBA:
+            case TextureComponentFormat::BC3_SRGB_ALPHA:
+            case TextureComponentFormat::BC5_RG:
+                return 16;
+            default:
+                throw std::runtime_error("Format is not block compressed");
+        }
+    }
+
+    size_t BlockCompressedSizeBytes(const TextureComponentFormat format, const uint32_t width, const uint32_t height) {
+        const size_t blocksX = (size_t(width) + 3) / 4;
+        const size_t blocksY = (size_t(height) + 3) / 4;
+        return blocksX * blocksY * BlockBytes_(format);
+    }
+
+    static uint16_t PackRgb565_(const float * rgb) {
+        const auto quantize = [](const float value, const int max) {
+            return uint16_t(std::clamp(int(std::lround(value * float(max) / 255.0f)), 0, max));
+        };
+        return uint16_t((quantize(rgb[0], 31) << 11) | (quantize(rgb[1], 63) << 5) | quantize(rgb[2], 31));
+    }
+
+    // Expands to 8 bits per channel the same way the hardware does
+    static void UnpackRgb565_(const uint16_t color, float * rgb) {
+        const uint32_t r = (color >> 11) & 31;
+        const uint32_t g = (color >> 5) & 63;
+        const uint32_t b = color & 31;
+        rgb[0] = float((r << 3) | (r >> 2));
+        rgb[1] = float((g << 2) | (g >> 4));
+        rgb[2] = float((b << 3) | (b >> 2));
+    }
+
+    // Orders the endpoints for the 4 color mode and picks the closest palette entry for each pixel.
+    // Returns the total squared error.
+    static float EncodeBC1Endpoints_(const float (*pixels)[3], uint16_t c0, uint16_t c1, uint16_t& outC0, uint16_t& outC1, uint32_t& indices) {
+        // c0 <= c1 would switch to the 3 color mode. When they're equal every index ends up 0 below, which
+        // decodes the same in both modes.
+        if (c0 < c1) std::swap(c0, c1);
+        outC0 = c0;
+        outC1 = c1;
+
+        float palette[4][3];
+        UnpackRgb565_(c0, palette[0]);
+        UnpackRgb565_(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+
+        indices = 0;
+        float error = 0.0f;
+        for (int i = 0; i < 16; ++i) {
+            uint32_t best = 0;
+            float bestDistance = std::numeric_limits<float>::max();
+            for (uint32_t p = 0; p < 4; ++p) {
+                float distance = 0.0f;
+                for (int c = 0; c < 3; ++c) {
+                    const float d = pixels[i][c] - palette[p][c];
+                    distance += d * d;
+                }
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= best << (2 * i);
+            error += bestDistance;
+        }
+        return error;
+    }
+
+    void CompressBC1Block(const uint8_t * block, uint8_t * out) {
+        float pixels[16][3];
+        float mean[3] = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                pixels[i][c] = float(block[i * 4 + c]);
+                mean[c] += pixels[i][c] / 16.0f;
+            }
+        }
+
+        // Endpoints go at either end of the block's principal axis, found by power iteration on the covariance
+        float covariance[3][3] = {};
+        for (int i = 0; i < 16; ++i) {
+            for (int r = 0; r < 3; ++r) {
+                for (int c = 0; c < 3; ++c) {
+                    covariance[r][c] += (pixels[i][r] - mean[r]) * (pixels[i][c] - mean[c]);
+                }
+            }
+        }
+
+        float axis[3] = {1.0f, 1.0f, 1.0f};
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            float next[3];
+            for (int r = 0; r < 3; ++r) {
+                next[r] = covariance[r][0] * axis[0] + covariance[r][1] * axis[1] + covariance[r][2] * axis[2];
+            }
+            const float length = std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+            // Every pixel is the same color
+            if (length < 1e-6f) break;
+            for (int c = 0; c < 3; ++c) axis[c] = next[c] / length;
+        }
+
+        int minPixel = 0, maxPixel = 0;
+        float minDot = std::numeric_limits<float>::max();
+        float maxDot = -std::numeric_limits<float>::max();
+        for (int i = 0; i < 16; ++i) {
+            const float dot = pixels[i][0] * axis[0] + pixels[i][1] * axis[1] + pixels[i][2] * axis[2];
+            if (dot < minDot) { minDot = dot; minPixel = i; }
+            if (dot > maxDot) { maxDot = dot; maxPixel = i; }
+        }
+
+        uint16_t c0, c1;
+        uint32_t indices;
+        float error = EncodeBC1Endpoints_(pixels, PackRgb565_(pixels[maxPixel]), PackRgb565_(pixels[minPixel]), c0, c1, indices);
+
+        // Least squares fit of the endpoints to the chosen indices, kept if it does better
+        static constexpr float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[3] = {0.0f, 0.0f, 0.0f}, bx[3] = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; ++i) {
+            const float a = weights[(indices >> (2 * i)) & 3];
+            const float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; ++c) {
+                ax[c] += a * pixels[i][c];
+                bx[c] += b * pixels[i][c];
+            }
+        }
+
+        const float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) > 1e-6f) {
+            float e0[3], e1[3];
+            for (int c = 0; c < 3; ++c) {
+                e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+                e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+            }
+
+            uint16_t fitC0, fitC1;
+            uint32_t fitIndices;
+            const float fitError = EncodeBC1Endpoints_(pixels, PackRgb565_(e0), PackRgb565_(e1), fitC0, fitC1, fitIndices);
+            if (fitError < error) {
+                c0 = fitC0;
+                c1 = fitC1;
+                indices = fitIndices;
+            }
+        }
+
+        out[0] = uint8_t(c0 & 0xFF);
+        out[1] = uint8_t(c0 >> 8);
+        out[2] = uint8_t(c1 & 0xFF);
+        out[3] = uint8_t(c1 >> 8);
+        for (int b = 0; b < 4; ++b) out[4 + b] = uint8_t(indices >> (8 * b));
+    }
+
+    void CompressBC4Block(const uint8_t * block, const int channel, uint8_t * out) {
+        uint8_t minValue = 255, maxValue = 0;
+        for (int i = 0; i < 16; ++i) {
+            minValue = std::min(minValue, block[i * 4 + channel]);
+            maxValue = std::max(maxValue, block[i * 4 + channel]);
+        }
+
+        // max > min selects the 8 value mode. If they're equal every index stays 0.
+        out[0] = maxValue;
+        out[1] = minValue;
+
+        uint64_t indices = 0;
+        if (maxValue > minValue) {
+            float palette[8];
+            palette[0] = float(maxValue);
+            palette[1] = float(minValue);
+            for (int p = 2; p < 8; ++p) {
+                palette[p] = (float(8 - p) * palette[0] + float(p - 1) * palette[1]) / 7.0f;
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                const float value = float(block[i * 4 + channel]);
+                uint64_t best = 0;
+                float bestDistance = std::numeric_limits<float>::max();
+                for (uint64_t p = 0; p < 8; ++p) {
+                    const float distance = std::abs(value - palette[p]);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = p;
+                    }
+                }
+                indices |= best << (3 * i);
+            }
+        }
+
+        for (int b = 0; b < 6; ++b) out[2 + b] = uint8_t(indices >> (8 * b));
+    }
+
+    std::vector<uint8_t> CompressImage(const TextureComponentFormat format, const uint8_t * rgba, const uint32_t width, const uint32_t height) {
+        const size_t blockBytes = BlockBytes_(format);
+        std::vector<uint8_t> out(BlockCompressedSizeBytes(format, width, height));
+        if (width == 0 || height == 0) return out;
+
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+        uint8_t block[64];
+        for (uint32_t by = 0; by < blocksY; ++by) {
+            for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                for (uint32_t y = 0; y < 4; ++y) {
+                    const uint32_t sy = std::min(by * 4 + y, height - 1);
+                    for (uint32_t x = 0; x < 4; ++x) {
+                        const uint32_t sx = std::min(bx * 4 + x, width - 1);
+                        std::memcpy(block + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+                    }
+                }
+
+                uint8_t * dst = out.data() + (size_t(by) * blocksX + bx) * blockBytes;
+                switch (format) {
+                    case TextureComponentFormat::BC1_RGB:
+                    case TextureComponentFormat::BC1_SRGB:
+                        CompressBC1Block(block, dst);
+                        break;
+                    case TextureComponentFormat::BC3_RGBA:
+                    case TextureComponentFormat::BC3_SRGB_ALPHA:
+                        CompressBC4Block(block, 3, dst);
+                        CompressBC1Block(block, dst + 8);
+                        break;
+                    case TextureComponentFormat::BC4_RED:
+                        CompressBC4Block(block, 0, dst);
+                        break;
+                    default: // BC5_RG
+                        CompressBC4Block(block, 0, dst);
+                        CompressBC4Block(block, 1, dst + 8);
+                        break;
+                }
+            }
+        }
+
+        return out;
+    }
+
+    static const std::array<float, 256>& SrgbToLinearTable_() {
+        static const std::array<float, 256> table = []() {
+            std::array<float, 256> values;
+            for (int i = 0; i < 256; ++i) {
+                const float c = float(i) / 255.0f;
+                values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    static uint8_t LinearToSrgb_(float c) {
+        c = std::clamp(c, 0.0f, 1.0f);
+        const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return uint8_t(std::lround(s * 255.0f));
+    }
+
+    std::vector<uint8_t> DownsampleImage(const uint8_t * rgba, const uint32_t width, const uint32_t height, const bool srgb, const bool normalMap) {
+        const uint32_t outWidth = std::max(1u, width / 2);
+        const uint32_t outHeight = std::max(1u, height / 2);
+        const auto& toLinear = SrgbToLinearTable_();
+
+        std::vector<uint8_t> out(size_t(outWidth) * outHeight * 4);
+        for (uint32_t y = 0; y < outHeight; ++y) {
+            const uint32_t ys[2] = {std::min(2 * y, height - 1), std::min(2 * y + 1, height - 1)};
+            for (uint32_t x = 0; x < outWidth; ++x) {
+                const uint32_t xs[2] = {std::min(2 * x, width - 1), std::min(2 * x + 1, width - 1)};
+                const uint8_t * samples[4] = {
+                    rgba + (size_t(ys[0]) * width + xs[0]) * 4,
+                    rgba + (size_t(ys[0]) * width + xs[1]) * 4,
+                    rgba + (size_t(ys[1]) * width + xs[0]) * 4,
+                    rgba + (size_t(ys[1]) * width + xs[1]) * 4
+                };
+
+                uint8_t * dst = out.data() + (size_t(y) * outWidth + x) * 4;
+                if (normalMap) {
+                    float normal[3] = {0.0f, 0.0f, 0.0f};
+                    for (const uint8_t * sample : samples) {
+                        for (int c = 0; c < 3; ++c) normal[c] += float(sample[c]) / 127.5f - 1.0f;
+                    }
+                    float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    // Opposing normals cancel out (up to 8 bit rounding) - point straight out of the surface
+                    if (length < 0.1f) {
+                        normal[0] = normal[1] = 0.0f;
+                        normal[2] = length = 1.0f;
+                    }
+                    for (int c = 0; c < 3; ++c) {
+                        dst[c] = uint8_t(std::clamp(std::lround((normal[c] / length + 1.0f) * 127.5f), 0L, 255L));
+                    }
+                }
+                else {
+                    for (int c = 0; c < 3; ++c) {
+                        if (srgb) {
+                            float sum = 0.0f;
+                            for (const uint8_t * sample : samples) sum += toLinear[sample[c]];
+                            dst[c] = LinearToSrgb_(sum / 4.0f);
+                        }
+                        else {
+                            uint32_t sum = 2;
+                            for (const uint8_t * sample : samples) sum += sample[c];
+                            dst[c] = uint8_t(sum / 4);
+                        }
+                    }
+                }
+
+                uint32_t alpha = 2;
+                for (const uint8_t * sample : samples) alpha += sample[3];
+                dst[3] = uint8_t(alpha / 4);
+            }
+        }
+
+        return out;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "StratusTexture.h"
+
+namespace stratus {
+    // CPU encoders for the BCn block compressed formats. Every 4x4 block of pixels is encoded on its own, and
+    // images whose size isn't a multiple of 4 repeat their edge pixels to fill out the last row and column
+    // of blocks.
+    //
+    // All images are tightly packed RGBA8 in row order.
+
+    // True for the BC* members of TextureComponentFormat
+    bool IsBlockCompressed(const TextureComponentFormat);
+    // Size of a width x height image in a block compressed format
+    size_t BlockCompressedSizeBytes(const TextureComponentFormat, const uint32_t width, const uint32_t height);
+
+    // BC1 keeps rgb, BC3 keeps rgba, BC4 keeps red and BC5 keeps red and green. sRGB formats are encoded the
+    // same way as their linear counterparts.
+    std::vector<uint8_t> CompressImage(const TextureComponentFormat, const uint8_t * rgba, const uint32_t width, const uint32_t height);
+
+    // Next mip level down (each dimension halved, never below 1) using a box filter. With srgb the color
+    // channels are averaged in linear space. With normalMap rgb is treated as a unit vector and renormalized.
+    std::vector<uint8_t> DownsampleImage(const uint8_t * rgba, const uint32_t width, const uint32_t height, const bool srgb, const bool normalMap);
+
+    // block is 16 RGBA pixels. BC1 blocks are 8 bytes and always use the 4 color mode so they're also valid
+    // as the color half of a BC3 block.
+    void CompressBC1Block(const uint8_t * block, uint8_t * out);
+    // 8 bytes encoding a single channel (0 = red, ..., 3 = alpha) of block
+    void CompressBC4Block(const uint8_t * block, const int channel, uint8_t * out);
+}
@@ -0,0 +1,179 @@
+#include "StratusChangeJournal.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace stratus {
+    struct ChangeJournalRecord_ {
+        ComponentTypeId type;
+        ChangeJournal::Entry entry;
+    };
+
+    struct ChangeJournalChunk_ {
+        static constexpr size_t Capacity = 1024;
+
+        ChangeJournalRecord_ records[Capacity];
+        // Both are only written by the thread which owns the chunk
+        std::atomic<size_t> count{0};
+        std::atomic<ChangeJournalChunk_ *> next{nullptr};
+    };
+
+    // Single producer (the thread that owns it) / single consumer (whoever is merging) list of chunks,
+    // so recording never needs a lock or a read-modify-write
+    struct ChangeJournalThread_ {
+        // Only touched by the owning thread
+        ChangeJournalChunk_ * tail;
+        // Only touched while holding the state mutex
+        ChangeJournalChunk_ * head;
+        size_t consumed = 0;
+        // Drained chunks handed back to the owning thread for reuse. Only the owner pops and only the
+        // consumer pushes, so there's no ABA problem.
+        std::atomic<ChangeJournalChunk_ *> free{nullptr};
+
+        ChangeJournalThread_() : tail(new ChangeJournalChunk_()), head(tail) {}
+
+        ChangeJournalChunk_ * NextChunk() {
+            ChangeJournalChunk_ * chunk = free.load(std::memory_order_acquire);
+            while (chunk != nullptr) {
+                ChangeJournalChunk_ * next = chunk->next.load(std::memory_order_relaxed);
+                if (free.compare_exchange_weak(chunk, next, std::memory_order_acquire)) {
+                    chunk->next.store(nullptr, std::memory_order_relaxed);
+                    chunk->count.store(0, std::memory_order_relaxed);
+                    return chunk;
+                }
+            }
+            return new ChangeJournalChunk_();
+        }
+
+        void Recycle(ChangeJournalChunk_ * chunk) {
+            ChangeJournalChunk_ * top = free.load(std::memory_order_relaxed);
+            do {
+                chunk->next.store(top, std::memory_order_relaxed);
+            } while (!free.compare_exchange_weak(top, chunk, std::memory_order_release));
+        }
+    };
+
+    struct ChangeJournalState_ {
+        std::mutex mutex;
+        // Buffers are never freed so threads which have exited can't leave a dangling pointer behind
+        std::vector<ChangeJournalThread_ *> threads;
+
+        // Everything below is only touched by the thread which merges
+        std::vector<std::vector<ChangeJournal::Entry>> entries;
+        std::vector<ChangeJournalRecord_> merged;
+        uint64_t oldestCompleteFrame = 0;
+    };
+
+    // Never destroyed since threads can record during static destruction
+    static ChangeJournalState_& GetState() {
+        static auto * state = new ChangeJournalState_();
+        return *state;
+    }
+
+    static ChangeJournalThread_ * GetCurrentJournalThread() {
+        static thread_local ChangeJournalThread_ * current = nullptr;
+        if (current == nullptr) {
+            current = new ChangeJournalThread_();
+            ChangeJournalState_& state = GetState();
+            std::unique_lock<std::mutex> ul(state.mutex);
+            state.threads.push_back(current);
+        }
+        return current;
+    }
+
+    // Calls fn for every record the thread has published since the last drain. The state mutex must be held.
+    template<typename F>
+    static void DrainJournalThread(ChangeJournalThread_ * thread, const F& fn) {
+        while (true) {
+            ChangeJournalChunk_ * chunk = thread->head;
+            const size_t count = chunk->count.load(std::memory_order_acquire);
+            for (size_t i = thread->consumed; i < count; ++i) {
+                fn(chunk->records[i]);
+            }
+            thread->consumed = count;
+
+            // The owner never touches a chunk again once it has linked the next one
+            if (count < ChangeJournalChunk_::Capacity) return;
+            ChangeJournalChunk_ * next = chunk->next.load(std::memory_order_acquire);
+            if (next == nullptr) return;
+            thread->head = next;
+            thread->Recycle(chunk);
+            thread->consumed = 0;
+        }
+    }
+
+    static bool EntryFrameLess(const ChangeJournal::Entry& a, const ChangeJournal::Entry& b) {
+        return a.frame < b.frame;
+    }
+
+    void ChangeJournal::Record(const ComponentTypeId type, const uint64_t frame, const EntityHandle& entity) {
+        ChangeJournalThread_ * thread = GetCurrentJournalThread();
+        ChangeJournalChunk_ * chunk = thread->tail;
+        size_t count = chunk->count.load(std::memory_order_relaxed);
+        if (count == ChangeJournalChunk_::Capacity) {
+            ChangeJournalChunk_ * next = thread->NextChunk();
+            chunk->next.store(next, std::memory_order_release);
+            thread->tail = chunk = next;
+            count = 0;
+        }
+
+        chunk->records[count] = ChangeJournalRecord_{type, Entry{frame, entity}};
+        chunk->count.store(count + 1, std::memory_order_release);
+    }
+
+    void ChangeJournal::Merge(const uint64_t currentFrame) {
+        ChangeJournalState_& state = GetState();
+        {
+            std::unique_lock<std::mutex> ul(state.mutex);
+            for (ChangeJournalThread_ * thread : state.threads) {
+                DrainJournalThread(thread, [&state](const ChangeJournalRecord_& record) {
+                    state.merged.push_back(record);
+                });
+            }
+        }
+
+        const uint64_t oldest = currentFrame > RetainFrames ? currentFrame - RetainFrames : 0;
+        state.oldestCompleteFrame = std::max(state.oldestCompleteFrame, oldest);
+
+        for (const ChangeJournalRecord_& record : state.merged) {
+            if (record.entry.frame < state.oldestCompleteFrame) continue;
+            if (record.type >= state.entries.size()) state.entries.resize(record.type + 1);
+            state.entries[record.type].push_back(record.entry);
+        }
+        state.merged.clear();
+
+        for (auto& entries : state.entries) {
+            // Each thread's records are in order but threads are merged one after the other
+            if (!std::is_sorted(entries.begin(), entries.end(), EntryFrameLess)) {
+                std::stable_sort(entries.begin(), entries.end(), EntryFrameLess);
+            }
+            const Entry first{state.oldestCompleteFrame, EntityHandle()};
+            entries.erase(entries.begin(), std::lower_bound(entries.begin(), entries.end(), first, EntryFrameLess));
+        }
+    }
+
+    const std::vector<ChangeJournal::Entry>& ChangeJournal::Entries(const ComponentTypeId type) {
+        static const std::vector<Entry> empty;
+        ChangeJournalState_& state = GetState();
+        return type < state.entries.size() ? state.entries[type] : empty;
+    }
+
+    uint64_t ChangeJournal::OldestCompleteFrame() {
+        return GetState().oldestCompleteFrame;
+    }
+
+    void ChangeJournal::Clear(const uint64_t currentFrame) {
+        ChangeJournalState_& state = GetState();
+        {
+            std::unique_lock<std::mutex> ul(state.mutex);
+            for (ChangeJournalThread_ * thread : state.threads) {
+                DrainJournalThread(thread, [](const ChangeJournalRecord_&) {});
+            }
+        }
+
+        state.entries.clear();
+        state.merged.clear();
+        // Changes made earlier this frame are gone as well
+        state.oldestCompleteFrame = currentFrame + 1;
+    }
+}
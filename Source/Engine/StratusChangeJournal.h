@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "StratusEntity.h"
+
+namespace stratus {
+    // Records which entities had a component of a given type marked changed, and on which frame. Systems
+    // read it (see EntityManager::ForEachChangedSince) so that their cost depends on how much changed
+    // rather than on how many entities they track.
+    //
+    // EntityComponent::MarkChanged records into a lock-free buffer owned by the calling thread. Those buffers are
+    // only merged into the per type lists when the journal is read.
+    class ChangeJournal {
+    public:
+        // Changes from more than this many frames ago are dropped
+        static constexpr uint64_t RetainFrames = 8;
+
+        struct Entry {
+            uint64_t frame;
+            EntityHandle entity;
+        };
+
+        // Thread safe
+        static void Record(const ComponentTypeId, const uint64_t frame, const EntityHandle&);
+
+        // Merges everything recorded so far and drops entries older than the retained frames.
+        // Only one thread (EntityManager uses the application thread) may call this or Entries.
+        static void Merge(const uint64_t currentFrame);
+
+        // Changes to components of the given type sorted by frame - valid until the next Merge or Clear
+        static const std::vector<Entry>& Entries(const ComponentTypeId);
+
+        // Oldest frame the journal still holds every change for
+        static uint64_t OldestCompleteFrame();
+
+        // Drops everything, including anything still sitting in the per thread buffers
+        static void Clear(const uint64_t currentFrame);
+    };
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+// Coroutines need C++20 - configure with -DSTRATUS_ENABLE_COROUTINES=ON to turn them on.
+// STRATUS_COROUTINES_ENABLED is defined whenever this header provides anything.
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+
+#define STRATUS_COROUTINES_ENABLED 1
+
+#include <coroutine>
+#include <exception>
+#include "StratusAsync.h"
+#include "StratusThread.h"
+#include "StratusTaskSystem.h"
+#include "StratusApplicationThread.h"
+
+// Lets multi-stage work be written top to bottom instead of as nested callbacks:
+//
+// Task<Texture> LoadTexture(std::string file) {
+//     co_await ResumeOn(INSTANCE(TaskSystem));          // now on a task thread
+//     auto raw = Decode(file);
+//     co_await ResumeOn(ApplicationThread::Instance()); // now on the GL thread
+//     co_return Upload(raw);
+// }
+//
+// Task<T> is an Async<T>, so callers can poll it, chain Then, pass it to WhenAll or co_await it.
+namespace stratus {
+    // co_await on an Async suspends until it completes and then resumes on whichever thread completed
+    // it (or straight away if it already had). The result of the co_await is the Async itself so that
+    // Failed/Get work as usual. Follow it with co_await ResumeOn(...) to pick a different thread.
+    template<typename E>
+    struct AsyncAwaiter_ {
+        Async<E> async;
+
+        bool await_ready() const {
+            return async.Completed();
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            async.OnComplete([handle]() { handle.resume(); });
+        }
+
+        Async<E> await_resume() const {
+            return async;
+        }
+    };
+
+    template<typename E>
+    AsyncAwaiter_<E> operator co_await(const Async<E>& async) {
+        return AsyncAwaiter_<E>{async};
+    }
+
+    // Suspends and resumes on the next call to Dispatch for the given thread (even if we are already on it)
+    struct ResumeOnThread_ {
+        Thread * thread;
+
+        bool await_ready() const {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            thread->Queue([handle]() { handle.resume(); });
+        }
+
+        void await_resume() const {}
+    };
+
+    // Suspends and resumes on one of the task threads
+    struct ResumeOnTaskSystem_ {
+        TaskSystem * tasks;
+
+        bool await_ready() const {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            tasks->Execute([handle]() { handle.resume(); });
+        }
+
+        void await_resume() const {}
+    };
+
+    // Suspends and resumes on the application thread during the next frame
+    struct ResumeOnApplicationThread_ {
+        ApplicationThread * thread;
+
+        bool await_ready() const {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            thread->Queue([handle]() { handle.resume(); });
+        }
+
+        void await_resume() const {}
+    };
+
+    inline ResumeOnThread_ ResumeOn(Thread& thread) {
+        return ResumeOnThread_{&thread};
+    }
+
+    inline ResumeOnTaskSystem_ ResumeOn(TaskSystem * tasks) {
+        return ResumeOnTaskSystem_{tasks};
+    }
+
+    inline ResumeOnApplicationThread_ ResumeOn(ApplicationThread * thread) {
+        return ResumeOnApplicationThread_{thread};
+    }
+
+    // Shared by Task<T> and Task<void>. Tasks start running immediately on the calling thread
+    // and the coroutine frame frees itself once it finishes - the result lives on in the Async.
+    template<typename T>
+    struct TaskPromiseBase_ {
+        AsyncPromise<T> promise;
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() {
+            try {
+                std::rethrow_exception(std::current_exception());
+            }
+            catch (const std::exception& e) {
+                promise.SetFailed(e.what());
+            }
+            catch (...) {
+                promise.SetFailed("Unknown exception thrown from Task");
+            }
+        }
+    };
+
+    // Coroutine which completes an Async<T> with whatever it co_returns
+    template<typename T>
+    class Task : public Async<T> {
+    public:
+        struct promise_type : public TaskPromiseBase_<T> {
+            Task get_return_object() {
+                return Task(this->promise.GetAsync());
+            }
+
+            void return_value(std::shared_ptr<T> value) {
+                this->promise.SetValue(value);
+            }
+
+            void return_value(T value) {
+                this->promise.SetValue(std::make_shared<T>(std::move(value)));
+            }
+        };
+
+        Task() {}
+        Task(const Async<T>& async) : Async<T>(async) {}
+    };
+
+    template<>
+    class Task<void> : public Async<void> {
+    public:
+        struct promise_type : public TaskPromiseBase_<void> {
+            Task get_return_object() {
+                return Task(this->promise.GetAsync());
+            }
+
+            void return_void() {
+                this->promise.SetValue();
+            }
+        };
+
+        Task() {}
+        Task(const Async<void>& async) : Async<void>(async) {}
+    };
+}
+
+#endif
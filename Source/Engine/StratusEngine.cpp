@@ -9,11 +9,15 @@
 #include "StratusTaskSystem.h"
 #include "StratusEntityManager.h"
 #include "StratusGraphicsDriver.h"
+#include "StratusProfiler.h"
 #include <atomic>
+#include <exception>
 #include <mutex>
+#include <string>
 
 namespace stratus {
     Engine * Engine::instance_ = nullptr;
+    std::atomic<uint64_t> Engine::currentFrame_(0);
 
     bool Engine::EngineMain(Application * app, const int numArgs, const char ** args) {
         static std::mutex preventMultipleMainCalls;
@@ -26,11 +30,16 @@ namespace stratus {
         EngineInitParams params;
         params.numCmdArgs = numArgs;
         params.cmdArgs = args;
+        for (int i = 0; i < numArgs; ++i) {
+            if (std::string(args[i]) == "--headless") params.headless = true;
+            if (std::string(args[i]) == "--adaptive-frame-rate") params.adaptiveFrameRate = true;
+        }
         Application::Instance_() = app;
 
         // Delete the instance in case it's left over from a previous run
         delete Engine::instance_;
         Engine::instance_ = new Engine(params);
+        Engine::currentFrame_.store(0);
 
         // Pre-initialize to set up things like the ApplicationThread
         Engine::Instance()->PreInitialize();
@@ -45,10 +54,18 @@ namespace stratus {
             Engine::Instance()->ShutDown();
         };
 
-        // Enter main loop
+        // Enter main loop. Anything thrown during a frame (e.g. by an entity process) still goes through
+        // the normal shut down sequence before it is rethrown to the caller.
         std::atomic<SystemStatus> status(SystemStatus::SYSTEM_CONTINUE);
-        const auto runFrame = [&status]() {
-            status.store(Engine::Instance()->Frame());
+        std::exception_ptr frameException;
+        const auto runFrame = [&status, &frameException]() {
+            try {
+                status.store(Engine::Instance()->Frame());
+            }
+            catch (...) {
+                frameException = std::current_exception();
+                status.store(SystemStatus::SYSTEM_SHUTDOWN);
+            }
         };
 
         volatile bool shouldRestart = false;
@@ -81,12 +98,16 @@ namespace stratus {
         // Delete application thread
         DeleteResource_(ApplicationThread::Instance_());
 
+        if (frameException) std::rethrow_exception(frameException);
+
         // If this is true the boot function will call EngineMain again
         return shouldRestart;
     }
 
     Engine::Engine(const EngineInitParams& params)
-        : _params(params) {}
+        : _params(params), pacer_(params.maxFrameRate) {
+        pacer_.SetAdaptive(params.adaptiveFrameRate);
+    }
 
     bool Engine::IsInitializing() const {
         return isInitializing_.load();
@@ -99,6 +120,17 @@ namespace stratus {
     void Engine::SetMaxFrameRate(const uint32_t rate) {
         std::unique_lock<std::shared_mutex> ul(mainLoop_);
         _params.maxFrameRate = std::max<uint32_t>(rate, 30);
+        pacer_.SetMaxFrameRate(_params.maxFrameRate);
+    }
+
+    uint32_t Engine::TargetFrameRate() const {
+        return pacer_.GetTargetFrameRate();
+    }
+
+    void Engine::SetAdaptiveFrameRate(const bool adaptive) {
+        std::unique_lock<std::shared_mutex> ul(mainLoop_);
+        _params.adaptiveFrameRate = adaptive;
+        pacer_.SetAdaptive(adaptive);
     }
 
     uint64_t Engine::FrameCount() const {
@@ -109,6 +141,22 @@ namespace stratus {
         return stats_.lastFrameTimeSeconds;
     }
 
+    double Engine::LastFrameWorkSeconds() const {
+        return stats_.lastFrameWorkSeconds;
+    }
+
+    FrameTimePercentiles Engine::GetFrameTimePercentiles() const {
+        return stats_.frameTimePercentiles;
+    }
+
+    const std::vector<EntityProcessTiming>& Engine::GetEntityProcessTimings() const {
+        return stats_.entityProcessTimings;
+    }
+
+    bool Engine::IsHeadless() const {
+        return _params.headless;
+    }
+
     void Engine::PreInitialize() {
         if (IsInitializing()) {
             throw std::runtime_error("Engine::PreInitialize called twice");
@@ -179,7 +227,7 @@ namespace stratus {
     }
 
     void Engine::InitGraphicsDriver_() {
-        GraphicsDriver::Initialize();
+        GraphicsDriver::Initialize(_params.headless);
     }
 
     void Engine::InitEntityManager_() {
@@ -203,7 +251,7 @@ namespace stratus {
     }
 
     void Engine::InitWindow_() {
-        EngineModuleInit::InitializeEngineModule(Window::Instance_(), new Window(1600, 900), true);
+        EngineModuleInit::InitializeEngineModule(Window::Instance_(), new Window(1600, 900, _params.headless), true);
         //EngineModuleInit::InitializeEngineModule(Window::Instance_(), new Window(1920, 1080), true);
     }
 
@@ -250,20 +298,11 @@ namespace stratus {
     // Processes the next full system frame, including rendering. Returns false only
     // if the main engine loop should stop.
     SystemStatus Engine::Frame() {
-        // Calculate new frame time
-        const auto end = std::chrono::high_resolution_clock::now();
-        //const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - _stats.prevFrameStart).count();
+        // Everything since the last frame started was work - the rest is spent waiting so that
+        // we don't exceed the max frame rate
+        const double workSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - stats_.prevFrameStart).count();
+        const auto end = pacer_.WaitUntilNextFrame(stats_.prevFrameStart);
         const auto elapsed = end - stats_.prevFrameStart;
-        const double durationMsec = std::chrono::duration<double, std::micro>(elapsed).count();
-        const auto requestedFrameTimingMsec = 1000000.0 / double(_params.maxFrameRate);
-        // Make sure we haven't exceeded the max frame rate
-        //if (frameRate > _params.maxFrameRate) {
-        if (durationMsec < requestedFrameTimingMsec) {
-            //std::this_thread::sleep_for(std::chrono::nanoseconds(1));
-            return SystemStatus::SYSTEM_CONTINUE;
-        }
-
-        //STRATUS_LOG << durationMsec << " " << requestedFrameTimingMsec << std::endl;
 
         // Validate
         CHECK_IS_APPLICATION_THREAD();
@@ -283,21 +322,36 @@ namespace stratus {
 
         // Frame counter should always be +1 for each valid frame
         ++stats_.currentFrame;
+        currentFrame_.store(stats_.currentFrame, std::memory_order_relaxed);
 
         // Update prev frame start to be the beginning of this current frame
         stats_.prevFrameStart = end;
+        stats_.lastFrameTimeSeconds = deltaSeconds;
+        stats_.lastFrameWorkSeconds = workSeconds;
+
+        // The first frame's delta includes startup so it's left out
+        if (stats_.currentFrame > 1) {
+            pacer_.RecordFrame(deltaSeconds, workSeconds);
+            stats_.frameTimePercentiles = pacer_.GetPercentiles();
+        }
 
         //ul.unlock();
 
+        STRATUS_PROFILE_SCOPE("Engine::Frame");
+
         SystemStatus status;
         #define UPDATE_MODULE(name)                                     \
-            status = name::Instance()->Update(deltaSeconds);            \
+            {                                                           \
+                STRATUS_PROFILE_SCOPE(#name "::Update");                \
+                status = name::Instance()->Update(deltaSeconds);        \
+            }                                                           \
             if (status != SystemStatus::SYSTEM_CONTINUE) return status;
 
         // Update core modules
         UPDATE_MODULE(Log)
         UPDATE_MODULE(InputManager)
         UPDATE_MODULE(EntityManager)
+        stats_.entityProcessTimings = INSTANCE(EntityManager)->GetProcessTimings();
         UPDATE_MODULE(TaskSystem)
         UPDATE_MODULE(MaterialManager)
         UPDATE_MODULE(ResourceManager)
@@ -305,6 +359,7 @@ namespace stratus {
         UPDATE_MODULE(RendererFrontend)
 
         // Finish with update to application
+        STRATUS_PROFILE_SCOPE("Application::Update");
         return Application::Instance()->Update(deltaSeconds);
 
         #undef UPDATE_MODULE
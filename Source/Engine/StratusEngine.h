@@ -9,6 +9,8 @@
 #include "StratusHandle.h"
 #include "StratusApplication.h"
 #include "StratusSystemStatus.h"
+#include "StratusFramePacer.h"
+#include "StratusEntityProcess.h"
 #include <shared_mutex>
 #include <memory>
 #include <atomic>
@@ -34,6 +36,11 @@ namespace stratus {
         uint32_t           numCmdArgs;
         const char **      cmdArgs;
         uint32_t           maxFrameRate = 1000;
+        // Skips window creation and swaps in a graphics driver which makes no GL calls. All CPU
+        // work (entities, tasks, renderer frontend) still runs. Set with the --headless argument.
+        bool               headless = false;
+        // Lowers the frame rate below maxFrameRate whenever frames can't keep up (see FramePacer)
+        bool               adaptiveFrameRate = false;
     };
 
     struct EngineStatistics {
@@ -41,7 +48,13 @@ namespace stratus {
         uint64_t currentFrame = 0;
         // Records the time the last frame took to complete - 16.0/1000.0 = 60 fps for example
         double lastFrameTimeSeconds = 0.0;
+        // Part of the last frame not spent waiting for the next one to start
+        double lastFrameWorkSeconds = 0.0;
         std::chrono::high_resolution_clock::time_point prevFrameStart = std::chrono::high_resolution_clock::now();
+        // Covers the last FramePacer::HistorySize frames
+        FrameTimePercentiles frameTimePercentiles;
+        // How long each entity process took this frame - the slowest process in each wave bounds the update
+        std::vector<EntityProcessTiming> entityProcessTimings;
     };
 
     // Engine class which handles initializing all core engine subsystems and helps 
@@ -64,14 +77,27 @@ namespace stratus {
 
         // Sets max frame rate
         void SetMaxFrameRate(const uint32_t);
+        // Frame rate the engine is currently pacing to (below max if adaptive frame rate backed off)
+        uint32_t TargetFrameRate() const;
+        void SetAdaptiveFrameRate(const bool);
         // Checks if the engine has completed its init phase
         bool IsInitializing() const;
         // True if the engine is performing final shutdown sequence
         bool IsShuttingDown() const;
         // Returns how many frames the engine has processed since first start
         uint64_t FrameCount() const;
+        // Same value as FrameCount() but readable without the engine instance. This is what per-component
+        // change tracking reads, and it stays 0 when no engine is running.
+        static uint64_t CurrentFrame() { return currentFrame_.load(std::memory_order_relaxed); }
         // Useful functions for checking current and average frame delta seconds
         double LastFrameTimeSeconds() const;
+        double LastFrameWorkSeconds() const;
+        // p50/p95/p99 frame times over recent frames
+        FrameTimePercentiles GetFrameTimePercentiles() const;
+        // Per-process times from this frame's entity update
+        const std::vector<EntityProcessTiming>& GetEntityProcessTimings() const;
+        // True if running without a window or GL context (see EngineInitParams::headless)
+        bool IsHeadless() const;
 
         // Pre-initialization for things like CommandLine, Log, Filesystem
         void PreInitialize();
@@ -115,8 +141,11 @@ namespace stratus {
     private:
         // Global engine instance - should only be set by EngineMain function
         static Engine * instance_;
+        // Mirrors stats_.currentFrame - see CurrentFrame()
+        static std::atomic<uint64_t> currentFrame_;
         EngineStatistics stats_;
         EngineInitParams _params;
+        FramePacer pacer_;
         Thread * main_;
         std::atomic<bool> isInitializing_{false};
         std::atomic<bool> isShuttingDown_{false};
@@ -1,9 +1,16 @@
 #include "StratusEntity.h"
 #include "StratusEntityManager.h"
 #include "StratusEngine.h"
+#include "StratusChangeJournal.h"
 #include "StratusPoolAllocator.h"
+#include <atomic>
 
 namespace stratus {
+    ComponentTypeId NextComponentTypeId_() {
+        static std::atomic<ComponentTypeId> next(0);
+        return next.fetch_add(1);
+    }
+
     EntityPtr Entity::Create() {
         return Create(nullptr);
         //return EntityPtr(new Entity());
@@ -17,48 +24,50 @@ namespace stratus {
     }
 
     void EntityComponent::MarkChanged() {
-        if (INSTANCE(Engine)) {
-            lastFrameChanged_ = INSTANCE(Engine)->FrameCount();
+        const uint64_t frame = Engine::CurrentFrame();
+        lastFrameChanged_ = frame;
+
+        // Entities only get a handle once they're in the world
+        if (lastFrameJournaled_ != frame && owner_ != nullptr && owner_->GetHandle()) {
+            lastFrameJournaled_ = frame;
+            ChangeJournal::Record(TypeId(), frame, owner_->GetHandle());
         }
     }
 
     bool EntityComponent::ChangedLastFrame() const {
-        uint64_t diff = INSTANCE(Engine)->FrameCount() - lastFrameChanged_;
+        uint64_t diff = Engine::CurrentFrame() - lastFrameChanged_;
         return diff == 1;
     }
 
     bool EntityComponent::ChangedThisFrame() const {
-        uint64_t diff = INSTANCE(Engine)->FrameCount() - lastFrameChanged_;
+        uint64_t diff = Engine::CurrentFrame() - lastFrameChanged_;
         return diff == 0;
     }
 
     bool EntityComponent::ChangedWithinLastFrame() const {
-        uint64_t diff = INSTANCE(Engine)->FrameCount() - lastFrameChanged_;
+        uint64_t diff = Engine::CurrentFrame() - lastFrameChanged_;
         return diff <= 1;
     }
 
     EntityComponentSet::~EntityComponentSet() {
         componentManagers_.clear();
         components_.clear();
-        componentTypeNames_.clear();
     }
 
     void EntityComponentSet::SetOwner_(Entity * owner) {
         owner_ = owner;
+        for (auto& manager : componentManagers_) {
+            manager.component->owner_ = owner;
+        }
     }
 
     Entity::Entity() : Entity(EntityComponentSet::Create()) {}
 
     Entity::Entity(EntityComponentSet * ptr) {
-        handle_ = EntityHandle::NextHandle();
         components_ = ptr;
         components_->SetOwner_(this);
     }
 
-    const EntityHandle& Entity::GetHandle() const {
-        return handle_;
-    }
-
     Entity::~Entity() {
         childNodes_.clear();
         EntityComponentSet::Destroy(components_);
@@ -72,22 +81,25 @@ namespace stratus {
     EntityComponentSet * EntityComponentSet::Copy() const {
         //auto sl = std::shared_lock<std::shared_mutex>(_m);
         EntityComponentSet * copy = EntityComponentSet::Create();
+        copy->componentManagers_.reserve(componentManagers_.size());
         for (const auto& manager : componentManagers_) {
-            auto mgrCopy = CopyManager_(manager);
-            copy->AttachComponent_(mgrCopy);
+            copy->AttachComponent_(manager.Copy());
         }
         return copy;
     }
 
-    void EntityComponentSet::AttachComponent_(std::unique_ptr<EntityComponentPointerManager>& ptr) {
-        EntityComponentView view(ptr->component);
-        const std::string name = view.component->TypeName();
+    void EntityComponentSet::AttachComponent_(EntityComponentPointerManager&& ptr) {
+        EntityComponent * component = ptr.component;
+        const ComponentTypeId id = component->TypeId();
+        if (FindSlot_(id) != nullptr) return;
+
+        component->owner_ = owner_;
         componentManagers_.push_back(std::move(ptr));
-        components_.insert(view);
-        componentTypeNames_.insert(std::make_pair(name, std::make_pair(view, EntityComponentStatus::COMPONENT_ENABLED)));
+        if (id >= components_.size()) components_.resize(id + 1);
+        components_[id] = EntityComponentPair<EntityComponent>{component, EntityComponentStatus::COMPONENT_ENABLED};
 
         if (owner_ && owner_->IsInWorld()) {
-            INSTANCE(EntityManager)->NotifyComponentsAdded_(owner_->shared_from_this(), view.component);
+            INSTANCE(EntityManager)->NotifyComponentsAdded_(owner_->shared_from_this(), component);
         }
     }
 
@@ -105,12 +117,24 @@ namespace stratus {
         return GetComponentByName_<const EntityComponent>(name);
     }
 
+    EntityComponentPair<EntityComponent> EntityComponentSet::GetComponentById(const ComponentTypeId id) {
+        const auto slot = FindSlot_(id);
+        return slot != nullptr ? *slot : EntityComponentPair<EntityComponent>();
+    }
+
+    EntityComponentPair<const EntityComponent> EntityComponentSet::GetComponentById(const ComponentTypeId id) const {
+        const auto slot = FindSlot_(id);
+        return slot != nullptr ? 
+            EntityComponentPair<const EntityComponent>{slot->component, slot->status} : 
+            EntityComponentPair<const EntityComponent>();
+    }
+
     std::vector<EntityComponentPair<EntityComponent>> EntityComponentSet::GetAllComponents() {
         //auto sl = std::shared_lock<std::shared_mutex>(_m);
         std::vector<EntityComponentPair<EntityComponent>> v;
-        v.reserve(components_.size());
-        for (auto& component : componentTypeNames_) {
-            v.push_back(EntityComponentPair<EntityComponent>{component.second.first.component, component.second.second});
+        v.reserve(componentManagers_.size());
+        for (const auto& manager : componentManagers_) {
+            v.push_back(*FindSlot_(manager.component->TypeId()));
         }
         return v;
     }
@@ -118,9 +142,10 @@ namespace stratus {
     std::vector<EntityComponentPair<const EntityComponent>> EntityComponentSet::GetAllComponents() const {
         //auto sl = std::shared_lock<std::shared_mutex>(_m);
         std::vector<EntityComponentPair<const EntityComponent>> v;
-        v.reserve(components_.size());
-        for (const auto& component : componentTypeNames_) {
-            v.push_back(EntityComponentPair<const EntityComponent>{component.second.first.component, component.second.second});
+        v.reserve(componentManagers_.size());
+        for (const auto& manager : componentManagers_) {
+            const auto slot = FindSlot_(manager.component->TypeId());
+            v.push_back(EntityComponentPair<const EntityComponent>{slot->component, slot->status});
         }
         return v;
     }
@@ -134,7 +159,8 @@ namespace stratus {
     }
 
     // Called by World class
-    void Entity::AddToWorld_() {
+    void Entity::AddToWorld_(const EntityHandle& handle) {
+        handle_ = handle;
         partOfWorld_ = true;
     }
 
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "StratusHandle.h"
+#include "StratusSlotMap.h"
 #include <unordered_set>
 #include <unordered_map>
 #include <typeinfo>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
@@ -22,49 +24,55 @@ size_t ClassHashCode() {
     return typeid(E).hash_code();
 }
 
-template<typename Component>
-struct ComponentAllocator_ {
-    std::mutex m;
-    stratus::PoolAllocator<Component> allocator;
-};
+namespace stratus {
+    // Dense ids (0, 1, 2, ...) given out the first time each component type is used. They are
+    // only stable within a single run so they should never be saved.
+    typedef uint32_t ComponentTypeId;
 
-template<typename Component>
-ComponentAllocator_<Component>& GetComponentAllocator_() {
-    static ComponentAllocator_<Component> allocator;
-    return allocator;
+    ComponentTypeId NextComponentTypeId_();
+
+    template<typename E>
+    ComponentTypeId GetComponentTypeId() {
+        static const ComponentTypeId id = NextComponentTypeId_();
+        return id;
+    }
 }
 
+// Components get created and destroyed from many threads at once (e.g. while loading models) so each
+// thread allocates from its own cache of free slots - see stratus::GetThreadCachedPoolStats for contention
+template<typename Component>
+using ComponentAllocator_ = stratus::ThreadCachedPoolAllocator<Component>;
+
 #define ENTITY_COMPONENT_STRUCT(name)                                                       \
     struct name final : public stratus::EntityComponent {                                   \
         static std::string STypeName() { return ClassName<name>(); }                        \
         static size_t SHashCode() { return ClassHashCode<name>(); }                         \
+        static stratus::ComponentTypeId STypeId() {                                         \
+            return stratus::GetComponentTypeId<name>();                                     \
+        }                                                                                   \
         std::string TypeName() const override { return STypeName(); }                       \
         size_t HashCode() const override { return SHashCode(); }                            \
+        stratus::ComponentTypeId TypeId() const override { return STypeId(); }              \
         bool operator==(const stratus::EntityComponent * other) const override {            \
             if (this == other) return true;                                                 \
             if (!other) return false;                                                       \
-            return TypeName() == std::string(other->TypeName());                            \
+            return TypeId() == other->TypeId();                                             \
         }                                                                                   \
         stratus::EntityComponent * Copy() const override {                                  \
-            auto ptr = dynamic_cast<stratus::EntityComponent *>(name::Create(*this));       \
-            return ptr;                                                                     \
+            return name::Create(*this);                                                     \
         }                                                                                   \
         template<typename ... Types>                                                        \
         static name * Create(const Types& ... args) {                                       \
-            auto& allocator = GetComponentAllocator_<name>();                               \
-            auto ul = std::unique_lock(allocator.m);                                        \
-            return allocator.allocator.AllocateConstruct(args...);                                   \
+            return ComponentAllocator_<name>::AllocateConstruct(args...);                   \
         }                                                                                   \
         static void Destroy(name * ptr) {                                                   \
-            if (ptr == nullptr) return;                                                     \
-            auto& allocator = GetComponentAllocator_<name>();                               \
-            auto ul = std::unique_lock(allocator.m);                                        \
-            allocator.allocator.DestroyDeallocate(ptr);                                            \
+            ComponentAllocator_<name>::DestroyDeallocate(ptr);                              \
         }
 
 namespace stratus {
     class Entity;
-    typedef Handle<Entity> EntityHandle;
+    // Index + generation of the entity's slot in EntityManager
+    typedef GenerationalHandle<Entity> EntityHandle;
 
     enum class EntityComponentStatus : int64_t {
         COMPONENT_ENABLED,
@@ -77,19 +85,38 @@ namespace stratus {
         virtual ~EntityComponent() = default;
         virtual std::string TypeName() const = 0;
         virtual size_t HashCode() const = 0;
+        virtual ComponentTypeId TypeId() const = 0;
         virtual bool operator==(const EntityComponent *) const = 0;
 
         virtual EntityComponent * Copy() const = 0;
 
+        // Also records the change in the ChangeJournal (once per frame) if the owning entity is part of the world
         void MarkChanged();
         bool ChangedLastFrame() const;
         bool ChangedThisFrame() const;
         bool ChangedWithinLastFrame() const;
+        uint64_t LastFrameChanged() const { return lastFrameChanged_; }
+
+    protected:
+        EntityComponent() = default;
+        // Copies start out unattached so only the change frame carries over
+        EntityComponent(const EntityComponent& other)
+            : lastFrameChanged_(other.lastFrameChanged_) {}
+        EntityComponent& operator=(const EntityComponent& other) {
+            lastFrameChanged_ = other.lastFrameChanged_;
+            return *this;
+        }
 
     protected:
         // Last engine frame this component was modified
         uint64_t lastFrameChanged_ = 0;
 
+    private:
+        friend struct EntityComponentSet;
+        // Set by the component set this is attached to
+        Entity * owner_ = nullptr;
+        // Last frame this component was added to the change journal
+        uint64_t lastFrameJournaled_ = UINT64_MAX;
     };
 
     // Enables an entity component pointer to be inserted into hash set/map
@@ -112,37 +139,57 @@ namespace stratus {
         }
     };
 
+    // Owns a component and knows which pool to give it back to. Stored by value so attaching a
+    // component doesn't need a separate heap allocation for the wrapper.
     struct EntityComponentPointerManager {
+        typedef void (*DestroyFunction)(EntityComponent *);
+
         EntityComponent * component = nullptr;
+        DestroyFunction destroy = nullptr;
 
-        EntityComponentPointerManager(EntityComponent * c)
-            : component(c) {}
+        EntityComponentPointerManager(EntityComponent * c, DestroyFunction destroy)
+            : component(c), destroy(destroy) {}
 
-        virtual ~EntityComponentPointerManager() = default;
+        EntityComponentPointerManager(EntityComponentPointerManager&& other)
+            : component(other.component), destroy(other.destroy) {
+            other.component = nullptr;
+        }
 
-        virtual EntityComponentPointerManager * Copy() const = 0;
-    };
+        EntityComponentPointerManager& operator=(EntityComponentPointerManager&& other) {
+            if (this == &other) return *this;
+            Reset_();
+            component = other.component;
+            destroy = other.destroy;
+            other.component = nullptr;
+            return *this;
+        }
 
-    template<typename Component, typename ... Types>
-    std::unique_ptr<EntityComponentPointerManager> ConstructComponent_(const Types& ... args) {
-        struct Pointer_ final : public EntityComponentPointerManager {
-            Pointer_(EntityComponent * c)
-                : EntityComponentPointerManager(c) {}
+        EntityComponentPointerManager(const EntityComponentPointerManager&) = delete;
+        EntityComponentPointerManager& operator=(const EntityComponentPointerManager&) = delete;
 
-            virtual ~Pointer_() {
-                Component::Destroy(dynamic_cast<Component *>(component));
-            }
+        ~EntityComponentPointerManager() {
+            Reset_();
+        }
 
-            EntityComponentPointerManager * Copy() const override {
-                return new Pointer_(component->Copy());
-            }
-        };
+        EntityComponentPointerManager Copy() const {
+            return EntityComponentPointerManager(component->Copy(), destroy);
+        }
+
+    private:
+        void Reset_() {
+            if (component != nullptr) destroy(component);
+            component = nullptr;
+        }
+    };
 
-        return std::unique_ptr<EntityComponentPointerManager>(new Pointer_(Component::Create(args...)));
+    template<typename Component>
+    void DestroyComponent_(EntityComponent * c) {
+        Component::Destroy(static_cast<Component *>(c));
     }
 
-    inline std::unique_ptr<EntityComponentPointerManager> CopyManager_(const std::unique_ptr<EntityComponentPointerManager>& ptr) {
-        return std::unique_ptr<EntityComponentPointerManager>(ptr->Copy());
+    template<typename Component, typename ... Types>
+    EntityComponentPointerManager ConstructComponent_(const Types& ... args) {
+        return EntityComponentPointerManager(Component::Create(args...), DestroyComponent_<Component>);
     }
 }
 
@@ -167,6 +214,7 @@ namespace stratus {
     // Guarantee: Component pointers will never move around in memory even when new ones are added
     struct EntityComponentSet final {
         friend class Entity;
+        friend class Prefab;
 
         ~EntityComponentSet();
 
@@ -186,6 +234,9 @@ namespace stratus {
         EntityComponentPair<EntityComponent> GetComponentByName(const std::string&);
         EntityComponentPair<const EntityComponent> GetComponentByName(const std::string&) const;
 
+        EntityComponentPair<EntityComponent> GetComponentById(const ComponentTypeId);
+        EntityComponentPair<const EntityComponent> GetComponentById(const ComponentTypeId) const;
+
         template<typename E>
         void EnableComponent();
         
@@ -221,24 +272,27 @@ namespace stratus {
         template<typename E>
         void SetComponentStatus_(EntityComponentStatus);
 
-        void AttachComponent_(std::unique_ptr<EntityComponentPointerManager>&);
+        void AttachComponent_(EntityComponentPointerManager&&);
         void SetOwner_(Entity *);
         void NotifyEntityManagerComponentEnabledDisabled_();
 
+        const EntityComponentPair<EntityComponent> * FindSlot_(const ComponentTypeId id) const {
+            return id < components_.size() && components_[id].component != nullptr ? &components_[id] : nullptr;
+        }
+
     private:
         //mutable std::shared_mutex _m;
-        Entity * owner_;
-        // Component pointer managers (allocates and deallocates from shared pool)
-        std::vector<std::unique_ptr<EntityComponentPointerManager>> componentManagers_;
-        // List of unique components
-        std::unordered_set<EntityComponentView> components_;
-        // List of components by type name
-        std::unordered_map<std::string, std::pair<EntityComponentView, EntityComponentStatus>> componentTypeNames_;
+        Entity * owner_ = nullptr;
+        // Component pointer managers (allocates and deallocates from shared pool) in the order they were attached
+        std::vector<EntityComponentPointerManager> componentManagers_;
+        // Indexed by ComponentTypeId - empty slots have a null component
+        std::vector<EntityComponentPair<EntityComponent>> components_;
     };
 
     // Collection of unque ID + configurable component data
     class Entity final : public std::enable_shared_from_this<Entity> {
         friend class EntityManager;
+        friend class Prefab;
 
         Entity();
         Entity(EntityComponentSet *);
@@ -282,11 +336,13 @@ namespace stratus {
         const std::vector<EntityPtr>& GetChildNodes() const;
         bool ContainsChildNode(const EntityPtr&) const;
 
-        const EntityHandle& GetHandle() const;
+        // Null until the entity is first added to the world. After it is removed the handle is kept
+        // but is stale, so anything keyed by it can still be cleaned up.
+        const EntityHandle& GetHandle() const { return handle_; }
 
     private:
         // Called by EntityManager class
-        void AddToWorld_();
+        void AddToWorld_(const EntityHandle&);
         void RemoveFromWorld_();
 
     private:
@@ -341,14 +397,12 @@ namespace stratus {
     template<typename E, typename ... Types>
     void EntityComponentSet::AttachComponent_(const Types& ... args) {
         if (ContainsComponent_<E>()) return;
-        auto ptr = ConstructComponent_<E>(args...);
-        AttachComponent_(ptr);
+        AttachComponent_(ConstructComponent_<E>(args...));
     }
 
     template<typename E>
     bool EntityComponentSet::ContainsComponent_() const {
-        std::string name = E::STypeName();
-        return componentTypeNames_.find(name) != componentTypeNames_.end();
+        return FindSlot_(E::STypeId()) != nullptr;
     }
 
     template<typename E>
@@ -364,18 +418,27 @@ namespace stratus {
     template<typename E>
     EntityComponentPair<E> EntityComponentSet::GetComponent_() const {
         static_assert(std::is_base_of<EntityComponent, E>::value);
-        std::string name = E::STypeName();
-        return GetComponentByName_<E>(name);
+        //auto sl = std::shared_lock<std::shared_mutex>(_m);
+        // The slot for E's id can only ever hold an E so no dynamic_cast is needed
+        const auto slot = FindSlot_(E::STypeId());
+        return slot != nullptr ?
+            EntityComponentPair<E>{static_cast<E *>(slot->component), slot->status} :
+            EntityComponentPair<E>();
     }
 
     template<typename E>
     EntityComponentPair<E> EntityComponentSet::GetComponentByName_(const std::string& name) const {
         static_assert(std::is_base_of<EntityComponent, E>::value);
         //auto sl = std::shared_lock<std::shared_mutex>(_m);
-        auto it = componentTypeNames_.find(name);
-        return it != componentTypeNames_.end() ? 
-            EntityComponentPair<E>{dynamic_cast<E *>(it->second.first.component), it->second.second} : 
-            EntityComponentPair<E>();
+        // Linear scan over componentManagers_ comparing type names - fine since sets only hold a handful
+        // of components
+        for (const auto& manager : componentManagers_) {
+            if (manager.component->TypeName() == name) {
+                const auto slot = FindSlot_(manager.component->TypeId());
+                return EntityComponentPair<E>{dynamic_cast<E *>(slot->component), slot->status};
+            }
+        }
+        return EntityComponentPair<E>();
     }
 
     template<typename E>
@@ -392,13 +455,10 @@ namespace stratus {
     void EntityComponentSet::SetComponentStatus_(EntityComponentStatus status) {
         static_assert(std::is_base_of<EntityComponent, E>::value);
         //auto ul = std::unique_lock<std::shared_mutex>(_m);
-        std::string name = E::STypeName();
-        auto it = componentTypeNames_.find(name);
-        if (it != componentTypeNames_.end()) {
-            if (it->second.second != status) {
-                it->second.second = status;
-                NotifyEntityManagerComponentEnabledDisabled_();
-            }
+        const ComponentTypeId id = E::STypeId();
+        if (FindSlot_(id) != nullptr && components_[id].status != status) {
+            components_[id].status = status;
+            NotifyEntityManagerComponentEnabledDisabled_();
         }
     }
 }
\ No newline at end of file
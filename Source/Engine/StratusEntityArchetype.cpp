@@ -0,0 +1,94 @@
+#include "StratusEntityArchetype.h"
+#include <algorithm>
+
+namespace stratus {
+    std::vector<ComponentTypeId> ArchetypeStorage::EnabledComponentTypes_(const EntityPtr& e) {
+        std::vector<ComponentTypeId> types;
+        for (const auto& pair : e->Components().GetAllComponents()) {
+            if (pair.status == EntityComponentStatus::COMPONENT_ENABLED) types.push_back(pair.component->TypeId());
+        }
+        std::sort(types.begin(), types.end());
+        return types;
+    }
+
+    void ArchetypeStorage::Update(const EntityPtr& e) {
+        const auto types = EnabledComponentTypes_(e);
+        const size_t archetype = FindOrCreateArchetype_(types);
+
+        // Even if the archetype didn't change the row is rebuilt in case a component was replaced
+        auto it = locations_.find(e.get());
+        if (it != locations_.end()) RemoveRow_(it->second);
+
+        AddRow_(e, archetype);
+    }
+
+    void ArchetypeStorage::Remove(const EntityPtr& e) {
+        auto it = locations_.find(e.get());
+        if (it == locations_.end()) return;
+        RemoveRow_(it->second);
+        locations_.erase(e.get());
+    }
+
+    bool ArchetypeStorage::Contains(const EntityPtr& e) const {
+        return locations_.find(e.get()) != locations_.end();
+    }
+
+    void ArchetypeStorage::Clear() {
+        archetypes_.clear();
+        archetypeIndices_.clear();
+        locations_.clear();
+    }
+
+    size_t ArchetypeStorage::NumEntities() const {
+        return locations_.size();
+    }
+
+    size_t ArchetypeStorage::NumArchetypes() const {
+        return archetypes_.size();
+    }
+
+    const Archetype& ArchetypeStorage::GetArchetype(const size_t index) const {
+        return *archetypes_[index];
+    }
+
+    size_t ArchetypeStorage::FindOrCreateArchetype_(const std::vector<ComponentTypeId>& types) {
+        auto it = archetypeIndices_.find(types);
+        if (it != archetypeIndices_.end()) return it->second;
+
+        auto archetype = std::make_unique<Archetype>();
+        archetype->types = types;
+        archetype->columns.resize(types.size());
+        if (types.size() > 0) archetype->columnIndices_.resize(types.back() + 1, -1);
+        for (size_t i = 0; i < types.size(); ++i) {
+            archetype->columnIndices_[types[i]] = int32_t(i);
+        }
+
+        const size_t index = archetypes_.size();
+        archetypes_.push_back(std::move(archetype));
+        archetypeIndices_.insert(std::make_pair(types, index));
+        return index;
+    }
+
+    void ArchetypeStorage::AddRow_(const EntityPtr& e, const size_t index) {
+        Archetype& archetype = *archetypes_[index];
+        auto& components = e->Components();
+        for (size_t i = 0; i < archetype.types.size(); ++i) {
+            archetype.columns[i].push_back(components.GetComponentById(archetype.types[i]).component);
+        }
+        locations_[e.get()] = Location_{index, archetype.entities.size()};
+        archetype.entities.push_back(e);
+    }
+
+    void ArchetypeStorage::RemoveRow_(const Location_& location) {
+        // Swap with the last row so every column stays densely packed
+        Archetype& archetype = *archetypes_[location.archetype];
+        const size_t last = archetype.entities.size() - 1;
+        if (location.row != last) {
+            archetype.entities[location.row] = std::move(archetype.entities[last]);
+            for (auto& column : archetype.columns) column[location.row] = column[last];
+            locations_[archetype.entities[location.row].get()].row = location.row;
+        }
+        archetype.entities.pop_back();
+        for (auto& column : archetype.columns) column.pop_back();
+    }
+}
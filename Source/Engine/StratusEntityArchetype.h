@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "StratusEntity.h"
+
+namespace stratus {
+    // Every in-world entity whose enabled components are exactly the same set of types. Each type gets
+    // a column of component pointers (one row per entity) so a query only reads the columns it asks for
+    // and walks them front to back.
+    //
+    // Columns hold pointers rather than the components themselves since component pointers are
+    // guaranteed never to move (see EntityComponentSet). Only the pointers are contiguous - where the
+    // components live is up to the per-thread pools they came from, so neighbouring rows can point
+    // anywhere.
+    struct Archetype {
+        // Sorted
+        std::vector<ComponentTypeId> types;
+        std::vector<EntityPtr> entities;
+        // One per entry in types
+        std::vector<std::vector<EntityComponent *>> columns;
+
+        // Index into columns for the given type or -1 if this archetype doesn't have it
+        int32_t ColumnIndex(const ComponentTypeId id) const {
+            return id < columnIndices_.size() ? columnIndices_[id] : -1;
+        }
+
+        size_t Size() const {
+            return entities.size();
+        }
+
+        template<typename ... Components>
+        bool Matches() const {
+            return ((ColumnIndex(Components::STypeId()) >= 0) && ...);
+        }
+
+        // Calls fn(entity, Components *...) for each row in [begin, end)
+        template<typename ... Components, typename F>
+        void ForEachRow(const size_t begin, const size_t end, const F& fn) const {
+            ForEachRow_<Components...>(begin, end, fn, std::index_sequence_for<Components...>{});
+        }
+
+    private:
+        friend class ArchetypeStorage;
+
+        template<typename ... Components, typename F, size_t ... Indices>
+        void ForEachRow_(const size_t begin, const size_t end, const F& fn, std::index_sequence<Indices...>) const {
+            const std::array<EntityComponent * const *, sizeof...(Components)> columnData{
+                columns[ColumnIndex(Components::STypeId())].data()...
+            };
+            (void)columnData;
+            for (size_t row = begin; row < end; ++row) {
+                fn(entities[row], static_cast<Components *>(columnData[Indices][row])...);
+            }
+        }
+
+        std::vector<int32_t> columnIndices_;
+    };
+
+    // Groups entities into archetypes so that systems can iterate every entity with a given set of
+    // components linearly instead of looking components up entity by entity.
+    //
+    // Not thread safe - EntityManager only changes it during its Update and queries run on the
+    // application thread (or from tasks it waits on).
+    class ArchetypeStorage {
+    public:
+        // Rows per chunk when a query is split across threads
+        static constexpr size_t ChunkSize = 1024;
+
+        // Adds the entity or moves it to a new archetype if its set of enabled components changed
+        void Update(const EntityPtr&);
+        void Remove(const EntityPtr&);
+        bool Contains(const EntityPtr&) const;
+        void Clear();
+
+        size_t NumEntities() const;
+        // Archetypes are never removed once created, even once empty
+        size_t NumArchetypes() const;
+        const Archetype& GetArchetype(const size_t) const;
+
+        // Calls fn(const EntityPtr&, Components *...) for every entity with all of Components enabled
+        template<typename ... Components, typename F>
+        void ForEach(const F& fn) const {
+            for (const auto& archetype : archetypes_) {
+                if (archetype->Size() == 0 || !archetype->template Matches<Components...>()) continue;
+                archetype->template ForEachRow<Components...>(0, archetype->Size(), fn);
+            }
+        }
+
+        // Number of entities with all of Components enabled
+        template<typename ... Components>
+        size_t Count() const {
+            size_t count = 0;
+            for (const auto& archetype : archetypes_) {
+                if (archetype->template Matches<Components...>()) count += archetype->Size();
+            }
+            return count;
+        }
+
+    private:
+        struct Location_ {
+            size_t archetype;
+            size_t row;
+        };
+
+        static std::vector<ComponentTypeId> EnabledComponentTypes_(const EntityPtr&);
+        size_t FindOrCreateArchetype_(const std::vector<ComponentTypeId>&);
+        void AddRow_(const EntityPtr&, const size_t archetype);
+        void RemoveRow_(const Location_&);
+
+    private:
+        // Pointers so that archetype references stay valid as more are created
+        std::vector<std::unique_ptr<Archetype>> archetypes_;
+        std::map<std::vector<ComponentTypeId>, size_t> archetypeIndices_;
+        std::unordered_map<const Entity *, Location_> locations_;
+    };
+}
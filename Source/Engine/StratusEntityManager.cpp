@@ -1,18 +1,59 @@
 #include "StratusEntityManager.h"
 #include "StratusEntity.h"
 #include "StratusApplicationThread.h"
+#include "StratusEngine.h"
 #include "StratusTransformComponent.h"
+#include "StratusProfiler.h"
 #include <algorithm>
+#include <chrono>
+#include <typeinfo>
+#include <stdexcept>
 
 namespace stratus {
     EntityManager::EntityManager() {}
 
+    // Set while this thread is inside Process for a process which declared its component access
+    static thread_local bool InSharedProcess_ = false;
+
+    // Sets the flag until Clear is called, or until the scope exits if a process throws
+    struct ScopedFlag_ {
+        std::atomic<bool>& flag;
+        ScopedFlag_(std::atomic<bool>& flag) : flag(flag) { flag.store(true); }
+        ~ScopedFlag_() { Clear(); }
+        void Clear() { flag.store(false); }
+    };
+
+    // Sorts by address and drops duplicates
+    static void SortUnique_(EntityList& entities) {
+        std::sort(entities.begin(), entities.end(), [](const EntityPtr& a, const EntityPtr& b) {
+            return a.get() < b.get();
+        });
+        entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+    }
+
+    static const EntityList& Filter_(const EntityComponentMask& mask, const EntityList& entities, EntityList& scratch) {
+        if (mask.Empty()) return entities;
+        scratch.clear();
+        for (const auto& e : entities) {
+            if (mask.Matches(e->Components())) scratch.push_back(e);
+        }
+        return scratch;
+    }
+
+    static const EntityComponentsAddedList& Filter_(const EntityComponentMask& mask, const EntityComponentsAddedList& added, EntityComponentsAddedList& scratch) {
+        if (mask.Empty()) return added;
+        scratch.clear();
+        for (const auto& entry : added) {
+            if (mask.Matches(entry.first->Components())) scratch.push_back(entry);
+        }
+        return scratch;
+    }
+
     void EntityManager::AddEntity(const EntityPtr& e) {
         if (e == nullptr) return;
         if (e->GetParentNode() != nullptr) {
             throw std::runtime_error("Unsupported operation - must add root node");
         }
-        std::unique_lock<std::shared_mutex> ul(m_);
         AddEntity_(e);
     }
 
@@ -21,25 +62,39 @@ namespace stratus {
         if (e->GetParentNode() != nullptr) {
             throw std::runtime_error("Unsupported operation - tree structure is immutable after adding to manager");
         }
-        std::unique_lock<std::shared_mutex> ul(m_);
         RemoveEntity_(e);
     }
 
     void EntityManager::AddEntity_(const EntityPtr& e) {
-        entitiesToAdd_.insert(e);
+        RecordCommand_(EntityCommandType_::ADD_ENTITY, e, nullptr);
         for (const EntityPtr& c : e->GetChildNodes()) {
             AddEntity_(c);
         }
     }
 
     void EntityManager::RemoveEntity_(const EntityPtr& e) {
-        entitiesToRemove_.insert(e);    
+        RecordCommand_(EntityCommandType_::REMOVE_ENTITY, e, nullptr);
         for (const EntityPtr& c : e->GetChildNodes()) {
             RemoveEntity_(c);
         }
     }
 
+    void EntityManager::RecordCommand_(EntityCommandType_ type, const EntityPtr& e, EntityComponent * component) {
+        // No synchronization at all for the application thread since it's the one which merges commands
+        if (std::this_thread::get_id() == applicationThreadId_) {
+            applicationCommands_.push_back(EntityCommand_{type, e, component});
+        }
+        else {
+            commands_.Push(EntityCommand_{type, e, component});
+        }
+    }
+
     bool EntityManager::Initialize() {
+        // Engine initializes every module on the application thread
+        applicationThreadId_ = std::this_thread::get_id();
+        // Anything left over from a previous run refers to handles which no longer mean anything
+        ChangeJournal::Clear(Engine::CurrentFrame());
+
         // Initialize core engine entity processors
         RegisterEntityProcess<TransformProcess>();
 
@@ -49,66 +104,217 @@ namespace stratus {
     SystemStatus EntityManager::Update(const double deltaSeconds) {
         CHECK_IS_APPLICATION_THREAD();
 
-        // Notify processes of added/removed entities and allow them to
-        // perform their process routine
-        auto entitiesToAdd = std::move(entitiesToAdd_);
-        auto addedComponents = std::move(addedComponents_);
-        auto entitiesToRemove = std::move(entitiesToRemove_);
-        auto componentsEnabledDisabled = std::move(componentsEnabledDisabled_);
+        // Keeps the journal from growing even if nothing reads it
+        ChangeJournal::Merge(Engine::CurrentFrame());
 
-        for (auto ptr : entitiesToAdd) ptr->AddToWorld_();
-        for (auto ptr : entitiesToRemove) ptr->RemoveFromWorld_();
+        // Merge every command recorded since last frame. Anything recorded after this point
+        // (including by processes below) waits until next frame.
+        std::vector<EntityCommand_> commands = std::move(applicationCommands_);
+        applicationCommands_.clear();
+        EntityCommand_ command;
+        while (commands_.Pop(command)) {
+            commands.push_back(std::move(command));
+        }
 
-        for (EntityProcessPtr& ptr : processes_) {
-            if (entitiesToAdd.size() > 0) ptr->EntitiesAdded(entitiesToAdd);
-            if (addedComponents.size() > 0) ptr->EntityComponentsAdded(addedComponents);
-            if (entitiesToRemove.size() > 0) ptr->EntitiesRemoved(entitiesToRemove);
-            if (componentsEnabledDisabled.size() > 0) ptr->EntityComponentsEnabledDisabled(componentsEnabledDisabled);
-            ptr->Process(deltaSeconds);
+        EntityList entitiesToAdd;
+        EntityList entitiesToRemove;
+        EntityList componentsEnabledDisabled;
+        std::vector<std::pair<EntityPtr, EntityComponent *>> addedComponentList;
+        for (auto& c : commands) {
+            switch (c.type) {
+            case EntityCommandType_::ADD_ENTITY:
+                entitiesToAdd.push_back(std::move(c.entity));
+                break;
+            case EntityCommandType_::REMOVE_ENTITY:
+                entitiesToRemove.push_back(std::move(c.entity));
+                break;
+            case EntityCommandType_::COMPONENT_ADDED:
+                addedComponentList.push_back(std::make_pair(std::move(c.entity), c.component));
+                break;
+            case EntityCommandType_::COMPONENT_ENABLED_DISABLED:
+                componentsEnabledDisabled.push_back(std::move(c.entity));
+                break;
+            }
+        }
+        commands.clear();
+
+        SortUnique_(entitiesToAdd);
+        SortUnique_(entitiesToRemove);
+        SortUnique_(componentsEnabledDisabled);
+
+        // Stable so that each entity's components stay in the order they were added
+        std::stable_sort(addedComponentList.begin(), addedComponentList.end(), [](const auto& a, const auto& b) {
+            return a.first.get() < b.first.get();
+        });
+        EntityComponentsAddedList addedComponents;
+        for (auto& entry : addedComponentList) {
+            if (addedComponents.size() == 0 || addedComponents.back().first != entry.first) {
+                addedComponents.push_back(std::make_pair(std::move(entry.first), std::vector<EntityComponent *>()));
+            }
+            addedComponents.back().second.push_back(entry.second);
+        }
+
+        // Handles are given out before any process hears about the entities. Slots freed by removals
+        // below aren't reused until next frame.
+        for (auto& ptr : entitiesToAdd) {
+            if (!entities_.Contains(ptr->GetHandle())) ptr->AddToWorld_(entities_.Insert(ptr));
+        }
+        for (auto& ptr : entitiesToRemove) ptr->RemoveFromWorld_();
+
+        // Bring archetypes up to date before any process runs
+        for (auto& e : entitiesToAdd) archetypes_.Update(e);
+        for (auto& p : addedComponents) {
+            if (archetypes_.Contains(p.first)) archetypes_.Update(p.first);
         }
+        for (auto& e : componentsEnabledDisabled) {
+            if (archetypes_.Contains(e)) archetypes_.Update(e);
+        }
+        for (auto& e : entitiesToRemove) archetypes_.Remove(e);
 
-        // Commit added/removed entities
-        for (auto& e : entitiesToAdd) entities_.insert(e);
-        for (auto& e : entitiesToRemove) entities_.erase(e);
+        EntityList scratch;
+        EntityComponentsAddedList addedScratch;
+        auto tasks = INSTANCE(TaskSystem);
+        // Nothing below changes entities_ or archetypes_ until the last wave is done, so lookups are safe
+        // from any thread until then
+        ScopedFlag_ running(processesRunning_);
+        for (const auto& wave : schedule_) {
+            for (const size_t index : wave) {
+                auto& entry = processes_[index];
+                auto& ptr = entry.process;
+                const auto& added = Filter_(entry.mask, entitiesToAdd, scratch);
+                if (added.size() > 0) ptr->EntitiesAdded(added);
+                const auto& componentsAdded = Filter_(entry.mask, addedComponents, addedScratch);
+                if (componentsAdded.size() > 0) ptr->EntityComponentsAdded(componentsAdded);
+                const auto& removed = Filter_(entry.mask, entitiesToRemove, scratch);
+                if (removed.size() > 0) ptr->EntitiesRemoved(removed);
+                const auto& enabledDisabled = Filter_(entry.mask, componentsEnabledDisabled, scratch);
+                if (enabledDisabled.size() > 0) ptr->EntityComponentsEnabledDisabled(enabledDisabled);
+            }
+
+            // Exclusive processes are always alone in their wave so they stay on the application thread
+            if (wave.size() == 1 || tasks == nullptr) {
+                for (const size_t index : wave) RunProcess_(processes_[index], deltaSeconds);
+            }
+            else {
+                // If a process throws, whatever in the wave hasn't started yet is skipped and the exception
+                // comes back out here on the application thread, same as for processes run above
+                tasks->ParallelFor(0, wave.size(), 1, [this, &wave, deltaSeconds](const size_t i) {
+                    RunProcess_(processes_[wave[i]], deltaSeconds);
+                });
+            }
+        }
+        running.Clear();
+
+        // Processes have seen the removals so the handles can go stale now
+        for (auto& e : entitiesToRemove) entities_.Remove(e->GetHandle());
 
         // If any processes have been added, tell them about all available entities
         // and allow them to perform their process routine for the first time
-        auto processesToAdd = std::move(processesToAdd_);
+        std::vector<EntityProcessPtr> processesToAdd;
+        {
+            std::unique_lock<std::shared_mutex> ul(m_);
+            processesToAdd = std::move(processesToAdd_);
+            processesToAdd_.clear();
+        }
+
+        EntityList allEntities;
+        if (processesToAdd.size() > 0) {
+            allEntities = entities_.Values();
+            SortUnique_(allEntities);
+        }
+
         for (EntityProcessPtr& ptr : processesToAdd) {
-            if (entities_.size() > 0) ptr->EntitiesAdded(entities_);
-            ptr->Process(deltaSeconds);
+            RegisteredProcess_ entry;
+            entry.process = ptr;
+            entry.mask = ptr->GetComponentMask();
+            entry.access = ptr->GetComponentAccess();
+            entry.name = typeid(*ptr).name();
+            const auto& added = Filter_(entry.mask, allEntities, scratch);
+            if (added.size() > 0) ptr->EntitiesAdded(added);
+            RunProcess_(entry, deltaSeconds);
 
             // Commit process to list
-            processes_.push_back(ptr);
+            processes_.push_back(std::move(entry));
             handlesToPtrs_.insert(std::make_pair((EntityProcessHandle)ptr.get(), ptr));
         }
 
         // If any processes have been removed then remove them now
-        auto processesToRemove = std::move(processesToRemove_);
+        std::unordered_set<EntityProcessHandle> processesToRemove;
+        {
+            std::unique_lock<std::shared_mutex> ul(m_);
+            processesToRemove = std::move(processesToRemove_);
+            processesToRemove_.clear();
+        }
+
+        bool scheduleChanged = processesToAdd.size() > 0;
         for (EntityProcessHandle handle : processesToRemove) {
             auto handleIt = handlesToPtrs_.find(handle);
             if (handleIt == handlesToPtrs_.end()) continue;
             auto remove = handleIt->second;
             for (auto it = processes_.begin(); it != processes_.end(); ++it) {
-                EntityProcessPtr process = *it;
-                if (process == remove) {
+                if (it->process == remove) {
                     processes_.erase(it);
+                    scheduleChanged = true;
                     break;
                 }
             }
             handlesToPtrs_.erase(handle);
         }
 
+        if (scheduleChanged) RebuildSchedule_();
+
+        processTimings_.resize(processes_.size());
+        for (size_t i = 0; i < processes_.size(); ++i) {
+            const auto& entry = processes_[i];
+            processTimings_[i] = EntityProcessTiming{entry.name, entry.wave, entry.seconds};
+        }
+
         return SystemStatus::SYSTEM_CONTINUE;
     }
+
+    void EntityManager::RebuildSchedule_() {
+        // Conflicting processes still run in the order they were registered
+        schedule_.clear();
+        for (size_t i = 0; i < processes_.size(); ++i) {
+            auto& entry = processes_[i];
+            entry.wave = 0;
+            for (size_t j = 0; j < i; ++j) {
+                if (processes_[j].access.ConflictsWith(entry.access)) {
+                    entry.wave = std::max(entry.wave, processes_[j].wave + 1);
+                }
+            }
+            if (entry.wave >= schedule_.size()) schedule_.resize(entry.wave + 1);
+            schedule_[entry.wave].push_back(i);
+        }
+    }
+
+    void EntityManager::RunProcess_(RegisteredProcess_& entry, const double deltaSeconds) {
+        STRATUS_PROFILE_SCOPE("EntityProcess::Process");
+        const auto start = std::chrono::high_resolution_clock::now();
+        const bool wasShared = InSharedProcess_;
+        InSharedProcess_ = !entry.access.IsExclusive();
+        try {
+            entry.process->Process(deltaSeconds);
+        }
+        catch (...) {
+            InSharedProcess_ = wasShared;
+            throw;
+        }
+        InSharedProcess_ = wasShared;
+        entry.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
     
     void EntityManager::Shutdown() {
-        entities_.clear();
-        entitiesToAdd_.clear();
-        entitiesToRemove_.clear();
+        entities_.Clear();
+        applicationCommands_.clear();
+        EntityCommand_ command;
+        while (commands_.Pop(command)) {}
         processes_.clear();
         processesToAdd_.clear();
-        addedComponents_.clear();
+        schedule_.clear();
+        processTimings_.clear();
+        archetypes_.Clear();
+        ChangeJournal::Clear(Engine::CurrentFrame());
     }
     
     void EntityManager::RegisterEntityProcess_(EntityProcessPtr& ptr) {
@@ -116,24 +322,57 @@ namespace stratus {
         processesToAdd_.push_back(std::move(ptr));
     }
 
+    const std::vector<EntityProcessTiming>& EntityManager::GetProcessTimings() const {
+        EnsureCanRead_();
+        return processTimings_;
+    }
+
     void EntityManager::UnregisterEntityProcess(EntityProcessHandle handle) {
         std::unique_lock<std::shared_mutex> ul(m_);
         processesToRemove_.insert(handle);
     }
     
-    void EntityManager::NotifyComponentsAdded_(const EntityPtr& ptr, EntityComponent * component) {
-        std::unique_lock<std::shared_mutex> ul(m_);
-        auto it = addedComponents_.find(ptr);
-        if (it == addedComponents_.end()) {
-            addedComponents_.insert(std::make_pair(ptr, std::vector<EntityComponent *>{component}));
-        }
-        else {
-            it->second.push_back(component);
+    EntityPtr EntityManager::GetEntity(const EntityHandle& handle) const {
+        EnsureCanRead_();
+        const EntityPtr * ptr = entities_.Find(handle);
+        return ptr != nullptr ? *ptr : nullptr;
+    }
+
+    bool EntityManager::ContainsEntity(const EntityHandle& handle) const {
+        EnsureCanRead_();
+        return entities_.Contains(handle);
+    }
+
+    bool EntityManager::ChangedSince_(const ComponentTypeId type, const uint64_t sinceFrame, const ChangeJournal::Entry *& begin,
+                                      const ChangeJournal::Entry *& end) const {
+        // Merge writes to the journal so this can't be allowed on task threads. Checked separately so that
+        // a process which declares its access fails here even when its wave happens to run on this thread.
+        if (InSharedProcess_) {
+            throw std::runtime_error("ForEachChangedSince can't be called from a process which declares its component access");
         }
+        CHECK_IS_APPLICATION_THREAD();
+        ChangeJournal::Merge(Engine::CurrentFrame());
+        if (sinceFrame < ChangeJournal::OldestCompleteFrame()) return false;
+
+        const auto& entries = ChangeJournal::Entries(type);
+        const auto first = std::lower_bound(entries.begin(), entries.end(), sinceFrame, [](const ChangeJournal::Entry& e, const uint64_t frame) {
+            return e.frame < frame;
+        });
+        begin = entries.data() + (first - entries.begin());
+        end = entries.data() + entries.size();
+        return true;
+    }
+
+    void EntityManager::EnsureCanRead_() const {
+        if (processesRunning_.load()) return;
+        CHECK_IS_APPLICATION_THREAD();
+    }
+
+    void EntityManager::NotifyComponentsAdded_(const EntityPtr& ptr, EntityComponent * component) {
+        RecordCommand_(EntityCommandType_::COMPONENT_ADDED, ptr, component);
     }
 
     void EntityManager::NotifyComponentsEnabledDisabled_(const EntityPtr& ptr) {
-        std::unique_lock<std::shared_mutex> ul(m_);
-        componentsEnabledDisabled_.insert(ptr);
+        RecordCommand_(EntityCommandType_::COMPONENT_ENABLED_DISABLED, ptr, nullptr);
     }
 }
\ No newline at end of file
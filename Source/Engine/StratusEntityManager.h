@@ -11,8 +11,22 @@
 #include <vector>
 #include "StratusEntityCommon.h"
 #include "StratusEntityProcess.h"
+#include "StratusEntityArchetype.h"
+#include "StratusTaskSystem.h"
+#include "StratusMpscQueue.h"
+#include "StratusSlotMap.h"
+#include "StratusChangeJournal.h"
+#include <algorithm>
+#include <thread>
+#include <atomic>
 
 namespace stratus {
+    // Processes which declare their component access (see EntityProcess::GetComponentAccess) may run on task
+    // threads. While processes are running the world can't change, so from inside Process they may call:
+    //      GetEntity, ContainsEntity, GetProcessTimings, ForEach, ParallelForEach, Count - from any thread
+    //      AddEntity, RemoveEntity, RegisterEntityProcess, UnregisterEntityProcess - take effect next frame
+    // ForEachChangedSince is only for the application thread and exclusive processes. A process which declares
+    // its access gets an exception every time it calls it, whichever thread it happens to be on.
     SYSTEM_MODULE_CLASS(EntityManager)
         friend struct EntityComponentSet;
         friend class Entity;
@@ -23,21 +37,87 @@ namespace stratus {
         void AddEntity(const EntityPtr&);
         void RemoveEntity(const EntityPtr&);
 
+        // O(1) lookup of an entity in the world. Returns nullptr if the handle is stale (entity was removed).
+        // Reflects the world as of this frame's update. Application thread or any EntityProcess::Process.
+        EntityPtr GetEntity(const EntityHandle&) const;
+        bool ContainsEntity(const EntityHandle&) const;
+
         // Registers or Unregisters an EntityProcess type
         template<typename E, typename ... Types>
         EntityProcessHandle RegisterEntityProcess(const Types&... args);
         void UnregisterEntityProcess(EntityProcessHandle);
 
+        // Time each process spent in Process during the last update, in the order they were registered
+        const std::vector<EntityProcessTiming>& GetProcessTimings() const;
+
+        // Calls fn(const EntityPtr&, Components *...) for every entity in the world which has all of
+        // Components enabled. Reflects the world as of the start of this frame's update. Application thread
+        // or any EntityProcess::Process.
+        template<typename ... Components, typename F>
+        void ForEach(const F& fn) const;
+
+        // Same as ForEach but the entities are split into chunks which run across the task system.
+        // fn must be safe to call from multiple threads at once.
+        template<typename ... Components, typename F>
+        void ParallelForEach(const F& fn) const;
+
+        // Number of entities ForEach<Components...> would visit
+        template<typename ... Components>
+        size_t Count() const;
+
+        // Calls fn(const EntityPtr&, Component *) once for each entity in the world whose Component was marked
+        // changed on sinceFrame or later (see Engine::FrameCount), whether the component is enabled or not. Cost
+        // depends only on how much changed. Returns false without calling fn if the journal no longer goes back
+        // that far, in which case the caller has to check everything it tracks. Application thread only (this
+        // includes exclusive processes but not ones which declare their access), and fn must not call
+        // ForEachChangedSince itself.
+        template<typename Component, typename F>
+        bool ForEachChangedSince(const uint64_t sinceFrame, const F& fn) const;
+
         // SystemModule inteface
     private:
         bool Initialize() override;
         SystemStatus Update(const double) override;
         void Shutdown() override;
 
+    private:
+        enum class EntityCommandType_ : int {
+            ADD_ENTITY,
+            REMOVE_ENTITY,
+            COMPONENT_ADDED,
+            COMPONENT_ENABLED_DISABLED
+        };
+
+        struct EntityCommand_ {
+            EntityCommandType_ type;
+            EntityPtr entity;
+            // Only set for COMPONENT_ADDED
+            EntityComponent * component;
+        };
+
+        struct RegisteredProcess_ {
+            EntityProcessPtr process;
+            EntityComponentMask mask;
+            EntityComponentAccess access;
+            const char * name;
+            // Index into schedule_
+            size_t wave = 0;
+            double seconds = 0.0;
+        };
+
     private:
         void RegisterEntityProcess_(EntityProcessPtr&);
+        // Puts each process in the wave after the last earlier process it conflicts with
+        void RebuildSchedule_();
+        void RunProcess_(RegisteredProcess_&, const double deltaSeconds);
         void AddEntity_(const EntityPtr&);
         void RemoveEntity_(const EntityPtr&);
+        void RecordCommand_(EntityCommandType_, const EntityPtr&, EntityComponent *);
+        // Throws unless on the application thread or processes are running (the world can't change then)
+        void EnsureCanRead_() const;
+        // Journal entries for the component type from sinceFrame onward, or false if they're no longer kept
+        bool ChangedSince_(const ComponentTypeId, const uint64_t sinceFrame, const ChangeJournal::Entry *& begin,
+                           const ChangeJournal::Entry *& end) const;
 
     private:
         // Meant to be called by Entity
@@ -46,23 +126,29 @@ namespace stratus {
 
     private:
         mutable std::shared_mutex m_;
-        // All entities currently tracked
-        std::unordered_set<EntityPtr> entities_;
-        // Entities added within the last frame
-        std::unordered_set<EntityPtr> entitiesToAdd_;
-        // Entities which are pending removal (removed during Update)
-        std::unordered_set<EntityPtr> entitiesToRemove_;
+        // Thread which runs Update - commands it records skip the queue
+        std::thread::id applicationThreadId_;
+        // Set while Update is running processes
+        std::atomic<bool> processesRunning_{false};
+        // Commands recorded on the application thread since the last Update (only ever touched by that thread)
+        std::vector<EntityCommand_> applicationCommands_;
+        // Commands recorded on any other thread
+        MpscQueue<EntityCommand_> commands_;
+        // All entities currently tracked - gives out their handles
+        SlotMap<EntityPtr, Entity> entities_;
         // Processes removed within last frame
         std::unordered_set<EntityProcessHandle> processesToRemove_;
         // Processes added within last frame
         std::vector<EntityProcessPtr> processesToAdd_;
         // Systems which operate on entities
-        std::vector<EntityProcessPtr> processes_;
+        std::vector<RegisteredProcess_> processes_;
+        // Indices into processes_ - none of the processes within a wave conflict with each other
+        std::vector<std::vector<size_t>> schedule_;
+        std::vector<EntityProcessTiming> processTimings_;
         // Convert handle to process ptr
         std::unordered_map<EntityProcessHandle, EntityProcessPtr> handlesToPtrs_;
-        // Component change lists
-        std::unordered_map<EntityPtr, std::vector<EntityComponent *>> addedComponents_;
-        std::unordered_set<EntityPtr> componentsEnabledDisabled_;
+        // Entities in the world grouped by their enabled components (only changed during Update)
+        ArchetypeStorage archetypes_;
     };
 
     template<typename E, typename ... Types>
@@ -73,4 +159,58 @@ namespace stratus {
         RegisterEntityProcess_(ptr);
         return (EntityProcessHandle)p;
     }
+
+    template<typename ... Components, typename F>
+    void EntityManager::ForEach(const F& fn) const {
+        EnsureCanRead_();
+        archetypes_.ForEach<Components...>(fn);
+    }
+
+    template<typename ... Components, typename F>
+    void EntityManager::ParallelForEach(const F& fn) const {
+        EnsureCanRead_();
+        struct Chunk_ {
+            const Archetype * archetype;
+            size_t begin;
+        };
+
+        // All chunks go into a single ParallelFor so small archetypes don't serialize the work
+        std::vector<Chunk_> chunks;
+        for (size_t i = 0; i < archetypes_.NumArchetypes(); ++i) {
+            const Archetype& archetype = archetypes_.GetArchetype(i);
+            if (archetype.Size() == 0 || !archetype.template Matches<Components...>()) continue;
+            for (size_t begin = 0; begin < archetype.Size(); begin += ArchetypeStorage::ChunkSize) {
+                chunks.push_back(Chunk_{&archetype, begin});
+            }
+        }
+
+        INSTANCE(TaskSystem)->ParallelFor(0, chunks.size(), 1, [&chunks, &fn](const size_t i) {
+            const Chunk_& chunk = chunks[i];
+            const size_t end = std::min(chunk.begin + ArchetypeStorage::ChunkSize, chunk.archetype->Size());
+            chunk.archetype->template ForEachRow<Components...>(chunk.begin, end, fn);
+        });
+    }
+
+    template<typename ... Components>
+    size_t EntityManager::Count() const {
+        EnsureCanRead_();
+        return archetypes_.Count<Components...>();
+    }
+
+    template<typename Component, typename F>
+    bool EntityManager::ForEachChangedSince(const uint64_t sinceFrame, const F& fn) const {
+        const ChangeJournal::Entry * begin;
+        const ChangeJournal::Entry * end;
+        if (!ChangedSince_(Component::STypeId(), sinceFrame, begin, end)) return false;
+
+        for (; begin != end; ++begin) {
+            const EntityPtr * entity = entities_.Find(begin->entity);
+            if (entity == nullptr) continue;
+            Component * component = (*entity)->Components().template GetComponent<Component>().component;
+            // Only the entry for the latest change is visited
+            if (component == nullptr || component->LastFrameChanged() != begin->frame) continue;
+            fn(*entity, component);
+        }
+        return true;
+    }
 }
\ No newline at end of file
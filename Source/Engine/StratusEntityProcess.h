@@ -1,34 +1,157 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <unordered_set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "StratusEntityCommon.h"
+#include "StratusEntity.h"
 
 namespace stratus {
+    // Entity lists handed to processes are sorted by address and never contain the same entity twice
+    typedef std::vector<EntityPtr> EntityList;
+    // Sorted by entity - each entity's components are in the order they were attached
+    typedef std::vector<std::pair<EntityPtr, std::vector<EntityComponent *>>> EntityComponentsAddedList;
+
+    // Set of component types a process wants to hear about
+    class EntityComponentMask {
+    public:
+        template<typename ... Components>
+        static EntityComponentMask Of() {
+            EntityComponentMask mask;
+            (mask.Add(Components::STypeId()), ...);
+            return mask;
+        }
+
+        void Add(const ComponentTypeId id) {
+            if (Contains(id)) return;
+            if (id / 64 >= bits_.size()) bits_.resize(id / 64 + 1, 0);
+            bits_[id / 64] |= uint64_t(1) << (id % 64);
+            ids_.push_back(id);
+        }
+
+        bool Contains(const ComponentTypeId id) const {
+            return id / 64 < bits_.size() && (bits_[id / 64] & (uint64_t(1) << (id % 64))) != 0;
+        }
+
+        bool Empty() const {
+            return ids_.size() == 0;
+        }
+
+        // True if any component is in both masks
+        bool Intersects(const EntityComponentMask& other) const {
+            const size_t size = std::min(bits_.size(), other.bits_.size());
+            for (size_t i = 0; i < size; ++i) {
+                if ((bits_[i] & other.bits_[i]) != 0) return true;
+            }
+            return false;
+        }
+
+        // True if any component in the mask is attached (enabled or not)
+        bool Matches(const EntityComponentSet& components) const {
+            for (const ComponentTypeId id : ids_) {
+                if (components.GetComponentById(id).component != nullptr) return true;
+            }
+            return false;
+        }
+
+    private:
+        std::vector<uint64_t> bits_;
+        std::vector<ComponentTypeId> ids_;
+    };
+
+    // Component types a process reads and writes from Process. Two processes conflict if either one
+    // writes something the other reads or writes. For example:
+    //      return EntityComponentAccess().Reads<LocalTransformComponent>().Writes<GlobalTransformComponent>();
+    class EntityComponentAccess {
+    public:
+        // Conflicts with every other process
+        static EntityComponentAccess Exclusive() {
+            EntityComponentAccess access;
+            access.exclusive_ = true;
+            return access;
+        }
+
+        template<typename ... Components>
+        EntityComponentAccess& Reads() {
+            (reads_.Add(Components::STypeId()), ...);
+            return *this;
+        }
+
+        template<typename ... Components>
+        EntityComponentAccess& Writes() {
+            (writes_.Add(Components::STypeId()), ...);
+            return *this;
+        }
+
+        bool IsExclusive() const {
+            return exclusive_;
+        }
+
+        bool ConflictsWith(const EntityComponentAccess& other) const {
+            if (exclusive_ || other.exclusive_) return true;
+            return writes_.Intersects(other.reads_) || writes_.Intersects(other.writes_) || reads_.Intersects(other.writes_);
+        }
+
+    private:
+        EntityComponentMask reads_;
+        EntityComponentMask writes_;
+        bool exclusive_ = false;
+    };
+
+    // How long one process spent in Process during the last EntityManager update
+    struct EntityProcessTiming {
+        // typeid name of the process
+        const char * name;
+        // Processes with the same wave were free to run at the same time
+        size_t wave;
+        double seconds;
+    };
+
     // An entity system process signals to the engine that it wants to be called once
     // per frame in order to operate on certain entity data lists
     struct EntityProcess : public std::enable_shared_from_this<EntityProcess> {
         virtual ~EntityProcess() = default;
 
         // Gives the system a change to do whatever processing it needs
-        // Guarantee: only one process will be active at a time and may split
-        // the entities it is looping over across as many threads as it wants
+        // Guarantee: no process which conflicts with this one (see GetComponentAccess)
+        // will be active at the same time. It may split the entities it is looping
+        // over across as many threads as it wants.
         //
         // Requirement: when Process returns no entity data is being touched
         // by any other threads
         virtual void Process(const double deltaSeconds) = 0;
 
+        // The functions below are always called on the application thread while no
+        // process is running.
+        //
         // Called when an entity is added or removed from the world directly,
         // or when it is attached or detached from a parent entity who is
         // part of the world
-        virtual void EntitiesAdded(const std::unordered_set<stratus::EntityPtr>&) = 0;
-        virtual void EntitiesRemoved(const std::unordered_set<stratus::EntityPtr>&) = 0;
+        virtual void EntitiesAdded(const EntityList&) = 0;
+        virtual void EntitiesRemoved(const EntityList&) = 0;
 
         // Called when an entity has a component added
-        virtual void EntityComponentsAdded(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent *>>&) = 0;
+        virtual void EntityComponentsAdded(const EntityComponentsAddedList&) = 0;
         // Called when an entity component is enabled or disabled
-        virtual void EntityComponentsEnabledDisabled(const std::unordered_set<stratus::EntityPtr>&) = 0;
+        virtual void EntityComponentsEnabledDisabled(const EntityList&) = 0;
+
+        // Only entities with at least one of these components are passed to the functions
+        // above. Checked once when the process is registered - the default empty mask
+        // receives every entity.
+        virtual EntityComponentMask GetComponentMask() const {
+            return EntityComponentMask();
+        }
+
+        // What Process touches. Processes which don't conflict can have Process called at the same time,
+        // possibly on task threads, so anything they share has to be thread safe and they can only use the
+        // EntityManager functions it lists as allowed from Process. Exclusive processes always run by themselves
+        // on the application thread, which is the default for processes that don't say what they touch.
+        // Checked once when the process is registered.
+        virtual EntityComponentAccess GetComponentAccess() const {
+            return EntityComponentAccess::Exclusive();
+        }
     };
-}
\ No newline at end of file
+}
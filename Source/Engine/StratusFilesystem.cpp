@@ -1,10 +1,24 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <utility>
+#include <atomic>
+#include <thread>
 
 #include "StratusFilesystem.h"
 #include "StratusLog.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace stratus {
 /**
  * @see http://insanecoding.blogspot.com/2011/11/how-to-read-in-file-in-c.html
@@ -49,4 +63,147 @@ std::string Filesystem::ReadAscii(const std::string &file) {
 std::filesystem::path Filesystem::CurrentPath() {
     return std::filesystem::current_path();
 }
-}
\ No newline at end of file
+
+bool Filesystem::WriteBinaryAtomic(const std::string& file, const std::function<void (std::ofstream&)>& write) {
+    static std::atomic<uint64_t> nextTempId(0);
+
+    if (file.empty()) return false;
+
+    std::error_code error;
+    const auto parent = std::filesystem::path(file).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, error);
+
+    // Unique per thread and per call so concurrent writers of the same file don't share a temporary
+    std::stringstream temp;
+    temp << file << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << "." << nextTempId.fetch_add(1) << ".tmp";
+    const std::string tempFile = temp.str();
+
+    {
+        std::ofstream out(tempFile, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        write(out);
+        if (!out.good()) {
+            out.close();
+            std::filesystem::remove(tempFile, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempFile, file, error);
+    if (error) {
+        std::filesystem::remove(tempFile, error);
+        return false;
+    }
+    return true;
+}
+
+uint64_t HashFnv1a(const void * data, const size_t bytes, uint64_t hash) {
+    const uint8_t * ptr = reinterpret_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < bytes; ++i) {
+        hash ^= ptr[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void CacheDirectory::Set(const std::string& directory) {
+    auto ul = std::unique_lock<std::mutex>(m_);
+    directory_ = directory;
+}
+
+std::string CacheDirectory::Get() const {
+    auto ul = std::unique_lock<std::mutex>(m_);
+    return directory_;
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this == &other) return *this;
+    Close();
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+#ifdef _WIN32
+    std::swap(file_, other.file_);
+    std::swap(mapping_, other.mapping_);
+#endif
+    return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& file) {
+    Close();
+    HANDLE handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    const void * data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    data_ = (const uint8_t *)data;
+    size_ = size_t(size.QuadPart);
+    file_ = handle;
+    mapping_ = mapping;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_ != nullptr) UnmapViewOfFile(data_);
+    if (mapping_ != nullptr) CloseHandle(mapping_);
+    if (file_ != nullptr) CloseHandle(file_);
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = nullptr;
+    file_ = nullptr;
+}
+#else
+bool MappedFile::Open(const std::string& file) {
+    Close();
+    const int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void * data = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    data_ = (const uint8_t *)data;
+    size_ = size_t(info.st_size);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_ != nullptr) munmap((void *)data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+#endif
+}
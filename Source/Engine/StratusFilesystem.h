@@ -6,6 +6,11 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <mutex>
 
 namespace stratus {
     struct Filesystem {
@@ -22,6 +27,56 @@ namespace stratus {
 
         // Returns the current working directory
         static std::filesystem::path CurrentPath();
+
+        // Creates any missing parent directories, then calls write with a stream to a temporary file next to
+        // file and renames it into place, so readers (and other writers) never see a partial file. Safe to
+        // call from multiple threads, even for the same file. Returns false without logging if anything fails.
+        static bool WriteBinaryAtomic(const std::string& file, const std::function<void (std::ofstream&)>& write);
+    };
+
+    // 64-bit FNV-1a. Pass the previous result in as hash to keep hashing more data.
+    uint64_t HashFnv1a(const void * data, const size_t bytes, uint64_t hash = 14695981039346656037ull);
+
+    // Directory setting for an on-disk cache which can be changed and read from any thread
+    class CacheDirectory {
+    public:
+        explicit CacheDirectory(const std::string& directory) : directory_(directory) {}
+
+        void Set(const std::string&);
+        std::string Get() const;
+
+    private:
+        mutable std::mutex m_;
+        std::string directory_;
+    };
+
+    // Read-only view of a whole file. Pages are only read in as they're touched, and the
+    // mapping is released when this is destroyed.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(MappedFile&&) noexcept;
+        MappedFile& operator=(MappedFile&&) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Returns false if the file couldn't be opened or is empty
+        bool Open(const std::string& file);
+        void Close();
+
+        bool IsOpen() const { return data_ != nullptr; }
+        const uint8_t * Data() const { return data_; }
+        size_t Size() const { return size_; }
+
+    private:
+        const uint8_t * data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void * file_ = nullptr;
+        void * mapping_ = nullptr;
+#endif
     };
 }
 
@@ -0,0 +1,145 @@
+#include "StratusFramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace stratus {
+    // Sleeps are done in steps of this size so the overshoot estimate stays accurate
+    static constexpr auto SleepStep = std::chrono::milliseconds(1);
+    // Overshoot assumed before the first sleep has been measured
+    static constexpr double InitialOvershootSeconds = 0.001;
+    // Weight of each new overshoot sample - roughly the last 1 / OvershootWeight sleeps are what count
+    static constexpr double OvershootWeight = 0.1;
+    // Adaptive pacing reconsiders the target this often
+    static constexpr size_t AdaptIntervalFrames = 60;
+    // Leaves some headroom so a frame which just barely fits doesn't cause oscillation
+    static constexpr double AdaptHeadroom = 1.1;
+
+    static double Seconds(const FramePacer::Clock::duration& duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+
+    FramePacer::FramePacer(const uint32_t maxFrameRate)
+        : maxFrameRate_(std::max<uint32_t>(maxFrameRate, 1)),
+          targetFrameRate_(std::max<uint32_t>(maxFrameRate, 1)),
+          frameSeconds_(HistorySize, 0.0),
+          workSeconds_(HistorySize, 0.0) {}
+
+    void FramePacer::SetMaxFrameRate(const uint32_t rate) {
+        maxFrameRate_.store(std::max<uint32_t>(rate, 1));
+        targetFrameRate_.store(maxFrameRate_.load());
+    }
+
+    uint32_t FramePacer::GetMaxFrameRate() const {
+        return maxFrameRate_.load();
+    }
+
+    uint32_t FramePacer::GetTargetFrameRate() const {
+        return targetFrameRate_.load();
+    }
+
+    void FramePacer::SetAdaptive(const bool adaptive) {
+        adaptive_.store(adaptive);
+        if (!adaptive) targetFrameRate_.store(maxFrameRate_.load());
+    }
+
+    bool FramePacer::IsAdaptive() const {
+        return adaptive_.load();
+    }
+
+    FramePacer::Clock::time_point FramePacer::WaitUntilNextFrame(const Clock::time_point& prevFrameStart) {
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / double(targetFrameRate_.load())));
+        const auto deadline = prevFrameStart + period;
+
+        SleepUntil_(deadline);
+
+        // Spin out whatever is left
+        auto now = Clock::now();
+        while (now < deadline) {
+            std::this_thread::yield();
+            now = Clock::now();
+        }
+
+        return now;
+    }
+
+    void FramePacer::SleepUntil_(const Clock::time_point& deadline) {
+        while (true) {
+            const double overshoot = GetSleepOvershootSeconds();
+            const auto start = Clock::now();
+            if (Seconds(deadline - start) <= Seconds(SleepStep) + overshoot) return;
+
+            std::this_thread::sleep_for(SleepStep);
+
+            RecordSleepOvershoot(Seconds(Clock::now() - start) - Seconds(SleepStep));
+        }
+    }
+
+    double FramePacer::GetSleepOvershootSeconds() const {
+        if (!hasOvershoot_) return InitialOvershootSeconds;
+        // Mean + one standard deviation errs on the side of spinning a little longer
+        return overshootMean_ + std::sqrt(overshootVariance_);
+    }
+
+    void FramePacer::RecordSleepOvershoot(const double seconds) {
+        const double sample = std::max(0.0, seconds);
+        if (!hasOvershoot_) {
+            overshootMean_ = sample;
+            overshootVariance_ = 0.0;
+            hasOvershoot_ = true;
+            return;
+        }
+
+        const double delta = sample - overshootMean_;
+        overshootMean_ += OvershootWeight * delta;
+        overshootVariance_ = (1.0 - OvershootWeight) * (overshootVariance_ + OvershootWeight * delta * delta);
+    }
+
+    void FramePacer::RecordFrame(const double frameSeconds, const double workSeconds) {
+        frameSeconds_[next_] = frameSeconds;
+        workSeconds_[next_] = workSeconds;
+        next_ = (next_ + 1) % HistorySize;
+        count_ = std::min(count_ + 1, HistorySize);
+
+        if (adaptive_.load()) {
+            ++framesSinceAdapt_;
+            if (framesSinceAdapt_ >= AdaptIntervalFrames) {
+                framesSinceAdapt_ = 0;
+                AdaptTargetFrameRate_();
+            }
+        }
+    }
+
+    static double Percentile(std::vector<double>& values, const double percentile) {
+        const size_t index = std::min(values.size() - 1, size_t(std::ceil(percentile * double(values.size()))) - 1);
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    FrameTimePercentiles FramePacer::GetPercentiles() const {
+        FrameTimePercentiles result;
+        if (count_ == 0) return result;
+
+        std::vector<double> sorted(frameSeconds_.begin(), frameSeconds_.begin() + count_);
+        result.p50Seconds = Percentile(sorted, 0.50);
+        result.p95Seconds = Percentile(sorted, 0.95);
+        result.p99Seconds = Percentile(sorted, 0.99);
+        return result;
+    }
+
+    void FramePacer::AdaptTargetFrameRate_() {
+        std::vector<double> work(workSeconds_.begin(), workSeconds_.begin() + count_);
+        const double p95Work = Percentile(work, 0.95);
+        if (p95Work <= 0.0) return;
+
+        const uint32_t maxRate = maxFrameRate_.load();
+        const uint32_t current = targetFrameRate_.load();
+        const uint32_t sustainable = std::clamp<uint32_t>(
+            uint32_t(1.0 / (p95Work * AdaptHeadroom)), std::min(MinAdaptiveFrameRate, maxRate), maxRate);
+
+        // Back off right away but only climb back once there is clearly room for it
+        if (sustainable < current || double(sustainable) > double(current) * AdaptHeadroom) {
+            targetFrameRate_.store(sustainable);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace stratus {
+    struct FrameTimePercentiles {
+        double p50Seconds = 0.0;
+        double p95Seconds = 0.0;
+        double p99Seconds = 0.0;
+    };
+
+    // Holds the engine to its max frame rate without busy waiting for the whole frame. Most of the
+    // wait is spent asleep and only the last part (sized by how much the OS has been oversleeping)
+    // is spent spinning so frames still start on time.
+    //
+    // With adaptive pacing enabled the target frame rate drops whenever the frames themselves can't
+    // keep up, so frame times stay even instead of alternating between fast and slow frames. It
+    // climbs back toward the max once there is headroom again.
+    //
+    // Only the thread running the engine loop should call WaitUntilNextFrame, RecordFrame and
+    // RecordSleepOvershoot.
+    class FramePacer {
+    public:
+        typedef std::chrono::high_resolution_clock Clock;
+
+        // Number of frames the percentiles and adaptive pacing look at
+        static constexpr size_t HistorySize = 240;
+        // Lowest frame rate adaptive pacing will drop to
+        static constexpr uint32_t MinAdaptiveFrameRate = 30;
+
+        explicit FramePacer(const uint32_t maxFrameRate);
+
+        void SetMaxFrameRate(const uint32_t);
+        uint32_t GetMaxFrameRate() const;
+        // Frame rate currently being paced to - only differs from the max while adaptive pacing has backed off
+        uint32_t GetTargetFrameRate() const;
+
+        void SetAdaptive(const bool);
+        bool IsAdaptive() const;
+
+        // Blocks until one target frame period has passed since prevFrameStart. Returns the time the
+        // wait finished (immediately if the period has already passed).
+        Clock::time_point WaitUntilNextFrame(const Clock::time_point& prevFrameStart);
+
+        // frameSeconds is start to start, workSeconds is the part of it not spent waiting
+        void RecordFrame(const double frameSeconds, const double workSeconds);
+
+        // Frame time percentiles over the last HistorySize frames
+        FrameTimePercentiles GetPercentiles() const;
+
+        // Current guess at how far past the requested time a 1 ms sleep wakes up
+        double GetSleepOvershootSeconds() const;
+        // Adds one measurement of how far a sleep overshot. Recent sleeps count the most so the guess
+        // follows changes in timer resolution or system load. Called by WaitUntilNextFrame after each sleep.
+        void RecordSleepOvershoot(const double seconds);
+
+    private:
+        void SleepUntil_(const Clock::time_point&);
+        void AdaptTargetFrameRate_();
+
+    private:
+        std::atomic<uint32_t> maxFrameRate_;
+        std::atomic<uint32_t> targetFrameRate_;
+        std::atomic<bool> adaptive_{false};
+
+        // Ring buffers of the most recent frames
+        std::vector<double> frameSeconds_;
+        std::vector<double> workSeconds_;
+        size_t next_ = 0;
+        size_t count_ = 0;
+        size_t framesSinceAdapt_ = 0;
+
+        // Exponentially weighted mean/variance of how much sleeps overshoot
+        double overshootMean_ = 0.0;
+        double overshootVariance_ = 0.0;
+        bool hasOvershoot_ = false;
+    };
+}
@@ -3,7 +3,10 @@
 #include <iostream>
 #include <algorithm>
 #include "StratusApplicationThread.h"
+#include "StratusGraphicsDriver.h"
 #include "StratusLog.h"
+#include <atomic>
+#include <cstring>
 
 namespace stratus {
     typedef std::function<void(void)> GpuBufferCommand;
@@ -74,13 +77,48 @@ namespace stratus {
         glNamedBufferStorage(buffer, sizeBytes, data, _ConvertUsageType(usage));
     }
 
+    // Buffers can be created and destroyed from any thread so everything is atomic
+    struct NullGpuBufferCounters {
+        std::atomic<uint64_t> buffersCreated{0};
+        std::atomic<uint64_t> buffersDestroyed{0};
+        std::atomic<uint64_t> liveBytes{0};
+        std::atomic<uint64_t> bytesCopiedToGpu{0};
+        std::atomic<uint64_t> bytesCopiedOnGpu{0};
+        std::atomic<uint64_t> bytesCopiedToSysMem{0};
+        std::atomic<uint64_t> binds{0};
+        std::atomic<uint64_t> maps{0};
+    };
+
+    static NullGpuBufferCounters& GetNullCounters() {
+        static NullGpuBufferCounters counters;
+        return counters;
+    }
+
+    static void _Count(std::atomic<uint64_t>& counter, const uint64_t amount = 1) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+
     struct GpuBufferImpl {
         GpuBufferImpl(const void * data, const uintptr_t sizeBytes, const Bitfield usage) 
-            : _sizeBytes(sizeBytes) {
+            : _sizeBytes(sizeBytes),
+              _null(GraphicsDriver::IsHeadless()) {
+            if (_null) {
+                _buffer = 0;
+                _Count(GetNullCounters().buffersCreated);
+                _Count(GetNullCounters().liveBytes, sizeBytes);
+                if (data != nullptr) _Count(GetNullCounters().bytesCopiedToGpu, sizeBytes);
+                return;
+            }
             _CreateBuffer(_buffer, data, sizeBytes, usage);
         }
 
         ~GpuBufferImpl() {
+            if (_null) {
+                _Count(GetNullCounters().buffersDestroyed);
+                GetNullCounters().liveBytes.fetch_sub(_sizeBytes, std::memory_order_relaxed);
+                return;
+            }
+
             if (ApplicationThread::Instance()->CurrentIsApplicationThread()) {
                 glDeleteBuffers(1, &_buffer);
             }
@@ -132,26 +170,41 @@ namespace stratus {
     }
 
     void Bind(const GpuBindingPoint point) const {
+        if (_null) {
+            _Count(GetNullCounters().binds);
+            return;
+        }
         glBindBuffer(_ConvertBufferType(int(point)), _buffer);
         for (auto& enable : _enableAttributes) enable();
     }
 
     void Unbind(const GpuBindingPoint point) const {
+        if (_null) return;
         glBindBuffer(_ConvertBufferType(int(point)), 0);
     }
 
     void BindBase(const GpuBaseBindingPoint point, const uint32_t index) const {
+        if (_null) {
+            _Count(GetNullCounters().binds);
+            return;
+        }
         glBindBufferBase(_ConvertBufferType(int(point)), index, _buffer);
     }
 
     void * MapMemory(const Bitfield access) const {
         _isMemoryMapped = true;
+        if (_null) {
+            _Count(GetNullCounters().maps);
+            // Only buffers which actually get mapped pay for system memory
+            _nullMemory.resize(_sizeBytes);
+            return (void *)_nullMemory.data();
+        }
         void * ptr = glMapNamedBufferRange(_buffer, 0, _sizeBytes, _ConvertUsageType(access));
         return ptr;
     }
     
     void UnmapMemory() const {
-        glUnmapNamedBuffer(_buffer);
+        if (!_null) glUnmapNamedBuffer(_buffer);
         _isMemoryMapped = false;
     }
 
@@ -167,6 +220,11 @@ namespace stratus {
         if (offset + size > SizeBytes()) {
             throw std::runtime_error("offset+size exceeded maximum GPU buffer size");
         }
+        if (_null) {
+            _Count(GetNullCounters().bytesCopiedToGpu, size);
+            if (_nullMemory.size() > 0) std::memcpy(_nullMemory.data() + offset, data, size);
+            return;
+        }
         glNamedBufferSubData(_buffer, offset, size, data);
     }
 
@@ -177,13 +235,44 @@ namespace stratus {
         if (this == &buffer) {
             throw std::runtime_error("Attempt to copy from buffer to itself");
         }
+        if (_null) {
+            _Count(GetNullCounters().bytesCopiedOnGpu, buffer.SizeBytes());
+            if (buffer._nullMemory.size() > 0) {
+                _nullMemory.resize(_sizeBytes);
+                std::memcpy(_nullMemory.data(), buffer._nullMemory.data(), buffer.SizeBytes());
+            }
+            return;
+        }
         glCopyNamedBufferSubData(buffer._buffer, _buffer, 0, 0, buffer.SizeBytes());
     }
 
+    void CopyDataFromBuffer(const GpuBufferImpl& buffer, intptr_t srcOffset, intptr_t dstOffset, uintptr_t size) {
+        if (srcOffset + size > buffer.SizeBytes() || dstOffset + size > SizeBytes()) {
+            throw std::runtime_error("offset+size exceeded maximum GPU buffer size");
+        }
+        if (this == &buffer) {
+            throw std::runtime_error("Attempt to copy from buffer to itself");
+        }
+        if (_null) {
+            _Count(GetNullCounters().bytesCopiedOnGpu, size);
+            if (_nullMemory.size() > 0 && buffer._nullMemory.size() > 0) {
+                std::memcpy(_nullMemory.data() + dstOffset, buffer._nullMemory.data() + srcOffset, size);
+            }
+            return;
+        }
+        glCopyNamedBufferSubData(buffer._buffer, _buffer, srcOffset, dstOffset, size);
+    }
+
     void CopyDataFromBufferToSysMem(intptr_t offset, uintptr_t size, void * data) {
         if (offset + size > SizeBytes()) {
             throw std::runtime_error("offset+size exceeded maximum GPU buffer size");
         }
+        if (_null) {
+            _Count(GetNullCounters().bytesCopiedToSysMem, size);
+            if (_nullMemory.size() > 0) std::memcpy(data, _nullMemory.data() + offset, size);
+            else std::memset(data, 0, size);
+            return;
+        }
         glGetNamedBufferSubData(_buffer, offset, size, data);
     }
 
@@ -203,6 +292,9 @@ namespace stratus {
         GLuint _buffer;
         uintptr_t _sizeBytes;
         mutable bool _isMemoryMapped = false;
+        // Null buffers make no GL calls. System memory is only allocated if the buffer gets mapped.
+        const bool _null;
+        mutable std::vector<uint8_t> _nullMemory;
 
         std::vector<GpuBufferCommand> _enableAttributes;
     };
@@ -253,6 +345,13 @@ namespace stratus {
         impl_->CopyDataFromBuffer(*buffer.impl_);
     }
 
+    void GpuBuffer::CopyDataFromBuffer(const GpuBuffer& buffer, intptr_t srcOffset, intptr_t dstOffset, uintptr_t size) {
+        if (impl_ == nullptr || buffer.impl_ == nullptr) {
+            throw std::runtime_error("Attempt to use null GpuBuffer");
+        }
+        impl_->CopyDataFromBuffer(*buffer.impl_, srcOffset, dstOffset, size);
+    }
+
     void GpuBuffer::CopyDataFromBufferToSysMem(intptr_t offset, uintptr_t size, void * data) {
         impl_->CopyDataFromBufferToSysMem(offset, size, data);
     }
@@ -261,6 +360,20 @@ namespace stratus {
         impl_->FinalizeMemory();
     }
 
+    GpuBufferStatistics GpuBuffer::GetNullStatistics() {
+        const NullGpuBufferCounters& counters = GetNullCounters();
+        GpuBufferStatistics stats;
+        stats.buffersCreated = counters.buffersCreated.load(std::memory_order_relaxed);
+        stats.buffersDestroyed = counters.buffersDestroyed.load(std::memory_order_relaxed);
+        stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+        stats.bytesCopiedToGpu = counters.bytesCopiedToGpu.load(std::memory_order_relaxed);
+        stats.bytesCopiedOnGpu = counters.bytesCopiedOnGpu.load(std::memory_order_relaxed);
+        stats.bytesCopiedToSysMem = counters.bytesCopiedToSysMem.load(std::memory_order_relaxed);
+        stats.binds = counters.binds.load(std::memory_order_relaxed);
+        stats.maps = counters.maps.load(std::memory_order_relaxed);
+        return stats;
+    }
+
     GpuPrimitiveBuffer::GpuPrimitiveBuffer(const GpuPrimitiveBindingPoint type, const void * data, const uintptr_t sizeBytes, const Bitfield usage)
         : GpuBuffer(data, sizeBytes, usage),
           type_(type) {}
@@ -372,6 +485,13 @@ namespace stratus {
     std::vector<GpuMeshAllocator::_MeshData> GpuMeshAllocator::freeVertices_;
     std::vector<GpuMeshAllocator::_MeshData> GpuMeshAllocator::freeIndices_;
     bool GpuMeshAllocator::initialized_ = false;
+    GpuBuffer GpuMeshAllocator::staging_;
+    uint8_t * GpuMeshAllocator::stagingMemory_ = nullptr;
+    size_t GpuMeshAllocator::stagingSegment_ = 0;
+    size_t GpuMeshAllocator::stagingNextByte_ = 0;
+    std::vector<GLsync> GpuMeshAllocator::stagingFences_;
+    static constexpr size_t stagingSegmentBytes = 1024 * 1024 * 4;
+    static constexpr size_t numStagingSegments = 4;
     static constexpr size_t startVertices = 1024 * 1024 * 10;
     static constexpr size_t minVerticesPerAlloc = startVertices; //1024 * 1024;
     static constexpr size_t maxVertexBytes = std::numeric_limits<uint32_t>::max() * sizeof(GpuMeshData);
@@ -527,6 +647,83 @@ namespace stratus {
         indices_.CopyDataToBuffer(byteOffset, data.size() * sizeof(uint32_t), (const void *)data.data());
     }
 
+    void GpuMeshAllocator::StreamVertexData(const GpuMeshData * data, const uint32_t numVertices, const uint32_t offset) {
+        static constexpr size_t maxPerCopy = stagingSegmentBytes / sizeof(GpuMeshData);
+        for (size_t first = 0; first < numVertices; first += maxPerCopy) {
+            const size_t count = std::min<size_t>(numVertices - first, maxPerCopy);
+            const size_t bytes = count * sizeof(GpuMeshData);
+            size_t stagingOffset;
+            uint8_t * staging = ReserveStaging_(bytes, stagingOffset);
+            std::memcpy(staging, data + first, bytes);
+            vertices_.CopyDataFromBuffer(staging_, stagingOffset, (intptr_t(offset) + first) * sizeof(GpuMeshData), bytes);
+        }
+    }
+
+    void GpuMeshAllocator::StreamIndexData(const uint32_t * data, const uint32_t numIndices, const uint32_t offset, const uint32_t baseVertex) {
+        static constexpr size_t maxPerCopy = stagingSegmentBytes / sizeof(uint32_t);
+        for (size_t first = 0; first < numIndices; first += maxPerCopy) {
+            const size_t count = std::min<size_t>(numIndices - first, maxPerCopy);
+            const size_t bytes = count * sizeof(uint32_t);
+            size_t stagingOffset;
+            uint32_t * staging = reinterpret_cast<uint32_t *>(ReserveStaging_(bytes, stagingOffset));
+            // Indices are relative to the mesh but the vertices live in one global buffer
+            for (size_t i = 0; i < count; ++i) {
+                staging[i] = data[first + i] + baseVertex;
+            }
+            indices_.CopyDataFromBuffer(staging_, stagingOffset, (intptr_t(offset) + first) * sizeof(uint32_t), bytes);
+        }
+    }
+
+    uint8_t * GpuMeshAllocator::ReserveStaging_(const size_t bytes, size_t& stagingOffset) {
+        assert(bytes <= stagingSegmentBytes);
+
+        // Created on first use since most frames never stream anything
+        if (stagingMemory_ == nullptr) {
+            const Bitfield flags = GPU_MAP_WRITE | GPU_MAP_PERSISTENT | GPU_MAP_COHERENT;
+            staging_ = GpuBuffer(nullptr, stagingSegmentBytes * numStagingSegments, flags);
+            stagingMemory_ = (uint8_t *)staging_.MapMemory(flags);
+            stagingFences_.resize(numStagingSegments, nullptr);
+            stagingSegment_ = 0;
+            stagingNextByte_ = 0;
+        }
+
+        if (stagingNextByte_ + bytes > stagingSegmentBytes) {
+            const bool headless = GraphicsDriver::IsHeadless();
+            // Every copy out of the segment we're leaving has been issued, so one fence covers all of them
+            if (!headless) stagingFences_[stagingSegment_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            stagingSegment_ = (stagingSegment_ + 1) % numStagingSegments;
+            stagingNextByte_ = 0;
+
+            // Only blocks if we've wrapped all the way around before the GPU caught up
+            GLsync& fence = stagingFences_[stagingSegment_];
+            if (fence != nullptr) {
+                while (true) {
+                    const GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+                    if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) break;
+                }
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+
+        stagingOffset = stagingSegment_ * stagingSegmentBytes + stagingNextByte_;
+        stagingNextByte_ += bytes;
+        return stagingMemory_ + stagingOffset;
+    }
+
+    void GpuMeshAllocator::ReleaseStaging_() {
+        if (stagingMemory_ == nullptr) return;
+        if (!GraphicsDriver::IsHeadless()) {
+            for (GLsync fence : stagingFences_) {
+                if (fence != nullptr) glDeleteSync(fence);
+            }
+        }
+        stagingFences_.clear();
+        staging_.UnmapMemory();
+        staging_ = GpuBuffer();
+        stagingMemory_ = nullptr;
+    }
+
     void GpuMeshAllocator::BindBase(const GpuBaseBindingPoint& point, const uint32_t index) {
         vertices_.BindBase(point, index);
     }
@@ -549,6 +746,7 @@ namespace stratus {
     }
 
     void GpuMeshAllocator::Shutdown_() {
+        ReleaseStaging_();
         vertices_ = GpuBuffer();
         indices_ = GpuBuffer();
         initialized_ = false;
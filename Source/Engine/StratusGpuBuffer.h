@@ -74,6 +74,22 @@ namespace stratus {
     struct GpuBufferImpl;
     struct GpuArrayBufferImpl;
 
+    // Totals recorded by the null GpuBuffer backend which is used while GraphicsDriver is headless
+    struct GpuBufferStatistics {
+        uint64_t buffersCreated = 0;
+        uint64_t buffersDestroyed = 0;
+        // Sum of SizeBytes() for every buffer still alive
+        uint64_t liveBytes = 0;
+        // CopyDataToBuffer and data passed in at creation
+        uint64_t bytesCopiedToGpu = 0;
+        // CopyDataFromBuffer
+        uint64_t bytesCopiedOnGpu = 0;
+        // CopyDataFromBufferToSysMem
+        uint64_t bytesCopiedToSysMem = 0;
+        uint64_t binds = 0;
+        uint64_t maps = 0;
+    };
+
     // A gpu buffer holds primitive data usually in the form of floats, ints and shorts
     // TODO: Look into use cases for things other than STATIC_DRAW
     struct GpuBuffer {
@@ -96,11 +112,16 @@ namespace stratus {
         // Make sure GPU_DYNAMIC_DATA is set
         void CopyDataToBuffer(intptr_t offset, uintptr_t size, const void * data);
         void CopyDataFromBuffer(const GpuBuffer&);
+        // Copies size bytes starting at srcOffset in the other buffer to dstOffset in this one
+        void CopyDataFromBuffer(const GpuBuffer&, intptr_t srcOffset, intptr_t dstOffset, uintptr_t size);
         void CopyDataFromBufferToSysMem(intptr_t offset, uintptr_t size, void * data);
 
         // Memory mapping and data copying won't work after this
         void FinalizeMemory();
 
+        // Only buffers created while GraphicsDriver::IsHeadless() is true are counted
+        static GpuBufferStatistics GetNullStatistics();
+
         bool operator==(const GpuBuffer& other) const {
             // Pointer comparison
             return this->impl_ == other.impl_;
@@ -174,7 +195,8 @@ namespace stratus {
         GpuTypedBuffer& operator=(const GpuTypedBuffer&) = delete;
 
         // Changes are buffered on the CPU
-        void UploadChangesToGpu() {
+        // Returns how many bytes were uploaded
+        size_t UploadChangesToGpu() {
             if (firstModifiedIndex_ != lastModifiedIndex_) {
                 const intptr_t offsetBytes = intptr_t(firstModifiedIndex_) * sizeof(E);
                 const uintptr_t sizeBytes = uintptr_t(lastModifiedIndex_ - firstModifiedIndex_) * sizeof(E);
@@ -183,7 +205,9 @@ namespace stratus {
 
                 firstModifiedIndex_ = -1;
                 lastModifiedIndex_ = -1;
+                return size_t(sizeBytes);
             }
+            return 0;
         }
 
         // Adds an element to either an existing slot
@@ -388,6 +412,12 @@ namespace stratus {
         static void CopyVertexData(const std::vector<GpuMeshData>&, const uint32_t offset);
         static void CopyIndexData(const std::vector<uint32_t>&, const uint32_t offset);
 
+        // Uploads through a persistently mapped staging ring instead of from a std::vector. The source is
+        // read exactly once, so it can point straight into a memory mapped file.
+        static void StreamVertexData(const GpuMeshData *, const uint32_t numVertices, const uint32_t offset);
+        // baseVertex is added to each index on the way through
+        static void StreamIndexData(const uint32_t *, const uint32_t numIndices, const uint32_t offset, const uint32_t baseVertex);
+
         // Binds the GpuMesh buffer
         static void BindBase(const GpuBaseBindingPoint&, const uint32_t);
         // Binds/unbinds indices buffer
@@ -406,6 +436,9 @@ namespace stratus {
         static void Shutdown_();
         static void Resize_(GpuBuffer& buffer, _MeshData& data, const size_t newSizeBytes);
         static size_t RemainingBytes_(const _MeshData& data);
+        // Returns mapped staging memory for bytes (at most one segment) and where it lives in staging_
+        static uint8_t * ReserveStaging_(const size_t bytes, size_t& stagingOffset);
+        static void ReleaseStaging_();
 
     private:
         static GpuBuffer vertices_;
@@ -418,5 +451,12 @@ namespace stratus {
         static std::vector<_MeshData> freeVertices_;
         static std::vector<_MeshData> freeIndices_;
         static bool initialized_;
+        // Split into segments which are fenced when the ring moves past them so that memory isn't
+        // overwritten before the GPU has copied out of it
+        static GpuBuffer staging_;
+        static uint8_t * stagingMemory_;
+        static size_t stagingSegment_;
+        static size_t stagingNextByte_;
+        static std::vector<GLsync> stagingFences_;
     };
 }
@@ -368,12 +368,12 @@ namespace stratus {
             return;
         }
 
-        // Already recorded
-        if (entities_.find(e) != entities_.end()) {
+        // Already recorded (or not part of the world)
+        if (!e->GetHandle() || entities_.Contains(e->GetHandle())) {
             return;
         }
 
-        entities_.insert(e);
+        entities_.Insert(e->GetHandle(), e);
 
         auto c = GetComponent<RenderComponent>(e);
         auto mt = GetComponent<MeshWorldTransforms>(e);
@@ -415,11 +415,11 @@ namespace stratus {
             &staticPbrMeshes
         };
 
-        if (entities_.find(e) == entities_.end()) {
+        if (!entities_.Contains(e->GetHandle())) {
             return;
         }
 
-        entities_.erase(e);
+        entities_.Remove(e->GetHandle());
 
         auto c = GetComponent<RenderComponent>(e);
 
@@ -435,7 +435,9 @@ namespace stratus {
 
     void GpuCommandManager::ClearCommands()
     {
-        for (auto& e : entities_) {
+        // RemoveAllCommands changes entities_
+        const std::vector<EntityPtr> entities = entities_.Values();
+        for (auto& e : entities) {
             RemoveAllCommands(e);
         }
     }
@@ -454,7 +456,7 @@ namespace stratus {
             &staticPbrMeshes
         };
 
-        if (entities_.find(e) == entities_.end()) {
+        if (!entities_.Contains(e->GetHandle())) {
             return;
         }
 
@@ -485,7 +487,7 @@ namespace stratus {
             &staticPbrMeshes
         };
 
-        if (entities_.find(e) == entities_.end()) {
+        if (!entities_.Contains(e->GetHandle())) {
             return;
         }
 
@@ -126,7 +126,8 @@ namespace stratus {
         }
 
     private:
-        std::unordered_set<EntityPtr> entities_;
+        // Keyed by entity handle - every entity recorded here is part of the world
+        SparseHandleMap<EntityPtr, Entity> entities_;
         size_t numLods_;
     };
 
@@ -1,6 +1,8 @@
 #include "StratusGpuMaterialBuffer.h"
 #include "StratusResourceManager.h"
 #include "StratusLog.h"
+#include <algorithm>
+#include <limits>
 
 namespace stratus {
     GpuMaterialBuffer::GpuMaterialBuffer(size_t maxMaterials)
@@ -135,7 +137,29 @@ namespace stratus {
                 index = it->second;
             }
 
-            availableMaterials_.find(material)->second.insert(component);
+            auto& users = availableMaterials_.find(material)->second;
+            users.insert(component);
+            if (pendingMaterials_.find(material) != pendingMaterials_.end()) {
+                PrioritizeLoadingTextures_(material, users.size());
+            }
+        }
+    }
+
+    // Textures of materials which more components are waiting on get decoded first
+    void GpuMaterialBuffer::PrioritizeLoadingTextures_(const MaterialPtr& material, const size_t numUsers) {
+        const int priority = static_cast<int>(std::min<size_t>(numUsers, std::numeric_limits<int>::max()));
+        const TextureHandle handles[] = {
+            material->GetDiffuseMap(),
+            material->GetEmissiveMap(),
+            material->GetNormalMap(),
+            material->GetRoughnessMap(),
+            material->GetMetallicMap(),
+            material->GetMetallicRoughnessMap()
+        };
+
+        for (const TextureHandle handle : handles) {
+            if (handle == TextureHandle::Null()) continue;
+            INSTANCE(ResourceManager)->PrioritizeTexture(handle, priority);
         }
     }
 
@@ -173,13 +197,21 @@ namespace stratus {
 
     void GpuMaterialBuffer::UploadDataToGpu()
     {
-        auto pending = std::move(pendingMaterials_);
-        for (auto& p : pending) {
-            const int index = static_cast<int>(usedIndices_.find(p)->second);
-            CopyMaterialToGpuStaging_(p, index);
+        // Nothing a pending material is waiting on can have changed until another texture finishes
+        const uint64_t numTexturesFinished = INSTANCE(ResourceManager)->GetNumTexturesFinished();
+        if (numTexturesFinished != numTexturesFinished_) {
+            numTexturesFinished_ = numTexturesFinished;
+            auto pending = std::move(pendingMaterials_);
+            for (auto& p : pending) {
+                const int index = static_cast<int>(usedIndices_.find(p)->second);
+                CopyMaterialToGpuStaging_(p, index);
+            }
         }
 
-        materials_->UploadChangesToGpu();
+        // The next draw reads these so they can't wait for the upload scheduler, but they still come
+        // out of its budget
+        const size_t bytes = materials_->UploadChangesToGpu();
+        if (bytes > 0) INSTANCE(ResourceManager)->ChargeImmediateUpload(bytes);
     }
 
     GpuBuffer GpuMaterialBuffer::GetMaterialBuffer() const
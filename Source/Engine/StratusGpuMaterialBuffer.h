@@ -42,6 +42,7 @@ namespace stratus {
 
     private:
         void CopyMaterialToGpuStaging_(const MaterialPtr& material, const int index);
+        void PrioritizeLoadingTextures_(const MaterialPtr& material, const size_t numUsers);
 
     private:
         GpuTypedBufferPtr<GpuMaterial> materials_;
@@ -51,5 +52,7 @@ namespace stratus {
         // Indices can change completely if new materials are added
         std::unordered_map<MaterialPtr, uint32_t> usedIndices_;
         std::unordered_set<MaterialPtr> pendingMaterials_;
+        // Pending materials are only checked again once more textures have finished loading
+        uint64_t numTexturesFinished_ = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "StratusGpuUploadScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include "StratusMath.h"
+
+namespace stratus {
+    // How much each older upload counts for compared to the one after it (roughly the last 50 uploads matter)
+    static constexpr double CostModelDecay_ = 0.98;
+    // Fraction of the gap closed each frame when there is room to grow the time budget. Cutting it back
+    // happens all at once.
+    static constexpr double TimeBudgetGrowRate_ = 0.25;
+
+    static double ToMegabytes_(const size_t bytes) {
+        return double(bytes) / (1024.0 * 1024.0);
+    }
+
+    void GpuUploadScheduler::CostModel_::Add(const double megabytes, const double seconds) {
+        weight_ = weight_ * CostModelDecay_ + 1.0;
+        sumX_ = sumX_ * CostModelDecay_ + megabytes;
+        sumY_ = sumY_ * CostModelDecay_ + seconds;
+        sumXX_ = sumXX_ * CostModelDecay_ + megabytes * megabytes;
+        sumXY_ = sumXY_ * CostModelDecay_ + megabytes * seconds;
+    }
+
+    void GpuUploadScheduler::CostModel_::Coefficients(double& secondsPerUpload, double& secondsPerMegabyte) const {
+        secondsPerUpload = 0.0;
+        secondsPerMegabyte = 0.0;
+        if (weight_ <= 0.0) return;
+
+        const double meanX = sumX_ / weight_;
+        const double meanY = sumY_ / weight_;
+        const double varianceX = sumXX_ / weight_ - meanX * meanX;
+        if (varianceX > 1e-6 * meanX * meanX && varianceX > 0.0) {
+            secondsPerMegabyte = (sumXY_ / weight_ - meanX * meanY) / varianceX;
+            secondsPerUpload = meanY - secondsPerMegabyte * meanX;
+        }
+        // Every upload so far was about the same size so there's no telling fixed cost apart from per byte cost
+        else if (meanX > 0.0) {
+            secondsPerMegabyte = meanY / meanX;
+        }
+        else {
+            secondsPerUpload = meanY;
+        }
+
+        // Neither can be negative - fall back to fitting only the other one
+        if (secondsPerMegabyte < 0.0) {
+            secondsPerMegabyte = 0.0;
+            secondsPerUpload = meanY;
+        }
+        else if (secondsPerUpload < 0.0) {
+            secondsPerUpload = 0.0;
+            secondsPerMegabyte = sumXX_ > 0.0 ? sumXY_ / sumXX_ : 0.0;
+        }
+    }
+
+    double GpuUploadScheduler::CostModel_::Predict(const double megabytes) const {
+        double secondsPerUpload, secondsPerMegabyte;
+        Coefficients(secondsPerUpload, secondsPerMegabyte);
+        return secondsPerUpload + secondsPerMegabyte * megabytes;
+    }
+
+    GpuUploadScheduler::GpuUploadScheduler(const GpuUploadBudget& budget, const ClockFunction& clock)
+        : budget_(budget), clock_(clock), timeBudget_(budget.minSeconds) {}
+
+    void GpuUploadScheduler::SetBudget(const GpuUploadBudget& budget) {
+        std::unique_lock<std::mutex> ul(mutex_);
+        budget_ = budget;
+    }
+
+    GpuUploadBudget GpuUploadScheduler::GetBudget() const {
+        std::unique_lock<std::mutex> ul(mutex_);
+        return budget_;
+    }
+
+    void GpuUploadScheduler::Submit(const size_t estimatedBytes, const int priority, const UploadFunction& upload, const uint64_t key) {
+        Submit_(Upload_{0, key, priority, false, GpuAABB(), estimatedBytes, upload, true, 0.0f});
+    }
+
+    void GpuUploadScheduler::Submit(const GpuAABB& worldBounds, const size_t estimatedBytes, const int priority, const UploadFunction& upload, const uint64_t key) {
+        Submit_(Upload_{0, key, priority, true, worldBounds, estimatedBytes, upload, true, 0.0f});
+    }
+
+    void GpuUploadScheduler::Submit_(Upload_&& upload) {
+        std::unique_lock<std::mutex> ul(mutex_);
+        upload.sequence = nextSequence_++;
+        pending_.push_back(std::move(upload));
+        stats_.numPending = pending_.size();
+    }
+
+    bool GpuUploadScheduler::Prioritize(const uint64_t key, const int priority) {
+        if (key == NoKey) return false;
+
+        // Only a few things ever get prioritized, so a search is cheaper than keeping an index up to date
+        std::unique_lock<std::mutex> ul(mutex_);
+        bool found = false;
+        for (auto& upload : pending_) {
+            if (upload.key != key) continue;
+            upload.priority = std::max(upload.priority, priority);
+            found = true;
+        }
+        return found;
+    }
+
+    void GpuUploadScheduler::Clear() {
+        std::unique_lock<std::mutex> ul(mutex_);
+        pending_.clear();
+        stats_.numPending = 0;
+    }
+
+    void GpuUploadScheduler::SetViewer(const glm::vec3& position, const std::vector<glm::vec4>& frustumPlanes) {
+        viewerPosition_ = position;
+        frustumPlanes_ = frustumPlanes;
+    }
+
+    void GpuUploadScheduler::ChargeImmediate(const size_t bytes) {
+        immediateBytes_.fetch_add(bytes);
+    }
+
+    void GpuUploadScheduler::AdaptTimeBudget_(const double lastFrameWorkSeconds) {
+        const GpuUploadBudget budget = GetBudget();
+        if (lastFrameWorkSeconds > 0.0) {
+            // Assume everything besides uploads costs about what it did last frame
+            const double otherWork = std::max(0.0, lastFrameWorkSeconds - lastUploadSeconds_);
+            const double available = budget.targetFrameSeconds - otherWork;
+            if (available < timeBudget_) {
+                timeBudget_ = available;
+            }
+            else {
+                timeBudget_ += (available - timeBudget_) * TimeBudgetGrowRate_;
+            }
+        }
+
+        timeBudget_ = std::clamp(timeBudget_, budget.minSeconds, std::max(budget.minSeconds, budget.maxSeconds));
+    }
+
+    size_t GpuUploadScheduler::ProcessFrame(const double lastFrameWorkSeconds) {
+        AdaptTimeBudget_(lastFrameWorkSeconds);
+
+        std::vector<Upload_> uploads;
+        size_t maxBytes;
+        {
+            std::unique_lock<std::mutex> ul(mutex_);
+            uploads.swap(pending_);
+            maxBytes = budget_.maxBytes;
+        }
+
+        const size_t immediateBytes = immediateBytes_.exchange(0);
+        const size_t byteBudget = maxBytes - std::min(maxBytes, immediateBytes);
+
+        const bool cullUploads = frustumPlanes_.size() >= 6;
+        for (auto& upload : uploads) {
+            upload.visible = !upload.hasBounds || !cullUploads || IsAabbInFrustum(upload.bounds, frustumPlanes_);
+            upload.distance = upload.hasBounds ? DistanceFromPointToAABB(viewerPosition_, upload.bounds) : 0.0f;
+        }
+
+        std::sort(uploads.begin(), uploads.end(), [](const Upload_& a, const Upload_& b) {
+            if (a.priority != b.priority) return a.priority > b.priority;
+            if (a.visible != b.visible) return a.visible;
+            if (a.distance != b.distance) return a.distance < b.distance;
+            return a.sequence < b.sequence;
+        });
+
+        // Upload functions run without the lock so they're free to submit more uploads
+        size_t numUploaded = 0;
+        size_t bytesUploaded = 0;
+        double uploadSeconds = 0.0;
+        for (; numUploaded < uploads.size(); ++numUploaded) {
+            Upload_& upload = uploads[numUploaded];
+            if (numUploaded > 0) {
+                if (bytesUploaded + upload.bytes > byteBudget) break;
+                if (uploadSeconds + cost_.Predict(ToMegabytes_(upload.bytes)) > timeBudget_) break;
+            }
+
+            const double start = Now_();
+            const size_t bytes = upload.upload();
+            const double seconds = Now_() - start;
+            cost_.Add(ToMegabytes_(bytes), seconds);
+
+            bytesUploaded += bytes;
+            uploadSeconds += seconds;
+            // Releases whatever the upload was holding on to right away
+            upload.upload = nullptr;
+        }
+        lastUploadSeconds_ = uploadSeconds;
+
+        std::unique_lock<std::mutex> ul(mutex_);
+        pending_.insert(pending_.end(), std::make_move_iterator(uploads.begin() + numUploaded), std::make_move_iterator(uploads.end()));
+
+        stats_.numPending = pending_.size();
+        stats_.timeBudgetSeconds = timeBudget_;
+        stats_.byteBudget = byteBudget;
+        stats_.numUploaded = numUploaded;
+        stats_.bytesUploaded = bytesUploaded;
+        stats_.uploadSeconds = uploadSeconds;
+        stats_.immediateBytes = immediateBytes;
+        cost_.Coefficients(stats_.secondsPerUpload, stats_.secondsPerMegabyte);
+        stats_.totalUploaded += numUploaded;
+        stats_.totalBytesUploaded += bytesUploaded;
+
+        return numUploaded;
+    }
+
+    GpuUploadStatistics GpuUploadScheduler::GetStatistics() const {
+        std::unique_lock<std::mutex> ul(mutex_);
+        return stats_;
+    }
+
+    double GpuUploadScheduler::Now_() const {
+        if (clock_) return clock_();
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "glm/glm.hpp"
+#include "StratusGpuCommon.h"
+
+namespace stratus {
+    struct GpuUploadBudget {
+        // Frame time (not counting time spent waiting on frame pacing) that uploads try to stay within
+        double targetFrameSeconds = 1.0 / 60.0;
+        // Uploads always get at least this much time so loading keeps moving even when frames are slow
+        double minSeconds = 0.0005;
+        double maxSeconds = 0.008;
+        // Hard cap on what gets uploaded each frame, including anything passed to ChargeImmediate
+        size_t maxBytes = 1024 * 1024 * 64;
+    };
+
+    struct GpuUploadStatistics {
+        size_t numPending = 0;
+        // Budget given to the most recent frame
+        double timeBudgetSeconds = 0.0;
+        size_t byteBudget = 0;
+        // Work done during the most recent frame
+        size_t numUploaded = 0;
+        size_t bytesUploaded = 0;
+        double uploadSeconds = 0.0;
+        size_t immediateBytes = 0;
+        // Current cost model: seconds = secondsPerUpload + secondsPerMegabyte * megabytes
+        double secondsPerUpload = 0.0;
+        double secondsPerMegabyte = 0.0;
+        uint64_t totalUploaded = 0;
+        uint64_t totalBytesUploaded = 0;
+    };
+
+    // Spreads GPU uploads (mesh data, textures, ...) across frames so that loading never adds more to a frame
+    // than it has room for. Each frame gets a time budget which grows while frames finish under
+    // GpuUploadBudget::targetFrameSeconds and is cut back as soon as they don't, and uploads are only started
+    // while the cost model (fit to how long uploads have actually taken) says they fit in what is left.
+    //
+    // Uploads go highest priority first. Ties go to those whose bounds are inside the view frustum, then the
+    // ones closest to the viewer, then the order they were submitted. The first upload of a frame always
+    // runs so that nothing can be starved by one upload which is larger than the whole budget.
+    //
+    // Submit, Prioritize, Clear, ChargeImmediate and GetStatistics are thread safe. Everything else belongs
+    // to the thread which owns the GL context.
+    class GpuUploadScheduler {
+    public:
+        // Performs the upload and returns how many bytes it sent to the GPU
+        typedef std::function<size_t ()> UploadFunction;
+        // Seconds since some fixed point in time
+        typedef std::function<double ()> ClockFunction;
+
+        static constexpr uint64_t NoKey = 0;
+
+        // The clock defaults to std::chrono::high_resolution_clock
+        explicit GpuUploadScheduler(const GpuUploadBudget& = GpuUploadBudget(), const ClockFunction& = nullptr);
+        ~GpuUploadScheduler() = default;
+
+        GpuUploadScheduler(GpuUploadScheduler&&) = delete;
+        GpuUploadScheduler(const GpuUploadScheduler&) = delete;
+        GpuUploadScheduler& operator=(GpuUploadScheduler&&) = delete;
+        GpuUploadScheduler& operator=(const GpuUploadScheduler&) = delete;
+
+        void SetBudget(const GpuUploadBudget&);
+        GpuUploadBudget GetBudget() const;
+
+        // Uploads without bounds count as visible and right next to the viewer. key is only needed for Prioritize.
+        void Submit(const size_t estimatedBytes, const int priority, const UploadFunction&, const uint64_t key = NoKey);
+        void Submit(const GpuAABB& worldBounds, const size_t estimatedBytes, const int priority, const UploadFunction&, const uint64_t key = NoKey);
+        // Only ever raises the priority. Returns false if nothing with that key is waiting.
+        bool Prioritize(const uint64_t key, const int priority);
+        // Drops every upload which hasn't run yet
+        void Clear();
+
+        // Used to order uploads from the next ProcessFrame on. frustumPlanes can be empty, which
+        // counts everything as visible.
+        void SetViewer(const glm::vec3& position, const std::vector<glm::vec4>& frustumPlanes);
+
+        // Records an upload which couldn't wait for its turn (e.g. material changes the next draw depends on).
+        // Its bytes come out of the next frame's byte budget. Its time is already part of the frame time
+        // the next budget is based on.
+        void ChargeImmediate(const size_t bytes);
+
+        // Call once per frame. lastFrameWorkSeconds is how long the previous frame took, not counting time
+        // spent waiting for the next frame to start (0 if unknown). Returns how many uploads ran.
+        size_t ProcessFrame(const double lastFrameWorkSeconds);
+
+        GpuUploadStatistics GetStatistics() const;
+
+    private:
+        struct Upload_ {
+            uint64_t sequence;
+            uint64_t key;
+            int priority;
+            bool hasBounds;
+            GpuAABB bounds;
+            size_t bytes;
+            UploadFunction upload;
+            // Filled in by ProcessFrame
+            bool visible;
+            float distance;
+        };
+
+        // Least squares fit of seconds against megabytes which favors recent uploads
+        class CostModel_ {
+        public:
+            void Add(const double megabytes, const double seconds);
+            double Predict(const double megabytes) const;
+            void Coefficients(double& secondsPerUpload, double& secondsPerMegabyte) const;
+
+        private:
+            double weight_ = 0.0;
+            double sumX_ = 0.0;
+            double sumY_ = 0.0;
+            double sumXX_ = 0.0;
+            double sumXY_ = 0.0;
+        };
+
+    private:
+        void Submit_(Upload_&&);
+        void AdaptTimeBudget_(const double lastFrameWorkSeconds);
+        double Now_() const;
+
+    private:
+        mutable std::mutex mutex_;
+        GpuUploadBudget budget_;
+        ClockFunction clock_;
+        std::vector<Upload_> pending_;
+        uint64_t nextSequence_ = 0;
+        GpuUploadStatistics stats_;
+
+        std::atomic<size_t> immediateBytes_{0};
+
+        // Only touched by the thread calling ProcessFrame
+        CostModel_ cost_;
+        double timeBudget_;
+        double lastUploadSeconds_ = 0.0;
+        glm::vec3 viewerPosition_ = glm::vec3(0.0f);
+        std::vector<glm::vec4> frustumPlanes_;
+    };
+}
@@ -8,7 +8,8 @@
 namespace stratus {
     struct GraphicsContext {
         GraphicsConfig config;
-        SDL_GLContext context;
+        SDL_GLContext context = nullptr;
+        bool headless = false;
     };
 
     static GraphicsContext& GetContext() {
@@ -78,7 +79,54 @@ namespace stratus {
         }
     }
 
-    bool GraphicsDriver::Initialize() {
+    // Fills in a config which looks like a typical 4.6 driver so that code sizing
+    // itself off of the config still works when headless
+    static void InitializeNullConfig(GraphicsConfig& config) {
+        config = GraphicsConfig();
+        config.renderer = "Null (headless)";
+        config.version = "4.6 (headless)";
+        config.majorVersion = 4;
+        config.minorVersion = 6;
+        config.maxAnisotropy = 16.0f;
+        config.maxDrawBuffers = 8;
+        config.maxCombinedTextures = 192;
+        config.maxCubeMapTextureSize = 16384;
+        config.maxFragmentUniformVectors = 1024;
+        config.maxFragmentUniformComponents = 4096;
+        config.maxVaryingFloats = 128;
+        config.maxRenderbufferSize = 16384;
+        config.maxTextureImageUnits = 32;
+        config.maxTextureSize1D2D = 16384;
+        config.maxTextureSize3D = 2048;
+        config.maxTextureSizeCubeMap = 16384;
+        config.maxVertexAttribs = 16;
+        config.maxVertexUniformVectors = 1024;
+        config.maxVertexUniformComponents = 4096;
+        config.maxViewportDims[0] = config.maxViewportDims[1] = 16384;
+        config.maxComputeShaderStorageBlocks = 16;
+        config.maxComputeUniformBlocks = 14;
+        config.maxComputeTexImageUnits = 32;
+        config.maxComputeUniformComponents = 1024;
+        config.maxComputeAtomicCounters = 16384;
+        config.maxComputeAtomicCounterBuffers = 8;
+        config.maxComputeWorkGroupInvocations = 1024;
+        for (int i = 0; i < 3; ++i) {
+            config.maxComputeWorkGroupCount[i] = 65535;
+            config.maxComputeWorkGroupSize[i] = i < 2 ? 1024 : 64;
+            config.supportsSparseTextures2D[i] = false;
+            config.supportsSparseTextures3D[i] = false;
+        }
+    }
+
+    bool GraphicsDriver::Initialize(const bool headless) {
+        GetContext().headless = headless;
+        if (headless) {
+            STRATUS_LOG << "Initializing headless graphics driver - no OpenGL calls will be made" << std::endl;
+            InitializeNullConfig(GetContext().config);
+            GpuMeshAllocator::Initialize_();
+            return true;
+        }
+
         SDL_Window * window = (SDL_Window *)Window::Instance()->GetWindowObject();
 
         // Set the profile to core as opposed to compatibility mode
@@ -191,11 +239,14 @@ namespace stratus {
     }
 
     void GraphicsDriver::MakeContextCurrent() {
+        if (GetContext().headless) return;
         SDL_Window* window = (SDL_Window*)Window::Instance()->GetWindowObject();
         SDL_GL_MakeCurrent(window, GetContext().context);
     }
 
     void GraphicsDriver::SwapBuffers(const bool vsync) {
+        if (GetContext().headless) return;
+
         if (!vsync) {
             // 0 lets it run as fast as it can
             SDL_GL_SetSwapInterval(0);
@@ -213,4 +264,8 @@ namespace stratus {
     const GraphicsConfig& GraphicsDriver::GetConfig() {
         return GetContext().config;
     }
+
+    bool GraphicsDriver::IsHeadless() {
+        return GetContext().headless;
+    }
 }
\ No newline at end of file
@@ -56,11 +56,15 @@ namespace stratus {
 
     // Initializes both the underlying graphics context as well as any
     // global GPU memory that the system will need
+    //
+    // When headless no context is created and GPU resources such as GpuBuffer switch to a
+    // null backend which only records sizes and operations (see GpuBuffer::GetNullStatistics).
     struct GraphicsDriver {
-        static bool Initialize();
+        static bool Initialize(const bool headless = false);
         static void Shutdown();
         static void MakeContextCurrent();
         static void SwapBuffers(const bool vsync);
         static const GraphicsConfig& GetConfig();
+        static bool IsHeadless();
     };
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+namespace stratus {
+    // Move-only replacement for std::function<void(void)> which stores the callable inside
+    // of a fixed size buffer whenever it fits. This means queueing a small lambda never touches
+    // the heap. Callables which are too large (or not nothrow movable) fall back to a heap allocation.
+    template<size_t Capacity>
+    class InlineFunction {
+        enum class Op_ {
+            Move,
+            Destroy
+        };
+
+        typedef void (*Invoke_)(void *);
+        typedef void (*Manage_)(Op_, void * self, void * other);
+
+        template<typename F>
+        static constexpr bool StoredInline_ = sizeof(F) <= Capacity
+                                           && alignof(F) <= alignof(std::max_align_t)
+                                           && std::is_nothrow_move_constructible<F>::value;
+
+    public:
+        InlineFunction() = default;
+
+        template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InlineFunction>::value>>
+        InlineFunction(F&& function) {
+            Construct_<std::decay_t<F>>(std::forward<F>(function));
+        }
+
+        InlineFunction(InlineFunction&& other) noexcept {
+            MoveFrom_(other);
+        }
+
+        InlineFunction& operator=(InlineFunction&& other) noexcept {
+            if (this != &other) {
+                Reset();
+                MoveFrom_(other);
+            }
+            return *this;
+        }
+
+        InlineFunction(const InlineFunction&) = delete;
+        InlineFunction& operator=(const InlineFunction&) = delete;
+
+        ~InlineFunction() {
+            Reset();
+        }
+
+        void operator()() {
+            invoke_(Storage_());
+        }
+
+        explicit operator bool() const {
+            return invoke_ != nullptr;
+        }
+
+        // True if the callable lives inside the internal buffer rather than on the heap
+        bool IsInline() const {
+            return inline_;
+        }
+
+        void Reset() {
+            if (manage_ != nullptr) manage_(Op_::Destroy, Storage_(), nullptr);
+            invoke_ = nullptr;
+            manage_ = nullptr;
+            inline_ = false;
+        }
+
+    private:
+        void * Storage_() {
+            return static_cast<void *>(&storage_);
+        }
+
+        template<typename F, typename Arg>
+        void Construct_(Arg&& function) {
+            if constexpr (StoredInline_<F>) {
+                new (Storage_()) F(std::forward<Arg>(function));
+                invoke_ = [](void * self) {
+                    (*static_cast<F *>(self))();
+                };
+                manage_ = [](Op_ op, void * self, void * other) {
+                    F * f = static_cast<F *>(self);
+                    if (op == Op_::Move) new (other) F(std::move(*f));
+                    f->~F();
+                };
+                inline_ = true;
+            }
+            else {
+                new (Storage_()) F*(new F(std::forward<Arg>(function)));
+                invoke_ = [](void * self) {
+                    (**static_cast<F **>(self))();
+                };
+                manage_ = [](Op_ op, void * self, void * other) {
+                    F ** f = static_cast<F **>(self);
+                    // Moving only needs to transfer the pointer
+                    if (op == Op_::Move) new (other) F*(*f);
+                    else delete *f;
+                };
+                inline_ = false;
+            }
+        }
+
+        void MoveFrom_(InlineFunction& other) {
+            if (other.manage_ == nullptr) return;
+            // Move constructs into our storage and destroys what was in other's storage
+            other.manage_(Op_::Move, other.Storage_(), Storage_());
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+            inline_ = other.inline_;
+            other.invoke_ = nullptr;
+            other.manage_ = nullptr;
+            other.inline_ = false;
+        }
+
+    private:
+        std::aligned_storage_t<(Capacity < sizeof(void *) ? sizeof(void *) : Capacity), alignof(std::max_align_t)> storage_;
+        Invoke_ invoke_ = nullptr;
+        Manage_ manage_ = nullptr;
+        bool inline_ = false;
+    };
+}
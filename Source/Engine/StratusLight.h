@@ -179,11 +179,11 @@ namespace stratus {
 
         void SetPosition(const glm::vec3& position) {
             position_ = position;
-            lastFramePositionChanged_ = INSTANCE(Engine)->FrameCount();
+            lastFramePositionChanged_ = Engine::CurrentFrame();
         }
 
         bool PositionChangedWithinLastFrame() const {
-            auto diff = INSTANCE(Engine)->FrameCount() - lastFramePositionChanged_;
+            auto diff = Engine::CurrentFrame() - lastFramePositionChanged_;
             return diff <= 1;
         }
 
@@ -244,7 +244,7 @@ namespace stratus {
         }
 
         bool RadiusChangedWithinLastFrame() const {
-            auto diff = INSTANCE(Engine)->FrameCount() - lastFrameRadiusChanged_;
+            auto diff = Engine::CurrentFrame() - lastFrameRadiusChanged_;
             return diff <= 1;
 
         }
@@ -272,7 +272,7 @@ namespace stratus {
             const float Imax = std::max(intensity.x, std::max(intensity.y, intensity.z));
             //_radius = sqrtf(4.0f * (Imax * lightMin - 1.0f)) / 2.0f;
             radius_ = sqrtf(Imax * lightMin - 1.0f) * 2.0f;
-            lastFrameRadiusChanged_ = INSTANCE(Engine)->FrameCount();
+            lastFrameRadiusChanged_ = Engine::CurrentFrame();
         }
 
         void RecalcColorWithIntensity_() {
@@ -9,12 +9,12 @@ namespace stratus {
 
     void Material::MarkChanged() {
         auto ul = LockWrite_();
-        lastFrameChanged_ = INSTANCE(Engine)->FrameCount();
+        lastFrameChanged_ = Engine::CurrentFrame();
     }
 
     bool Material::ChangedWithinLastFrame() {
         auto sl = LockRead_();
-        auto diff = INSTANCE(Engine)->FrameCount() - lastFrameChanged_;
+        auto diff = Engine::CurrentFrame() - lastFrameChanged_;
         return diff <= 1;
     }
 
@@ -0,0 +1,329 @@
+#include "StratusMeshCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include "StratusFilesystem.h"
+
+namespace stratus {
+    // Bump whenever the layout below or the way meshes are processed changes
+    static constexpr uint32_t MeshCacheMagic_ = 0x31434d53; // "SMC1"
+    static constexpr uint32_t MeshCacheVersion_ = 2;
+    // Vertex data starts on this boundary so meshes can point straight into the mapping
+    static constexpr size_t MeshCacheAlignment_ = 16;
+
+    static CacheDirectory directory_("CookedMeshes");
+
+    // Layout (all values little endian, no padding):
+    //
+    //   magic, version, source size, source modified, import key, #materials, #nodes, #meshes, source path
+    //   materials: flags, diffuse, emissive, metallic, roughness, reflectance, texture paths
+    //   nodes:     parent, renderable, #meshes, (mesh, material, transform) per mesh
+    //   meshes:    #vertices, #lods, cull mode, aabb, #indices per lod, padding, GpuMeshData[], indices for each lod
+    struct CookedWriter_ {
+        std::ofstream& out;
+
+        template<typename T>
+        void Write(const T& value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        void Write(const void * data, const size_t bytes) {
+            if (bytes > 0) out.write(reinterpret_cast<const char *>(data), bytes);
+        }
+
+        void Write(const std::string& str) {
+            Write(uint32_t(str.size()));
+            Write(str.data(), str.size());
+        }
+
+        void Align(const size_t alignment) {
+            const size_t position = size_t(out.tellp());
+            const size_t padding = (alignment - position % alignment) % alignment;
+            for (size_t i = 0; i < padding; ++i) Write(uint8_t(0));
+        }
+    };
+
+    // Every read is bounds checked so a truncated or corrupt file fails rather than crashing
+    struct CookedReader_ {
+        const uint8_t * data;
+        size_t size;
+        size_t offset = 0;
+
+        bool Read(void * out, const size_t bytes) {
+            if (bytes > size - offset) return false;
+            if (bytes > 0) std::memcpy(out, data + offset, bytes);
+            offset += bytes;
+            return true;
+        }
+
+        template<typename T>
+        bool Read(T& value) {
+            return Read(&value, sizeof(T));
+        }
+
+        bool Read(std::string& str) {
+            uint32_t length;
+            if (!Read(length) || length > size - offset) return false;
+            str.assign(reinterpret_cast<const char *>(data + offset), length);
+            offset += length;
+            return true;
+        }
+
+        bool Align(const size_t alignment) {
+            const size_t padding = (alignment - offset % alignment) % alignment;
+            if (padding > size - offset) return false;
+            offset += padding;
+            return true;
+        }
+
+        // Pointer into the file for count elements, which are skipped over
+        template<typename T>
+        const T * View(const size_t count) {
+            if (!HasRemaining(count, sizeof(T))) return nullptr;
+            const T * view = reinterpret_cast<const T *>(data + offset);
+            offset += count * sizeof(T);
+            return view;
+        }
+
+        // Guards allocations against sizes read from a corrupt file
+        bool HasRemaining(const uint64_t count, const size_t elementBytes) const {
+            return count <= (size - offset) / elementBytes;
+        }
+    };
+
+    CookedModel::~CookedModel() {
+        for (MeshPtr mesh : meshes) {
+            Mesh::Destroy(mesh);
+        }
+    }
+
+    CookedModel& CookedModel::operator=(CookedModel&& other) {
+        if (this == &other) return *this;
+        for (MeshPtr mesh : meshes) {
+            Mesh::Destroy(mesh);
+        }
+        materials = std::move(other.materials);
+        nodes = std::move(other.nodes);
+        meshes = std::move(other.meshes);
+        other.meshes.clear();
+        return *this;
+    }
+
+    void MeshCache::SetDirectory(const std::string& directory) {
+        directory_.Set(directory);
+    }
+
+    std::string MeshCache::GetDirectory() {
+        return directory_.Get();
+    }
+
+    bool MeshCache::GetStamp(const std::string& source, MeshCacheStamp& stamp) {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(source, error);
+        if (error) return false;
+        const auto modified = std::filesystem::last_write_time(source, error);
+        if (error) return false;
+
+        stamp.source = source;
+        stamp.sizeBytes = uint64_t(size);
+        stamp.lastModified = int64_t(modified.time_since_epoch().count());
+        return true;
+    }
+
+    std::string MeshCache::CookedPath(const std::string& source, const uint64_t importKey) {
+        const std::string directory = GetDirectory();
+        if (directory.empty()) return std::string();
+
+        // Models with the same name in different directories, or imported with different settings,
+        // get different files
+        uint64_t hash = HashFnv1a(source.data(), source.size());
+        hash = HashFnv1a(&importKey, sizeof(importKey), hash);
+
+        std::stringstream name;
+        name << std::filesystem::path(source).stem().string() << "_" << std::hex << hash << ".smc";
+        return (std::filesystem::path(directory) / name.str()).string();
+    }
+
+    bool MeshCache::Write(const std::string& cookedFile, const MeshCacheStamp& stamp, const uint64_t importKey, const CookedModel& model) {
+        if (cookedFile.empty()) return false;
+        for (const MeshPtr mesh : model.meshes) {
+            if (mesh->cpuData_ == nullptr || !mesh->cpuData_->processed) {
+                throw std::runtime_error("Meshes must be processed and not finalized before they are cooked");
+            }
+        }
+
+        return Filesystem::WriteBinaryAtomic(cookedFile, [&](std::ofstream& out) {
+            CookedWriter_ writer{out};
+            writer.Write(MeshCacheMagic_);
+            writer.Write(MeshCacheVersion_);
+            writer.Write(stamp.sizeBytes);
+            writer.Write(stamp.lastModified);
+            writer.Write(importKey);
+            writer.Write(uint32_t(model.materials.size()));
+            writer.Write(uint32_t(model.nodes.size()));
+            writer.Write(uint32_t(model.meshes.size()));
+            writer.Write(stamp.source);
+
+            for (const CookedMaterial& material : model.materials) {
+                writer.Write(material.flags);
+                writer.Write(material.diffuseColor);
+                writer.Write(material.emissiveColor);
+                writer.Write(material.metallic);
+                writer.Write(material.roughness);
+                writer.Write(material.reflectance);
+                writer.Write(material.diffuseMap);
+                writer.Write(material.normalMap);
+                writer.Write(material.roughnessMap);
+                writer.Write(material.emissiveMap);
+                writer.Write(material.metallicMap);
+                writer.Write(material.metallicRoughnessMap);
+            }
+
+            for (const CookedNode& node : model.nodes) {
+                writer.Write(node.parent);
+                writer.Write(uint8_t(node.renderable ? 1 : 0));
+                writer.Write(uint32_t(node.meshes.size()));
+                for (const CookedNodeMesh& mesh : node.meshes) {
+                    writer.Write(mesh.mesh);
+                    writer.Write(mesh.material);
+                    writer.Write(mesh.transform);
+                }
+            }
+
+            for (const MeshPtr mesh : model.meshes) {
+                const auto * cpu = mesh->cpuData_;
+                const bool mapped = cpu->mapping != nullptr;
+                const auto& numIndicesPerLod = mesh->numIndicesPerLod_;
+                writer.Write(mesh->numVertices_);
+                writer.Write(uint32_t(numIndicesPerLod.size()));
+                writer.Write(int32_t(mesh->cullMode_));
+                writer.Write(mesh->aabb_);
+                writer.Write(numIndicesPerLod.data(), numIndicesPerLod.size() * sizeof(uint32_t));
+                writer.Align(MeshCacheAlignment_);
+                writer.Write(mapped ? cpu->mappedData : cpu->data.data(), size_t(mesh->numVertices_) * sizeof(GpuMeshData));
+                for (size_t lod = 0; lod < numIndicesPerLod.size(); ++lod) {
+                    const uint32_t * indices = mapped ? cpu->mappedIndicesPerLod[lod] : cpu->indicesPerLod[lod].data();
+                    writer.Write(indices, numIndicesPerLod[lod] * sizeof(uint32_t));
+                }
+            }
+        });
+    }
+
+    bool MeshCache::Read(const std::string& cookedFile, const MeshCacheStamp& stamp, const uint64_t importKey, CookedModel& model, const bool keepMapped) {
+        if (cookedFile.empty()) return false;
+
+        auto file = std::make_shared<MappedFile>();
+        if (!file->Open(cookedFile)) return false;
+
+        CookedReader_ reader{file->Data(), file->Size()};
+
+        uint32_t magic, version, numMaterials, numNodes, numMeshes;
+        uint64_t sizeBytes, key;
+        int64_t lastModified;
+        std::string source;
+        if (!reader.Read(magic) || !reader.Read(version) || magic != MeshCacheMagic_ || version != MeshCacheVersion_) return false;
+        if (!reader.Read(sizeBytes) || !reader.Read(lastModified) || !reader.Read(key)) return false;
+        if (sizeBytes != stamp.sizeBytes || lastModified != stamp.lastModified || key != importKey) return false;
+        if (!reader.Read(numMaterials) || !reader.Read(numNodes) || !reader.Read(numMeshes) || !reader.Read(source)) return false;
+        // Guards against hash collisions between different paths
+        if (source != stamp.source) return false;
+
+        std::vector<CookedMaterial> materials;
+        if (!reader.HasRemaining(numMaterials, sizeof(uint32_t))) return false;
+        materials.resize(numMaterials);
+        for (CookedMaterial& material : materials) {
+            const bool ok = reader.Read(material.flags) && reader.Read(material.diffuseColor) && reader.Read(material.emissiveColor) &&
+                reader.Read(material.metallic) && reader.Read(material.roughness) && reader.Read(material.reflectance) &&
+                reader.Read(material.diffuseMap) && reader.Read(material.normalMap) && reader.Read(material.roughnessMap) &&
+                reader.Read(material.emissiveMap) && reader.Read(material.metallicMap) && reader.Read(material.metallicRoughnessMap);
+            if (!ok) return false;
+        }
+
+        std::vector<CookedNode> nodes;
+        if (!reader.HasRemaining(numNodes, sizeof(int32_t))) return false;
+        nodes.resize(numNodes);
+        for (uint32_t n = 0; n < numNodes; ++n) {
+            CookedNode& node = nodes[n];
+            uint8_t renderable;
+            uint32_t numNodeMeshes;
+            if (!reader.Read(node.parent) || !reader.Read(renderable) || !reader.Read(numNodeMeshes)) return false;
+            // Parents always come first and only the first node is a root
+            if ((n == 0) != (node.parent < 0) || node.parent >= int32_t(n)) return false;
+            if (!reader.HasRemaining(numNodeMeshes, sizeof(CookedNodeMesh))) return false;
+
+            node.renderable = renderable != 0;
+            node.meshes.resize(numNodeMeshes);
+            for (CookedNodeMesh& mesh : node.meshes) {
+                if (!reader.Read(mesh.mesh) || !reader.Read(mesh.material) || !reader.Read(mesh.transform)) return false;
+                if (mesh.mesh >= numMeshes || mesh.material >= numMaterials) return false;
+            }
+        }
+
+        // Meshes created here are destroyed below if anything goes wrong, even partway through
+        std::vector<MeshPtr> meshes;
+        auto readMeshes = [&reader, &meshes, &file, numMeshes, keepMapped]() {
+            meshes.reserve(numMeshes);
+            for (uint32_t m = 0; m < numMeshes; ++m) {
+                uint32_t numVertices, numLods;
+                int32_t cullMode;
+                GpuAABB aabb;
+                if (!reader.Read(numVertices) || !reader.Read(numLods) || !reader.Read(cullMode) || !reader.Read(aabb)) return false;
+                if (numVertices == 0 || numLods == 0 || !reader.HasRemaining(numLods, sizeof(uint32_t))) return false;
+
+                std::vector<uint32_t> numIndicesPerLod(numLods);
+                if (!reader.Read(numIndicesPerLod.data(), numLods * sizeof(uint32_t))) return false;
+                if (!reader.Align(MeshCacheAlignment_)) return false;
+                const GpuMeshData * data = reader.View<GpuMeshData>(numVertices);
+                if (data == nullptr) return false;
+                std::vector<const uint32_t *> indicesPerLod(numLods);
+                for (uint32_t lod = 0; lod < numLods; ++lod) {
+                    indicesPerLod[lod] = reader.View<uint32_t>(numIndicesPerLod[lod]);
+                    if (indicesPerLod[lod] == nullptr) return false;
+                }
+
+                MeshPtr mesh = Mesh::Create();
+                meshes.push_back(mesh);
+
+                auto * cpu = mesh->cpuData_;
+                if (keepMapped) {
+                    cpu->mapping = file;
+                    cpu->mappedData = data;
+                    cpu->mappedIndicesPerLod = std::move(indicesPerLod);
+                }
+                else {
+                    cpu->data.assign(data, data + numVertices);
+                    cpu->indicesPerLod.resize(numLods);
+                    for (uint32_t lod = 0; lod < numLods; ++lod) {
+                        cpu->indicesPerLod[lod].assign(indicesPerLod[lod], indicesPerLod[lod] + numIndicesPerLod[lod]);
+                    }
+                }
+
+                // Only the packed data is stored, so everything derived from the separate vertex arrays
+                // has to be filled in here
+                cpu->needsRepacking = false;
+                cpu->processed = true;
+                mesh->numVertices_ = numVertices;
+                mesh->numIndices_ = numIndicesPerLod[0];
+                mesh->numIndicesPerLod_.assign(numIndicesPerLod.begin(), numIndicesPerLod.end());
+                mesh->dataSizeBytes_ = size_t(numVertices) * sizeof(GpuMeshData);
+                mesh->aabb_ = aabb;
+                mesh->cullMode_ = RenderFaceCulling(cullMode);
+            }
+            return true;
+        };
+
+        if (!readMeshes() || reader.offset != reader.size) {
+            for (MeshPtr mesh : meshes) Mesh::Destroy(mesh);
+            return false;
+        }
+
+        model.materials = std::move(materials);
+        model.nodes = std::move(nodes);
+        for (MeshPtr mesh : model.meshes) Mesh::Destroy(mesh);
+        model.meshes = std::move(meshes);
+        return true;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "StratusRenderComponents.h"
+#include "glm/glm.hpp"
+
+namespace stratus {
+    // Material properties as they were read from the source file. Textures are stored as file names
+    // rather than handles so that they can be loaded again on the next run.
+    struct CookedMaterial {
+        enum Flags : uint32_t {
+            HAS_DIFFUSE     = 1,
+            HAS_METALLIC    = 2,
+            HAS_ROUGHNESS   = 4,
+            HAS_REFLECTANCE = 8
+        };
+
+        uint32_t flags = 0;
+        glm::vec4 diffuseColor = glm::vec4(1.0f);
+        glm::vec3 emissiveColor = glm::vec3(0.0f);
+        float metallic = 0.0f;
+        float roughness = 0.0f;
+        float reflectance = 0.0f;
+        // Empty if the material doesn't use that texture
+        std::string diffuseMap;
+        std::string normalMap;
+        std::string roughnessMap;
+        std::string emissiveMap;
+        std::string metallicMap;
+        std::string metallicRoughnessMap;
+    };
+
+    struct CookedNodeMesh {
+        // Index into CookedModel::meshes
+        uint32_t mesh;
+        // Index into CookedModel::materials
+        uint32_t material;
+        glm::mat4 transform;
+    };
+
+    struct CookedNode {
+        // Index of the parent in CookedModel::nodes, or -1 for the root
+        int32_t parent;
+        // Nodes which had meshes in the source get a RenderComponent even if every mesh was skipped
+        bool renderable;
+        std::vector<CookedNodeMesh> meshes;
+    };
+
+    // Everything needed to build a model's entities without going back to the source file. Meshes have
+    // been through Mesh::ProcessCpuData but are not finalized. Any meshes still here when the model is
+    // destroyed are destroyed with it.
+    struct CookedModel {
+        CookedModel() = default;
+        ~CookedModel();
+
+        CookedModel(CookedModel&&) = default;
+        // Destroys any meshes this model still owns
+        CookedModel& operator=(CookedModel&&);
+        CookedModel(const CookedModel&) = delete;
+        CookedModel& operator=(const CookedModel&) = delete;
+
+        // One per source material, in source order
+        std::vector<CookedMaterial> materials;
+        // Parents always come before their children and children are in source order
+        std::vector<CookedNode> nodes;
+        std::vector<MeshPtr> meshes;
+    };
+
+    // Identifies the version of a source file a cooked file was made from
+    struct MeshCacheStamp {
+        std::string source;
+        uint64_t sizeBytes = 0;
+        int64_t lastModified = 0;
+    };
+
+    // On-disk cache of imported models. Cooked files hold the packed vertex data, LOD index lists, AABBs,
+    // material table and node hierarchy of a model so that loading it again skips the importer and all of
+    // the per-mesh processing. Files are read through a memory mapping, either into the mesh CPU buffers or
+    // left mapped so the data goes straight from the file to the GPU.
+    //
+    // A cooked file is only used if its source path, size, modification time and import key all match.
+    class MeshCache {
+    public:
+        // Defaults to "CookedMeshes" under the working directory. An empty string turns the cache off.
+        static void SetDirectory(const std::string&);
+        static std::string GetDirectory();
+
+        // Returns false if the source file doesn't exist
+        static bool GetStamp(const std::string& source, MeshCacheStamp&);
+
+        // importKey covers everything besides the source file which changes the cooked output (import flags,
+        // color space, ...). Returns an empty string if the cache is turned off.
+        static std::string CookedPath(const std::string& source, const uint64_t importKey);
+
+        // Neither of these log anything (so they can be called from any thread) - failures are left to the
+        // caller to report.
+        //
+        // Safe to call from multiple threads, even for the same file
+        static bool Write(const std::string& cookedFile, const MeshCacheStamp&, const uint64_t importKey, const CookedModel&);
+        // Fails without changing model if the file is missing, corrupt or was cooked from something else.
+        //
+        // With keepMapped the meshes point into the mapped file rather than getting their own copy, and
+        // are uploaded straight from it by Mesh::FinalizeData. The file is unmapped once every mesh has
+        // been uploaded or destroyed.
+        static bool Read(const std::string& cookedFile, const MeshCacheStamp&, const uint64_t importKey, CookedModel& model, const bool keepMapped = false);
+    };
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include "StratusPoolAllocator.h"
+
+namespace stratus {
+    // Lock-free multi-producer/single-consumer FIFO queue. Any number of threads can Push at the
+    // same time, but only one thread at a time is allowed to call Pop.
+    //
+    // Queue nodes come from a ConcurrentPoolAllocator owned by the queue, so once the queue has warmed
+    // up to its peak size Push and Pop never allocate.
+    //
+    // Queue algorithm: Dmitry Vyukov's intrusive MPSC node-based queue
+    template<typename E>
+    class MpscQueue {
+        struct Link_ {
+            std::atomic<Link_ *> next{nullptr};
+        };
+
+        struct Node_ : public Link_ {
+            template<typename T>
+            Node_(T&& value) : value(std::forward<T>(value)) {}
+
+            E value;
+        };
+
+    public:
+        MpscQueue() {
+            head_.store(&stub_, std::memory_order_relaxed);
+            tail_ = &stub_;
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue(MpscQueue&&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+        MpscQueue& operator=(MpscQueue&&) = delete;
+
+        ~MpscQueue() {
+            // Run destructors for anything which never got popped
+            while (true) {
+                Link_ * link = PopLink_();
+                if (link == nullptr) break;
+                nodes_.DestroyDeallocate(static_cast<Node_ *>(link));
+            }
+        }
+
+        // Any thread
+        void Push(E&& value) {
+            PushLink_(nodes_.AllocateConstruct(std::move(value)));
+        }
+
+        void Push(const E& value) {
+            PushLink_(nodes_.AllocateConstruct(value));
+        }
+
+        // Consumer thread only. Returns false if the queue was empty or if the next element
+        // is still in the middle of being pushed by a producer.
+        bool Pop(E& out) {
+            Link_ * link = PopLink_();
+            if (link == nullptr) return false;
+            Node_ * node = static_cast<Node_ *>(link);
+            out = std::move(node->value);
+            nodes_.DestroyDeallocate(node);
+            return true;
+        }
+
+        // Consumer thread only (approximate while producers are active)
+        bool Empty() const {
+            return tail_ == &stub_ && stub_.next.load(std::memory_order_acquire) == nullptr;
+        }
+
+        // Total number of nodes which have been allocated by the queue
+        size_t Capacity() const {
+            return nodes_.NumElems();
+        }
+
+    private:
+        void PushLink_(Link_ * link) {
+            link->next.store(nullptr, std::memory_order_relaxed);
+            Link_ * prev = head_.exchange(link, std::memory_order_acq_rel);
+            // Between the exchange and this store the queue is briefly disconnected, which
+            // is why Pop can return false while there are still elements in flight
+            prev->next.store(link, std::memory_order_release);
+        }
+
+        Link_ * PopLink_() {
+            Link_ * tail = tail_;
+            Link_ * next = tail->next.load(std::memory_order_acquire);
+            if (tail == &stub_) {
+                if (next == nullptr) return nullptr;
+                tail_ = next;
+                tail = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+
+            if (next != nullptr) {
+                tail_ = next;
+                return tail;
+            }
+
+            // Either a producer is in the middle of a push or this is the last element
+            Link_ * head = head_.load(std::memory_order_acquire);
+            if (tail != head) return nullptr;
+
+            // Re-insert the stub so that the last element can be removed
+            PushLink_(&stub_);
+            next = tail->next.load(std::memory_order_acquire);
+            if (next != nullptr) {
+                tail_ = next;
+                return tail;
+            }
+
+            return nullptr;
+        }
+
+    private:
+        // Producers swap themselves into the head
+        alignas(64) std::atomic<Link_ *> head_;
+        // Only touched by the consumer
+        alignas(64) Link_ * tail_;
+        Link_ stub_;
+        ConcurrentPoolAllocator<Node_> nodes_;
+    };
+}
@@ -6,6 +6,11 @@
 #include <shared_mutex>
 #include <functional>
 #include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <cstdint>
+#include <typeinfo>
+#include <vector>
 #include "StratusPointer.h"
 
 // See https://www.qt.io/blog/a-fast-and-thread-safe-pool-allocator-for-qt-part-1
@@ -267,7 +272,7 @@ namespace stratus {
                 : allocator(allocator) {}
 
             Deleter(Deleter&& other)
-                : allocator(other.allocator) {}
+                : allocator(std::move(other.allocator)) {}
 
             Deleter(const Deleter& other)
                 : allocator(other.allocator) {}
@@ -362,4 +367,371 @@ namespace stratus {
     private:
         inline thread_local static std::weak_ptr<Allocator> alloc_;
     };
-}
\ No newline at end of file
+
+    // Lock-free pool which any number of threads can allocate from and deallocate to at the same
+    // time (unlike PoolAllocator which supports one allocating thread). Only growing the pool takes
+    // a lock. Memory is held onto until the pool is destroyed, at which point anything still allocated
+    // is freed without running its destructor.
+    //
+    // Free slots form a Treiber stack keyed by slot index with a tag packed alongside to avoid ABA.
+    template<typename E, uint32_t FirstChunkSize = 64>
+    class ConcurrentPoolAllocator {
+        static_assert(FirstChunkSize > 0);
+
+        struct Slot_ {
+            alignas(E) uint8_t memory[sizeof(E)];
+            // Index + 1 of the next free slot (0 means end of free list)
+            std::atomic<uint32_t> nextFree{0};
+            uint32_t index = 0;
+        };
+
+        // Chunk k holds FirstChunkSize * 2^k slots so that slot indices never move
+        static constexpr uint32_t MaxChunks = 24;
+
+    public:
+        ConcurrentPoolAllocator() = default;
+
+        ConcurrentPoolAllocator(ConcurrentPoolAllocator&&) = delete;
+        ConcurrentPoolAllocator(const ConcurrentPoolAllocator&) = delete;
+        ConcurrentPoolAllocator& operator=(ConcurrentPoolAllocator&&) = delete;
+        ConcurrentPoolAllocator& operator=(const ConcurrentPoolAllocator&) = delete;
+
+        ~ConcurrentPoolAllocator() = default;
+
+        template<typename ... Types>
+        E * AllocateConstruct(Types&&... args) {
+            Slot_ * slot = AllocateSlot_();
+            try {
+                return ::new (slot->memory) E(std::forward<Types>(args)...);
+            }
+            catch (...) {
+                PushFree_(slot, slot);
+                throw;
+            }
+        }
+
+        void DestroyDeallocate(E * ptr) {
+            if (ptr == nullptr) return;
+            ptr->~E();
+            Slot_ * slot = reinterpret_cast<Slot_ *>(reinterpret_cast<uint8_t *>(ptr));
+            PushFree_(slot, slot);
+        }
+
+        size_t NumChunks() const {
+            return numChunks_.load(std::memory_order_relaxed);
+        }
+
+        size_t NumElems() const {
+            return numElems_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static uint64_t Pack_(const uint64_t tag, const uint32_t index) {
+            return (tag << 32) | uint64_t(index);
+        }
+
+        Slot_ * GetSlot_(const uint32_t index) const {
+            uint32_t chunk = 0;
+            uint32_t start = 0;
+            uint32_t size = FirstChunkSize;
+            while (index >= start + size) {
+                start += size;
+                size <<= 1;
+                ++chunk;
+            }
+            return &chunks_[chunk].load(std::memory_order_acquire)[index - start];
+        }
+
+        bool TryPopFree_(Slot_ *& out) {
+            uint64_t head = freeHead_.load(std::memory_order_acquire);
+            while (true) {
+                const uint32_t index = uint32_t(head & 0xFFFFFFFF);
+                if (index == 0) return false;
+                Slot_ * slot = GetSlot_(index - 1);
+                // If another thread takes this slot first the tag will have changed and the CAS fails
+                const uint32_t next = slot->nextFree.load(std::memory_order_relaxed);
+                if (freeHead_.compare_exchange_weak(head, Pack_((head >> 32) + 1, next), std::memory_order_acquire, std::memory_order_acquire)) {
+                    out = slot;
+                    return true;
+                }
+            }
+        }
+
+        // Pushes a chain of slots which are already linked from first to last
+        void PushFree_(Slot_ * first, Slot_ * last) {
+            uint64_t head = freeHead_.load(std::memory_order_relaxed);
+            while (true) {
+                last->nextFree.store(uint32_t(head & 0xFFFFFFFF), std::memory_order_relaxed);
+                if (freeHead_.compare_exchange_weak(head, Pack_((head >> 32) + 1, first->index + 1), std::memory_order_release, std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+        }
+
+        Slot_ * AllocateSlot_() {
+            Slot_ * slot = nullptr;
+            if (TryPopFree_(slot)) return slot;
+
+            std::unique_lock<std::mutex> ul(growMutex_);
+            // Someone else may have grown the pool while we were waiting
+            if (TryPopFree_(slot)) return slot;
+
+            const uint32_t chunk = uint32_t(numChunks_.load(std::memory_order_relaxed));
+            if (chunk >= MaxChunks) throw std::runtime_error("ConcurrentPoolAllocator exceeded maximum capacity");
+            const uint32_t size = FirstChunkSize << chunk;
+            const uint32_t start = FirstChunkSize * ((1u << chunk) - 1);
+
+            chunkStorage_[chunk] = std::make_unique<Slot_[]>(size);
+            Slot_ * slots = chunkStorage_[chunk].get();
+            for (uint32_t i = 0; i < size; ++i) {
+                slots[i].index = start + i;
+                if (i + 1 < size) slots[i].nextFree.store(start + i + 2, std::memory_order_relaxed);
+            }
+            chunks_[chunk].store(slots, std::memory_order_release);
+            numChunks_.fetch_add(1, std::memory_order_relaxed);
+            numElems_.fetch_add(size, std::memory_order_relaxed);
+
+            // Keep the first slot and make the rest available to everyone
+            if (size > 1) PushFree_(&slots[1], &slots[size - 1]);
+            return &slots[0];
+        }
+
+    private:
+        alignas(64) std::atomic<uint64_t> freeHead_{0};
+        std::atomic<Slot_ *> chunks_[MaxChunks] = {};
+        std::unique_ptr<Slot_[]> chunkStorage_[MaxChunks];
+        std::atomic<size_t> numChunks_{0};
+        std::atomic<size_t> numElems_{0};
+        std::mutex growMutex_;
+    };
+
+    // Counters for how often a ThreadCachedPoolAllocator's threads had to go to its shared pool. Only
+    // meant for profiling.
+    struct PoolContentionStats {
+        // typeid name of the element type
+        const char * name = nullptr;
+        // Batches threads took from or gave back to the shared pool
+        uint64_t refills = 0;
+        uint64_t returns = 0;
+        // How many of those had to wait because another thread held the shared pool's lock
+        uint64_t contended = 0;
+        // Slots created so far
+        uint64_t capacity = 0;
+    };
+
+    // Every ThreadCachedPoolAllocator type registers itself here the first time it's used
+    struct ThreadCachedPoolRegistry_ {
+        typedef PoolContentionStats (*StatsFunction)();
+
+        static void Register(StatsFunction fn) {
+            auto& registry = Get_();
+            auto ul = std::unique_lock<std::mutex>(registry.m);
+            registry.pools.push_back(fn);
+        }
+
+        static std::vector<PoolContentionStats> Stats() {
+            auto& registry = Get_();
+            std::vector<StatsFunction> pools;
+            {
+                auto ul = std::unique_lock<std::mutex>(registry.m);
+                pools = registry.pools;
+            }
+
+            std::vector<PoolContentionStats> stats;
+            stats.reserve(pools.size());
+            for (auto fn : pools) stats.push_back(fn());
+            return stats;
+        }
+
+    private:
+        std::mutex m;
+        std::vector<StatsFunction> pools;
+
+        static ThreadCachedPoolRegistry_& Get_() {
+            // Leaked so that pools can still be used while other statics are being destroyed
+            static auto * registry = new ThreadCachedPoolRegistry_();
+            return *registry;
+        }
+    };
+
+    // Contention counters for every ThreadCachedPoolAllocator which has been used so far
+    inline std::vector<PoolContentionStats> GetThreadCachedPoolStats() {
+        return ThreadCachedPoolRegistry_::Stats();
+    }
+
+    // One pool per type E which any thread can allocate from and deallocate to. Each thread keeps a small
+    // cache of free slots and only goes to the shared pool (which takes a lock) to take or give back
+    // BatchSize slots at a time, so threads creating lots of objects at once mostly don't see each other.
+    // Slots freed on a different thread than they were allocated on end up in that thread's cache.
+    //
+    // Memory is never given back to the system. When a thread exits its cached slots go back to the shared pool.
+    template<typename E, size_t BatchSize = 32>
+    class ThreadCachedPoolAllocator final {
+        static_assert(BatchSize > 0);
+
+        static constexpr size_t CacheCapacity_ = 2 * BatchSize;
+        static constexpr size_t SlotsPerChunk_ = 8 * BatchSize;
+
+        struct alignas(E) Slot_ {
+            uint8_t memory[sizeof(E)];
+        };
+
+        struct Shared_ {
+            std::mutex m;
+            std::vector<Slot_ *> free;
+            std::vector<std::unique_ptr<Slot_[]>> chunks;
+            uint64_t refills = 0;
+            uint64_t returns = 0;
+            std::atomic<uint64_t> contended{0};
+        };
+
+        // Trivially destructible so it stays usable while other thread_locals are being destroyed
+        struct Cache_ {
+            Slot_ * slots[CacheCapacity_];
+            size_t count;
+            bool registered;
+            // Set once the thread has started exiting - from then on everything goes straight to the shared pool
+            bool released;
+        };
+
+        // Hands the cache back to the shared pool when the thread exits
+        struct CacheOwner_ {
+            ~CacheOwner_() {
+                Cache_& cache = cache_;
+                if (cache.count > 0) Return_(cache.slots, cache.count);
+                cache.count = 0;
+                cache.released = true;
+            }
+        };
+
+    public:
+        ThreadCachedPoolAllocator() = delete;
+
+        template<typename ... Types>
+        static E * AllocateConstruct(const Types&... args) {
+            Cache_& cache = GetCache_();
+            Slot_ * slot;
+            if (cache.count > 0) {
+                slot = cache.slots[--cache.count];
+            }
+            else if (!cache.released) {
+                Refill_(cache);
+                slot = cache.slots[--cache.count];
+            }
+            else {
+                slot = TakeOne_();
+            }
+
+            try {
+                return ::new (slot->memory) E(args...);
+            }
+            catch (...) {
+                Deallocate_(slot);
+                throw;
+            }
+        }
+
+        static void DestroyDeallocate(E * ptr) {
+            if (ptr == nullptr) return;
+            ptr->~E();
+            Deallocate_(reinterpret_cast<Slot_ *>(ptr));
+        }
+
+        static PoolContentionStats Stats() {
+            Shared_& shared = GetShared_();
+            auto ul = std::unique_lock<std::mutex>(shared.m);
+            PoolContentionStats stats;
+            stats.name = typeid(E).name();
+            stats.refills = shared.refills;
+            stats.returns = shared.returns;
+            stats.contended = shared.contended.load(std::memory_order_relaxed);
+            stats.capacity = uint64_t(shared.chunks.size() * SlotsPerChunk_);
+            return stats;
+        }
+
+    private:
+        static Cache_& GetCache_() {
+            Cache_& cache = cache_;
+            if (!cache.registered) {
+                cache.registered = true;
+                // First use on this thread constructs the owner so its destructor runs on exit
+                (void)cacheOwner_;
+            }
+            return cache;
+        }
+
+        static void Deallocate_(Slot_ * slot) {
+            Cache_& cache = GetCache_();
+            if (cache.released) {
+                Return_(&slot, 1);
+                return;
+            }
+
+            // Give back the older half so the most recently freed (likely still in cache) slots get reused first
+            if (cache.count == CacheCapacity_) {
+                Return_(cache.slots, BatchSize);
+                std::move(cache.slots + BatchSize, cache.slots + CacheCapacity_, cache.slots);
+                cache.count -= BatchSize;
+            }
+            cache.slots[cache.count++] = slot;
+        }
+
+        static std::unique_lock<std::mutex> Lock_(Shared_& shared) {
+            auto ul = std::unique_lock<std::mutex>(shared.m, std::try_to_lock);
+            if (!ul.owns_lock()) {
+                shared.contended.fetch_add(1, std::memory_order_relaxed);
+                ul.lock();
+            }
+            return ul;
+        }
+
+        // Requires the shared lock
+        static void EnsureFree_(Shared_& shared, const size_t count) {
+            if (shared.free.size() >= count) return;
+            auto chunk = std::make_unique<Slot_[]>(SlotsPerChunk_);
+            // Reversed so that slots are handed out in address order
+            for (size_t i = SlotsPerChunk_; i > 0; --i) shared.free.push_back(&chunk[i - 1]);
+            shared.chunks.push_back(std::move(chunk));
+        }
+
+        static void Refill_(Cache_& cache) {
+            Shared_& shared = GetShared_();
+            auto ul = Lock_(shared);
+            EnsureFree_(shared, BatchSize);
+            const size_t first = shared.free.size() - BatchSize;
+            std::copy(shared.free.begin() + first, shared.free.end(), cache.slots);
+            shared.free.resize(first);
+            cache.count = BatchSize;
+            ++shared.refills;
+        }
+
+        static Slot_ * TakeOne_() {
+            Shared_& shared = GetShared_();
+            auto ul = Lock_(shared);
+            EnsureFree_(shared, 1);
+            Slot_ * slot = shared.free.back();
+            shared.free.pop_back();
+            return slot;
+        }
+
+        static void Return_(Slot_ * const * slots, const size_t count) {
+            Shared_& shared = GetShared_();
+            auto ul = Lock_(shared);
+            shared.free.insert(shared.free.end(), slots, slots + count);
+            ++shared.returns;
+        }
+
+        static Shared_& GetShared_() {
+            // Leaked since threads (and their caches) can outlive static destruction
+            static Shared_ * shared = []() {
+                ThreadCachedPoolRegistry_::Register(Stats);
+                return new Shared_();
+            }();
+            return *shared;
+        }
+
+    private:
+        inline thread_local static Cache_ cache_{};
+        inline thread_local static CacheOwner_ cacheOwner_;
+    };
+}
@@ -0,0 +1,84 @@
+#include "StratusPrefab.h"
+#include <stdexcept>
+
+namespace stratus {
+    static constexpr size_t NoParent_ = size_t(-1);
+
+    PrefabPtr Prefab::Create(const EntityPtr& root) {
+        if (root == nullptr) {
+            throw std::runtime_error("Prefab requires a root entity");
+        }
+        return PrefabPtr(new Prefab(root));
+    }
+
+    Prefab::Prefab(const EntityPtr& root) {
+        AddNode_(root, NoParent_);
+    }
+
+    void Prefab::AddNode_(const EntityPtr& entity, const size_t parent) {
+        const size_t index = nodes_.size();
+        {
+            auto sl = std::shared_lock<std::shared_mutex>(entity->m_);
+            const EntityComponentSet& set = *entity->components_;
+
+            Node_ node;
+            node.parent = parent;
+            node.numChildren = entity->childNodes_.size();
+            node.numSlots = set.components_.size();
+            node.components.reserve(set.componentManagers_.size());
+            for (const auto& manager : set.componentManagers_) {
+                const auto slot = set.FindSlot_(manager.component->TypeId());
+                node.components.push_back(Component_{manager.Copy(), slot->status});
+            }
+            nodes_.push_back(std::move(node));
+        }
+
+        for (const EntityPtr& child : entity->GetChildNodes()) {
+            AddNode_(child, index);
+        }
+    }
+
+    EntityPtr Prefab::Instantiate() const {
+        std::vector<EntityPtr> nodes(nodes_.size());
+        return Instantiate_(nodes);
+    }
+
+    std::vector<EntityPtr> Prefab::Instantiate(const size_t count) const {
+        std::vector<EntityPtr> roots;
+        roots.reserve(count);
+        std::vector<EntityPtr> nodes(nodes_.size());
+        for (size_t i = 0; i < count; ++i) {
+            roots.push_back(Instantiate_(nodes));
+        }
+        return roots;
+    }
+
+    EntityPtr Prefab::Instantiate_(std::vector<EntityPtr>& nodes) const {
+        for (size_t n = 0; n < nodes_.size(); ++n) {
+            const Node_& node = nodes_[n];
+            // Sizes are known up front and nothing can be a duplicate, so the set is filled in directly
+            EntityComponentSet * set = EntityComponentSet::Create();
+            set->componentManagers_.reserve(node.components.size());
+            set->components_.resize(node.numSlots);
+            for (const Component_& c : node.components) {
+                auto copy = c.component.Copy();
+                set->components_[copy.component->TypeId()] = EntityComponentPair<EntityComponent>{copy.component, c.status};
+                set->componentManagers_.push_back(std::move(copy));
+            }
+
+            // Entity takes ownership of the set and points the components at itself
+            nodes[n] = Entity::Create(set);
+            nodes[n]->childNodes_.reserve(node.numChildren);
+            if (node.parent == NoParent_) continue;
+
+            const EntityPtr& parent = nodes[node.parent];
+            parent->childNodes_.push_back(nodes[n]);
+            nodes[n]->parent_ = parent;
+        }
+
+        // Children are kept alive by their parents
+        EntityPtr root = std::move(nodes[0]);
+        for (auto& node : nodes) node.reset();
+        return root;
+    }
+}
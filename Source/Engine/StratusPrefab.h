@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "StratusEntity.h"
+#include "StratusEntityCommon.h"
+
+namespace stratus {
+    class Prefab;
+    typedef std::shared_ptr<Prefab> PrefabPtr;
+
+    // Snapshot of an entity tree which can be stamped out many times. The tree is flattened up front so
+    // instantiating builds each component set directly at its final size rather than going through
+    // Entity::Copy, which locks and walks the source tree and attaches components one at a time. Anything
+    // components share between copies, such as RenderComponent::meshes, stays shared by every instance.
+    //
+    // The prefab is immutable once created so Instantiate is thread safe.
+    class Prefab final {
+        Prefab(const EntityPtr&);
+
+    public:
+        // Takes its own copy of the tree, so later changes to root don't affect the prefab
+        static PrefabPtr Create(const EntityPtr& root);
+
+        ~Prefab() = default;
+
+        Prefab(Prefab&&) = delete;
+        Prefab(const Prefab&) = delete;
+        Prefab& operator=(Prefab&&) = delete;
+        Prefab& operator=(const Prefab&) = delete;
+
+        // New root entities which aren't part of the world yet. Unlike Entity::Copy, disabled
+        // components stay disabled.
+        EntityPtr Instantiate() const;
+        std::vector<EntityPtr> Instantiate(const size_t count) const;
+
+        // Number of entities in the tree
+        size_t NumNodes() const { return nodes_.size(); }
+
+    private:
+        struct Component_ {
+            EntityComponentPointerManager component;
+            EntityComponentStatus status;
+        };
+
+        struct Node_ {
+            // Index of the parent in nodes_ (parents always come before their children)
+            size_t parent;
+            size_t numChildren;
+            // Size of EntityComponentSet::components_ needed to hold every component id
+            size_t numSlots;
+            std::vector<Component_> components;
+        };
+
+    private:
+        void AddNode_(const EntityPtr&, const size_t parent);
+        // nodes is scratch space with room for NumNodes() entities
+        EntityPtr Instantiate_(std::vector<EntityPtr>& nodes) const;
+
+    private:
+        std::vector<Node_> nodes_;
+    };
+}
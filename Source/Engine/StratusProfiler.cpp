@@ -0,0 +1,203 @@
+#include "StratusProfiler.h"
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+
+namespace stratus {
+    struct ProfilerZone_ {
+        // Fields are atomic since a dump can read a zone while its thread is overwriting it
+        std::atomic<const char *> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> end{0};
+    };
+
+    struct ProfilerThread_ {
+        uint32_t id = 0;
+        // Protected by the registry mutex
+        std::string name;
+        // Total number of zones this thread has ever recorded - only the owning thread writes it
+        std::atomic<uint64_t> written{0};
+        // Zones before this index were dropped by Clear
+        std::atomic<uint64_t> cleared{0};
+        ProfilerZone_ zones[Profiler::ZonesPerThread];
+    };
+
+    struct ProfilerRegistry_ {
+        std::mutex mutex;
+        // Buffers are never freed so that zones from threads which have exited can still be dumped
+        std::vector<ProfilerThread_ *> threads;
+    };
+
+    // Never destroyed since threads can record during static destruction
+    static ProfilerRegistry_& GetRegistry() {
+        static auto * registry = new ProfilerRegistry_();
+        return *registry;
+    }
+
+    static ProfilerThread_ *& GetCurrentProfilerThread() {
+        static thread_local ProfilerThread_ * current = nullptr;
+        return current;
+    }
+
+    // First name given to the calling thread
+    static std::string& GetPendingThreadName() {
+        static thread_local std::string name;
+        return name;
+    }
+
+    static ProfilerThread_ * CreateProfilerThread() {
+        ProfilerThread_ * thread = new ProfilerThread_();
+        ProfilerRegistry_& registry = GetRegistry();
+        std::unique_lock<std::mutex> ul(registry.mutex);
+        thread->id = uint32_t(registry.threads.size() + 1);
+        thread->name = GetPendingThreadName().size() > 0 ? GetPendingThreadName() : "Thread " + std::to_string(thread->id);
+        registry.threads.push_back(thread);
+        return thread;
+    }
+
+    static void WriteEscaped(std::ostream& out, const std::string& str) {
+        for (const char c : str) {
+            if (c == '"' || c == '\\') out << '\\' << c;
+            else if (c == '\n') out << "\\n";
+            else if (static_cast<unsigned char>(c) >= 0x20) out << c;
+        }
+    }
+
+    // Trace timestamps are in microseconds
+    static void WriteMicroseconds(std::ostream& out, const uint64_t nanoseconds) {
+        out << (nanoseconds / 1000) << '.' << std::setw(3) << std::setfill('0') << (nanoseconds % 1000) << std::setfill(' ');
+    }
+
+    void Profiler::SetEnabled(const bool enabled) {
+        Enabled_().store(enabled);
+    }
+
+    uint64_t Profiler::Now() {
+        static const auto epoch = std::chrono::steady_clock::now();
+        const auto elapsed = std::chrono::steady_clock::now() - epoch;
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    void Profiler::Record(const char * name, const uint64_t startNanoseconds, const uint64_t endNanoseconds) {
+        ProfilerThread_ *& thread = GetCurrentProfilerThread();
+        if (thread == nullptr) thread = CreateProfilerThread();
+
+        const uint64_t index = thread->written.load(std::memory_order_relaxed);
+        ProfilerZone_& zone = thread->zones[index % ZonesPerThread];
+        // Pairs with the acquire fence in WriteChromeTrace: anyone who sees part of this zone also sees
+        // every zone before it as written, which is how torn zones get detected
+        std::atomic_thread_fence(std::memory_order_release);
+        zone.name.store(name, std::memory_order_relaxed);
+        zone.start.store(startNanoseconds, std::memory_order_relaxed);
+        zone.end.store(endNanoseconds, std::memory_order_relaxed);
+        thread->written.store(index + 1, std::memory_order_release);
+    }
+
+    void Profiler::SetCurrentThreadName(const std::string& name) {
+        std::string& pending = GetPendingThreadName();
+        if (pending.size() > 0) return;
+        pending = name;
+
+        ProfilerThread_ * thread = GetCurrentProfilerThread();
+        if (thread != nullptr) {
+            std::unique_lock<std::mutex> ul(GetRegistry().mutex);
+            thread->name = name;
+        }
+    }
+
+    bool Profiler::WriteChromeTrace(const std::string& file) {
+        struct ZoneCopy_ {
+            const char * name;
+            uint64_t start;
+            uint64_t end;
+        };
+
+        struct ThreadCopy_ {
+            uint32_t id;
+            std::string name;
+            std::vector<ZoneCopy_> zones;
+        };
+
+        // Copy everything out first so that recording threads only compete with us for as long as it takes to copy
+        std::vector<ThreadCopy_> threads;
+        {
+            ProfilerRegistry_& registry = GetRegistry();
+            std::unique_lock<std::mutex> ul(registry.mutex);
+            for (ProfilerThread_ * thread : registry.threads) {
+                ThreadCopy_ copy;
+                copy.id = thread->id;
+                copy.name = thread->name;
+
+                const uint64_t written = thread->written.load(std::memory_order_acquire);
+                const uint64_t cleared = thread->cleared.load(std::memory_order_relaxed);
+                const uint64_t first = std::max<uint64_t>(cleared, written > ZonesPerThread ? written - ZonesPerThread : 0);
+                std::vector<ZoneCopy_> zones;
+                zones.reserve(size_t(written - std::min(first, written)));
+                for (uint64_t i = first; i < written; ++i) {
+                    const ProfilerZone_& zone = thread->zones[i % ZonesPerThread];
+                    zones.push_back(ZoneCopy_{
+                        zone.name.load(std::memory_order_relaxed),
+                        zone.start.load(std::memory_order_relaxed),
+                        zone.end.load(std::memory_order_relaxed)
+                    });
+                }
+
+                // The owning thread may have lapped us while we were copying, in which case the oldest
+                // zones could be a mix of old and new data. The zone it is currently writing (index
+                // writtenAfter) overwrites the slot for index writtenAfter - ZonesPerThread so anything
+                // at or before that is thrown out.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const uint64_t writtenAfter = thread->written.load(std::memory_order_relaxed);
+                const uint64_t firstValid = writtenAfter >= ZonesPerThread ? writtenAfter - ZonesPerThread + 1 : 0;
+                for (uint64_t i = first; i < written; ++i) {
+                    if (i >= firstValid) copy.zones.push_back(zones[size_t(i - first)]);
+                }
+
+                threads.push_back(std::move(copy));
+            }
+        }
+
+        std::ofstream out(file, std::ios::out | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        const auto separator = [&out, &first]() {
+            if (!first) out << ",\n";
+            first = false;
+        };
+
+        for (const ThreadCopy_& thread : threads) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id << ",\"args\":{\"name\":\"";
+            WriteEscaped(out, thread.name);
+            out << "\"}}";
+
+            for (const ZoneCopy_& zone : thread.zones) {
+                if (zone.name == nullptr) continue;
+                separator();
+                out << "{\"name\":\"";
+                WriteEscaped(out, zone.name);
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.id << ",\"ts\":";
+                WriteMicroseconds(out, zone.start);
+                out << ",\"dur\":";
+                WriteMicroseconds(out, zone.end - zone.start);
+                out << "}";
+            }
+        }
+
+        out << "\n]}\n";
+        return out.good();
+    }
+
+    void Profiler::Clear() {
+        ProfilerRegistry_& registry = GetRegistry();
+        std::unique_lock<std::mutex> ul(registry.mutex);
+        for (ProfilerThread_ * thread : registry.threads) {
+            thread->cleared.store(thread->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+}
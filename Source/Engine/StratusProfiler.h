@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Set to 0 to compile every profile scope out of the engine
+#ifndef STRATUS_ENABLE_PROFILING
+#define STRATUS_ENABLE_PROFILING 1
+#endif
+
+#define STRATUS_PROFILE_CONCAT_IMPL_(a, b) a##b
+#define STRATUS_PROFILE_CONCAT_(a, b) STRATUS_PROFILE_CONCAT_IMPL_(a, b)
+
+// Usage example (name must be a string literal or otherwise outlive the profiler):
+//      STRATUS_PROFILE_SCOPE("RendererFrontend::UpdateVisibility");
+#if STRATUS_ENABLE_PROFILING
+#define STRATUS_PROFILE_SCOPE(name) stratus::ProfileScope STRATUS_PROFILE_CONCAT_(profileScope_, __LINE__)(name)
+#else
+#define STRATUS_PROFILE_SCOPE(name)
+#endif
+
+namespace stratus {
+    // CPU profiler which records named time ranges (zones) into a ring buffer owned by each thread.
+    // Recording never takes a lock - each thread only ever writes into its own buffer, and once a buffer
+    // fills up the oldest zones are overwritten. This means it's cheap enough to leave enabled so that
+    // the last few seconds of frames can be dumped whenever a spike shows up.
+    //
+    // Dumps use the Chrome trace event format which can be opened with chrome://tracing or ui.perfetto.dev.
+    class Profiler {
+    public:
+        // Number of zones each thread keeps before overwriting the oldest (dumps include at most ZonesPerThread - 1
+        // once a buffer wraps since the oldest slot could be mid-overwrite)
+        static constexpr size_t ZonesPerThread = 16384;
+
+        // Enabled by default. While disabled, profile scopes do not read the clock.
+        static void SetEnabled(const bool);
+        static bool IsEnabled() {
+            return Enabled_().load(std::memory_order_relaxed);
+        }
+
+        // Nanoseconds since the profiler was first used
+        static uint64_t Now();
+
+        // Records a zone for the calling thread
+        static void Record(const char * name, const uint64_t startNanoseconds, const uint64_t endNanoseconds);
+
+        // Gives the calling thread a name to show up as in the trace. Only the first name is kept.
+        static void SetCurrentThreadName(const std::string&);
+
+        // Writes every zone currently held by the ring buffers. Safe to call from any thread while
+        // other threads are still recording. Returns false if the file couldn't be written.
+        static bool WriteChromeTrace(const std::string& file);
+
+        // Drops all recorded zones
+        static void Clear();
+
+    private:
+        static std::atomic<bool>& Enabled_() {
+            static std::atomic<bool> enabled(true);
+            return enabled;
+        }
+    };
+
+    // Records a zone from construction to destruction - see STRATUS_PROFILE_SCOPE
+    class ProfileScope {
+    public:
+        explicit ProfileScope(const char * name)
+            : name_(Profiler::IsEnabled() ? name : nullptr),
+              start_(name_ != nullptr ? Profiler::Now() : 0) {}
+
+        ~ProfileScope() {
+            if (name_ != nullptr) Profiler::Record(name_, start_, Profiler::Now());
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope(ProfileScope&&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+        ProfileScope& operator=(ProfileScope&&) = delete;
+
+    private:
+        const char * name_;
+        const uint64_t start_;
+    };
+}
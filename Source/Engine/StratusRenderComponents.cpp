@@ -5,6 +5,7 @@
 #include "StratusApplicationThread.h"
 #include "StratusLog.h"
 #include "StratusTransformComponent.h"
+#include "StratusAffine.h"
 #include "StratusPoolAllocator.h"
 #include "meshoptimizer.h"
 
@@ -53,8 +54,12 @@ namespace stratus {
     }
 
     Mesh::~Mesh() {
+        // cpuData_ is only released once GPU data has been allocated, so meshes which were
+        // never finalized have nothing to give back to GpuMeshAllocator
+        const bool gpuDataGenerated = IsFinalized();
         delete cpuData_;
         cpuData_ = nullptr;
+        if (!gpuDataGenerated) return;
 
         auto vertexOffset = vertexOffset_;
         auto numVertices = numVertices_;
@@ -179,10 +184,11 @@ namespace stratus {
     void Mesh::PackCpuData() {
         EnsureNotFinalized_();
 
-        if (cpuData_->tangents.size() == 0 || cpuData_->bitangents.size() == 0) CalculateTangentsBitangents_();
-
+        // Cooked meshes only have packed data, so there is nothing to generate tangents from
         if (!cpuData_->needsRepacking) return;
 
+        if (cpuData_->tangents.size() == 0 || cpuData_->bitangents.size() == 0) CalculateTangentsBitangents_();
+
         // Pack all data into a single buffer
         cpuData_->data.clear();
         cpuData_->data.resize(numVertices_);
@@ -237,14 +243,11 @@ namespace stratus {
             }
         }
 
-        glm::vec3 vertex = glm::vec3(transform * glm::vec4(cpuData_->vertices[cpuData_->indices[0]], 1.0f));
-		glm::vec3 vmin = vertex;
-		glm::vec3 vmax = vertex;
-        for (size_t i = 0; i < cpuData_->indices.size(); ++i) {
-            vertex = glm::vec3(transform * glm::vec4(cpuData_->vertices[cpuData_->indices[i]], 1.0f));
-            vmin = glm::min(vmin, vertex);
-            vmax = glm::max(vmax, vertex);
-        }
+        glm::vec3 vmin;
+        glm::vec3 vmax;
+        CalculateTransformedBounds(
+            Affine3x4::FromMat4(transform), cpuData_->vertices.data(), cpuData_->indices.data(), cpuData_->indices.size(), vmin, vmax
+        );
 
         aabb_.vmin = glm::vec4(vmin, 1.0f);
         aabb_.vmax = glm::vec4(vmax, 1.0f);
@@ -314,6 +317,16 @@ namespace stratus {
         cpuData_->indicesPerLod[0] = cpuData_->indices;
     }
 
+    void Mesh::ProcessCpuData() {
+        EnsureNotFinalized_();
+        if (cpuData_->processed) return;
+
+        PackCpuData();
+        CalculateAabbs(glm::mat4(1.0f));
+        GenerateLODs();
+        cpuData_->processed = true;
+    }
+
     size_t Mesh::GetGpuSizeBytes() const {
         EnsureFinalized_();
         return dataSizeBytes_;
@@ -324,6 +337,16 @@ namespace stratus {
         return aabb_;
     }
 
+    size_t Mesh::GetUploadSizeBytes() const {
+        size_t numIndices = 0;
+        for (const uint32_t count : numIndicesPerLod_) numIndices += count;
+        return dataSizeBytes_ + numIndices * sizeof(uint32_t);
+    }
+
+    const GpuAABB& Mesh::GetProcessedAABB() const {
+        return aabb_;
+    }
+
     uint32_t Mesh::GetVertexOffset() const {
         return vertexOffset_;
     }
@@ -341,6 +364,21 @@ namespace stratus {
     void Mesh::GenerateGpuData_() {
         EnsureNotFinalized_();
 
+        if (cpuData_->mapping != nullptr) {
+            vertexOffset_ = GpuMeshAllocator::AllocateVertexData(numVertices_);
+            indexOffsetPerLod_.clear();
+            for (size_t lod = 0; lod < numIndicesPerLod_.size(); ++lod) {
+                indexOffsetPerLod_.push_back(GpuMeshAllocator::AllocateIndexData(numIndicesPerLod_[lod]));
+                GpuMeshAllocator::StreamIndexData(cpuData_->mappedIndicesPerLod[lod], numIndicesPerLod_[lod], indexOffsetPerLod_[lod], vertexOffset_);
+            }
+            GpuMeshAllocator::StreamVertexData(cpuData_->mappedData, numVertices_, vertexOffset_);
+
+            // Releases our hold on the file
+            delete cpuData_;
+            cpuData_ = nullptr;
+            return;
+        }
+
         if (cpuData_->indicesPerLod.size() == 0) {
             GenerateLODs();
         }
@@ -23,6 +23,7 @@ namespace stratus {
     };
 
     struct Mesh;
+    class MappedFile;
 
     typedef Mesh * MeshPtr;
 
@@ -30,6 +31,8 @@ namespace stratus {
     extern void InitializeRenderEntity(const EntityPtr&);
 
     struct Mesh final {
+        friend class MeshCache;
+
     private:
         Mesh();
 
@@ -54,6 +57,10 @@ namespace stratus {
         void FinalizeData();
 
         size_t GetGpuSizeBytes() const;
+        // What FinalizeData will upload (vertices and every LOD's indices) and the object space bounds. Unlike
+        // GetGpuSizeBytes and GetAABB these can be read as soon as ProcessCpuData has run.
+        size_t GetUploadSizeBytes() const;
+        const GpuAABB& GetProcessedAABB() const;
 
         void SetFaceCulling(const RenderFaceCulling&);
         RenderFaceCulling GetFaceCulling() const;
@@ -65,6 +72,9 @@ namespace stratus {
         void PackCpuData();
         void CalculateAabbs(const glm::mat4& transform);
         void GenerateLODs();
+        // All three of the above, skipped if they've already been done (meshes read from
+        // the cooked mesh cache come with everything done)
+        void ProcessCpuData();
 
         // Temporary - to be removed
         void Render(size_t numInstances, const GpuArrayBuffer& additionalBuffers) const;
@@ -93,12 +103,19 @@ namespace stratus {
             std::vector<GpuMeshData> data;
             std::vector<std::vector<uint32_t>> indicesPerLod;
             bool needsRepacking = false;
+            // Set by ProcessCpuData
+            bool processed = false;
+            // Meshes streamed from a cooked file point into its mapping instead of filling in data and
+            // indicesPerLod, and are uploaded straight from there. The file stays mapped until then.
+            std::shared_ptr<const MappedFile> mapping;
+            const GpuMeshData * mappedData = nullptr;
+            std::vector<const uint32_t *> mappedIndicesPerLod;
         };
 
     private:
         MeshCpuData_ * cpuData_;
         GpuAABB aabb_;
-        size_t dataSizeBytes_;
+        size_t dataSizeBytes_ = 0;
         uint32_t numVertices_;
         uint32_t numIndices_;
         uint32_t vertexOffset_; // Into global GpuBuffer
@@ -18,6 +18,7 @@
 #include "StratusEngine.h"
 #include "StratusWindow.h"
 #include "StratusGraphicsDriver.h"
+#include "StratusProfiler.h"
 
 namespace stratus {
 bool IsRenderable(const EntityPtr& p) {
@@ -1079,6 +1080,7 @@ void RendererBackend::RenderSkybox_() {
 }
 
 void RendererBackend::RenderCSMDepth_() {
+    STRATUS_PROFILE_SCOPE("RendererBackend::RenderCSMDepth_");
     if (frame_->csc.cascades.size() > state_.csmDepth.size()) {
         throw std::runtime_error("Max cascades exceeded (> 6)");
     }
@@ -1158,6 +1160,7 @@ void RendererBackend::RenderCSMDepth_() {
 }
 
 void RendererBackend::RenderSsaoOcclude_() {
+    STRATUS_PROFILE_SCOPE("RendererBackend::RenderSsaoOcclude_");
     glDisable(GL_CULL_FACE);
     glDisable(GL_DEPTH_TEST);
 
@@ -1187,6 +1190,7 @@ void RendererBackend::RenderSsaoOcclude_() {
 }
 
 void RendererBackend::RenderSsaoBlur_() {
+    STRATUS_PROFILE_SCOPE("RendererBackend::RenderSsaoBlur_");
     glDisable(GL_CULL_FACE);
     glDisable(GL_DEPTH_TEST);
 
@@ -1205,6 +1209,7 @@ void RendererBackend::RenderSsaoBlur_() {
 }
 
 void RendererBackend::RenderAtmosphericShadowing_() {
+    STRATUS_PROFILE_SCOPE("RendererBackend::RenderAtmosphericShadowing_");
     if (!frame_->csc.worldLight->GetEnabled()) return;
 
     constexpr float preventDivByZero = std::numeric_limits<float>::epsilon();
@@ -1332,6 +1337,7 @@ void RendererBackend::UpdatePointLights_(
     VplDistMultiSet_& perVPLDistToViewerSet,
     VplDistVector_& perVPLDistToViewerVec,
     std::vector<int, StackBasedPoolAllocator<int>>& visibleVplIndices) {
+    STRATUS_PROFILE_SCOPE("RendererBackend::UpdatePointLights_");
 
     const Camera& c = *frame_->camera;
 
@@ -1660,6 +1666,7 @@ void RendererBackend::PerformVirtualPointLightCullingStage1_(
 //     const std::vector<int>& visibleVplIndices) {
 void RendererBackend::PerformVirtualPointLightCullingStage2_(
     const VplDistVector_& perVPLDistToViewer) {
+    STRATUS_PROFILE_SCOPE("RendererBackend::PerformVirtualPointLightCullingStage2_");
 
     // int totalVisible = *(int *)state_.vpls.vplNumVisible.MapMemory();
     // state_.vpls.vplNumVisible.UnmapMemory();
@@ -1809,6 +1816,7 @@ void RendererBackend::PerformVirtualPointLightCullingStage2_(
 }
 
 void RendererBackend::ComputeVirtualPointLightGlobalIllumination_(const VplDistVector_& perVPLDistToViewer, const double deltaSeconds) {
+    STRATUS_PROFILE_SCOPE("RendererBackend::ComputeVirtualPointLightGlobalIllumination_");
     if (perVPLDistToViewer.size() == 0) return;
 
     // auto space = LogSpace<float>(1, 512, 30);
@@ -1947,6 +1955,7 @@ void RendererBackend::ComputeVirtualPointLightGlobalIllumination_(const VplDistV
 }
 
 void RendererBackend::RenderScene(const double deltaSeconds) {
+    STRATUS_PROFILE_SCOPE("RendererBackend::RenderScene");
     CHECK_IS_APPLICATION_THREAD();
 
     const Camera& c = *frame_->camera;
@@ -2003,34 +2012,37 @@ void RendererBackend::RenderScene(const double deltaSeconds) {
     RenderAtmosphericShadowing_();
 
     // Begin deferred lighting pass
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    state_.lightingFbo.Bind();
+    {
+        STRATUS_PROFILE_SCOPE("RendererBackend::DeferredLighting");
+        glDisable(GL_CULL_FACE);
+        glDisable(GL_DEPTH_TEST);
+        state_.lightingFbo.Bind();
 
-    //_unbindAllTextures();
-    Pipeline* lighting = state_.lighting.get();
-    if (frame_->csc.worldLight->GetEnabled()) {
-        lighting = state_.lightingWithInfiniteLight.get();
-    }
-
-    BindShader_(lighting);
-    InitLights_(lighting, perLightDistToViewerVec, state_.maxShadowCastingLightsPerFrame);
-    lighting->BindTexture("atmosphereBuffer", state_.atmosphericTexture);
-    lighting->SetMat4("invProjectionView", frame_->invProjectionView);
-    lighting->BindTexture("gDepth", state_.currentFrame.depth);
-    lighting->BindTexture("gNormal", state_.currentFrame.normals);
-    lighting->BindTexture("gAlbedo", state_.currentFrame.albedo);
-    lighting->BindTexture("gBaseReflectivity", state_.currentFrame.baseReflectivity);
-    lighting->BindTexture("gRoughnessMetallicAmbient", state_.currentFrame.roughnessMetallicAmbient);
-    lighting->BindTexture("ssao", state_.ssaoOcclusionBlurredTexture);
-    lighting->SetFloat("windowWidth", frame_->viewportWidth);
-    lighting->SetFloat("windowHeight", frame_->viewportHeight);
-    lighting->SetVec3("fogColor", frame_->settings.GetFogColor());
-    lighting->SetFloat("fogDensity", frame_->settings.GetFogDensity());
-    RenderQuad_();
-    state_.lightingFbo.Unbind();
-    UnbindShader_();
-    state_.finalScreenBuffer = state_.lightingFbo; // state_.lightingColorBuffer;
+        //_unbindAllTextures();
+        Pipeline* lighting = state_.lighting.get();
+        if (frame_->csc.worldLight->GetEnabled()) {
+            lighting = state_.lightingWithInfiniteLight.get();
+        }
+
+        BindShader_(lighting);
+        InitLights_(lighting, perLightDistToViewerVec, state_.maxShadowCastingLightsPerFrame);
+        lighting->BindTexture("atmosphereBuffer", state_.atmosphericTexture);
+        lighting->SetMat4("invProjectionView", frame_->invProjectionView);
+        lighting->BindTexture("gDepth", state_.currentFrame.depth);
+        lighting->BindTexture("gNormal", state_.currentFrame.normals);
+        lighting->BindTexture("gAlbedo", state_.currentFrame.albedo);
+        lighting->BindTexture("gBaseReflectivity", state_.currentFrame.baseReflectivity);
+        lighting->BindTexture("gRoughnessMetallicAmbient", state_.currentFrame.roughnessMetallicAmbient);
+        lighting->BindTexture("ssao", state_.ssaoOcclusionBlurredTexture);
+        lighting->SetFloat("windowWidth", frame_->viewportWidth);
+        lighting->SetFloat("windowHeight", frame_->viewportHeight);
+        lighting->SetVec3("fogColor", frame_->settings.GetFogColor());
+        lighting->SetFloat("fogDensity", frame_->settings.GetFogDensity());
+        RenderQuad_();
+        state_.lightingFbo.Unbind();
+        UnbindShader_();
+        state_.finalScreenBuffer = state_.lightingFbo; // state_.lightingColorBuffer;
+    }
 
     // If world light is enabled perform VPL Global Illumination pass
     if (frame_->csc.worldLight->GetEnabled() && frame_->settings.globalIlluminationEnabled) {
@@ -2075,6 +2087,7 @@ void RendererBackend::RenderScene(const double deltaSeconds) {
 }
 
 void RendererBackend::RenderForwardPassPbr_() {
+    STRATUS_PROFILE_SCOPE("RendererBackend::RenderForwardPassPbr_");
     // Make sure to bind our own frame buffer for rendering
     state_.currentFrame.fbo.Bind();
 
@@ -2108,6 +2121,7 @@ void RendererBackend::RenderForwardPassPbr_() {
 }
 
 void RendererBackend::RenderForwardPassFlat_() {
+    STRATUS_PROFILE_SCOPE("RendererBackend::RenderForwardPassFlat_");
     BindShader_(state_.forward.get());
 
     auto& jitter = frame_->settings.taaEnabled ? frame_->jitterProjectionView : frame_->projectionView;
@@ -2126,6 +2140,7 @@ void RendererBackend::RenderForwardPassFlat_() {
 }
 
 void RendererBackend::PerformPostFxProcessing_() {
+    STRATUS_PROFILE_SCOPE("RendererBackend::PerformPostFxProcessing_");
     glDisable(GL_CULL_FACE);
     glDisable(GL_BLEND);
     //glDisable(GL_BLEND);
@@ -2361,6 +2376,7 @@ void RendererBackend::PerformGammaTonemapPostFx_() {
 }
 
 void RendererBackend::FinalizeFrame_() {
+    STRATUS_PROFILE_SCOPE("RendererBackend::FinalizeFrame_");
     // Copy final frame to current frame
     //state_.gammaTonemapFbo.fbo.CopyFrom()
 
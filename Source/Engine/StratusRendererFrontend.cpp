@@ -3,6 +3,7 @@
 #include "StratusLog.h"
 #include "StratusWindow.h"
 #include "StratusTransformComponent.h"
+#include "StratusAffine.h"
 #include "StratusRenderComponents.h"
 #include "StratusResourceManager.h"
 #include "StratusEngine.h"
@@ -11,6 +12,7 @@
 #include "StratusEntityManager.h"
 #include "StratusGraphicsDriver.h"
 #include "StratusGpuMaterialBuffer.h"
+#include "StratusProfiler.h"
 
 #include <algorithm>
 
@@ -25,25 +27,35 @@ namespace stratus {
 
         virtual void Process(const double deltaSeconds) {}
 
-        void EntitiesAdded(const std::unordered_set<stratus::EntityPtr>& e) override {
+        void EntitiesAdded(const EntityList& e) override {
             auto rf = INSTANCE(RendererFrontend);
             if (rf) rf->EntitiesAdded_(e);
         }
 
-        void EntitiesRemoved(const std::unordered_set<stratus::EntityPtr>& e) override {
+        void EntitiesRemoved(const EntityList& e) override {
             auto rf = INSTANCE(RendererFrontend);
             if (rf) rf->EntitiesRemoved_(e);
         }
 
-        void EntityComponentsAdded(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent *>>& e) override {
+        void EntityComponentsAdded(const EntityComponentsAddedList& e) override {
             auto rf = INSTANCE(RendererFrontend);
             if (rf) rf->EntityComponentsAdded_(e);
         }
 
-        void EntityComponentsEnabledDisabled(const std::unordered_set<stratus::EntityPtr>& e) override {
+        void EntityComponentsEnabledDisabled(const EntityList& e) override {
             auto rf = INSTANCE(RendererFrontend);
             if (rf) rf->EntityComponentsEnabledDisabled_(e);
         }
+
+        // Anything without a render component can never be renderable
+        EntityComponentMask GetComponentMask() const override {
+            return EntityComponentMask::Of<RenderComponent>();
+        }
+
+        // Process does nothing so it never holds up another process
+        EntityComponentAccess GetComponentAccess() const override {
+            return EntityComponentAccess();
+        }
     };
 
     static void InitializeMeshTransformComponent(const EntityPtr& p) {
@@ -124,7 +136,7 @@ namespace stratus {
         frame_->materialInfo->MarkMaterialsUnused(c);
     }
 
-    void RendererFrontend::EntitiesAdded_(const std::unordered_set<stratus::EntityPtr>& e) {
+    void RendererFrontend::EntitiesAdded_(const EntityList& e) {
         auto ul = LockWrite_();
         bool added = false;
         for (auto ptr : e) {
@@ -132,7 +144,7 @@ namespace stratus {
         }
     }
 
-    void RendererFrontend::EntitiesRemoved_(const std::unordered_set<stratus::EntityPtr>& e) {
+    void RendererFrontend::EntitiesRemoved_(const EntityList& e) {
         auto ul = LockWrite_();
         bool removed = false;
         for (auto& ptr : e) {
@@ -140,7 +152,7 @@ namespace stratus {
         }
     }
 
-    void RendererFrontend::EntityComponentsAdded_(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent *>>& e) {
+    void RendererFrontend::EntityComponentsAdded_(const EntityComponentsAddedList& e) {
         auto ul = LockWrite_();
         bool changed = false;
         for (auto& entry : e) {
@@ -152,7 +164,7 @@ namespace stratus {
         }
     }
 
-    void RendererFrontend::EntityComponentsEnabledDisabled_(const std::unordered_set<stratus::EntityPtr>& e) {
+    void RendererFrontend::EntityComponentsEnabledDisabled_(const EntityList& e) {
         auto ul = LockWrite_();
         bool changed = false;
         for (auto& ptr : e) {
@@ -164,17 +176,18 @@ namespace stratus {
     }
 
     bool RendererFrontend::AddEntity_(const EntityPtr& p) {
-        if (p == nullptr || entities_.find(p) != entities_.end()) return false;
+        // Only entities in the world have a handle
+        if (p == nullptr || !p->GetHandle() || entities_.Contains(p->GetHandle())) return false;
         
         if (IsRenderable(p)) {
             InitializeMeshTransformComponent(p);
 
-            entities_.insert(p);
+            entities_.Insert(p->GetHandle(), p);
 
             const bool isStatic = IsStaticEntity(p);
 
             if (!isStatic) {
-                dynamicEntities_.insert(p);
+                dynamicEntities_.Insert(p->GetHandle(), p);
             }
 
             AddAllMaterialsForEntity_(p);
@@ -214,10 +227,10 @@ namespace stratus {
     }
 
     bool RendererFrontend::RemoveEntity_(const EntityPtr& p) {
-        if (p == nullptr || entities_.find(p) == entities_.end() || !IsRenderable(p)) return false;
+        if (p == nullptr || !entities_.Contains(p->GetHandle()) || !IsRenderable(p)) return false;
 
-        entities_.erase(p);
-        dynamicEntities_.erase(p);
+        entities_.Remove(p->GetHandle());
+        dynamicEntities_.Remove(p->GetHandle());
         dynamicPbrEntities_.erase(p);
         staticPbrEntities_.erase(p);
         flatEntities_.erase(p);
@@ -331,6 +344,24 @@ namespace stratus {
         return camera_;
     }
 
+    std::vector<glm::vec4> RendererFrontend::GetViewFrustumPlanes() const {
+        auto sl = LockRead_();
+        if (camera_ == nullptr) return std::vector<glm::vec4>();
+
+        // Same extraction as UpdateVisibility_
+        const glm::mat4 vpt = glm::transpose(projection_ * camera_->GetViewTransform());
+        return std::vector<glm::vec4>{
+            // left, right, bottom, top
+            (vpt[3] + vpt[0]),
+            (vpt[3] - vpt[0]),
+            (vpt[3] + vpt[1]),
+            (vpt[3] - vpt[1]),
+            // near, far
+            (vpt[3] + vpt[2]),
+            (vpt[3] - vpt[2])
+        };
+    }
+
     void RendererFrontend::SetFovY(const Degrees& fovy) {
         auto ul = LockWrite_();
         params_.fovy = fovy;
@@ -373,6 +404,7 @@ namespace stratus {
 
     SystemStatus RendererFrontend::Update(const double deltaSeconds) {
         CHECK_IS_APPLICATION_THREAD();
+        STRATUS_PROFILE_SCOPE("RendererFrontend::Update");
 
         auto ul = LockWrite_();
         if (camera_ == nullptr) return SystemStatus::SYSTEM_CONTINUE;
@@ -394,7 +426,8 @@ namespace stratus {
         UpdateLights_();
         UpdateMaterialSet_();
         UpdateDrawCommands_();
-        UpdateVisibility_();
+        // Culling runs in compute shaders so there is nothing to do when headless
+        if (!GraphicsDriver::IsHeadless()) UpdateVisibility_();
 
         // Update view projection and its inverse
         frame_->projectionView = frame_->projection * frame_->view;
@@ -416,6 +449,25 @@ namespace stratus {
 
         //_SwapFrames();
 
+        // Headless frames stop after the CPU side of the frame
+        if (!GraphicsDriver::IsHeadless()) {
+            RenderFrame_(deltaSeconds);
+        }
+
+        // This needs to be unset
+        frame_->csc.regenerateFbo = false;
+
+        // Set previous projection view
+        frame_->prevProjectionView = frame_->projectionView;
+        frame_->prevInvProjectionView = frame_->invProjectionView;
+
+        // Reset the per frame scratch memory
+        frame_->perFrameScratchMemory->Deallocate();
+
+        return SystemStatus::SYSTEM_CONTINUE;
+    }
+
+    void RendererFrontend::RenderFrame_(const double deltaSeconds) {
         // Check for shader recompile request
         if (recompileShaders_) {
             renderer_->RecompileShaders();
@@ -433,26 +485,16 @@ namespace stratus {
         renderer_->RenderScene(deltaSeconds);
         renderer_->End();
 
-        // This needs to be unset
-        frame_->csc.regenerateFbo = false;
-
         // Move current transforms -> previous transforms
         UpdatePrevFrameModelTransforms_();
-
-        // Set previous projection view
-        frame_->prevProjectionView = frame_->projectionView;
-        frame_->prevInvProjectionView = frame_->invProjectionView;
-
-        // Reset the per frame scratch memory
-        frame_->perFrameScratchMemory->Deallocate();
-
-        return SystemStatus::SYSTEM_CONTINUE;
     }
 
     bool RendererFrontend::Initialize() {
         CHECK_IS_APPLICATION_THREAD();
-        // Create the renderer on the renderer thread only
-        renderer_ = std::make_unique<RendererBackend>(Window::Instance()->GetWindowDims().first, Window::Instance()->GetWindowDims().second, params_.appName);
+        // Create the renderer on the renderer thread only (there is no backend when headless)
+        if (!GraphicsDriver::IsHeadless()) {
+            renderer_ = std::make_unique<RendererBackend>(Window::Instance()->GetWindowDims().first, Window::Instance()->GetWindowDims().second, params_.appName);
+        }
 
         frame_ = std::make_shared<RendererFrame>();
 
@@ -483,6 +525,8 @@ namespace stratus {
 
         ClearWorldLight();
 
+        if (GraphicsDriver::IsHeadless()) return true;
+
         // Initialize visibility culling compute pipeline
         const std::filesystem::path shaderRoot("../Source/Shaders");
         const ShaderApiVersion version{GraphicsDriver::GetConfig().majorVersion, GraphicsDriver::GetConfig().minorVersion};
@@ -519,8 +563,8 @@ namespace stratus {
         frame_.reset();
         renderer_.reset();
 
-        entities_.clear();
-        dynamicEntities_.clear();
+        entities_.Clear();
+        dynamicEntities_.Clear();
         lights_.clear();
         lightsToRemove_.clear();
 
@@ -812,41 +856,70 @@ namespace stratus {
         return tc->ChangedWithinLastFrame() || rc->ChangedWithinLastFrame();
     }
 
-    void RendererFrontend::CheckEntitySetForChanges_(std::unordered_set<EntityPtr>& set) {
-        for (auto& entity : set) {
-            // If this is a light-interacting node, run through all the lights to see if they need to be updated
-            if (EntityChanged_(entity)) {               
+    void RendererFrontend::UpdateChangedEntity_(const EntityPtr& entity) {
+        InitializeMeshTransformComponent(entity);
 
-                InitializeMeshTransformComponent(entity);
+        frame_->drawCommands->UpdateTransforms(entity);
 
-                frame_->drawCommands->UpdateTransforms(entity);
+        // If this is a light-interacting node, run through all the lights to see if they need to be updated
+        if (IsLightInteracting(entity)) {
+            for (const auto& light : lights_) {
+                // Static lights don't care about entity movement changes
+                if (light->IsStaticLight()) continue;
 
-                if (IsLightInteracting(entity)) {
-                    for (const auto& light : lights_) {
-                        // Static lights don't care about entity movement changes
-                        if (light->IsStaticLight()) continue;
-
-                        auto lightPos = light->GetPosition();
-                        auto lightRadius = light->GetRadius();
-                        //If the EntityView is in the light's visible set, its shadows are now out of date
-                        for (size_t i = 0; i < GetMeshCount(entity); ++i) {
-                            if (glm::distance(GetWorldTransform(entity, i), lightPos) > lightRadius) {
-                                frame_->lightsToUpdate.PushBack(light);
-                            }
-                            // If the EntityView has moved inside the light's radius, add it
-                            else if (glm::distance(GetWorldTransform(entity, i), lightPos) < lightRadius) {
-                                frame_->lightsToUpdate.PushBack(light);
-                            }
-                        }
+                auto lightPos = light->GetPosition();
+                auto lightRadius = light->GetRadius();
+                //If the EntityView is in the light's visible set, its shadows are now out of date
+                for (size_t i = 0; i < GetMeshCount(entity); ++i) {
+                    if (glm::distance(GetWorldTransform(entity, i), lightPos) > lightRadius) {
+                        frame_->lightsToUpdate.PushBack(light);
+                    }
+                    // If the EntityView has moved inside the light's radius, add it
+                    else if (glm::distance(GetWorldTransform(entity, i), lightPos) < lightRadius) {
+                        frame_->lightsToUpdate.PushBack(light);
                     }
                 }
             }
         }
     }
 
+    void RendererFrontend::CheckEntitySetForChanges_(const SparseHandleMap<EntityPtr, Entity>& set) {
+        for (const auto& entity : set) {
+            if (EntityChanged_(entity)) UpdateChangedEntity_(entity);
+        }
+    }
+
     void RendererFrontend::CheckForEntityChanges_() {
-        // We only care about dynamic light-interacting entities
-        CheckEntitySetForChanges_(dynamicEntities_);
+        STRATUS_PROFILE_SCOPE("RendererFrontend::CheckForEntityChanges_");
+        // We only care about dynamic light-interacting entities. The change journal hands back only the ones
+        // which changed within the same window EntityChanged_ checks - if it doesn't go back that far then
+        // every dynamic entity gets checked instead.
+        const uint64_t frame = Engine::CurrentFrame();
+        const uint64_t since = frame > 0 ? frame - 1 : 0;
+        const auto collect = [this](const EntityPtr& entity, const EntityComponent *) {
+            if (dynamicEntities_.Contains(entity->GetHandle())) changedEntities_.push_back(entity);
+        };
+
+        auto entities = INSTANCE(EntityManager);
+        changedEntities_.clear();
+        if (!entities->ForEachChangedSince<GlobalTransformComponent>(since, collect) ||
+            !entities->ForEachChangedSince<RenderComponent>(since, collect)) {
+
+            changedEntities_.clear();
+            CheckEntitySetForChanges_(dynamicEntities_);
+            return;
+        }
+
+        // Entities show up once per component type that changed
+        std::sort(changedEntities_.begin(), changedEntities_.end(), [](const EntityPtr& a, const EntityPtr& b) {
+            return a->GetHandle() < b->GetHandle();
+        });
+        changedEntities_.erase(std::unique(changedEntities_.begin(), changedEntities_.end()), changedEntities_.end());
+
+        for (const auto& entity : changedEntities_) {
+            UpdateChangedEntity_(entity);
+        }
+        changedEntities_.clear();
     }
 
     void RendererFrontend::MarkDynamicLightsDirty_() {
@@ -897,6 +970,7 @@ namespace stratus {
 
     // TODO: This desperately needs to be refactored and made more efficient
     void RendererFrontend::UpdateDrawCommands_() {
+        STRATUS_PROFILE_SCOPE("RendererFrontend::UpdateDrawCommands_");
         const bool staticLightsDirty = frame_->drawCommands->UploadStaticDataToGpu();
         const bool dynamicLightsDirty = staticLightsDirty || frame_->drawCommands->UploadDynamicDataToGpu();
         frame_->drawCommands->UploadFlatDataToGpu();
@@ -910,15 +984,16 @@ namespace stratus {
         glm::vec4 vmin = aabb.vmin.ToVec4();
         glm::vec4 vmax = aabb.vmax.ToVec4();
 
+        const Affine3x4 affine = Affine3x4::FromMat4(transform);
         std::vector<glm::vec4, Vec4Allocator> corners({
-            transform * glm::vec4(vmin.x, vmin.y, vmin.z, 1.0),
-            transform * glm::vec4(vmin.x, vmax.y, vmin.z, 1.0),
-            transform * glm::vec4(vmin.x, vmin.y, vmax.z, 1.0),
-            transform * glm::vec4(vmin.x, vmax.y, vmax.z, 1.0),
-            transform * glm::vec4(vmax.x, vmin.y, vmin.z, 1.0),
-            transform * glm::vec4(vmax.x, vmax.y, vmin.z, 1.0),
-            transform * glm::vec4(vmax.x, vmin.y, vmax.z, 1.0),
-            transform * glm::vec4(vmax.x, vmax.y, vmax.z, 1.0)
+            glm::vec4(affine.TransformPoint(glm::vec3(vmin.x, vmin.y, vmin.z)), 1.0f),
+            glm::vec4(affine.TransformPoint(glm::vec3(vmin.x, vmax.y, vmin.z)), 1.0f),
+            glm::vec4(affine.TransformPoint(glm::vec3(vmin.x, vmin.y, vmax.z)), 1.0f),
+            glm::vec4(affine.TransformPoint(glm::vec3(vmin.x, vmax.y, vmax.z)), 1.0f),
+            glm::vec4(affine.TransformPoint(glm::vec3(vmax.x, vmin.y, vmin.z)), 1.0f),
+            glm::vec4(affine.TransformPoint(glm::vec3(vmax.x, vmax.y, vmin.z)), 1.0f),
+            glm::vec4(affine.TransformPoint(glm::vec3(vmax.x, vmin.y, vmax.z)), 1.0f),
+            glm::vec4(affine.TransformPoint(glm::vec3(vmax.x, vmax.y, vmax.z)), 1.0f)
             },
 
             Vec4Allocator(perFrameAllocator)
@@ -927,23 +1002,9 @@ namespace stratus {
         return corners;
     }
 
-    // This code was taken from "3D Graphics Rendering Cookbook" source code, shared/UtilsMath.h
-    GpuAABB TransformAabb(const GpuAABB& aabb, const glm::mat4& transform, const UnsafePtr<StackAllocator>& perFrameAllocator) {
-        std::vector<glm::vec4, Vec4Allocator> corners = ComputeCornersWithTransform(aabb, transform, perFrameAllocator);
-
-        glm::vec3 vmin3 = corners[0];
-        glm::vec3 vmax3 = corners[0];
-
-        for (int i = 1; i < 8; ++i) {
-            vmin3 = glm::min(vmin3, glm::vec3(corners[i]));
-            vmax3 = glm::max(vmax3, glm::vec3(corners[i]));
-        }
-
-        GpuAABB result;
-        result.vmin = glm::vec4(vmin3, 1.0);
-        result.vmax = glm::vec4(vmax3, 1.0); 
-
-        return result;
+    // Global transforms are always affine so this doesn't need the corners (see stratus::TransformAabb)
+    GpuAABB TransformAabb(const GpuAABB& aabb, const glm::mat4& transform) {
+        return TransformAabb(Affine3x4::FromMat4(transform), aabb);
     }
 
     bool IsAabbVisible(const GpuAABB& aabb, const std::vector<glm::vec4>& frustumPlanes) {
@@ -952,6 +1013,7 @@ namespace stratus {
 
     // See the section on culling in "3D Graphics Rendering Cookbook"
     void RendererFrontend::UpdateVisibility_() {   
+        STRATUS_PROFILE_SCOPE("RendererFrontend::UpdateVisibility_");
         using CommandBufferAllocator = StackBasedPoolAllocator< std::unordered_map<RenderFaceCulling, GpuCommandBufferPtr>*>;
         const std::vector<std::unordered_map<RenderFaceCulling, GpuCommandBufferPtr>*, CommandBufferAllocator> commands({
             &frame_->drawCommands->flatMeshes,
@@ -45,6 +45,9 @@ namespace stratus {
 
         void SetCamera(const CameraPtr&);
         CameraPtr GetCamera() const;
+        // World space planes of the camera's view frustum as of the last frame (see IsAabbInFrustum).
+        // Empty if there is no camera.
+        std::vector<glm::vec4> GetViewFrustumPlanes() const;
         void SetFovY(const Degrees&);
         void SetNearFar(const float znear, const float zfar);
         void SetClearColor(const glm::vec4&);
@@ -70,7 +73,8 @@ namespace stratus {
         bool AddEntity_(const EntityPtr& p);
         static bool EntityChanged_(const EntityPtr&);
         bool RemoveEntity_(const EntityPtr&);
-        void CheckEntitySetForChanges_(std::unordered_set<EntityPtr>&);
+        void UpdateChangedEntity_(const EntityPtr&);
+        void CheckEntitySetForChanges_(const SparseHandleMap<EntityPtr, Entity>&);
         void CopyMaterialToGpuAndMarkForUse_(const MaterialPtr& material, GpuMaterial* gpuMaterial);
 
     private:
@@ -96,20 +100,25 @@ namespace stratus {
             std::unordered_map<RenderFaceCulling, GpuCommandBufferPtr>& commands
         );
         void UpdatePrevFrameModelTransforms_();
+        // Runs the backend and everything else which needs the GPU
+        void RenderFrame_(const double deltaSeconds);
 
     private:
         // These are called by the private entity handler
         friend struct RenderEntityProcess;
-        void EntitiesAdded_(const std::unordered_set<stratus::EntityPtr>&);
-        void EntitiesRemoved_(const std::unordered_set<stratus::EntityPtr>&);
-        void EntityComponentsAdded_(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent *>>&);
-        void EntityComponentsEnabledDisabled_(const std::unordered_set<stratus::EntityPtr>&);
+        void EntitiesAdded_(const EntityList&);
+        void EntitiesRemoved_(const EntityList&);
+        void EntityComponentsAdded_(const EntityComponentsAddedList&);
+        void EntityComponentsEnabledDisabled_(const EntityList&);
 
     private:
         RendererParams params_;
-        std::unordered_set<EntityPtr> entities_;
+        // Keyed by entity handle so the per-frame walks are over dense arrays
+        SparseHandleMap<EntityPtr, Entity> entities_;
         // These are entities we need to check for position/orientation/scale updates
-        std::unordered_set<EntityPtr> dynamicEntities_;
+        SparseHandleMap<EntityPtr, Entity> dynamicEntities_;
+        // Scratch list for CheckForEntityChanges_
+        std::vector<EntityPtr> changedEntities_;
         //std::vector<GpuMaterial> _gpuMaterials;
         std::unordered_set<LightPtr> lights_;
         std::unordered_set<LightPtr> dynamicLights_;
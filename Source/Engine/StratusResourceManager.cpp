@@ -8,17 +8,26 @@
 #include <assimp/GltfMaterial.h>
 #include "StratusRendererFrontend.h"
 #include "StratusApplicationThread.h"
+#include "StratusGraphicsDriver.h"
 #include "StratusTaskSystem.h"
+#include "StratusTaskGraph.h"
 #include "StratusAsync.h"
 #include "StratusRenderComponents.h"
 #include "StratusTransformComponent.h"
+#include "StratusMeshCache.h"
+#include "StratusAffine.h"
 #include <sstream>
 #include <algorithm>
+#include <filesystem>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 namespace stratus {
-    ResourceManager::ResourceManager() {}
+    // Enough for a handful of 4k textures at a time without letting a large scene decode everything at once
+    static constexpr size_t DefaultTextureDecodeBudget_ = 1024 * 1024 * 256;
+
+    ResourceManager::ResourceManager()
+        : textureDecodes_(DefaultTextureDecodeBudget_) {}
 
     ResourceManager::~ResourceManager() {
     }
@@ -26,10 +35,17 @@ namespace stratus {
     SystemStatus ResourceManager::Update(const double deltaSeconds) {
         {
             auto ul = LockWrite_();
-            ClearAsyncTextureData_();
             ClearAsyncModelData_();
         }
 
+        // Texture uploads take mutex_ so this can't hold it
+        auto frontend = RendererFrontend::Instance();
+        auto camera = frontend != nullptr ? frontend->GetCamera() : nullptr;
+        if (camera != nullptr) {
+            uploads_.SetViewer(camera->GetPosition(), frontend->GetViewFrustumPlanes());
+        }
+        uploads_.ProcessFrame(Engine::Instance()->LastFrameWorkSeconds());
+
         return SystemStatus::SYSTEM_CONTINUE;
     }
 
@@ -42,79 +58,21 @@ namespace stratus {
 
     void ResourceManager::Shutdown() {
         loadedModels_.clear();
+        modelPrefabs_.clear();
+        cubePrefab_.reset();
+        quadPrefab_.reset();
         pendingFinalize_.clear();
         meshFinalizeQueue_.clear();
-        asyncLoadedTextureData_.clear();
+        uploads_.Clear();
+        textureDecodes_.Clear();
         loadedTextures_.clear();
         loadedTexturesByFile_.clear();
     }
 
-    void ResourceManager::ClearAsyncTextureData_() {
-        std::vector<TextureHandle> toDelete;
-        //constexpr size_t maxBytes = 1024 * 1024 * 10; // 10 mb per frame
-        size_t totalTex = 0;
-        size_t totalBytes = 0;
-        std::vector<TextureHandle> handles;
-        std::vector<std::shared_ptr<RawTextureData>> rawTexData;
-        for (auto& tpair : asyncLoadedTextureData_) {
-            //if (totalBytes > maxBytes) break;
-            if (tpair.second.Completed()) {
-                toDelete.push_back(tpair.first);
-                if (tpair.second.Failed()) {
-                    continue;
-                }
-                TextureHandle handle = tpair.first;
-                auto texdata = tpair.second.GetPtr();
-                if (!texdata) continue;
-                totalBytes += texdata->sizeBytes;
-                ++totalTex;
-
-                handles.push_back(handle);
-                rawTexData.push_back(texdata);
-            }
-        }
-
-        if (totalBytes > 0) {
-            STRATUS_LOG << "Texture data bytes processed: " << totalBytes << ", " << totalTex << std::endl;
-        }
-
-        for (auto handle : toDelete) asyncLoadedTextureData_.erase(handle);
-
-        ApplicationThread::Instance()->Queue([this, handles, rawTexData]() {
-            std::vector<Texture *> ptrs(rawTexData.size());
-            for (int i = 0; i < rawTexData.size(); ++i) {
-                ptrs[i] = FinalizeTexture_(*rawTexData[i]);
-            }
-
-            auto ul = LockWrite_();
-            for (int i = 0; i < handles.size(); ++i) {
-                texturesStillLoading_.erase(handles[i]);
-                loadedTextures_.insert(std::make_pair(handles[i], Async<Texture>(std::shared_ptr<Texture>(ptrs[i]))));
-            }
-        });
-    }
-
     void ResourceManager::ClearAsyncModelData_() {
-        static constexpr size_t maxModelBytesPerFrame = 1024 * 1024 * 2;
-        // First generate GPU data for some of the meshes
-        size_t totalBytes = 0;
-        std::vector<MeshPtr> removeFromGpuDataQueue;
-        for (auto mesh : generateMeshGpuDataQueue_) {
-            mesh->FinalizeData();
-            totalBytes += mesh->GetGpuSizeBytes();
-            removeFromGpuDataQueue.push_back(mesh);
-            if (removeFromGpuDataQueue.size() > 5 || totalBytes >= maxModelBytesPerFrame) break;
-            //if (totalBytes >= maxModelBytesPerFrame) break;
-        }
-
-        for (auto mesh : removeFromGpuDataQueue) generateMeshGpuDataQueue_.erase(mesh);
-
-        if (totalBytes > 0) STRATUS_LOG << "Processed " << totalBytes << " bytes of mesh data: " << removeFromGpuDataQueue.size() << " meshes" << std::endl;
-
         // If none other left to finalize, end early
         if (pendingFinalize_.size() == 0) return;
 
-        //constexpr size_t maxBytes = 1024 * 1024 * 10; // 10 mb per frame
         std::vector<std::string> toDelete;
         for (auto& mpair : pendingFinalize_) {
             if (mpair.second.Completed() && !mpair.second.Failed()) {
@@ -131,64 +89,34 @@ namespace stratus {
 
         if (meshFinalizeQueue_.size() == 0) return;
 
-        //size_t totalBytes = 0;
-        std::vector<MeshPtr> meshesToDelete(meshFinalizeQueue_.size());
-        size_t idx = 0;
-        for (auto& mesh : meshFinalizeQueue_) {
-            meshesToDelete[idx] = mesh;
-            ++idx;
-        }
-
+        std::vector<std::pair<MeshPtr, glm::mat4>> meshesToFinalize(meshFinalizeQueue_.begin(), meshFinalizeQueue_.end());
         meshFinalizeQueue_.clear();
 
-        // for (MeshPtr mesh : _meshFinalizeQueue) {
-        //     mesh->FinalizeData();
-        //     totalBytes += mesh->GetGpuSizeBytes();
-        //     meshesToDelete.push_back(mesh);
-        //     //if (totalBytes >= maxBytes) break;
-        // }
-
-        std::vector<Async<bool>> waiting;
-        const size_t numThreads = INSTANCE(TaskSystem)->Size();
-        for (size_t i = 0; i < numThreads; ++i) {
-            const size_t threadIndex = i;
-
-            const auto process = [this, threadIndex, numThreads, meshesToDelete]() {
-                STRATUS_LOG << "Processing " << meshesToDelete.size() << " as a task group" << std::endl;
-                for (size_t i = threadIndex; i < meshesToDelete.size(); i += numThreads) {
-                    MeshPtr mesh = meshesToDelete[i];
-                    mesh->PackCpuData();
-                    mesh->CalculateAabbs(glm::mat4(1.0f));
-                    mesh->GenerateLODs();
-                }
-
-                return new bool(true);
-            };
-
-           waiting.push_back(INSTANCE(TaskSystem)->ScheduleTask<bool>(process));
+        // One task per mesh so that a few expensive meshes don't hold up an entire thread's share
+        STRATUS_LOG << "Processing " << meshesToFinalize.size() << " as a task group" << std::endl;
+        TaskGraph graph;
+        for (const auto& entry : meshesToFinalize) {
+            MeshPtr mesh = entry.first;
+            graph.AddTask([mesh]() {
+                // Nothing to do for models, which are processed while loading
+                mesh->ProcessCpuData();
+            });
         }
 
-        const auto callback = [this, meshesToDelete](auto) {
-            for (auto mesh : meshesToDelete) {
-                generateMeshGpuDataQueue_.insert(mesh);
+        // The GPU data is generated on the application thread as the upload budget allows. Bounds are
+        // only known once the CPU data has been processed.
+        graph.OnComplete([this, meshesToFinalize]() {
+            for (const auto& entry : meshesToFinalize) {
+                MeshPtr mesh = entry.first;
+                const GpuAABB bounds = TransformAabb(Affine3x4::FromMat4(entry.second), mesh->GetProcessedAABB());
+                uploads_.Submit(bounds, mesh->GetUploadSizeBytes(), 0, [mesh]() {
+                    mesh->FinalizeData();
+                    return mesh->GetUploadSizeBytes();
+                });
             }
-        };
-
-        INSTANCE(TaskSystem)->AddTaskGroupCallback<bool>(callback, waiting);
-
-        // for (auto& wait : waiting) {
-        //    while (!wait.Completed())
-        //        ;
-        // }
-
-        // for (auto mesh : meshesToDelete) {
-        //    mesh->FinalizeData();
-        //    totalBytes += mesh->GetGpuSizeBytes();
-        // }
-
-        // for (MeshPtr mesh : meshesToDelete) _meshFinalizeQueue.erase(mesh);
+        });
 
-        //if (totalBytes > 0) STRATUS_LOG << "Processed " << totalBytes << " bytes of mesh data: " << meshesToDelete.size() << " meshes" << std::endl;
+        graph.Run();
     }
 
     void ResourceManager::ClearAsyncModelData_(EntityPtr ptr) {
@@ -200,8 +128,10 @@ namespace stratus {
         auto rnode = ptr->Components().GetComponent<RenderComponent>().component;
         if (rnode == nullptr) return;
 
+        auto global = ptr->Components().GetComponent<GlobalTransformComponent>().component;
+        const glm::mat4 transform = global != nullptr ? global->GetGlobalTransform() : glm::mat4(1.0f);
         for (int i = 0; i < rnode->meshes->meshes.size(); ++i) {
-            meshFinalizeQueue_.insert(rnode->meshes->meshes[i]);
+            meshFinalizeQueue_.insert(std::make_pair(rnode->meshes->meshes[i], transform * rnode->meshes->transforms[i]));
         }
     }
 
@@ -210,7 +140,8 @@ namespace stratus {
             auto sl = LockRead_();
             if (loadedModels_.find(name) != loadedModels_.end()) {
                 Async<Entity> e = loadedModels_.find(name)->second;
-                return (e.Completed() && !e.Failed()) ? Async<Entity>(e.GetPtr()->Copy()) : e;
+                // The prefab is always added before the load completes
+                return (e.Completed() && !e.Failed()) ? Async<Entity>(modelPrefabs_.find(name)->second->Instantiate()) : e;
             }
         }
 
@@ -225,8 +156,14 @@ namespace stratus {
         return e;
     }
 
-    TextureHandle ResourceManager::LoadTexture(const std::string& name, const ColorSpace& cspace) {
-        return LoadTextureImpl_({name}, cspace);
+    PrefabPtr ResourceManager::GetModelPrefab(const std::string& name) const {
+        auto sl = LockRead_();
+        auto it = modelPrefabs_.find(name);
+        return it != modelPrefabs_.end() ? it->second : nullptr;
+    }
+
+    TextureHandle ResourceManager::LoadTexture(const std::string& name, const ColorSpace& cspace, const TextureUsage usage, const int priority) {
+        return LoadTextureImpl_({name}, cspace, usage, priority);
     }
 
     TextureHandle ResourceManager::LoadCubeMap(const std::string& prefix, const ColorSpace& cspace, const std::string& fileExt) {
@@ -237,14 +174,34 @@ namespace stratus {
                                  prefix + "front." + fileExt,
                                  prefix + "back." + fileExt}, 
                                 cspace,
+                                TextureUsage::GENERIC,
+                                0,
                                 TextureType::TEXTURE_CUBE_MAP,
                                 TextureCoordinateWrapping::CLAMP_TO_EDGE,
                                 TextureMinificationFilter::LINEAR_MIPMAP_LINEAR,
                                 TextureMagnificationFilter::LINEAR);
     }
 
+    // Size of the decoded pixels going by the file headers. Files which can't be read count as nothing
+    // since they will fail as soon as they get decoded. Textures which get cooked are always decoded
+    // to RGBA, and this is an overestimate once they are in the cache.
+    static size_t EstimateDecodedBytes(const std::vector<std::string>& files, const TextureUsage usage) {
+        size_t bytes = 0;
+        for (std::string file : files) {
+            std::replace(file.begin(), file.end(), '\\', '/');
+            int width, height, numChannels;
+            if (stbi_info(file.c_str(), &width, &height, &numChannels)) {
+                if (usage != TextureUsage::GENERIC) numChannels = 4;
+                bytes += size_t(width) * size_t(height) * size_t(numChannels);
+            }
+        }
+        return bytes;
+    }
+
     TextureHandle ResourceManager::LoadTextureImpl_(const std::vector<std::string>& files, 
                                                     const ColorSpace& cspace,
+                                                    const TextureUsage usage,
+                                                    const int priority,
                                                     const TextureType type,
                                                     const TextureCoordinateWrapping wrap,
                                                     const TextureMinificationFilter min,
@@ -264,22 +221,116 @@ namespace stratus {
             }
         }
 
-        auto ul = LockWrite_();
-        auto handle = TextureHandle::NextHandle();
+        const size_t estimatedBytes = EstimateDecodedBytes(files, usage);
+
+        TextureHandle handle;
+        {
+            auto ul = LockWrite_();
+            // Someone else may have gotten here first while the headers were being read
+            auto it = loadedTexturesByFile_.find(name);
+            if (it != loadedTexturesByFile_.end()) return it->second;
+
+            handle = TextureHandle::NextHandle();
+            texturesStillLoading_.insert(handle);
+            loadedTexturesByFile_.insert(std::make_pair(name, handle));
+        }
+
+        // The decode can start right away from inside Submit so this can't hold mutex_
+        textureDecodes_.Submit(handle, estimatedBytes, priority, [this, files, handle, cspace, usage, priority, type, wrap, min, mag]() {
+            DecodeTexture_(files, handle, cspace, usage, priority, type, wrap, min, mag);
+        });
+
+        return handle;
+    }
+
+    void ResourceManager::DecodeTexture_(const std::vector<std::string>& files,
+                                         const TextureHandle handle,
+                                         const ColorSpace& cspace,
+                                         const TextureUsage usage,
+                                         const int priority,
+                                         const TextureType type,
+                                         const TextureCoordinateWrapping wrap,
+                                         const TextureMinificationFilter min,
+                                         const TextureMagnificationFilter mag) {
         TaskSystem * tasks = TaskSystem::Instance();
         // We have to use the main thread since Texture calls glGenTextures :(
-        Async<RawTextureData> as = tasks->ScheduleTask<RawTextureData>([this, files, handle, cspace, type, wrap, min, mag]() {
-            auto result = LoadTexture_(files, handle, cspace, type, wrap, min, mag);
-            //auto ul = this->LockWrite_();
-            //this->texturesStillLoading_.erase(handle);
-            return result;
+        Async<RawTextureData> as = tasks->ScheduleTask<RawTextureData>([this, files, handle, cspace, usage, type, wrap, min, mag]() {
+            return LoadTexture_(files, handle, cspace, usage, type, wrap, min, mag);
         });
 
-        texturesStillLoading_.insert(handle);
-        loadedTexturesByFile_.insert(std::make_pair(name, handle));
-        asyncLoadedTextureData_.insert(std::make_pair(handle, as));
+        // Rather than polling for completion each frame, the task thread which finishes decoding hands
+        // the data straight to the upload scheduler. The decoded bytes stay reserved in textureDecodes_
+        // until they have been freed.
+        as.OnComplete([this, handle, priority, as]() {
+            auto texdata = as.Failed() ? nullptr : as.GetPtr();
+
+            // Either the decode failed or there is no GL context to upload to - the texture will report as failed
+            if (texdata == nullptr || GraphicsDriver::IsHeadless()) {
+                if (texdata && texdata->cooked == nullptr) {
+                    for (uint8_t * ptr : texdata->data) {
+                        stbi_image_free((void *)ptr);
+                    }
+                }
+                {
+                    auto ul = LockWrite_();
+                    texturesStillLoading_.erase(handle);
+                }
+                texturesFinished_.fetch_add(1);
+                textureDecodes_.Release(handle);
+                return;
+            }
 
-        return handle;
+            // Keyed by handle so that PrioritizeTexture still works while it waits for upload
+            uploads_.Submit(texdata->sizeBytes, priority, [this, handle, texdata]() {
+                Texture * ptr = FinalizeTexture_(*texdata);
+                {
+                    auto ul = LockWrite_();
+                    texturesStillLoading_.erase(handle);
+                    loadedTextures_.insert(std::make_pair(handle, Async<Texture>(std::shared_ptr<Texture>(ptr))));
+                }
+                texturesFinished_.fetch_add(1);
+                textureDecodes_.Release(handle);
+                return texdata->sizeBytes;
+            }, handle.Integer());
+        });
+    }
+
+    void ResourceManager::PrioritizeTexture(const TextureHandle handle, const int priority) {
+        if (!textureDecodes_.Prioritize(handle, priority)) {
+            uploads_.Prioritize(handle.Integer(), priority);
+        }
+    }
+
+    void ResourceManager::SetTextureDecodeBudget(const size_t bytes) {
+        textureDecodes_.SetBudget(bytes);
+    }
+
+    size_t ResourceManager::GetTextureDecodeBudget() const {
+        return textureDecodes_.GetBudget();
+    }
+
+    TextureDecodeStatistics ResourceManager::GetTextureDecodeStatistics() const {
+        return textureDecodes_.GetStatistics();
+    }
+
+    void ResourceManager::SetUploadBudget(const GpuUploadBudget& budget) {
+        uploads_.SetBudget(budget);
+    }
+
+    GpuUploadBudget ResourceManager::GetUploadBudget() const {
+        return uploads_.GetBudget();
+    }
+
+    GpuUploadStatistics ResourceManager::GetUploadStatistics() const {
+        return uploads_.GetStatistics();
+    }
+
+    void ResourceManager::ChargeImmediateUpload(const size_t bytes) {
+        uploads_.ChargeImmediate(bytes);
+    }
+
+    uint64_t ResourceManager::GetNumTexturesFinished() const {
+        return texturesFinished_.load();
     }
 
     Texture ResourceManager::LookupTexture(const TextureHandle handle, TextureLoadingStatus& status) const {
@@ -300,13 +351,22 @@ namespace stratus {
         return loadedTextures_.find(handle)->second.Get();
     }
 
-    static TextureHandle LoadMaterialTexture(aiMaterial * mat, const aiTextureType& type, const std::string& directory, const ColorSpace& cspace) {
+    // Bump whenever the import code below changes what ends up in a cooked model
+    static constexpr uint64_t ImporterVersion_ = 1;
+
+    static std::string MaterialTextureFile(const aiMaterial * mat, const aiTextureType& type, const std::string& directory) {
+        if (mat->GetTextureCount(type) == 0) return std::string();
+
+        aiString str;
+        mat->GetTexture(type, 0, &str);
+        std::string file = str.C_Str();
+        return directory + "/" + file;
+    }
+
+    static TextureHandle LoadMaterialTexture(const std::string& file, const ColorSpace& cspace, const TextureUsage usage) {
         TextureHandle texture;
-        if (mat->GetTextureCount(type) > 0) {
-            aiString str; 
-            mat->GetTexture(type, 0, &str);
-            std::string file = str.C_Str();
-            texture = ResourceManager::Instance()->LoadTexture(directory + "/" + file, cspace);
+        if (file.size() > 0) {
+            texture = ResourceManager::Instance()->LoadTexture(file, cspace, usage);
         }
 
         return texture;
@@ -348,38 +408,11 @@ namespace stratus {
         STRATUS_LOG << out.str();
     }
 
-    struct MeshToProcess_ {
-        aiMesh * aim;
-        MeshPtr mesh;
-        MaterialPtr material;
-    };
-
-    //static void ProcessMesh(
-    //    RenderComponent * renderNode, 
-    //    const aiMatrix4x4& transform, 
-    //    aiMesh * mesh, 
-    //    const aiScene * scene, 
-    //    MaterialPtr rootMat, 
-    //    const std::string& directory, 
-    //    const std::string& extension, 
-    //    RenderFaceCulling defaultCullMode, 
-    //    const ColorSpace& cspace) {
-    static void ProcessMesh(
-        MeshToProcess_& processMesh,
-        const aiScene * scene, 
-        const std::string& directory, 
-        const std::string& extension, 
-        RenderFaceCulling defaultCullMode, 
-        const ColorSpace& cspace) {
-        
+    static void ProcessMesh(aiMesh * mesh, const aiScene * scene, MeshPtr rmesh, RenderFaceCulling defaultCullMode) {
         //if (mesh->mNumUVComponents[0] == 0) return;
         //if (mesh->mNormals == nullptr || mesh->mTangents == nullptr || mesh->mBitangents == nullptr) return;
         //if (mesh->mNormals == nullptr) return;
 
-        //MeshPtr rmesh = Mesh::Create();
-        aiMesh * mesh = processMesh.aim;
-        MeshPtr rmesh = processMesh.mesh;
-
         // Process core primitive data
         for (uint32_t i = 0; i < mesh->mNumVertices; i++) {
             rmesh->AddVertex(glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z));
@@ -404,10 +437,6 @@ namespace stratus {
             }
         }
 
-        // Process material
-        //MaterialPtr m = rootMat->CreateSubMaterial();
-        MaterialPtr m = processMesh.material;
-
         RenderFaceCulling cull = defaultCullMode;
         if (mesh->mMaterialIndex >= 0) {
             aiMaterial * aimat = scene->mMaterials[mesh->mMaterialIndex];
@@ -422,147 +451,104 @@ namespace stratus {
             }
         }
 
-        // const glm::mat4 gt = ToMat4(transform);
-        // renderNode->meshes->meshes.push_back(rmesh);
-        // renderNode->meshes->transforms.push_back(gt);
-        // renderNode->AddMaterial(m);
         rmesh->SetFaceCulling(cull);
     }
 
-    static void ProcessMaterial(
-        const aiScene* scene,
-        const aiMesh* mesh,
-        MaterialPtr material,
-        const std::string& directory,
-        const std::string& extension,
-        const ColorSpace& cspace) {
+    // Reads everything the engine uses from an Assimp material. Textures are only recorded here and get
+    // loaded by ApplyMaterial.
+    static CookedMaterial DescribeMaterial(const aiMaterial * aimat, const std::string& directory, const std::string& extension) {
+        CookedMaterial material;
+
+        // PrintMatType(aimat, aiTextureType_DIFFUSE);
+        // PrintMatType(aimat, aiTextureType_SPECULAR);
+        // PrintMatType(aimat, aiTextureType_AMBIENT);
+        // PrintMatType(aimat, aiTextureType_EMISSIVE);
+        // PrintMatType(aimat, aiTextureType_HEIGHT);
+        // PrintMatType(aimat, aiTextureType_NORMALS);
+        // PrintMatType(aimat, aiTextureType_OPACITY);
+        // PrintMatType(aimat, aiTextureType_BASE_COLOR);
+        // PrintMatType(aimat, aiTextureType_METALNESS);
+        // PrintMatType(aimat, aiTextureType_UNKNOWN);
+
+        aiColor4D diffuse;
+        aiColor4D reflective;
+        aiColor4D emissive;
+        float metallic;
+        float roughness;
+        float specularFactor;
+        unsigned int max = 1;
+
+        if (aiGetMaterialFloat(aimat, AI_MATKEY_METALLIC_FACTOR, &metallic) == AI_SUCCESS) {
+            material.flags |= CookedMaterial::HAS_METALLIC;
+            material.metallic = metallic;
+        }
+        if (aiGetMaterialFloat(aimat, AI_MATKEY_ROUGHNESS_FACTOR, &roughness) == AI_SUCCESS) {
+            material.flags |= CookedMaterial::HAS_ROUGHNESS;
+            material.roughness = roughness;
+        }
 
-        if (mesh->mMaterialIndex >= 0) {
-            aiMaterial* aimat = scene->mMaterials[mesh->mMaterialIndex];
-
-            aiString matName;
-            aimat->Get<aiString>(AI_MATKEY_NAME, matName);
-            STRATUS_LOG << "Loading Mesh Material [" << material->GetName() << "]" << std::endl;
-            // PrintMatType(aimat, aiTextureType_DIFFUSE);
-            // PrintMatType(aimat, aiTextureType_SPECULAR);
-            // PrintMatType(aimat, aiTextureType_AMBIENT);
-            // PrintMatType(aimat, aiTextureType_EMISSIVE);
-            // PrintMatType(aimat, aiTextureType_HEIGHT);
-            // PrintMatType(aimat, aiTextureType_NORMALS);
-            // PrintMatType(aimat, aiTextureType_OPACITY);
-            // PrintMatType(aimat, aiTextureType_BASE_COLOR);
-            // PrintMatType(aimat, aiTextureType_NORMAL_CAMERA);
-            // PrintMatType(aimat, aiTextureType_EMISSION_COLOR);
-            // PrintMatType(aimat, aiTextureType_METALNESS);
-            // PrintMatType(aimat, aiTextureType_AMBIENT_OCCLUSION);
-            // PrintMatType(aimat, aiTextureType_DIFFUSE_ROUGHNESS);
-            // PrintMatType(aimat, aiTextureType_SHEEN);
-            // PrintMatType(aimat, aiTextureType_CLEARCOAT);
-            // PrintMatType(aimat, aiTextureType_TRANSMISSION);
-            // PrintMatType(aimat, aiTextureType_UNKNOWN);
-
-            aiColor4D diffuse;
-            aiColor4D reflective;
-            aiColor4D specular;
-            aiColor4D emissive;
-            float metallic;
-            float roughness;
-            float opacity;
-            float specularFactor;
-            unsigned int max = 1;
-            aiColor4D transparency;
-
-            if (aiGetMaterialFloat(aimat, AI_MATKEY_METALLIC_FACTOR, &metallic) == AI_SUCCESS) {
-                material->SetMetallic(metallic);
-                //STRATUS_LOG << "M: " << metallic << std::endl;
-            }
-            if (aiGetMaterialFloat(aimat, AI_MATKEY_ROUGHNESS_FACTOR, &roughness) == AI_SUCCESS) {
-                material->SetRoughness(roughness);
-            }
+        if (aiGetMaterialColor(aimat, AI_MATKEY_COLOR_DIFFUSE, &diffuse) == AI_SUCCESS) {
+            material.flags |= CookedMaterial::HAS_DIFFUSE;
+            material.diffuseColor = glm::vec4(diffuse.r, diffuse.g, diffuse.b, std::clamp(diffuse.a, 0.0f, 1.0f));
+        }
+        if (aiGetMaterialColor(aimat, AI_MATKEY_COLOR_EMISSIVE, &emissive) == AI_SUCCESS) {
+            material.emissiveColor = glm::vec3(emissive.r, emissive.g, emissive.b);
+        }
+        if (aiGetMaterialColor(aimat, AI_MATKEY_COLOR_REFLECTIVE, &reflective) == AI_SUCCESS) {
+            material.flags |= CookedMaterial::HAS_REFLECTANCE;
+            material.reflectance = std::max<float>(reflective.r, std::max<float>(reflective.g, reflective.b));
+        }
+        else if (aiGetMaterialFloatArray(aimat, AI_MATKEY_REFRACTI, &specularFactor, &max) == AI_SUCCESS) {
+            float reflectance = (specularFactor - 1.0) / (specularFactor + 1.0);
+            material.flags |= CookedMaterial::HAS_REFLECTANCE;
+            material.reflectance = reflectance * reflectance;
+        }
 
-            if (aiGetMaterialColor(aimat, AI_MATKEY_COLOR_DIFFUSE, &diffuse) == AI_SUCCESS) {
-                material->SetDiffuseColor(glm::vec4(diffuse.r, diffuse.g, diffuse.b, std::clamp(diffuse.a, 0.0f, 1.0f)));
-            }
-            if (aiGetMaterialColor(aimat, AI_MATKEY_COLOR_EMISSIVE, &emissive) == AI_SUCCESS) {
-                material->SetEmissiveColor(glm::vec3(emissive.r, emissive.g, emissive.b));
-            }
-            else {
-                material->SetEmissiveColor(glm::vec3(0.0f));
-            }
-            if (aiGetMaterialColor(aimat, AI_MATKEY_COLOR_REFLECTIVE, &reflective) == AI_SUCCESS) {
-                material->SetReflectance(std::max<float>(reflective.r, std::max<float>(reflective.g, reflective.b)));
-                //material->SetBaseReflectivity(glm::vec3(reflective.r, reflective.g, reflective.b));
-                //material->SetMaxReflectivity(glm::vec3(reflective.r, reflective.g, reflective.b));
-                //STRATUS_LOG << "RF: " << reflective.r << " " << reflective.g << " " << reflective.b << std::endl;
-            }
-            //else if (aiGetMaterialColor(aimat, AI_MATKEY_BASE_COLOR, &reflective) == AI_SUCCESS) {
-            //    m->SetBaseReflectivity(glm::vec3(reflective.r, reflective.g, reflective.b));
-            //    STRATUS_LOG << "RF: " << reflective.r << " " << reflective.g << " " << reflective.b << std::endl;
-            //}
-            else if (aiGetMaterialFloatArray(aimat, AI_MATKEY_REFRACTI, &specularFactor, &max) == AI_SUCCESS) {
-                //STRATUS_LOG << "SP: " << specularFactor << " " << max << std::endl;
-                float reflectance = (specularFactor - 1.0) / (specularFactor + 1.0);
-                reflectance = reflectance * reflectance;
-                material->SetReflectance(reflectance);
-                //material->SetBaseReflectivity(glm::vec3(reflectance));
-                //material->SetMaxReflectivity(glm::vec3(reflectance));
-                //STRATUS_LOG << "Reflectance: " << reflectance << std::endl;
-            }
-            if (aiGetMaterialFloat(aimat, AI_MATKEY_GLOSSINESS_FACTOR, &specularFactor) == AI_SUCCESS) {
-                // STRATUS_LOG << "G: " << specularFactor << std::endl;
-            }
+        material.diffuseMap = MaterialTextureFile(aimat, aiTextureType_DIFFUSE, directory);
+        material.normalMap = MaterialTextureFile(aimat, aiTextureType_NORMALS, directory);
+        material.roughnessMap = MaterialTextureFile(aimat, aiTextureType_DIFFUSE_ROUGHNESS, directory);
+        material.emissiveMap = MaterialTextureFile(aimat, aiTextureType_EMISSIVE, directory);
+        material.metallicMap = MaterialTextureFile(aimat, aiTextureType_METALNESS, directory);
+        // GLTF 2.0 have the metallic-roughness map specified as aiTextureType_UNKNOWN at the time of writing
+        // TODO: See if other file types encode metallic-roughness in the same way
+        if (extension == "gltf" || extension == "GLTF") {
+            material.metallicRoughnessMap = MaterialTextureFile(aimat, aiTextureType_UNKNOWN, directory);
+        }
 
-            // STRATUS_LOG << "RMS: " << roughness << " " << metallic << " " << specularFactor << " " << diffuse.r << " " << diffuse.g << " " << diffuse.b << std::endl;
+        return material;
+    }
 
-            //     STRATUS_LOG << "Opacity Value: " << opacity << std::endl;
-            // }
-            // if (aiGetMaterialColor(aimat, AI_MATKEY_COLOR_TRANSPARENT, &transparency) == AI_SUCCESS) {
-            //     STRATUS_LOG << "Transparency: " << transparency.r << ", " << transparency.g << ", " << transparency.b << ", " << transparency.a << std::endl;
-            // }
+    static void ApplyMaterial(const CookedMaterial& cooked, MaterialPtr material, const ColorSpace& cspace) {
+        STRATUS_LOG << "Loading Mesh Material [" << material->GetName() << "]" << std::endl;
 
-            material->SetDiffuseMap(LoadMaterialTexture(aimat, aiTextureType_DIFFUSE, directory, cspace));
-            // Important: Unless the normal/depth maps were generated as sRGB textures, srgb must be set to false!
-            auto normalMap = LoadMaterialTexture(aimat, aiTextureType_NORMALS, directory, ColorSpace::NONE);
-            if (normalMap != TextureHandle::Null()) {
-                material->SetNormalMap(normalMap);
-            }
-            //else {
-                //m->SetNormalMap(LoadMaterialTexture(aimat, aiTextureType_HEIGHT, directory, ColorSpace::LINEAR));
-            //}
-            //m->SetDepthMap(LoadMaterialTexture(aimat, aiTextureType_HEIGHT, directory, ColorSpace::LINEAR));
-            material->SetRoughnessMap(LoadMaterialTexture(aimat, aiTextureType_DIFFUSE_ROUGHNESS, directory, ColorSpace::NONE));
-            material->SetEmissiveMap(LoadMaterialTexture(aimat, aiTextureType_EMISSIVE, directory, ColorSpace::NONE));
-            material->SetMetallicMap(LoadMaterialTexture(aimat, aiTextureType_METALNESS, directory, ColorSpace::NONE));
-            // GLTF 2.0 have the metallic-roughness map specified as aiTextureType_UNKNOWN at the time of writing
-            // TODO: See if other file types encode metallic-roughness in the same way
-            if (extension == "gltf" || extension == "GLTF") {
-                material->SetMetallicRoughnessMap(LoadMaterialTexture(aimat, aiTextureType_UNKNOWN, directory, ColorSpace::NONE));
-            }
+        if (cooked.flags & CookedMaterial::HAS_METALLIC) material->SetMetallic(cooked.metallic);
+        if (cooked.flags & CookedMaterial::HAS_ROUGHNESS) material->SetRoughness(cooked.roughness);
+        if (cooked.flags & CookedMaterial::HAS_DIFFUSE) material->SetDiffuseColor(cooked.diffuseColor);
+        if (cooked.flags & CookedMaterial::HAS_REFLECTANCE) material->SetReflectance(cooked.reflectance);
+        material->SetEmissiveColor(cooked.emissiveColor);
 
-            // STRATUS_LOG << "m " 
-            //     << m->GetDiffuseMap() << " "
-            //     << m->GetNormalMap() << " "
-            //     << m->GetDepthMap() << " "
-            //     << m->GetRoughnessMap() << " "
-            //     << m->GetAmbientTexture() << " "
-            //     << m->GetMetallicMap() << " "
-            //     << m->GetMetallicRoughnessMap() << std::endl;
+        material->SetDiffuseMap(LoadMaterialTexture(cooked.diffuseMap, cspace, TextureUsage::COLOR));
+        // Important: Unless the normal/depth maps were generated as sRGB textures, srgb must be set to false!
+        auto normalMap = LoadMaterialTexture(cooked.normalMap, ColorSpace::NONE, TextureUsage::NORMAL_MAP);
+        if (normalMap != TextureHandle::Null()) {
+            material->SetNormalMap(normalMap);
+        }
+        material->SetRoughnessMap(LoadMaterialTexture(cooked.roughnessMap, ColorSpace::NONE, TextureUsage::SINGLE_CHANNEL));
+        material->SetEmissiveMap(LoadMaterialTexture(cooked.emissiveMap, ColorSpace::NONE, TextureUsage::COLOR));
+        material->SetMetallicMap(LoadMaterialTexture(cooked.metallicMap, ColorSpace::NONE, TextureUsage::SINGLE_CHANNEL));
+        if (cooked.metallicRoughnessMap.size() > 0) {
+            material->SetMetallicRoughnessMap(LoadMaterialTexture(cooked.metallicRoughnessMap, ColorSpace::NONE, TextureUsage::COLOR));
         }
-
     }
 
-
+    // Flattens the node tree into model.nodes and creates an empty Mesh for every aiMesh that will be used
     static void ProcessNode(
         aiNode * node, 
         const aiScene * scene, 
-        EntityPtr entity, 
+        const int32_t parent,
         const aiMatrix4x4& parentTransform, 
-        const std::string& name,
-        const std::string& directory, 
-        const std::string& extension, 
-        RenderFaceCulling defaultCullMode, 
-        const ColorSpace& cspace,
-        std::vector<MeshToProcess_>& meshes) {
+        CookedModel& model,
+        std::vector<aiMesh *>& sourceMeshes) {
 
         // set the transformation info
         aiMatrix4x4 aiMatTransform = node->mTransformation;
@@ -570,35 +556,15 @@ namespace stratus {
         // ASSIMP uses row-major convention
         auto transform = parentTransform * aiMatTransform;// * parentTransform;
 
+        const int32_t index = int32_t(model.nodes.size());
+        model.nodes.push_back(CookedNode{parent, node->mNumMeshes > 0, {}});
+
         if (node->mNumMeshes > 0) {
-            InitializeRenderEntity(entity);
-            auto rnode = entity->Components().GetComponent<RenderComponent>().component;
             auto gt = ToMat4(transform);
 
             // Process all node meshes (if any)
             for (uint32_t i = 0; i < node->mNumMeshes; ++i) {
                 aiMesh * mesh = scene->mMeshes[node->mMeshes[i]];
-                // aiMaterial* aimat = scene->mMaterials[mesh->mMaterialIndex];
-                // STRATUS_LOG << "Material Idx / Num Properties " << mesh->mMaterialIndex << " / " << aimat->mNumProperties << std::endl;
-                // std::vector<float> values(4);
-                // for (int i = 0; i < aimat->mNumProperties; ++i) {
-                //     STRATUS_LOG << aimat->mProperties[i]->mKey.C_Str() << " " << aimat->mProperties[i]->mDataLength << std::endl;
-                // }
-                // aiColor4D emissive;
-                // float metallic;
-                // float roughness;
-                // unsigned int max = 4;
-                // float refracti;
-                // aiGetMaterialFloatArray(aimat, AI_MATKEY_SHININESS, values.data(), &max);
-                // aiGetMaterialColor(aimat, AI_MATKEY_COLOR_EMISSIVE, &emissive);
-                // aiGetMaterialFloat(aimat, AI_MATKEY_METALLIC_FACTOR, &metallic);
-                // aiGetMaterialFloat(aimat, AI_MATKEY_ROUGHNESS_FACTOR, &roughness);
-
-                // aiGetMaterialFloatArray(aimat, AI_MATKEY_REFRACTI, &refracti, &max);
-
-                // STRATUS_LOG << "RMS: " << roughness << " " << metallic << " " << values[0] << " " << max << std::endl;
-                // STRATUS_LOG << "E: " << emissive.r << " " << emissive.g << " " << emissive.b << std::endl;
-                // STRATUS_LOG << "RF: " << refracti << std::endl;
 
                 //if (mesh->mNormals == nullptr || mesh->mTangents == nullptr || mesh->mBitangents == nullptr) continue;
                 if (mesh->mNormals == nullptr) continue;
@@ -615,41 +581,92 @@ namespace stratus {
                 else {
                     if (mesh->mNumVertices % 3 != 0) continue;
                 }
-                
-                auto stratusMesh = Mesh::Create();
-                
-                const std::string materialName = name + "#" + std::to_string(mesh->mMaterialIndex);
-                MaterialPtr m = INSTANCE(MaterialManager)->GetMaterial(materialName);
-                ProcessMaterial(scene, mesh, m, directory, extension, cspace);
-
-                rnode->meshes->meshes.push_back(stratusMesh);
-                rnode->meshes->transforms.push_back(gt);
-                rnode->AddMaterial(m);
-                MeshToProcess_ meshToProcess;
-                meshToProcess.aim = mesh;
-                meshToProcess.mesh = stratusMesh;
-                meshToProcess.material = m;
-                meshes.push_back(meshToProcess);
-                //ProcessMesh(rnode, transform, mesh, scene, rootMat, directory, extension, defaultCullMode, cspace);
+
+                model.nodes[index].meshes.push_back(CookedNodeMesh{uint32_t(model.meshes.size()), mesh->mMaterialIndex, gt});
+                model.meshes.push_back(Mesh::Create());
+                sourceMeshes.push_back(mesh);
             }
         }
 
         // Now do the same for each child
         for (uint32_t i = 0; i < node->mNumChildren; ++i) {
-            // Create a new container Entity
-            EntityPtr centity = CreateTransformEntity();
-            entity->AttachChildNode(centity);
-            ProcessNode(node->mChildren[i], scene, centity, transform, name, directory, extension, defaultCullMode, cspace, meshes);
+            ProcessNode(node->mChildren[i], scene, index, transform, model, sourceMeshes);
         }
     }
 
-    EntityPtr ResourceManager::LoadModel_(const std::string& name, const ColorSpace& cspace, const bool optimizeGraph, RenderFaceCulling defaultCullMode) {
-        STRATUS_LOG << "Attempting to load model: " << name << std::endl;
-
+    static bool ImportModel(const std::string& name, const unsigned int pflags, RenderFaceCulling defaultCullMode, CookedModel& model) {
         Assimp::Importer importer;
         //importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, 16000);
         importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, 4096);
 
+        //const aiScene *scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_GenUVCoords);
+        //const aiScene *scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_OptimizeMeshes);
+        const aiScene *scene = importer.ReadFile(name, pflags);
+
+        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+            STRATUS_ERROR << "Error loading model: " << name << std::endl << importer.GetErrorString() << std::endl;
+            return false;
+        }
+
+        const std::string extension = name.substr(name.find_last_of('.') + 1, name.size());
+        const std::string directory = name.substr(0, name.find_last_of('/'));
+
+        model.materials.reserve(scene->mNumMaterials);
+        for (uint32_t i = 0; i < scene->mNumMaterials; ++i) {
+            model.materials.push_back(DescribeMaterial(scene->mMaterials[i], directory, extension));
+        }
+
+        std::vector<aiMesh *> sourceMeshes;
+        ProcessNode(scene->mRootNode, scene, -1, aiMatrix4x4(), model, sourceMeshes);
+
+        // Meshes vary a lot in cost so let each thread claim them one at a time. This thread helps
+        // out rather than waiting idle. Everything up to the GPU upload is done here so that it
+        // ends up in the cooked file.
+        INSTANCE(TaskSystem)->ParallelFor(0, sourceMeshes.size(), 1, [&](const size_t i) {
+            ProcessMesh(sourceMeshes[i], scene, model.meshes[i], defaultCullMode);
+            model.meshes[i]->ProcessCpuData();
+        });
+
+        return true;
+    }
+
+    // Creates the entities and materials for a model. Meshes are handed to the entities as-is.
+    static EntityPtr BuildModel(const std::string& name, const CookedModel& model, const ColorSpace& cspace) {
+        // Create all scene materials
+        std::vector<MaterialPtr> materials(model.materials.size());
+        for (size_t i = 0; i < model.materials.size(); ++i) {
+            const std::string materialName = name + "#" + std::to_string(i);
+            materials[i] = INSTANCE(MaterialManager)->CreateMaterial(materialName);
+        }
+
+        // Materials nothing uses don't load their textures
+        std::vector<bool> applied(materials.size(), false);
+        std::vector<EntityPtr> entities(model.nodes.size());
+        for (size_t n = 0; n < model.nodes.size(); ++n) {
+            const CookedNode& node = model.nodes[n];
+            entities[n] = CreateTransformEntity();
+            if (node.parent >= 0) entities[node.parent]->AttachChildNode(entities[n]);
+            if (!node.renderable) continue;
+
+            InitializeRenderEntity(entities[n]);
+            auto rnode = entities[n]->Components().GetComponent<RenderComponent>().component;
+            for (const CookedNodeMesh& mesh : node.meshes) {
+                rnode->meshes->meshes.push_back(model.meshes[mesh.mesh]);
+                rnode->meshes->transforms.push_back(mesh.transform);
+                rnode->AddMaterial(materials[mesh.material]);
+                if (!applied[mesh.material]) {
+                    ApplyMaterial(model.materials[mesh.material], materials[mesh.material], cspace);
+                    applied[mesh.material] = true;
+                }
+            }
+        }
+
+        return entities[0];
+    }
+
+    EntityPtr ResourceManager::LoadModel_(const std::string& name, const ColorSpace& cspace, const bool optimizeGraph, RenderFaceCulling defaultCullMode) {
+        STRATUS_LOG << "Attempting to load model: " << name << std::endl;
+
         unsigned int pflags = aiProcess_Triangulate |
             aiProcess_JoinIdenticalVertices |
             aiProcess_SortByPType |
@@ -674,74 +691,82 @@ namespace stratus {
             pflags |= aiProcess_OptimizeGraph;
         }
 
-        //const aiScene *scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_GenUVCoords);
-        //const aiScene *scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_OptimizeMeshes);
-        const aiScene *scene = importer.ReadFile(name, pflags);
+        // Color space isn't part of the key since textures are loaded from their source files either way
+        const uint64_t importKey = (uint64_t(pflags) << 32) | (ImporterVersion_ << 8) | uint64_t(defaultCullMode);
 
-        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            STRATUS_ERROR << "Error loading model: " << name << std::endl << importer.GetErrorString() << std::endl;
-            return nullptr;
+        CookedModel model;
+        MeshCacheStamp stamp;
+        const std::string cookedFile = MeshCache::GetStamp(name, stamp) ? MeshCache::CookedPath(name, importKey) : std::string();
+        // Cooked meshes stay mapped and are uploaded straight from the file
+        if (cookedFile.size() > 0 && MeshCache::Read(cookedFile, stamp, importKey, model, true)) {
+            STRATUS_LOG << "Using cooked model: " << cookedFile << std::endl;
         }
+        else {
+            std::error_code error;
+            if (cookedFile.size() > 0 && std::filesystem::exists(cookedFile, error)) {
+                STRATUS_WARN << "Ignoring stale or corrupt cooked model: " << cookedFile << std::endl;
+            }
 
-        // Create all scene materials
-        for (uint32_t i = 0; i < scene->mNumMaterials; ++i) {
-            const std::string materialName = name + "#" + std::to_string(i);
-            auto material = INSTANCE(MaterialManager)->CreateMaterial(materialName);
-        }
+            if (!ImportModel(name, pflags, defaultCullMode, model)) {
+                return nullptr;
+            }
 
-        EntityPtr e = CreateTransformEntity();
-        std::vector<MeshToProcess_> meshes;
-        const std::string extension = name.substr(name.find_last_of('.') + 1, name.size());
-        const std::string directory = name.substr(0, name.find_last_of('/'));
-        ProcessNode(scene->mRootNode, scene, e, aiMatrix4x4(), name, directory, extension, defaultCullMode, cspace, meshes);
-
-        //for (auto& mesh : meshes) {
-        //    ProcessMesh(mesh, scene, directory, extension, defaultCullMode, cspace);
-        //}
-
-        std::vector<Async<void>> waiting;
-        // There are cases where the number of meshes to process is less than the total available threads,
-        // so in that case just use meshes.size() as the upper limit
-        const size_t numThreads = std::min(INSTANCE(TaskSystem)->Size(), meshes.size());
-        std::atomic<size_t> counter = 0;
-        // Important we start at 1 since we are including this current task thread already
-        for (size_t i = 1; i < numThreads; ++i) {
-            const size_t threadNum = i;
-            const auto process = [&counter, &meshes, threadNum, numThreads, scene, &directory, &extension, &defaultCullMode, &cspace]() {
-                size_t processed = 0;
-                for (size_t idx = threadNum; idx < meshes.size(); idx += numThreads, ++processed) {
-                    ProcessMesh(meshes[idx], scene, directory, extension, defaultCullMode, cspace);
-                }
+            if (cookedFile.size() > 0 && !MeshCache::Write(cookedFile, stamp, importKey, model)) {
+                STRATUS_WARN << "Unable to cache model: " << name << std::endl;
+            }
+        }
 
-                counter += processed;
-            };
+        EntityPtr e = BuildModel(name, model, cspace);
+        const size_t numMeshes = model.meshes.size();
+        // The entities own the meshes now
+        model.meshes.clear();
 
-            waiting.push_back(INSTANCE(TaskSystem)->ScheduleTask(process));
+        // Every instance (including this first one) comes from the prefab so none of them share components
+        // with the copy we keep
+        auto prefab = Prefab::Create(e);
+        {
+            auto ul = LockWrite_();
+            modelPrefabs_.insert(std::make_pair(name, prefab));
         }
 
-        // Now process our portion
-        size_t processed = 0;
-        for (size_t i = 0; i < meshes.size(); i += numThreads, ++processed) {
-            ProcessMesh(meshes[i], scene, directory, extension, defaultCullMode, cspace);
-        }
+        STRATUS_LOG << "Model loaded [" << name << "] with [" << numMeshes << "] meshes" << std::endl;
 
-        counter += processed;
+        return prefab->Instantiate();
+    }
 
-        while (counter.load() < meshes.size())
-            ;
+    // Reads the cooked version of file, cooking it first if it isn't in the cache yet. Returns nullptr if
+    // the cache is turned off or the file can't be loaded.
+    static std::shared_ptr<CookedTexture> LoadCookedTexture(const std::string& file, const TextureUsage usage, const bool srgb) {
+        uint64_t sourceHash;
+        if (TextureCache::GetDirectory().empty() || !TextureCache::HashSource(file, sourceHash)) return nullptr;
+
+        const uint64_t cookKey = TextureCache::CookKey(usage, srgb);
+        const std::string cookedFile = TextureCache::CookedPath(file, sourceHash, cookKey);
+        auto cooked = std::make_shared<CookedTexture>();
+        if (TextureCache::Read(cookedFile, sourceHash, cookKey, *cooked)) {
+            STRATUS_LOG << "Loaded cooked texture: " << cookedFile << std::endl;
+            return cooked;
+        }
 
-        auto ul = LockWrite_();
-        // Create an internal copy for thread safety
-        loadedModels_.insert(std::make_pair(name, Async<Entity>(e->Copy())));
+        int width, height, numChannels;
+        uint8_t * data = stbi_load(file.c_str(), &width, &height, &numChannels, 4);
+        if (data == nullptr) return nullptr;
 
-        STRATUS_LOG << "Model loaded [" << name << "] with [" << meshes.size() << "] meshes" << std::endl;
+        const bool success = TextureCache::Cook(data, uint32_t(width), uint32_t(height), usage, srgb, *cooked);
+        stbi_image_free((void *)data);
+        if (!success) return nullptr;
 
-        return e->Copy();
+        STRATUS_LOG << "Cooked texture " << file << " into " << cookedFile << std::endl;
+        if (!TextureCache::Write(cookedFile, sourceHash, cookKey, *cooked)) {
+            STRATUS_WARN << "Unable to cache texture: " << file << std::endl;
+        }
+        return cooked;
     }
 
     std::shared_ptr<ResourceManager::RawTextureData> ResourceManager::LoadTexture_(const std::vector<std::string>& files, 
                                                                                    const TextureHandle handle, 
                                                                                    const ColorSpace& cspace,
+                                                                                   const TextureUsage usage,
                                                                                    const TextureType type,
                                                                                    const TextureCoordinateWrapping wrap,
                                                                                    const TextureMinificationFilter min,
@@ -751,6 +776,36 @@ namespace stratus {
         texdata->min = min;
         texdata->mag = mag;
 
+        // Cube maps aren't cooked since the faces would all need to share one format
+        if (usage != TextureUsage::GENERIC && type == TextureType::TEXTURE_2D && files.size() == 1) {
+            std::string file = files[0];
+            std::replace(file.begin(), file.end(), '\\', '/');
+            auto cooked = LoadCookedTexture(file, usage, cspace == ColorSpace::SRGB);
+            if (cooked != nullptr) {
+                TextureConfig config;
+                config.type = type;
+                config.format = cooked->format;
+                config.storage = TextureComponentSize::BITS_DEFAULT;
+                config.dataType = TextureComponentType::UINT;
+                config.width = cooked->width;
+                config.height = cooked->height;
+                config.depth = 0;
+                config.generateMipMaps = false;
+                config.mipLevels = uint32_t(cooked->levels.size());
+
+                texdata->config = config;
+                texdata->handle = handle;
+                texdata->sizeBytes = 0;
+                for (auto& level : cooked->levels) {
+                    texdata->sizeBytes += level.size();
+                    texdata->data.push_back(level.data());
+                }
+                texdata->cooked = std::move(cooked);
+                return texdata;
+            }
+            // Otherwise it gets loaded as it is below
+        }
+
         #define FREE_ALL_STBI_IMAGE_DATA for (uint8_t * ptr : texdata->data) stbi_image_free((void *)ptr);
 
         for (const std::string& fileOrig : files) {
@@ -845,19 +900,22 @@ namespace stratus {
         texture->SetCoordinateWrapping(data.wrap);
         texture->SetMinMagFilter(data.min, data.mag);
         
-        for (uint8_t * ptr : data.data) {
-            stbi_image_free((void *)ptr);
+        // Cooked levels are freed along with data
+        if (data.cooked == nullptr) {
+            for (uint8_t * ptr : data.data) {
+                stbi_image_free((void *)ptr);
+            }
         }
         
         return texture;
     }
 
     EntityPtr ResourceManager::CreateCube() {
-        return cube_->Copy();
+        return cubePrefab_->Instantiate();
     }
 
     EntityPtr ResourceManager::CreateQuad() {
-        return quad_->Copy();
+        return quadPrefab_->Instantiate();
     }
 
     static const std::vector<GLfloat> cubeData = std::vector<GLfloat>{
@@ -938,6 +996,7 @@ namespace stratus {
 
         mesh->CalculateAabbs(glm::mat4(1.0f));
         pendingFinalize_.insert(std::make_pair("DefaultCube", Async<Entity>(cube_)));
+        cubePrefab_ = Prefab::Create(cube_);
 
         // rmesh->GenerateCpuData();
         // rnode->AddMeshContainer(RenderMeshContainer{rmesh, mat});
@@ -969,6 +1028,7 @@ namespace stratus {
         mesh->SetFaceCulling(RenderFaceCulling::CULLING_NONE);
         mesh->CalculateAabbs(glm::mat4(1.0f));
         pendingFinalize_.insert(std::make_pair("DefaultQuad", Async<Entity>(quad_)));
+        quadPrefab_ = Prefab::Create(quad_);
 
         // rmesh->GenerateCpuData();
         // rnode->AddMeshContainer(RenderMeshContainer{rmesh, mat});
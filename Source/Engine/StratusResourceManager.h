@@ -9,6 +9,11 @@
 #include "StratusTexture.h"
 #include "StratusSystemModule.h"
 #include "StratusAsync.h"
+#include "StratusPrefab.h"
+#include "StratusTextureDecodeQueue.h"
+#include "StratusTextureCache.h"
+#include "StratusGpuUploadScheduler.h"
+#include <atomic>
 #include <vector>
 #include <shared_mutex>
 #include <unordered_map>
@@ -35,6 +40,8 @@ namespace stratus {
             TextureMagnificationFilter mag;
             size_t sizeBytes;
             std::vector<uint8_t *> data;
+            // Set when data points into a cooked texture's levels rather than to stbi allocations
+            std::shared_ptr<CookedTexture> cooked;
         };
 
     public:
@@ -46,7 +53,11 @@ namespace stratus {
         virtual ~ResourceManager();
 
         Async<Entity> LoadModel(const std::string&, const ColorSpace&, const bool optimizeGraph, RenderFaceCulling defaultCullMode = RenderFaceCulling::CULLING_CCW);
-        TextureHandle LoadTexture(const std::string&, const ColorSpace&);
+        // Prefab of a model which has finished loading (nullptr until then) - use this to spawn many copies at once
+        PrefabPtr GetModelPrefab(const std::string&) const;
+        // Textures with a higher priority are decoded first when the decode budget is full. Anything besides
+        // TextureUsage::GENERIC gets block compressed with a full mip chain and cached on disk (see TextureCache).
+        TextureHandle LoadTexture(const std::string&, const ColorSpace&, const TextureUsage usage = TextureUsage::GENERIC, const int priority = 0);
         // prefix is used to select all faces with one string. It ends up expanding to:
         //      prefix + "right." + fileExt
         //      prefix + "left." + fileExt
@@ -54,6 +65,25 @@ namespace stratus {
         //      prefix + "back." + fileExt
         TextureHandle LoadCubeMap(const std::string& prefix, const ColorSpace&, const std::string& fileExt = "jpg");
         Texture LookupTexture(const TextureHandle, TextureLoadingStatus&) const;
+        // Raises the priority of a texture which is still waiting to be decoded
+        void PrioritizeTexture(const TextureHandle, const int priority);
+
+        // Limits how many bytes of decoded pixel data can be waiting for upload at once. Decoding stops
+        // while the limit is reached and picks back up as textures are uploaded.
+        void SetTextureDecodeBudget(const size_t bytes);
+        size_t GetTextureDecodeBudget() const;
+        TextureDecodeStatistics GetTextureDecodeStatistics() const;
+
+        // Mesh and texture uploads are spread across frames so that loading stays within this budget.
+        // Meshes closest to the camera (and inside its view) go first.
+        void SetUploadBudget(const GpuUploadBudget&);
+        GpuUploadBudget GetUploadBudget() const;
+        GpuUploadStatistics GetUploadStatistics() const;
+        // For uploads which have to happen this frame (e.g. material buffer changes) so that they count
+        // against the next frame's budget
+        void ChargeImmediateUpload(const size_t bytes);
+        // Goes up by one each time a texture finishes loading, whether or not it succeeded
+        uint64_t GetNumTexturesFinished() const;
 
         // Default shapes
         EntityPtr CreateCube();
@@ -66,7 +96,6 @@ namespace stratus {
         virtual void Shutdown();
 
     private:
-        void ClearAsyncTextureData_();
         void ClearAsyncModelData_();
         void ClearAsyncModelData_(EntityPtr);
 
@@ -77,6 +106,8 @@ namespace stratus {
         // Despite accepting multiple files, it assumes they all have the same format (e.g. for cube texture)
         TextureHandle LoadTextureImpl_(const std::vector<std::string>&, 
                                        const ColorSpace&,
+                                       const TextureUsage,
+                                       const int priority,
                                        const TextureType type = TextureType::TEXTURE_2D,
                                        const TextureCoordinateWrapping wrap = TextureCoordinateWrapping::REPEAT,
                                        const TextureMinificationFilter min = TextureMinificationFilter::LINEAR_MIPMAP_LINEAR,
@@ -84,11 +115,22 @@ namespace stratus {
         std::shared_ptr<RawTextureData> LoadTexture_(const std::vector<std::string>&, 
                                                      const TextureHandle, 
                                                      const ColorSpace&,
+                                                     const TextureUsage,
                                                      const TextureType type = TextureType::TEXTURE_2D,
                                                      const TextureCoordinateWrapping wrap = TextureCoordinateWrapping::REPEAT,
                                                      const TextureMinificationFilter min = TextureMinificationFilter::LINEAR_MIPMAP_LINEAR,
                                                      const TextureMagnificationFilter mag = TextureMagnificationFilter::LINEAR);
         Texture * FinalizeTexture_(const RawTextureData&);
+        // Schedules the decode once TextureDecodeQueue has made room for it, and then the upload
+        void DecodeTexture_(const std::vector<std::string>&,
+                            const TextureHandle,
+                            const ColorSpace&,
+                            const TextureUsage,
+                            const int priority,
+                            const TextureType,
+                            const TextureCoordinateWrapping,
+                            const TextureMinificationFilter,
+                            const TextureMagnificationFilter);
 
         void InitCube_();
         void InitQuad_();
@@ -96,15 +138,22 @@ namespace stratus {
     private:
         EntityPtr cube_;
         EntityPtr quad_;
+        PrefabPtr cubePrefab_;
+        PrefabPtr quadPrefab_;
         std::unordered_map<std::string, Async<Entity>> loadedModels_;
+        // Instances of loaded models are stamped out from these
+        std::unordered_map<std::string, PrefabPtr> modelPrefabs_;
         std::unordered_map<std::string, Async<Entity>> pendingFinalize_;
-        std::unordered_set<MeshPtr> meshFinalizeQueue_;
-        std::unordered_set<MeshPtr> generateMeshGpuDataQueue_;
+        // World transform of the first entity found using each mesh, which decides when it gets uploaded
+        std::unordered_map<MeshPtr, glm::mat4> meshFinalizeQueue_;
         //std::vector<MeshPtr> _meshFinalizeQueue;
-        std::unordered_map<TextureHandle, Async<RawTextureData>> asyncLoadedTextureData_;
         std::unordered_set<TextureHandle> texturesStillLoading_;
         std::unordered_map<TextureHandle, Async<Texture>> loadedTextures_;
         std::unordered_map<std::string, TextureHandle> loadedTexturesByFile_;
+        // These have their own locks so they never need mutex_
+        TextureDecodeQueue textureDecodes_;
+        GpuUploadScheduler uploads_;
+        std::atomic<uint64_t> texturesFinished_{0};
         mutable std::shared_mutex mutex_;
     };
 }
\ No newline at end of file
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace stratus {
+    // Slot index plus the generation the slot was on when the handle was given out. Freeing a slot
+    // bumps its generation so stale handles can be detected with a single compare. Generation 0 is
+    // never handed out and means null.
+    template<typename E>
+    class GenerationalHandle {
+    public:
+        // Default constructor creates the Null Handle
+        GenerationalHandle() = default;
+        GenerationalHandle(const uint32_t index, const uint32_t generation)
+            : index_(index), generation_(generation) {}
+
+        static GenerationalHandle<E> Null() { return GenerationalHandle<E>(); }
+
+        uint32_t Index() const { return index_; }
+        uint32_t Generation() const { return generation_; }
+
+        // Unsigned 64-bit integer representation
+        uint64_t Integer() const { return (uint64_t(generation_) << 32) | uint64_t(index_); }
+        size_t HashCode() const { return std::hash<uint64_t>{}(Integer()); }
+
+        // Comparison operators
+
+        bool operator==(const GenerationalHandle<E>& other) const { return Integer() == other.Integer(); }
+        bool operator!=(const GenerationalHandle<E>& other) const { return Integer() != other.Integer(); }
+        bool operator< (const GenerationalHandle<E>& other) const { return Integer() <  other.Integer(); }
+        operator bool() const { return generation_ != 0; }
+
+        friend std::ostream& operator<<(std::ostream& os, const GenerationalHandle<E>& h) {
+            return os << "Handle{" << h.index_ << ", " << h.generation_ << "}";
+        }
+
+    private:
+        uint32_t index_ = 0;
+        uint32_t generation_ = 0;
+    };
+
+    // Values live in a dense array so iterating them is a linear walk, while the handles given out stay
+    // valid across inserts and removes of other values. Lookup is two array reads and a generation compare.
+    //
+    // Removing swaps the last value into the hole, so iteration order is not stable. Not thread safe.
+    template<typename T, typename E = T>
+    class SlotMap {
+        static constexpr uint32_t Free_ = UINT32_MAX;
+
+        struct Slot_ {
+            uint32_t generation = 1;
+            // Index into values_, or Free_
+            uint32_t dense = Free_;
+        };
+
+    public:
+        typedef GenerationalHandle<E> HandleType;
+
+        HandleType Insert(T value) {
+            uint32_t index;
+            if (freeSlots_.size() > 0) {
+                index = freeSlots_.back();
+                freeSlots_.pop_back();
+            }
+            else {
+                index = uint32_t(slots_.size());
+                slots_.push_back(Slot_());
+            }
+
+            Slot_& slot = slots_[index];
+            slot.dense = uint32_t(values_.size());
+            const HandleType handle(index, slot.generation);
+            values_.push_back(std::move(value));
+            handles_.push_back(handle);
+            return handle;
+        }
+
+        // Returns false if the handle was stale
+        bool Remove(const HandleType& handle) {
+            if (!Contains(handle)) return false;
+
+            Slot_& slot = slots_[handle.Index()];
+            const uint32_t dense = slot.dense;
+            const uint32_t last = uint32_t(values_.size() - 1);
+            if (dense != last) {
+                values_[dense] = std::move(values_[last]);
+                handles_[dense] = handles_[last];
+                slots_[handles_[dense].Index()].dense = dense;
+            }
+            values_.pop_back();
+            handles_.pop_back();
+
+            slot.dense = Free_;
+            ++slot.generation;
+            if (slot.generation == 0) slot.generation = 1;
+            freeSlots_.push_back(handle.Index());
+            return true;
+        }
+
+        bool Contains(const HandleType& handle) const {
+            if (handle.Index() >= slots_.size()) return false;
+            const Slot_& slot = slots_[handle.Index()];
+            return slot.dense != Free_ && slot.generation == handle.Generation();
+        }
+
+        // Returns nullptr if the handle was stale. The pointer is invalidated by the next insert or remove.
+        T * Find(const HandleType& handle) {
+            return Contains(handle) ? &values_[slots_[handle.Index()].dense] : nullptr;
+        }
+
+        const T * Find(const HandleType& handle) const {
+            return Contains(handle) ? &values_[slots_[handle.Index()].dense] : nullptr;
+        }
+
+        size_t Size() const { return values_.size(); }
+        bool Empty() const { return values_.size() == 0; }
+
+        // Generations are kept so that handles given out before clearing stay stale
+        void Clear() {
+            for (const HandleType& handle : handles_) {
+                Slot_& slot = slots_[handle.Index()];
+                slot.dense = Free_;
+                ++slot.generation;
+                if (slot.generation == 0) slot.generation = 1;
+                freeSlots_.push_back(handle.Index());
+            }
+            values_.clear();
+            handles_.clear();
+        }
+
+        // Dense arrays - Handles()[i] belongs to Values()[i]
+        const std::vector<T>& Values() const { return values_; }
+        const std::vector<HandleType>& Handles() const { return handles_; }
+
+        typename std::vector<T>::iterator begin() { return values_.begin(); }
+        typename std::vector<T>::iterator end() { return values_.end(); }
+        typename std::vector<T>::const_iterator begin() const { return values_.begin(); }
+        typename std::vector<T>::const_iterator end() const { return values_.end(); }
+
+    private:
+        std::vector<Slot_> slots_;
+        std::vector<uint32_t> freeSlots_;
+        std::vector<T> values_;
+        std::vector<HandleType> handles_;
+    };
+
+    // Dense map keyed by handles which some SlotMap gave out. Same O(1) lookups and linear iteration
+    // as SlotMap but without owning the handles. The sparse array grows to the largest slot index seen.
+    //
+    // Removing swaps the last value into the hole, so iteration order is not stable. Not thread safe.
+    template<typename T, typename E>
+    class SparseHandleMap {
+        static constexpr uint32_t Empty_ = UINT32_MAX;
+
+    public:
+        typedef GenerationalHandle<E> HandleType;
+
+        // Returns false if the handle was null or is already present. A stale handle sharing the same
+        // slot is replaced.
+        bool Insert(const HandleType& handle, T value) {
+            if (!handle) return false;
+            if (handle.Index() >= sparse_.size()) sparse_.resize(handle.Index() + 1, Empty_);
+
+            uint32_t& dense = sparse_[handle.Index()];
+            if (dense != Empty_) {
+                if (handles_[dense] == handle) return false;
+                values_[dense] = std::move(value);
+                handles_[dense] = handle;
+                return true;
+            }
+
+            dense = uint32_t(values_.size());
+            values_.push_back(std::move(value));
+            handles_.push_back(handle);
+            return true;
+        }
+
+        bool Remove(const HandleType& handle) {
+            if (!Contains(handle)) return false;
+
+            const uint32_t dense = sparse_[handle.Index()];
+            const uint32_t last = uint32_t(values_.size() - 1);
+            if (dense != last) {
+                values_[dense] = std::move(values_[last]);
+                handles_[dense] = handles_[last];
+                sparse_[handles_[dense].Index()] = dense;
+            }
+            values_.pop_back();
+            handles_.pop_back();
+            sparse_[handle.Index()] = Empty_;
+            return true;
+        }
+
+        bool Contains(const HandleType& handle) const {
+            if (handle.Index() >= sparse_.size()) return false;
+            const uint32_t dense = sparse_[handle.Index()];
+            return dense != Empty_ && handles_[dense] == handle;
+        }
+
+        // Returns nullptr if not present. The pointer is invalidated by the next insert or remove.
+        T * Find(const HandleType& handle) {
+            return Contains(handle) ? &values_[sparse_[handle.Index()]] : nullptr;
+        }
+
+        const T * Find(const HandleType& handle) const {
+            return Contains(handle) ? &values_[sparse_[handle.Index()]] : nullptr;
+        }
+
+        size_t Size() const { return values_.size(); }
+        bool Empty() const { return values_.size() == 0; }
+
+        void Clear() {
+            for (const HandleType& handle : handles_) sparse_[handle.Index()] = Empty_;
+            values_.clear();
+            handles_.clear();
+        }
+
+        // Dense arrays - Handles()[i] belongs to Values()[i]
+        const std::vector<T>& Values() const { return values_; }
+        const std::vector<HandleType>& Handles() const { return handles_; }
+
+        typename std::vector<T>::iterator begin() { return values_.begin(); }
+        typename std::vector<T>::iterator end() { return values_.end(); }
+        typename std::vector<T>::const_iterator begin() const { return values_.begin(); }
+        typename std::vector<T>::const_iterator end() const { return values_.end(); }
+
+    private:
+        std::vector<uint32_t> sparse_;
+        std::vector<T> values_;
+        std::vector<HandleType> handles_;
+    };
+}
+
+namespace std {
+    template<typename E>
+    struct hash<stratus::GenerationalHandle<E>> {
+        size_t operator()(const stratus::GenerationalHandle<E> & h) const {
+            return h.HashCode();
+        }
+    };
+}
@@ -0,0 +1,137 @@
+#include "StratusTaskGraph.h"
+#include "StratusTaskSystem.h"
+#include <stdexcept>
+
+namespace stratus {
+    TaskGraph::TaskGraph()
+        : state_(std::make_shared<State_>()) {}
+
+    TaskGraph::TaskId TaskGraph::AddTask(const Thread::ThreadFunction& function, const std::vector<TaskId>& predecessors) {
+        EnsureNotRunning_();
+
+        const TaskId id = state_->nodes.size();
+        for (const TaskId predecessor : predecessors) {
+            if (predecessor >= id) throw std::runtime_error("Task graph predecessor does not exist");
+        }
+
+        auto node = std::make_unique<Node_>();
+        node->function = function;
+        node->numPredecessors = predecessors.size();
+        state_->nodes.push_back(std::move(node));
+
+        for (const TaskId predecessor : predecessors) {
+            state_->nodes[predecessor]->successors.push_back(id);
+        }
+
+        return id;
+    }
+
+    TaskGraph::TaskId TaskGraph::AddContinuation(const Thread::ThreadFunction& function) {
+        // Only tasks without successors need to be waited on directly
+        std::vector<TaskId> predecessors;
+        for (TaskId id = 0; id < state_->nodes.size(); ++id) {
+            if (state_->nodes[id]->successors.size() == 0) predecessors.push_back(id);
+        }
+        return AddTask(function, predecessors);
+    }
+
+    void TaskGraph::OnComplete(const Thread::ThreadFunction& callback) {
+        EnsureNotRunning_();
+        state_->onComplete = callback;
+    }
+
+    void TaskGraph::Run() {
+        EnsureNotRunning_();
+        state_->running = true;
+        state_->callbackThread = &Thread::Current();
+
+        if (state_->nodes.size() == 0) {
+            Finish_(*state_);
+            return;
+        }
+
+        // Counts have to be reset before anything starts running since tasks schedule their successors
+        std::vector<TaskId> roots;
+        for (TaskId id = 0; id < state_->nodes.size(); ++id) {
+            Node_& node = *state_->nodes[id];
+            node.remaining.store(node.numPredecessors);
+            if (node.numPredecessors == 0) roots.push_back(id);
+        }
+
+        for (const TaskId id : roots) {
+            Schedule_(state_, id);
+        }
+    }
+
+    void TaskGraph::Wait() {
+        if (!state_->running) Run();
+        INSTANCE(TaskSystem)->Join([this]() { return Completed(); });
+
+        if (Failed()) {
+            auto ul = std::unique_lock<std::mutex>(state_->exceptionMutex);
+            std::rethrow_exception(state_->exception);
+        }
+    }
+
+    void TaskGraph::RunAndWait() {
+        Run();
+        Wait();
+    }
+
+    bool TaskGraph::Running() const {
+        return state_->running && !Completed();
+    }
+
+    bool TaskGraph::Completed() const {
+        return state_->finished.load();
+    }
+
+    bool TaskGraph::Failed() const {
+        return state_->failed.load();
+    }
+
+    size_t TaskGraph::Size() const {
+        return state_->nodes.size();
+    }
+
+    void TaskGraph::Schedule_(const std::shared_ptr<State_>& state, const TaskId id) {
+        INSTANCE(TaskSystem)->Submit_([state, id]() {
+            Execute_(state, id);
+        });
+    }
+
+    void TaskGraph::Execute_(const std::shared_ptr<State_>& state, const TaskId id) {
+        Node_& node = *state->nodes[id];
+        // Successors are still scheduled after a failure (and skipped) so that the graph always finishes
+        if (node.function && !state->failed.load()) {
+            try {
+                node.function();
+            }
+            catch (...) {
+                auto ul = std::unique_lock<std::mutex>(state->exceptionMutex);
+                if (!state->exception) state->exception = std::current_exception();
+                state->failed.store(true);
+            }
+        }
+
+        for (const TaskId successor : node.successors) {
+            // Whoever finishes the last predecessor is responsible for scheduling the successor
+            if (state->nodes[successor]->remaining.fetch_sub(1) == 1) {
+                Schedule_(state, successor);
+            }
+        }
+
+        if (state->completed.fetch_add(1) + 1 == state->nodes.size()) {
+            Finish_(*state);
+        }
+    }
+
+    void TaskGraph::Finish_(State_& state) {
+        if (state.onComplete && !state.failed.load()) state.callbackThread->Queue(state.onComplete);
+        state.finished.store(true);
+    }
+
+    void TaskGraph::EnsureNotRunning_() const {
+        if (state_->running) throw std::runtime_error("Task graph cannot be modified after it has started running");
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "StratusThread.h"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace stratus {
+    class TaskSystem;
+
+    // A set of tasks with dependencies between them. Once Run is called, every task without
+    // predecessors is handed to the TaskSystem and each remaining task is scheduled as soon as
+    // the last of its predecessors finishes.
+    //
+    // A running graph keeps its own state alive, so it is fine for the TaskGraph object to go
+    // out of scope before the tasks finish (use OnComplete or Wait if you need to know when).
+    //
+    // If a task throws, tasks which haven't started yet are skipped, OnComplete is never queued and Wait
+    // rethrows the first exception once nothing is running anymore.
+    class TaskGraph {
+    public:
+        typedef size_t TaskId;
+
+        TaskGraph();
+        ~TaskGraph() = default;
+
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph(TaskGraph&&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+        TaskGraph& operator=(TaskGraph&&) = delete;
+
+        // Predecessors must have been returned by a previous call to AddTask on this graph
+        TaskId AddTask(const Thread::ThreadFunction&, const std::vector<TaskId>& predecessors = {});
+        // Adds a task which runs after every task that has been added so far
+        TaskId AddContinuation(const Thread::ThreadFunction&);
+        // Queued onto the thread which calls Run once every task in the graph has finished without throwing
+        void OnComplete(const Thread::ThreadFunction&);
+
+        // Starts executing the graph. Tasks can't be added once the graph is running.
+        void Run();
+        // Blocks until every task has finished (calls Run first if needed). Task threads help execute
+        // queued tasks while they wait (see TaskSystem::Join). Rethrows the first exception thrown by a task.
+        void Wait();
+        void RunAndWait();
+
+        bool Running() const;
+        bool Completed() const;
+        // True if any task threw
+        bool Failed() const;
+        size_t Size() const;
+
+    private:
+        struct Node_ {
+            Thread::ThreadFunction function;
+            std::vector<TaskId> successors;
+            size_t numPredecessors = 0;
+            std::atomic<size_t> remaining{0};
+        };
+
+        struct State_ {
+            std::vector<std::unique_ptr<Node_>> nodes;
+            std::atomic<size_t> completed{0};
+            // Set once the last task has finished and OnComplete has been queued
+            std::atomic<bool> finished{false};
+            std::atomic<bool> failed{false};
+            std::mutex exceptionMutex;
+            std::exception_ptr exception;
+            bool running = false;
+            Thread::ThreadFunction onComplete;
+            Thread * callbackThread = nullptr;
+        };
+
+        static void Schedule_(const std::shared_ptr<State_>&, const TaskId);
+        static void Execute_(const std::shared_ptr<State_>&, const TaskId);
+        static void Finish_(State_&);
+        void EnsureNotRunning_() const;
+
+    private:
+        std::shared_ptr<State_> state_;
+    };
+}
@@ -1,26 +1,50 @@
 #include "StratusTaskSystem.h"
 #include "StratusLog.h"
+#include "StratusProfiler.h"
 #include <string>
+#include <chrono>
+#include <exception>
 
 namespace stratus {
+    struct CurrentTaskWorker_ {
+        const TaskSystem * owner = nullptr;
+        size_t index = 0;
+    };
+
+    // Lets a task thread find its own deque without any lookups
+    static CurrentTaskWorker_& GetCurrentTaskWorker() {
+        static thread_local CurrentTaskWorker_ current;
+        return current;
+    }
+
     TaskSystem::TaskSystem() {}
-            
+
     bool TaskSystem::Initialize() {
-        taskThreads_.clear();
+        workers_.clear();
         // Important that this is > 1
         unsigned int concurrency = 2;
         if (std::thread::hardware_concurrency() > concurrency) {
             concurrency = std::thread::hardware_concurrency();
         }
 
+        executor_ = [this](Thread::QueuedFunction&& function) {
+            Submit_(std::move(function));
+        };
+
+        running_.store(true);
+
+        // All workers need to exist before any of them start stealing from each other
         for (unsigned int i = 0; i < concurrency; ++i) {
-            Thread * ptr = new Thread("TaskThread#" + std::to_string(i + 1), true);
-            threadsWorking_.push_back(std::unique_ptr<std::atomic<size_t>>(new std::atomic<size_t>(0)));
-            threadToIndexMap_.insert(std::make_pair(ptr->Id(), threadsWorking_.size() - 1));
-            taskThreads_.push_back(ThreadPtr(std::move(ptr)));
+            auto worker = std::make_unique<TaskWorker_>();
+            worker->thread = ThreadPtr(new Thread("TaskThread#" + std::to_string(i + 1), false));
+            workers_.push_back(std::move(worker));
         }
 
-        nextTaskThread_ = 0;
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            workers_[i]->context = std::thread([this, i]() {
+                WorkerMain_(i);
+            });
+        }
 
         STRATUS_LOG << "Started " << Name() << " with " << concurrency << " threads" << std::endl;
 
@@ -28,27 +52,15 @@ namespace stratus {
     }
 
     SystemStatus TaskSystem::Update(const double) {
-        for (ThreadPtr& thread : taskThreads_) {
-            if (thread->Idle()) {
-                thread->Dispatch();
+        // Tasks are picked up immediately, but functions queued directly onto a task thread
+        // (for example Async callbacks) need the thread to wake up and check for them
+        for (auto& worker : workers_) {
+            if (worker->thread->HasQueuedFunctions()) {
+                WakeAll_();
+                break;
             }
         }
 
-        auto ul = std::unique_lock<std::mutex>(m_);
-        if (waiting_.size() == 0) return SystemStatus::SYSTEM_CONTINUE;
-
-        std::vector<TaskWait_ *> waiting;
-        for (TaskWait_* wait : waiting_) {
-            if (wait->CheckForCompletion()) {
-                delete wait;
-            }
-            else {
-                waiting.push_back(wait);
-            }
-        }
-
-        waiting_ = std::move(waiting);
-        
         return SystemStatus::SYSTEM_CONTINUE;
     }
 
@@ -56,7 +68,8 @@ namespace stratus {
         bool allIdle = false;
         size_t updateCount = 0;
         size_t messageCount = 1;
-        
+
+        // Tasks can schedule more tasks, so wait until everything has settled
         while (!allIdle) {
             if (updateCount % 1000 == 0) {
                 STRATUS_LOG << "[" << messageCount << "] Waiting on task threads to shutdown ..." << std::endl;
@@ -65,24 +78,152 @@ namespace stratus {
 
             ++updateCount;
 
-            allIdle = true;
+            allIdle = numQueued_.load() == 0 && numActive_.load() == 0;
 
-            for (auto& thread : taskThreads_) {
-                if (!thread->Idle()) {
+            for (auto& worker : workers_) {
+                if (worker->thread->HasQueuedFunctions()) {
                     allIdle = false;
                     break;
                 }
             }
 
             if (!allIdle) {
-                for (auto& thread : taskThreads_) {
-                    thread->Dispatch();
-                }
-
+                WakeAll_();
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
             }
         }
 
-        taskThreads_.clear();
+        running_.store(false);
+        WakeAll_();
+
+        for (auto& worker : workers_) {
+            worker->context.join();
+        }
+
+        workers_.clear();
+    }
+
+    void TaskSystem::Submit_(Thread::QueuedFunction&& function) {
+        if (workers_.size() == 0) throw std::runtime_error("Task threads size equal to 0");
+
+        Thread::QueuedFunction * task = taskPool_.AllocateConstruct(std::move(function));
+        // Increment before the task becomes visible so that a sleeping thread which wakes up
+        // can never observe the task without also observing the count
+        numQueued_.fetch_add(1);
+
+        const auto& current = GetCurrentTaskWorker();
+        if (current.owner == this) {
+            workers_[current.index]->tasks.Push(task);
+        }
+        else {
+            std::unique_lock<std::mutex> ul(sharedTasksMutex_);
+            sharedTasks_.push_back(task);
+            numSharedTasks_.fetch_add(1);
+        }
+
+        parker_.NotifyOne();
+        joinParker_.NotifyAll();
+    }
+
+    void TaskSystem::WorkerMain_(const size_t index) {
+        TaskWorker_& worker = *workers_[index];
+        worker.thread->BindToCurrentContext_();
+        GetCurrentTaskWorker() = CurrentTaskWorker_{this, index};
+
+        while (running_.load()) {
+            Thread::QueuedFunction * task = NextTask_(index);
+            if (task != nullptr) {
+                RunTask_(task);
+                continue;
+            }
+
+            if (worker.thread->HasQueuedFunctions()) {
+                worker.thread->Dispatch();
+                continue;
+            }
+
+            Park_();
+        }
+
+        GetCurrentTaskWorker() = CurrentTaskWorker_();
+        worker.thread->UnbindFromCurrentContext_();
+    }
+
+    Thread::QueuedFunction * TaskSystem::NextTask_(const size_t index) {
+        const size_t numWorkers = workers_.size();
+        const bool isWorker = index < numWorkers;
+
+        Thread::QueuedFunction * task = nullptr;
+        bool found = isWorker && workers_[index]->tasks.Pop(task);
+
+        if (!found && numSharedTasks_.load() > 0) {
+            std::unique_lock<std::mutex> ul(sharedTasksMutex_);
+            if (sharedTasks_.size() > 0) {
+                task = sharedTasks_.front();
+                sharedTasks_.pop_front();
+                numSharedTasks_.fetch_sub(1);
+                found = true;
+            }
+        }
+
+        // Start at a different victim for each worker to spread out contention
+        for (size_t i = isWorker ? 1 : 0; !found && i < numWorkers; ++i) {
+            const size_t victim = (index + i) % numWorkers;
+            found = workers_[victim]->tasks.Steal(task);
+        }
+
+        if (!found) return nullptr;
+
+        // Increment active before decrementing queued so that both are never 0 at the same time
+        numActive_.fetch_add(1);
+        numQueued_.fetch_sub(1);
+        return task;
+    }
+
+    void TaskSystem::RunTask_(Thread::QueuedFunction * task) {
+        const auto start = std::chrono::steady_clock::now();
+        {
+            STRATUS_PROFILE_SCOPE("TaskSystem::Task");
+            // Nothing is waiting on an Execute task to hand an exception to, so it gets logged and dropped.
+            // Letting it escape would leak the task, leave numActive_ up forever and end the process.
+            try {
+                (*task)();
+            }
+            catch (const std::exception& e) {
+                STRATUS_ERROR << "Uncaught exception in task: " << e.what() << std::endl;
+            }
+            catch (...) {
+                STRATUS_ERROR << "Uncaught exception in task" << std::endl;
+            }
+        }
+        taskPool_.DestroyDeallocate(task);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        parker_.RecordBusy(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        numActive_.fetch_sub(1);
+        // Anything blocked in Join may have been waiting on this task
+        joinParker_.NotifyAll();
+    }
+
+    bool TaskSystem::TryRunTask_() {
+        Thread::QueuedFunction * task = NextTask_(GetCurrentTaskWorker().index);
+        if (task == nullptr) return false;
+        RunTask_(task);
+        return true;
+    }
+
+    bool TaskSystem::CurrentIsWorker_() const {
+        return GetCurrentTaskWorker().owner == this;
+    }
+
+    void TaskSystem::Park_() {
+        const uint64_t generation = wakeGeneration_.load();
+        parker_.Wait([this, generation]() {
+            return numQueued_.load() > 0 || !running_.load() || wakeGeneration_.load() != generation;
+        });
+    }
+
+    void TaskSystem::WakeAll_() {
+        wakeGeneration_.fetch_add(1);
+        parker_.NotifyAll();
     }
-}
\ No newline at end of file
+}
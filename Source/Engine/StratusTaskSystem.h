@@ -3,50 +3,24 @@
 #include "StratusSystemModule.h"
 #include "StratusThread.h"
 #include "StratusAsync.h"
+#include "StratusWorkStealingDeque.h"
 
 #include <mutex>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <exception>
 #include <vector>
 #include <cmath>
 #include <unordered_map>
 #include <algorithm>
 
 namespace stratus { 
-    // Allows groups of async processes to be waited on in an async manner
-    struct TaskWait_ {
-        virtual ~TaskWait_() = default;
-        virtual bool CheckForCompletion() const = 0;
-    };
-
-    template<typename E>
-    struct TaskWaitImpl_ : public TaskWait_ {
-        TaskWaitImpl_(const std::function<void(const std::vector<Async<E>>&)>& callback, const std::vector<Async<E>>& group)
-            : callback(callback), group(group) {
-            thread = &Thread::Current();
-        }
-
-        virtual bool CheckForCompletion() const override {
-            for (const auto& as : group) {
-                if (!as.Completed()) {
-                    return false;
-                }
-            }
-
-            std::function<void(const std::vector<Async<E>>&)> c = callback;
-            std::vector<Async<E>> g = group;
-            thread->Queue([c, g]() {
-                c(g);
-            });
-            return true;
-        }
-
-        Thread* thread;
-        std::function<void(const std::vector<Async<E>>&)> callback;
-        std::vector<Async<E>> group;
-    };
-
     // Enables easy access to asynchronous processing by providing its own Task
     // Threads which are used under the hood to support Async<E>.
     SYSTEM_MODULE_CLASS(TaskSystem)
+        friend class TaskGraph;
+
         TaskSystem(const TaskSystem&) = delete;
         TaskSystem(TaskSystem&&) = delete;
         TaskSystem& operator=(const TaskSystem&) = delete;
@@ -60,77 +34,38 @@ namespace stratus {
         virtual void Shutdown();
 
     private:
-        template<typename E, typename T>
-        Async<E> CreateAsyncTask_(const T& process, const size_t index) {
-            // Increment the working #
-            threadsWorking_[index]->fetch_add(1);
-
-            const auto processWithHook = [this, index, process]() {
-                auto result = process();
-                // Decrement working counter
-                threadsWorking_[index]->fetch_sub(1);
-                return result;
-            };
-
-            auto as = Async<E>(*taskThreads_[index].get(), processWithHook);
-            return as;
-        }
-
-        Async<void> CreateAsyncVoidTask_(const std::function<void (void)>& process, const size_t index) {
-            // Increment the working #
-            threadsWorking_[index]->fetch_add(1);
-
-            const auto processWithHook = [this, index, process]() {
-                process();
-                // Decrement working counter
-                threadsWorking_[index]->fetch_sub(1);
-            };
-
-            auto as = Async<void>(*taskThreads_[index].get(), processWithHook);
-            return as;
-        }
-
-        size_t GetNextThreadIndexForTask_() {
-            if (taskThreads_.size() == 0) throw std::runtime_error("Task threads size equal to 0");
-
-            // Enter the threads with their current number of work items in a list
-            bool found = false;
-            const auto currentId = Thread::Current().Id();
-            std::vector<std::pair<ThreadHandle, size_t>> currentWorkLoads;
-            currentWorkLoads.reserve(threadToIndexMap_.size());
-            for (const auto& entry : threadToIndexMap_) {
-                if (entry.first == currentId) continue;
-                currentWorkLoads.push_back(std::make_pair(entry.first, threadsWorking_[entry.second]->load()));
-            }
-
-            const auto comparison = [](const std::pair<ThreadHandle, size_t>& a, const std::pair<ThreadHandle, size_t>& b) {
-                return a.second < b.second;
-            };
-
-            // Sort the threads based on how much work they currently have
-            std::sort(currentWorkLoads.begin(), currentWorkLoads.end(), comparison);
-            
-            // Choose the first which should have the least work items
-            return threadToIndexMap_.find(currentWorkLoads[0].first)->second;
-        }
+        // Each task thread owns a deque which it pushes and pops locally and which the other
+        // task threads steal from once they run out of their own work
+        struct TaskWorker_ {
+            // Provides the stratus::Thread identity (Thread::Current) for everything run by the worker
+            ThreadPtr thread;
+            std::thread context;
+            WorkStealingDeque<Thread::QueuedFunction *> tasks;
+        };
 
         template<typename E, typename T>
         Async<E> ScheduleTask_(const T& process) {
-            auto ul = std::unique_lock<std::mutex>(m_);
-
-            const auto index = GetNextThreadIndexForTask_();
-
-            return CreateAsyncTask_<E, T>(process, index);
+            return Async<E>(executor_, process);
         }
 
         Async<void> ScheduleVoidTask_(const std::function<void (void)>& process) {
-            auto ul = std::unique_lock<std::mutex>(m_);
-
-            const auto index = GetNextThreadIndexForTask_();
-
-            return CreateAsyncVoidTask_(process, index);
+            return Async<void>(executor_, process);
         }
 
+        // Pushes onto the current task thread's deque, or onto the shared queue if called from
+        // any other thread, and then wakes up a sleeping task thread
+        void Submit_(Thread::QueuedFunction&&);
+        void WorkerMain_(const size_t);
+        // Index is workers_.size() for threads which are not task threads
+        Thread::QueuedFunction * NextTask_(const size_t);
+        void RunTask_(Thread::QueuedFunction *);
+        // Runs one queued task on the calling task thread if there is one available
+        bool TryRunTask_();
+        // True if called from one of this system's task threads
+        bool CurrentIsWorker_() const;
+        void Park_();
+        void WakeAll_();
+
     public:
         template<typename E>
         Async<E> ScheduleTask(const std::function<std::shared_ptr<E> (void)>& process) {
@@ -146,27 +81,130 @@ namespace stratus {
             return ScheduleVoidTask_(process);
         }
 
+        // Runs function on a task thread without creating an Async to track it. If function throws, the
+        // exception is logged and dropped - use ScheduleTask or ParallelFor to get it back.
+        template<typename F>
+        void Execute(F&& function) {
+            Submit_(Thread::QueuedFunction(std::forward<F>(function)));
+        }
+
+        // Queues callback onto the calling thread once every Async in the group has completed
         template<typename E>
         void AddTaskGroupCallback(const std::function<void (const std::vector<Async<E>>&)>& callback, const std::vector<Async<E>>& group) {
-            auto ul = std::unique_lock<std::mutex>(m_);
-            waiting_.push_back(new TaskWaitImpl_<E>(callback, group));
+            Thread * thread = &Thread::Current();
+            WhenAll(group).Then([thread, callback, group](auto) {
+                thread->Queue([callback, group]() { callback(group); });
+            });
+        }
+
+        // Calls function(i) for every i in [begin, end). The range is split into chunks of grain
+        // indices (0 picks a grain automatically) which are claimed dynamically by the task threads
+        // and the calling thread (which only ever runs chunks of this loop unless it is a task thread itself).
+        // Returns once every index has been processed.
+        //
+        // If function throws, chunks which haven't started yet are skipped and the first exception is
+        // rethrown on the calling thread once no other thread is still inside of function.
+        template<typename F>
+        void ParallelFor(const size_t begin, const size_t end, size_t grain, const F& function) {
+            if (begin >= end) return;
+            const size_t count = end - begin;
+            if (grain == 0) grain = std::max<size_t>(1, count / (std::max<size_t>(workers_.size(), 1) * 4));
+            const size_t numChunks = (count + grain - 1) / grain;
+
+            if (numChunks == 1 || workers_.size() == 0) {
+                for (size_t i = begin; i < end; ++i) function(i);
+                return;
+            }
+
+            struct ParallelForState_ {
+                std::atomic<size_t> next{0};
+                std::atomic<size_t> completed{0};
+                std::atomic<bool> failed{false};
+                std::mutex m;
+                // First exception thrown by function
+                std::exception_ptr exception;
+            };
+
+            // Helper tasks may start after everything is done, so the counters need to outlive this call.
+            // function itself is only touched after claiming a chunk, which can't happen once we've returned.
+            auto state = std::make_shared<ParallelForState_>();
+            const auto runChunks = [state, begin, end, grain, numChunks, &function]() {
+                while (true) {
+                    const size_t chunk = state->next.fetch_add(1);
+                    if (chunk >= numChunks) return;
+                    // Chunks still have to be counted after a failure so that the caller knows when to stop waiting
+                    if (!state->failed.load()) {
+                        try {
+                            const size_t first = begin + chunk * grain;
+                            const size_t last = std::min(first + grain, end);
+                            for (size_t i = first; i < last; ++i) function(i);
+                        }
+                        catch (...) {
+                            auto ul = std::unique_lock<std::mutex>(state->m);
+                            if (!state->exception) state->exception = std::current_exception();
+                            state->failed.store(true);
+                        }
+                    }
+                    state->completed.fetch_add(1);
+                }
+            };
+
+            // The calling thread takes one share of the chunks, which only costs a task thread if it is one
+            const size_t numHelpers = CurrentIsWorker_() ? std::min(numChunks, workers_.size()) - 1 : std::min(numChunks - 1, workers_.size());
+            for (size_t i = 0; i < numHelpers; ++i) {
+                Submit_(runChunks);
+            }
+
+            runChunks();
+            Join([&state, numChunks]() { return state->completed.load() == numChunks; });
+
+            if (state->failed.load()) {
+                auto ul = std::unique_lock<std::mutex>(state->m);
+                std::rethrow_exception(state->exception);
+            }
+        }
+
+        // Blocks until done() returns true. Task threads execute other queued tasks while they wait, which
+        // makes it safe to call from inside of a task. Any other thread (e.g. the application thread) only
+        // waits so that it never picks up unrelated work such as a model import.
+        template<typename Predicate>
+        void Join(const Predicate& done) {
+            const bool help = CurrentIsWorker_();
+            while (!done()) {
+                if (help && TryRunTask_()) continue;
+                // Woken up whenever a task finishes or new work is submitted
+                joinParker_.Wait([this, &done, help]() { return done() || (help && numQueued_.load() > 0); });
+            }
         }
 
         size_t Size() const {
-            return taskThreads_.size();
+            return workers_.size();
+        }
+
+        // Combined time all task threads have spent working vs waiting for work
+        ThreadIdleStatistics GetIdleStatistics() const {
+            return parker_.GetStatistics();
         }
 
     private:
-        mutable std::mutex m_;
-        // The size of the following vectors/maps are immutable after initializing
-        std::vector<ThreadPtr> taskThreads_;
-        std::unordered_map<ThreadHandle, size_t> threadToIndexMap_;
-        // Measures # of work items per thread
-        std::vector<std::unique_ptr<std::atomic<size_t>>> threadsWorking_;
-        
-        // This changes with every call to wait on task group
-        //std::vector<std::pair<Thread *, std::vector<
-        std::vector<TaskWait_ *> waiting_;
-        size_t nextTaskThread_;
+        // The size of this vector is immutable after initializing
+        std::vector<std::unique_ptr<TaskWorker_>> workers_;
+        AsyncExecutor executor_;
+        // Tasks scheduled from threads which are not task threads (e.g. the application thread)
+        std::mutex sharedTasksMutex_;
+        std::deque<Thread::QueuedFunction *> sharedTasks_;
+        std::atomic<size_t> numSharedTasks_{0};
+        // Tasks which have been scheduled but not yet picked up by a task thread
+        std::atomic<size_t> numQueued_{0};
+        // Tasks which are currently being executed
+        std::atomic<size_t> numActive_{0};
+        std::atomic<bool> running_{false};
+        // Storage for submitted tasks so that scheduling doesn't need to allocate
+        ConcurrentPoolAllocator<Thread::QueuedFunction> taskPool_;
+        // Idle task threads sleep until new work arrives
+        ThreadParker parker_;
+        std::atomic<uint64_t> wakeGeneration_{0};
+        // Threads blocked in Join
+        ThreadParker joinParker_;
     };
 }
\ No newline at end of file
@@ -6,6 +6,22 @@
 #include <iostream>
 #include "StratusApplicationThread.h"
 #include "StratusGraphicsDriver.h"
+#include "StratusBlockCompression.h"
+#include <algorithm>
+
+// S3TC is an extension rather than core so the loader headers may not define these
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
 
 namespace stratus {
     static const void * CastTexDataToPtr(const TextureArrayData& data, const size_t offset) {
@@ -24,6 +40,12 @@ namespace stratus {
 
     public:
         TextureImpl(const TextureConfig & config, const TextureArrayData& data, bool initHandle) {
+            const uint32_t mipLevels = std::max(1u, config.mipLevels);
+            const bool compressed = IsBlockCompressed(config.format);
+            if ((compressed || mipLevels > 1) && config.type != TextureType::TEXTURE_2D && config.type != TextureType::TEXTURE_CUBE_MAP) {
+                throw std::runtime_error("Only 2D and cube map textures support compressed formats or mip levels");
+            }
+
             if (initHandle) {
                 handle_ = TextureHandle::NextHandle();
             }
@@ -38,16 +60,7 @@ namespace stratus {
             // See https://registry.khronos.org/OpenGL-Refpages/es1.1/xhtml/glPixelStorei.xml
             glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
             if (config.type == TextureType::TEXTURE_2D || config.type == TextureType::TEXTURE_RECTANGLE) {
-                glTexImage2D(_convertTexture(config.type), // target
-                    0, // level 
-                    _convertInternalFormat(config.format, config.storage, config.dataType), // internal format (e.g. RGBA16F)
-                    config.width, 
-                    config.height,
-                    0,
-                    _convertFormat(config.format), // format (e.g. RGBA)
-                    _convertType(config.dataType, config.storage), // type (e.g. FLOAT)
-                    CastTexDataToPtr(data, 0)
-                );
+                uploadLevels_(_convertTexture(config.type), data, 0);
 
                 // Set anisotropic filtering
                 auto maxAnisotropy = GraphicsDriver::GetConfig().maxAnisotropy;
@@ -92,28 +105,61 @@ namespace stratus {
                 }
 
                 for (int face = 0; face < 6; ++face) {
-                    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 
-                        0, 
-                        _convertInternalFormat(config.format, config.storage, config.dataType),
-                        config.width, 
-                        config.height,
-                        0, 
-                        _convertFormat(config.format),
-                        _convertType(config.dataType, config.storage), 
-                        CastTexDataToPtr(data, (const size_t)face)
-                    );
+                    uploadLevels_(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, data, (const size_t)face);
                 }
             }
             else {
                 throw std::runtime_error("Unknown texture type specified");
             }
 
+            // Only the levels which were given can be sampled
+            if (mipLevels > 1) glTexParameteri(_convertTexture(config.type), GL_TEXTURE_MAX_LEVEL, GLint(mipLevels - 1));
+
             unbind();
 
-            // Mipmaps aren't generated for rectangle textures
-            if (config.generateMipMaps && config.type != TextureType::TEXTURE_RECTANGLE) glGenerateTextureMipmap(texture_);
+            // Mipmaps aren't generated for rectangle textures, or when they were provided. Drivers don't
+            // have to support generating them for compressed formats.
+            if (config.generateMipMaps && mipLevels == 1 && !compressed && config.type != TextureType::TEXTURE_RECTANGLE) {
+                glGenerateTextureMipmap(texture_);
+            }
         }
 
+    private:
+        // Uploads every mip level of one face (face 0 for anything besides cube maps)
+        void uploadLevels_(const GLenum target, const TextureArrayData& data, const size_t face) {
+            const uint32_t mipLevels = std::max(1u, config_.mipLevels);
+            for (uint32_t level = 0; level < mipLevels; ++level) {
+                const uint32_t width = std::max(1u, config_.width >> level);
+                const uint32_t height = std::max(1u, config_.height >> level);
+                const void * levelData = CastTexDataToPtr(data, face * mipLevels + level);
+                if (IsBlockCompressed(config_.format)) {
+                    glCompressedTexImage2D(target,
+                        GLint(level),
+                        _convertInternalFormat(config_.format, config_.storage, config_.dataType),
+                        width,
+                        height,
+                        0,
+                        GLsizei(BlockCompressedSizeBytes(config_.format, width, height)),
+                        levelData
+                    );
+                }
+                else {
+                    glTexImage2D(target, // target
+                        GLint(level), // level 
+                        _convertInternalFormat(config_.format, config_.storage, config_.dataType), // internal format (e.g. RGBA16F)
+                        width, 
+                        height,
+                        0,
+                        _convertFormat(config_.format), // format (e.g. RGBA)
+                        _convertType(config_.dataType, config_.storage), // type (e.g. FLOAT)
+                        levelData
+                    );
+                }
+            }
+        }
+
+    public:
+
         ~TextureImpl() {
             if (ApplicationThread::Instance()->CurrentIsApplicationThread()) {
                 glDeleteTextures(1, &texture_);
@@ -302,6 +348,17 @@ namespace stratus {
 
         // See https://gamedev.stackexchange.com/questions/168241/is-gl-depth-component32-deprecated-in-opengl-4-5 for more info on depth component
         static GLint _convertInternalFormat(TextureComponentFormat format, TextureComponentSize size, TextureComponentType type) {
+            // Storage size and type don't apply to compressed formats
+            switch (format) {
+                case TextureComponentFormat::BC1_RGB: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                case TextureComponentFormat::BC1_SRGB: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+                case TextureComponentFormat::BC3_RGBA: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case TextureComponentFormat::BC3_SRGB_ALPHA: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+                case TextureComponentFormat::BC4_RED: return GL_COMPRESSED_RED_RGTC1;
+                case TextureComponentFormat::BC5_RG: return GL_COMPRESSED_RG_RGTC2;
+                default: break;
+            }
+
             // If the bits are default we just mirror the format for the internal format option
             if (format == TextureComponentFormat::DEPTH_STENCIL || size == TextureComponentSize::BITS_DEFAULT) {
                 switch (format) {
@@ -27,7 +27,14 @@ namespace stratus {
         RGBA,
         SRGB_ALPHA,
         DEPTH,
-        DEPTH_STENCIL
+        DEPTH_STENCIL,
+        // Block compressed - the data for each mip level is already compressed (see StratusBlockCompression.h)
+        BC1_RGB,
+        BC1_SRGB,
+        BC3_RGBA,
+        BC3_SRGB_ALPHA,
+        BC4_RED,
+        BC5_RG
     };
 
     enum class TextureComponentSize : int {
@@ -102,6 +109,11 @@ namespace stratus {
         uint32_t height;
         uint32_t depth;
         bool generateMipMaps;
+        // Number of mip levels included with the data. Anything above 1 means the data holds
+        // every level of every face, face major (data[face * mipLevels + level]), and
+        // generateMipMaps is ignored. Only 2D textures and cube maps can be given mip levels,
+        // and block compressed formats are only supported for them.
+        uint32_t mipLevels = 1;
     };
 
     struct TextureData {
@@ -0,0 +1,190 @@
+#include "StratusTextureCache.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "StratusBlockCompression.h"
+#include "StratusFilesystem.h"
+
+namespace stratus {
+    static constexpr uint32_t TextureCacheMagic_ = 0x31435453; // "STC1"
+    // Bump whenever the layout below or the way textures are cooked changes
+    static constexpr uint32_t TextureCacheVersion_ = 1;
+    // Each level halves in size so this is far more than any real texture needs
+    static constexpr uint32_t MaxMipLevels_ = 32;
+
+    static CacheDirectory directory_("CookedTextures");
+
+    void TextureCache::SetDirectory(const std::string& directory) {
+        directory_.Set(directory);
+    }
+
+    std::string TextureCache::GetDirectory() {
+        return directory_.Get();
+    }
+
+    uint64_t TextureCache::CookKey(const TextureUsage usage, const bool srgb) {
+        return (uint64_t(TextureCacheVersion_) << 32) | (uint64_t(usage) << 1) | uint64_t(srgb ? 1 : 0);
+    }
+
+    bool TextureCache::HashSource(const std::string& source, uint64_t& sourceHash) {
+        MappedFile file;
+        if (!file.Open(source)) return false;
+
+        // FNV-1a over 8 byte words rather than single bytes - source images can be tens of MB and this
+        // runs on every load
+        const uint8_t * data = file.Data();
+        const size_t size = file.Size();
+        uint64_t hash = HashFnv1a(&size, sizeof(size));
+        size_t offset = 0;
+        for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, data + offset, sizeof(word));
+            hash ^= word;
+            hash *= 1099511628211ull;
+        }
+        sourceHash = HashFnv1a(data + offset, size - offset, hash);
+        return true;
+    }
+
+    std::string TextureCache::CookedPath(const std::string& source, const uint64_t sourceHash, const uint64_t cookKey) {
+        const std::string directory = GetDirectory();
+        if (directory.empty()) return std::string();
+
+        // The name is only there to make the directory easier to look through
+        const uint64_t hash = HashFnv1a(&cookKey, sizeof(cookKey), sourceHash);
+        std::stringstream name;
+        name << std::filesystem::path(source).stem().string() << "_" << std::hex << hash << ".stc";
+        return (std::filesystem::path(directory) / name.str()).string();
+    }
+
+    bool TextureCache::Cook(const uint8_t * rgba, const uint32_t width, const uint32_t height, const TextureUsage usage, const bool srgb, CookedTexture& texture) {
+        if (usage == TextureUsage::GENERIC || width == 0 || height == 0) return false;
+
+        TextureComponentFormat format;
+        switch (usage) {
+            case TextureUsage::COLOR: {
+                bool opaque = true;
+                for (size_t i = 0; i < size_t(width) * height && opaque; ++i) {
+                    opaque = rgba[i * 4 + 3] == 255;
+                }
+                if (opaque) format = srgb ? TextureComponentFormat::BC1_SRGB : TextureComponentFormat::BC1_RGB;
+                else        format = srgb ? TextureComponentFormat::BC3_SRGB_ALPHA : TextureComponentFormat::BC3_RGBA;
+                break;
+            }
+            case TextureUsage::NORMAL_MAP:
+                format = TextureComponentFormat::BC5_RG;
+                break;
+            default:
+                format = TextureComponentFormat::BC4_RED;
+                break;
+        }
+
+        const bool srgbMips = srgb && usage == TextureUsage::COLOR;
+        const bool normalMap = usage == TextureUsage::NORMAL_MAP;
+
+        CookedTexture cooked;
+        cooked.format = format;
+        cooked.width = width;
+        cooked.height = height;
+
+        // Level 0 comes straight from the source, the rest are built from the level above them
+        std::vector<uint8_t> level;
+        const uint8_t * current = rgba;
+        uint32_t levelWidth = width;
+        uint32_t levelHeight = height;
+        while (true) {
+            cooked.levels.push_back(CompressImage(format, current, levelWidth, levelHeight));
+            if (levelWidth == 1 && levelHeight == 1) break;
+
+            level = DownsampleImage(current, levelWidth, levelHeight, srgbMips, normalMap);
+            current = level.data();
+            levelWidth = std::max(1u, levelWidth / 2);
+            levelHeight = std::max(1u, levelHeight / 2);
+        }
+
+        texture = std::move(cooked);
+        return true;
+    }
+
+    // Layout (all values little endian, no padding):
+    //
+    //   magic, version, source hash, cook key, format, width, height, #levels
+    //   levels: size, compressed data
+    bool TextureCache::Write(const std::string& cookedFile, const uint64_t sourceHash, const uint64_t cookKey, const CookedTexture& texture) {
+        return Filesystem::WriteBinaryAtomic(cookedFile, [&texture, sourceHash, cookKey](std::ofstream& out) {
+            const auto write = [&out](const void * data, const size_t bytes) {
+                if (bytes > 0) out.write(reinterpret_cast<const char *>(data), bytes);
+            };
+
+            const int32_t format = int32_t(texture.format);
+            const uint32_t numLevels = uint32_t(texture.levels.size());
+            write(&TextureCacheMagic_, sizeof(TextureCacheMagic_));
+            write(&TextureCacheVersion_, sizeof(TextureCacheVersion_));
+            write(&sourceHash, sizeof(sourceHash));
+            write(&cookKey, sizeof(cookKey));
+            write(&format, sizeof(format));
+            write(&texture.width, sizeof(texture.width));
+            write(&texture.height, sizeof(texture.height));
+            write(&numLevels, sizeof(numLevels));
+            for (const auto& level : texture.levels) {
+                const uint64_t size = uint64_t(level.size());
+                write(&size, sizeof(size));
+                write(level.data(), level.size());
+            }
+        });
+    }
+
+    bool TextureCache::Read(const std::string& cookedFile, const uint64_t sourceHash, const uint64_t cookKey, CookedTexture& texture) {
+        if (cookedFile.empty()) return false;
+
+        MappedFile file;
+        if (!file.Open(cookedFile)) return false;
+
+        // Every read is bounds checked so a truncated or corrupt file fails rather than crashing. The caller
+        // cooks the texture again in that case, which overwrites the bad file.
+        const uint8_t * data = file.Data();
+        const size_t size = file.Size();
+        size_t offset = 0;
+        const auto read = [data, size, &offset](void * out, const size_t bytes) {
+            if (bytes > size - offset) return false;
+            std::memcpy(out, data + offset, bytes);
+            offset += bytes;
+            return true;
+        };
+
+        uint32_t magic, version, numLevels;
+        uint64_t hash, key;
+        int32_t format;
+        CookedTexture cooked;
+        if (!read(&magic, sizeof(magic)) || !read(&version, sizeof(version))) return false;
+        if (magic != TextureCacheMagic_ || version != TextureCacheVersion_) return false;
+        if (!read(&hash, sizeof(hash)) || !read(&key, sizeof(key)) || hash != sourceHash || key != cookKey) return false;
+
+        const bool header = read(&format, sizeof(format)) && read(&cooked.width, sizeof(cooked.width)) &&
+            read(&cooked.height, sizeof(cooked.height)) && read(&numLevels, sizeof(numLevels));
+        cooked.format = TextureComponentFormat(format);
+        if (!header || !IsBlockCompressed(cooked.format) || cooked.width == 0 || cooked.height == 0 || numLevels == 0 || numLevels > MaxMipLevels_) {
+            return false;
+        }
+
+        cooked.levels.resize(numLevels);
+        for (uint32_t level = 0; level < numLevels; ++level) {
+            const uint32_t width = std::max(1u, cooked.width >> level);
+            const uint32_t height = std::max(1u, cooked.height >> level);
+            uint64_t levelSize;
+            // Sizes always follow from the format and dimensions, so anything else means the file is bad
+            if (!read(&levelSize, sizeof(levelSize)) || levelSize != BlockCompressedSizeBytes(cooked.format, width, height) || levelSize > size - offset) {
+                return false;
+            }
+            cooked.levels[level].assign(data + offset, data + offset + levelSize);
+            offset += levelSize;
+        }
+
+        if (offset != size) return false;
+
+        texture = std::move(cooked);
+        return true;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "StratusTexture.h"
+
+namespace stratus {
+    // How a material uses a texture, which decides what it gets compressed to
+    enum class TextureUsage : int {
+        // Uploaded as it is and never cooked
+        GENERIC,
+        // Albedo, emissive or packed channels: BC1, or BC3 if any pixel isn't fully opaque
+        COLOR,
+        // Tangent space normal map: BC5 keeping x and y, with z rebuilt in the shader
+        NORMAL_MAP,
+        // Only the red channel is sampled (roughness, metallic, ...): BC4
+        SINGLE_CHANNEL
+    };
+
+    // Full mip chain of a texture in a block compressed format, level 0 first
+    struct CookedTexture {
+        TextureComponentFormat format = TextureComponentFormat::BC1_RGB;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<std::vector<uint8_t>> levels;
+    };
+
+    // On-disk cache of block compressed textures with pre-built mip chains, so that loading them again
+    // skips decoding the source image, generating mips on the GPU and uploading uncompressed pixels.
+    //
+    // Cooked files are keyed by a hash of the source file's contents along with the cook key, so editing
+    // a texture (or moving it) never picks up stale data.
+    class TextureCache {
+    public:
+        // Defaults to "CookedTextures" under the working directory. An empty string turns the cache off.
+        static void SetDirectory(const std::string&);
+        static std::string GetDirectory();
+
+        // Covers everything besides the source contents which changes the cooked output
+        static uint64_t CookKey(const TextureUsage, const bool srgb);
+        // Returns false if the source file can't be read
+        static bool HashSource(const std::string& source, uint64_t& sourceHash);
+        // Returns an empty string if the cache is turned off
+        static std::string CookedPath(const std::string& source, const uint64_t sourceHash, const uint64_t cookKey);
+
+        // Builds the mip chain from width x height RGBA8 pixels and compresses every level. Returns false
+        // for TextureUsage::GENERIC.
+        static bool Cook(const uint8_t * rgba, const uint32_t width, const uint32_t height, const TextureUsage, const bool srgb, CookedTexture&);
+
+        // Neither of these log anything (so they can be called from any thread) - failures are left to the
+        // caller to report.
+        //
+        // Safe to call from multiple threads, even for the same file
+        static bool Write(const std::string& cookedFile, const uint64_t sourceHash, const uint64_t cookKey, const CookedTexture&);
+        // Fails without changing texture if the file is missing, corrupt or was cooked from something else
+        static bool Read(const std::string& cookedFile, const uint64_t sourceHash, const uint64_t cookKey, CookedTexture& texture);
+    };
+}
@@ -0,0 +1,113 @@
+#include "StratusTextureDecodeQueue.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace stratus {
+    TextureDecodeQueue::TextureDecodeQueue(const size_t budgetBytes)
+        : budgetBytes_(budgetBytes) {}
+
+    void TextureDecodeQueue::SetBudget(const size_t budgetBytes) {
+        {
+            std::unique_lock<std::mutex> ul(mutex_);
+            budgetBytes_ = budgetBytes;
+        }
+        // A larger budget might have made room for more
+        StartDecodes_();
+    }
+
+    size_t TextureDecodeQueue::GetBudget() const {
+        std::unique_lock<std::mutex> ul(mutex_);
+        return budgetBytes_;
+    }
+
+    void TextureDecodeQueue::Submit(const TextureHandle handle, const size_t estimatedBytes, const int priority, const DecodeFunction& decode) {
+        {
+            std::unique_lock<std::mutex> ul(mutex_);
+            if (pendingByHandle_.find(handle) != pendingByHandle_.end() || inFlight_.find(handle) != inFlight_.end()) {
+                throw std::runtime_error("Texture decode was already submitted");
+            }
+
+            auto it = pending_.insert(Pending_{priority, nextSequence_++, handle, estimatedBytes, decode}).first;
+            pendingByHandle_.insert(std::make_pair(handle, it));
+        }
+
+        StartDecodes_();
+    }
+
+    bool TextureDecodeQueue::Prioritize(const TextureHandle handle, const int priority) {
+        {
+            std::unique_lock<std::mutex> ul(mutex_);
+            auto it = pendingByHandle_.find(handle);
+            if (it == pendingByHandle_.end()) return false;
+            if (it->second->priority >= priority) return true;
+
+            // Keeps its sequence number so it stays ahead of later submissions at the same priority
+            auto node = pending_.extract(it->second);
+            node.value().priority = priority;
+            it->second = pending_.insert(std::move(node)).position;
+        }
+
+        // If it moved to the front it might fit where the old front didn't
+        StartDecodes_();
+        return true;
+    }
+
+    void TextureDecodeQueue::Release(const TextureHandle handle) {
+        {
+            std::unique_lock<std::mutex> ul(mutex_);
+            auto it = inFlight_.find(handle);
+            if (it == inFlight_.end()) return;
+
+            inFlightBytes_ -= it->second;
+            inFlight_.erase(it);
+        }
+
+        StartDecodes_();
+    }
+
+    void TextureDecodeQueue::Clear() {
+        std::unique_lock<std::mutex> ul(mutex_);
+        pending_.clear();
+        pendingByHandle_.clear();
+    }
+
+    TextureDecodeStatistics TextureDecodeQueue::GetStatistics() const {
+        std::unique_lock<std::mutex> ul(mutex_);
+        TextureDecodeStatistics stats;
+        stats.budgetBytes = budgetBytes_;
+        stats.inFlightBytes = inFlightBytes_;
+        stats.peakInFlightBytes = peakInFlightBytes_;
+        stats.numInFlight = inFlight_.size();
+        stats.numPending = pending_.size();
+        return stats;
+    }
+
+    void TextureDecodeQueue::ResetPeak() {
+        std::unique_lock<std::mutex> ul(mutex_);
+        peakInFlightBytes_ = inFlightBytes_;
+    }
+
+    void TextureDecodeQueue::StartDecodes_() {
+        std::vector<DecodeFunction> start;
+        {
+            std::unique_lock<std::mutex> ul(mutex_);
+            while (pending_.size() > 0) {
+                auto front = pending_.begin();
+                if (inFlight_.size() > 0 && inFlightBytes_ + front->bytes > budgetBytes_) break;
+
+                inFlightBytes_ += front->bytes;
+                peakInFlightBytes_ = std::max(peakInFlightBytes_, inFlightBytes_);
+                inFlight_.insert(std::make_pair(front->handle, front->bytes));
+                start.push_back(front->decode);
+
+                pendingByHandle_.erase(front->handle);
+                pending_.erase(front);
+            }
+        }
+
+        for (auto& decode : start) {
+            decode();
+        }
+    }
+}
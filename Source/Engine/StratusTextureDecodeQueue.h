@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include "StratusTexture.h"
+
+namespace stratus {
+    struct TextureDecodeStatistics {
+        size_t budgetBytes = 0;
+        // Bytes reserved by decodes which have started but haven't been released yet
+        size_t inFlightBytes = 0;
+        // Largest inFlightBytes has been since the queue was created or ResetPeak was called
+        size_t peakInFlightBytes = 0;
+        size_t numInFlight = 0;
+        size_t numPending = 0;
+    };
+
+    // Caps how much decoded texture data can exist at once. A decode reserves its estimated size before it
+    // starts and keeps it until Release, which should be called once the pixels have been uploaded and
+    // freed. Decodes which don't fit wait their turn, highest priority first and then in the order they
+    // were submitted.
+    //
+    // The front of the queue is never skipped in favor of a smaller decode behind it, and a decode larger
+    // than the whole budget still starts once nothing else is in flight.
+    //
+    // Thread safe. Decode functions are called with no locks held, from either Submit or the Release which
+    // made room for them, so they should hand the actual decoding off to another thread.
+    class TextureDecodeQueue {
+    public:
+        typedef std::function<void ()> DecodeFunction;
+
+        explicit TextureDecodeQueue(const size_t budgetBytes);
+        ~TextureDecodeQueue() = default;
+
+        TextureDecodeQueue(TextureDecodeQueue&&) = delete;
+        TextureDecodeQueue(const TextureDecodeQueue&) = delete;
+        TextureDecodeQueue& operator=(TextureDecodeQueue&&) = delete;
+        TextureDecodeQueue& operator=(const TextureDecodeQueue&) = delete;
+
+        // Decodes which have already started are not affected
+        void SetBudget(const size_t budgetBytes);
+        size_t GetBudget() const;
+
+        void Submit(const TextureHandle, const size_t estimatedBytes, const int priority, const DecodeFunction& decode);
+        // Only ever raises the priority. Returns false if the decode isn't waiting (already started or never submitted).
+        bool Prioritize(const TextureHandle, const int priority);
+        // Gives back the reservation of a decode which has started
+        void Release(const TextureHandle);
+        // Drops every decode which hasn't started yet
+        void Clear();
+
+        TextureDecodeStatistics GetStatistics() const;
+        void ResetPeak();
+
+    private:
+        struct Pending_ {
+            int priority;
+            uint64_t sequence;
+            TextureHandle handle;
+            size_t bytes;
+            DecodeFunction decode;
+        };
+
+        struct PendingOrder_ {
+            bool operator()(const Pending_& a, const Pending_& b) const {
+                if (a.priority != b.priority) return a.priority > b.priority;
+                return a.sequence < b.sequence;
+            }
+        };
+
+        typedef std::set<Pending_, PendingOrder_> PendingSet_;
+
+    private:
+        // Starts as many decodes from the front of the queue as the budget allows
+        void StartDecodes_();
+
+    private:
+        mutable std::mutex mutex_;
+        size_t budgetBytes_;
+        size_t inFlightBytes_ = 0;
+        size_t peakInFlightBytes_ = 0;
+        uint64_t nextSequence_ = 0;
+        PendingSet_ pending_;
+        std::unordered_map<TextureHandle, PendingSet_::iterator> pendingByHandle_;
+        std::unordered_map<TextureHandle, size_t> inFlight_;
+    };
+}
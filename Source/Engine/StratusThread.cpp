@@ -1,4 +1,5 @@
 #include "StratusThread.h"
+#include "StratusProfiler.h"
 #include <chrono>
 #include <string>
 
@@ -19,6 +20,7 @@ namespace stratus {
             throw std::runtime_error("Attempt to overwrite existing thread pointer");
         }
         *current = thread;
+        Profiler::SetCurrentThreadName(thread->Name());
     }
 
     // Used for when the user does not specify their own thread name
@@ -62,21 +64,27 @@ namespace stratus {
             if (processing_.load()) return;
             
             // If nothing to process, return early
-            if (frontQueue_.size() == 0) return;
+            const size_t numQueued = numQueued_.load();
+            if (numQueued == 0) return;
 
-            // Copy contents of front buffer to back buffer for processing
-            for (const auto & func : frontQueue_) backQueue_.push_back(func);
-            frontQueue_.clear();
+            // Anything queued after this point will wait for the next call to Dispatch
+            numQueued_.fetch_sub(numQueued);
+            numToProcess_ = numQueued;
 
             // Signal ready for processing
             processing_.store(true);
         }
 
+        // Wake up the private thread if it's parked
+        if (ownsExecutionContext_) workParker_.NotifyOne();
+
         // If we don't own the context, use the current thread
         if (!ownsExecutionContext_) {
-            SetCurrentThread(this);
+            // The calling context may already be bound to this thread (see BindToCurrentContext_)
+            const bool bound = *GetCurrentThreadPtr() == this;
+            if (!bound) SetCurrentThread(this);
             ProcessNext_();
-            NullifyCurrentThread();
+            if (!bound) NullifyCurrentThread();
         }
     }
 
@@ -89,28 +97,70 @@ namespace stratus {
         return !processing_.load();
     }
 
+    bool Thread::HasQueuedFunctions() const {
+        return numQueued_.load() > 0;
+    }
+
+    void Thread::SetAdaptiveSpinEnabled(const bool enabled) {
+        workParker_.SetAdaptiveSpinEnabled(enabled);
+        syncParker_.SetAdaptiveSpinEnabled(enabled);
+    }
+
+    ThreadIdleStatistics Thread::GetIdleStatistics() const {
+        return workParker_.GetStatistics();
+    }
+
     void Thread::Dispose() {
         running_.store(false);
-        if (ownsExecutionContext_) context_.join();
+        workParker_.NotifyAll();
+        if (ownsExecutionContext_ && context_.joinable()) context_.join();
     }
 
     void Thread::Synchronize() const {
         // Wait until processing is complete
-        while (processing_.load()) std::this_thread::sleep_for(std::chrono::nanoseconds(1));
+        syncParker_.Wait([this]() { return !processing_.load(); });
     }
 
     void Thread::ProcessNext_() {
         if (processing_.load()) {
-            for (const ThreadFunction & func : backQueue_) func();
-            backQueue_.clear();
+            STRATUS_PROFILE_SCOPE("Thread::Dispatch");
+            const auto start = std::chrono::steady_clock::now();
+            QueuedFunction func;
+            for (size_t remaining = numToProcess_; remaining > 0; ) {
+                if (queue_.Pop(func)) {
+                    func();
+                    func.Reset();
+                    --remaining;
+                }
+                else {
+                    // A producer which queued before us is still in the middle of its push
+                    std::this_thread::yield();
+                }
+            }
+            numToProcess_ = 0;
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            workParker_.RecordBusy(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+
             processing_.store(false); // Signal completion
+            syncParker_.NotifyAll();
         }
         else {
-            // Sleep a bit to prevent hogging CPU core
-            std::this_thread::sleep_for(std::chrono::nanoseconds(1));
+            // Park until the next call to Dispatch or Dispose
+            workParker_.Wait([this]() { return processing_.load() || !running_.load(); });
         }
     }
 
+    void Thread::BindToCurrentContext_() {
+        if (ownsExecutionContext_) {
+            throw std::runtime_error("Attempt to bind a thread which owns its own execution context");
+        }
+        SetCurrentThread(this);
+    }
+
+    void Thread::UnbindFromCurrentContext_() {
+        if (*GetCurrentThreadPtr() == this) NullifyCurrentThread();
+    }
+
     const std::string& Thread::Name() const {
         return name_;
     }
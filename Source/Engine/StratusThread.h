@@ -5,18 +5,164 @@
 #include <atomic>
 #include <mutex>
 #include <shared_mutex>
+#include <condition_variable>
+#include <chrono>
 #include <functional>
 #include <vector>
 #include <unordered_map>
 #include "StratusHandle.h"
+#include "StratusInlineFunction.h"
+#include "StratusMpscQueue.h"
 #include "StratusCommon.h"
 
 namespace stratus {
     class Thread;
+    class TaskSystem;
     typedef Handle<Thread> ThreadHandle;
     typedef std::unique_ptr<Thread> ThreadPtr;
     typedef std::shared_ptr<Thread> ThreadSharedPtr;
 
+    // Snapshot of how a thread (or group of threads) spent its time
+    struct ThreadIdleStatistics {
+        // Time spent executing work
+        uint64_t busyNanoseconds = 0;
+        // Time spent spinning while waiting for work (this uses the CPU)
+        uint64_t spinNanoseconds = 0;
+        // Time spent parked while waiting for work (this does not use the CPU)
+        uint64_t parkedNanoseconds = 0;
+        // Number of waits which ended during the spin phase vs after parking
+        uint64_t spinWakeups = 0;
+        uint64_t parkedWakeups = 0;
+
+        // Fraction of total time spent burning CPU without doing any work. Close to 0
+        // means idle threads are not competing with anything else for the CPU.
+        double IdleCpuRatio() const {
+            const double total = double(busyNanoseconds + spinNanoseconds + parkedNanoseconds);
+            return total > 0.0 ? double(spinNanoseconds) / total : 0.0;
+        }
+    };
+
+    // Blocks the calling thread until a predicate becomes true. Before blocking on a condition
+    // variable it optionally spins for a short amount of time since waking a parked thread costs
+    // far more than a few microseconds of spinning. The spin duration adapts: it grows when work
+    // tends to arrive during the spin and shrinks when it doesn't.
+    //
+    // Whatever state the predicate reads must be made visible (seq_cst atomics or under Mutex())
+    // before calling NotifyOne/NotifyAll.
+    class ThreadParker {
+    public:
+        static constexpr uint64_t MinSpinNanoseconds = 1000;
+        static constexpr uint64_t MaxSpinNanoseconds = 50000;
+
+        ThreadParker(const bool adaptiveSpin = true)
+            : adaptiveSpin_(adaptiveSpin) {}
+
+        ThreadParker(const ThreadParker&) = delete;
+        ThreadParker(ThreadParker&&) = delete;
+        ThreadParker& operator=(const ThreadParker&) = delete;
+        ThreadParker& operator=(ThreadParker&&) = delete;
+
+        template<typename Predicate>
+        void Wait(const Predicate& ready) {
+            typedef std::chrono::steady_clock Clock;
+            auto start = Clock::now();
+
+            if (adaptiveSpin_.load(std::memory_order_relaxed)) {
+                const uint64_t spinLimit = spinNanoseconds_.load(std::memory_order_relaxed);
+                const auto deadline = start + std::chrono::nanoseconds(spinLimit);
+                while (true) {
+                    if (ready()) {
+                        RecordElapsed_(spinTotal_, start);
+                        spinWakeups_.fetch_add(1, std::memory_order_relaxed);
+                        spinNanoseconds_.store(std::min<uint64_t>(spinLimit * 2, MaxSpinNanoseconds), std::memory_order_relaxed);
+                        return;
+                    }
+                    if (Clock::now() >= deadline) break;
+                    std::this_thread::yield();
+                }
+                RecordElapsed_(spinTotal_, start);
+                spinNanoseconds_.store(std::max<uint64_t>(spinLimit / 2, MinSpinNanoseconds), std::memory_order_relaxed);
+                start = Clock::now();
+            }
+
+            {
+                const uint64_t startNanoseconds = NowNanoseconds_();
+                std::unique_lock<std::mutex> ul(mutex_);
+                numParked_.fetch_add(1);
+                parkStartSum_.fetch_add(startNanoseconds);
+                condition_.wait(ul, ready);
+                parkStartSum_.fetch_sub(startNanoseconds);
+                numParked_.fetch_sub(1);
+            }
+            RecordElapsed_(parkedTotal_, start);
+            parkedWakeups_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void NotifyOne() {
+            if (numParked_.load() == 0) return;
+            std::unique_lock<std::mutex> ul(mutex_);
+            condition_.notify_one();
+        }
+
+        void NotifyAll() {
+            if (numParked_.load() == 0) return;
+            std::unique_lock<std::mutex> ul(mutex_);
+            condition_.notify_all();
+        }
+
+        void SetAdaptiveSpinEnabled(const bool enabled) {
+            adaptiveSpin_.store(enabled);
+        }
+
+        void RecordBusy(const uint64_t nanoseconds) {
+            busyTotal_.fetch_add(nanoseconds, std::memory_order_relaxed);
+        }
+
+        size_t NumParked() const {
+            return numParked_.load();
+        }
+
+        ThreadIdleStatistics GetStatistics() const {
+            ThreadIdleStatistics stats;
+            stats.busyNanoseconds = busyTotal_.load(std::memory_order_relaxed);
+            stats.spinNanoseconds = spinTotal_.load(std::memory_order_relaxed);
+            stats.parkedNanoseconds = parkedTotal_.load(std::memory_order_relaxed);
+            // Include time from waits which are still in progress
+            std::unique_lock<std::mutex> ul(mutex_);
+            const uint64_t inProgress = numParked_.load() * NowNanoseconds_() - parkStartSum_.load();
+            stats.parkedNanoseconds += inProgress;
+            stats.spinWakeups = spinWakeups_.load(std::memory_order_relaxed);
+            stats.parkedWakeups = parkedWakeups_.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        static uint64_t NowNanoseconds_() {
+            const auto now = std::chrono::steady_clock::now().time_since_epoch();
+            return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+        }
+
+        template<typename TimePoint>
+        static void RecordElapsed_(std::atomic<uint64_t>& total, const TimePoint& start) {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            total.fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), std::memory_order_relaxed);
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable condition_;
+        std::atomic<size_t> numParked_{0};
+        // Sum of the start times of all waits currently parked
+        std::atomic<uint64_t> parkStartSum_{0};
+        std::atomic<bool> adaptiveSpin_;
+        std::atomic<uint64_t> spinNanoseconds_{MinSpinNanoseconds};
+        std::atomic<uint64_t> busyTotal_{0};
+        std::atomic<uint64_t> spinTotal_{0};
+        std::atomic<uint64_t> parkedTotal_{0};
+        std::atomic<uint64_t> spinWakeups_{0};
+        std::atomic<uint64_t> parkedWakeups_{0};
+    };
+
     // A stratus thread represents a reusable thread of execution. To use it, small
     // functions should be queued for execution on it, and these functions should have
     // a finite execution time rather than being infinite.
@@ -25,8 +171,12 @@ namespace stratus {
     // until the next call to Dispatch, which happens from outside the thread. This is useful
     // in the sense that the main game loop can keep all thread in-sync to some extent.
     class Thread {
+        friend class TaskSystem;
+
     public:
         typedef std::function<void(void)> ThreadFunction;
+        // Storage used for queued functions - lambdas which capture up to 48 bytes are stored inline
+        typedef InlineFunction<48> QueuedFunction;
 
         // If ownsExecutionContext is true, a new thread will be created to handle the work
         // at each call to Dispatch. If false, whatever thread calls Dispatch will be used to
@@ -42,12 +192,16 @@ namespace stratus {
 
         template<typename E>
         void QueueMany(const E& functions) {
-            std::unique_lock<std::mutex> ul(mutex_);
-            for (auto & func : functions) frontQueue_.push_back(func);
+            for (auto & func : functions) Queue(func);
         }
 
-        void Queue(const ThreadFunction& function) {
-            QueueMany(std::vector<ThreadFunction>{function});
+        // Safe to call from any number of threads at once - this does not take a lock, and it does
+        // not allocate once the queue has warmed up (assuming the function fits in QueuedFunction)
+        template<typename F>
+        void Queue(F&& function) {
+            queue_.Push(QueuedFunction(std::forward<F>(function)));
+            // Only counted once fully pushed so that Dispatch never waits on an incomplete push
+            numQueued_.fetch_add(1);
         }
 
         // Two modes of operation: if ownsExecutionContext was true, functions will be pulled
@@ -60,6 +214,13 @@ namespace stratus {
         // Checks if the thread is ready for the next call to Dispatch meaning it is sitting idle (note that
         // this is more of a hint since another thread could immediately call Dispatch())
         bool Idle() const;
+        // Checks if any functions have been queued which are waiting on the next call to Dispatch
+        bool HasQueuedFunctions() const;
+        // Enables or disables the short spin performed before the thread parks itself while waiting
+        // for the next call to Dispatch (enabled by default)
+        void SetAdaptiveSpinEnabled(const bool);
+        // Time spent working vs waiting for work since the thread was created
+        ThreadIdleStatistics GetIdleStatistics() const;
         // Tells the thread to quit after it finishes executing the last call to Dispatch
         void Dispose();
         // Gets thread name set in constructor (note: not required to be unique)
@@ -75,6 +236,11 @@ namespace stratus {
 
     private:
         void ProcessNext_();
+        // Binds/unbinds this Thread to the calling OS thread so that Current() returns it. This allows
+        // an external executor (see TaskSystem) to drive its own OS thread while still appearing as a
+        // stratus::Thread to everything it runs.
+        void BindToCurrentContext_();
+        void UnbindFromCurrentContext_();
 
     private:
         // May be empty if ownsExecutionContext is false
@@ -87,12 +253,18 @@ namespace stratus {
         const ThreadHandle id_;
         // While true the thread can continue servicing calls to Dispatch
         std::atomic<bool> running_{true};
-        // List of functions to execute on next call to Dispatch
-        std::vector<ThreadFunction> frontQueue_;
-        std::vector<ThreadFunction> backQueue_;
-        // Protects critical section
+        // Functions waiting to execute - Dispatch takes however many have been fully pushed at the time
+        MpscQueue<QueuedFunction> queue_;
+        std::atomic<size_t> numQueued_{0};
+        // Number of functions the current call to Dispatch is responsible for
+        size_t numToProcess_ = 0;
+        // Serializes calls to Dispatch
         mutable std::mutex mutex_;
         // When true it signals to the dispatch thread that it should begin its next batch of work
         std::atomic<bool> processing_{false};
+        // Parks the private thread while waiting for Dispatch
+        ThreadParker workParker_;
+        // Parks callers of Synchronize while waiting for processing to complete
+        mutable ThreadParker syncParker_;
     };
 }
\ No newline at end of file
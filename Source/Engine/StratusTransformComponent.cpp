@@ -1,4 +1,7 @@
 #include "StratusTransformComponent.h"
+#include "StratusTaskSystem.h"
+
+#include <algorithm>
 
 namespace stratus {
     EntityPtr CreateTransformEntity() {
@@ -55,22 +58,15 @@ namespace stratus {
         return transform_;
     }
 
+    const Affine3x4& LocalTransformComponent::GetLocalAffine() const {
+        return affine_;
+    }
+
     void LocalTransformComponent::MarkChangedAndRecalculate_() {
         this->MarkChanged();
-        auto S = glm::mat4(1.0f);
-        matScale(S, scale_);
-        auto R = glm::mat4(1.0f);
-        matInset(R, rotation_); 
-        auto T = glm::mat4(1.0f);
-        matTranslate(T, position_);
-        transform_ = T * R * S;
-        /*
-        glm::mat3 RS = _rotation;
-        matScale(RS, _scale);
-        _transform = glm::mat4(1.0f);
-        matTranslate(_transform, _position);
-        matInset(_transform, RS);
-        */
+        // Equivalent to T * R * S without the two full matrix multiplies
+        affine_ = Affine3x4::FromTRS(scale_, rotation_, position_);
+        affine_.ToMat4(transform_);
     }
 
     const glm::mat4& GlobalTransformComponent::GetGlobalTransform() const {
@@ -82,59 +78,79 @@ namespace stratus {
         transform_ = m;
     }
 
+    void GlobalTransformComponent::SetGlobalTransform_(const Affine3x4& m) {
+        this->MarkChanged();
+        m.ToMat4(transform_);
+    }
+
     TransformProcess::~TransformProcess() {}
 
     void TransformProcess::Process(const double deltaSeconds) {
-        for (auto root : rootNodes_) {
-            ProcessNode_(root);
+        if (hierarchyChanged_) RebuildHierarchy_();
+
+        // Every node's parent is in an earlier level, so the nodes within a level can all run at once
+        auto tasks = INSTANCE(TaskSystem);
+        for (size_t level = 0; level + 1 < levelOffsets_.size(); ++level) {
+            const size_t begin = levelOffsets_[level];
+            const size_t end = levelOffsets_[level + 1];
+            if (tasks != nullptr && (end - begin) >= MinParallelLevelSize) {
+                tasks->ParallelFor(begin, end, ParallelGrainSize, [this](const size_t i) { ProcessNode_(i); });
+            }
+            else {
+                for (size_t i = begin; i < end; ++i) ProcessNode_(i);
+            }
+        }
+
+        if (hasForced_) {
+            std::fill(forced_.begin(), forced_.end(), uint8_t(0));
+            hasForced_ = false;
         }
     }
 
-    void TransformProcess::EntitiesAdded(const std::unordered_set<stratus::EntityPtr>& entities) {
-        for (auto ptr : entities) {
+    void TransformProcess::EntitiesAdded(const EntityList& entities) {
+        for (const auto& ptr : entities) {
             if (IsEntityRelevant_(ptr)) {
-                std::vector<EntityComponent *> components{
-                    ptr->Components().GetComponent<LocalTransformComponent>().component,
-                    ptr->Components().GetComponent<GlobalTransformComponent>().component
-                };
-                
-                components_.insert(std::make_pair(ptr, std::move(components)));
+                const EntityHandle& handle = ptr->GetHandle();
+                if (!entities_.Insert(handle, ptr)) continue;
+                pending_.Insert(handle, ptr);
+                hierarchyChanged_ = true;
 
                 if (ptr->GetParentNode() == nullptr) {
-                    rootNodes_.insert(ptr);
-                    ProcessNode_(ptr);
+                    rootNodes_.Insert(handle, ptr);
                 }
             }
         }
     }
 
-    void TransformProcess::EntitiesRemoved(const std::unordered_set<stratus::EntityPtr>& entities) {
-        for (auto ptr : entities) {
-            rootNodes_.erase(ptr);
-            components_.erase(ptr);
+    void TransformProcess::EntitiesRemoved(const EntityList& entities) {
+        for (const auto& ptr : entities) {
+            const EntityHandle& handle = ptr->GetHandle();
+            rootNodes_.Remove(handle);
+            pending_.Remove(handle);
+            if (entities_.Remove(handle)) hierarchyChanged_ = true;
         }
     }
 
-    void TransformProcess::EntityComponentsAdded(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent *>>& entities) {
-        std::unordered_set<EntityPtr> added;
-        for (auto p : entities) {
+    void TransformProcess::EntityComponentsAdded(const EntityComponentsAddedList& entities) {
+        EntityList added;
+        for (const auto& p : entities) {
             if (IsEntityRelevant_(p.first)) {
-                added.insert(p.first);
+                added.push_back(p.first);
             }
         }
 
         EntitiesAdded(added);
     }
 
-    void TransformProcess::EntityComponentsEnabledDisabled(const std::unordered_set<stratus::EntityPtr>& entities) {
-        std::unordered_set<EntityPtr> added;
-        std::unordered_set<EntityPtr> removed;
-        for (auto ptr : entities) {
+    void TransformProcess::EntityComponentsEnabledDisabled(const EntityList& entities) {
+        EntityList added;
+        EntityList removed;
+        for (const auto& ptr : entities) {
             if (IsEntityRelevant_(ptr)) {
-                added.insert(ptr);
+                added.push_back(ptr);
             }
             else {
-                removed.insert(ptr);
+                removed.push_back(ptr);
             }
         }
 
@@ -142,6 +158,14 @@ namespace stratus {
         EntitiesRemoved(removed);
     }
 
+    EntityComponentMask TransformProcess::GetComponentMask() const {
+        return EntityComponentMask::Of<LocalTransformComponent, GlobalTransformComponent>();
+    }
+
+    EntityComponentAccess TransformProcess::GetComponentAccess() const {
+        return EntityComponentAccess().Reads<LocalTransformComponent>().Writes<GlobalTransformComponent>();
+    }
+
     bool TransformProcess::IsEntityRelevant_(const EntityPtr& e) {
         auto& components = e->Components();
         auto local = components.GetComponent<LocalTransformComponent>();
@@ -151,36 +175,69 @@ namespace stratus {
             global.status == EntityComponentStatus::COMPONENT_ENABLED;
     }
 
-    void TransformProcess::ProcessNode_(const EntityPtr& p) {
-        auto it = components_.find(p);
-        if (it == components_.end()) return;
-
-        bool parentChanged = false;
-        auto parent = p->GetParentNode();
-        GlobalTransformComponent * parentGlobal = nullptr;
-        if (parent != nullptr) {
-            auto itparent = components_.find(parent);
-            if (itparent != components_.end()) {
-                auto local = (LocalTransformComponent *)itparent->second[0];
-                auto global = (GlobalTransformComponent *)itparent->second[1];
-                parentChanged = local->ChangedLastFrame() || global->ChangedThisFrame();
-                parentGlobal = global;
+    void TransformProcess::RebuildHierarchy_() {
+        hierarchyChanged_ = false;
+        nodes_.clear();
+        levelOffsets_.clear();
+        forced_.clear();
+
+        std::vector<EntityPtr> current(rootNodes_.begin(), rootNodes_.end());
+        std::vector<EntityPtr> next;
+        std::vector<int32_t> parents(current.size(), -1);
+        std::vector<int32_t> nextParents;
+        while (current.size() > 0) {
+            levelOffsets_.push_back(nodes_.size());
+            for (size_t i = 0; i < current.size(); ++i) {
+                const auto& ptr = current[i];
+                auto& components = ptr->Components();
+                const int32_t index = int32_t(nodes_.size());
+                nodes_.push_back(Node_{
+                    parents[i],
+                    components.GetComponent<LocalTransformComponent>().component,
+                    components.GetComponent<GlobalTransformComponent>().component
+                });
+                forced_.push_back(pending_.Contains(ptr->GetHandle()) ? 1 : 0);
+
+                // Children of untracked nodes are skipped along with their parent
+                for (const auto& child : ptr->GetChildNodes()) {
+                    if (!entities_.Contains(child->GetHandle())) continue;
+                    next.push_back(child);
+                    nextParents.push_back(index);
+                }
             }
+
+            current.swap(next);
+            parents.swap(nextParents);
+            next.clear();
+            nextParents.clear();
         }
+        levelOffsets_.push_back(nodes_.size());
 
-        auto local = (LocalTransformComponent *)it->second[0];
-        auto global = (GlobalTransformComponent *)it->second[1];
+        globals_.resize(nodes_.size());
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            globals_[i] = Affine3x4::FromMat4(nodes_[i].global->GetGlobalTransform());
+        }
+
+        dirty_.assign(nodes_.size(), 0);
+        hasForced_ = pending_.Size() > 0;
+        pending_.Clear();
+    }
+
+    void TransformProcess::ProcessNode_(const size_t index) {
+        const Node_& node = nodes_[index];
+        const bool parentChanged = node.parent >= 0 && dirty_[node.parent] != 0;
 
         // See if local or parent changed requiring recompute of global transform
-        if (parentChanged || local->ChangedLastFrame()) {
-            global->SetGlobalTransform_(
-                (parentGlobal ? parentGlobal->GetGlobalTransform() : glm::mat4(1.0f)) * local->GetLocalTransform()
-            );
-        }
+        const bool changed = parentChanged || forced_[index] != 0 || node.local->ChangedLastFrame();
+        dirty_[index] = changed ? 1 : 0;
+        if (!changed) return;
 
-        // Process each child node recursively
-        for (auto c : p->GetChildNodes()) {
-            ProcessNode_(c);
+        if (node.parent >= 0) {
+            globals_[index] = globals_[node.parent] * node.local->GetLocalAffine();
+        }
+        else {
+            globals_[index] = node.local->GetLocalAffine();
         }
+        node.global->SetGlobalTransform_(globals_[index]);
     }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "StratusEntityProcess.h"
 #include "StratusUtils.h"
 #include "StratusMath.h"
+#include "StratusAffine.h"
 
 #include <unordered_map>
 #include <unordered_set>
@@ -36,6 +37,8 @@ namespace stratus {
         void SetLocalTransform(const glm::vec3& scale, const glm::mat3& rot, const glm::vec3& position);
 
         const glm::mat4& GetLocalTransform() const;
+        // Same transform as GetLocalTransform
+        const Affine3x4& GetLocalAffine() const;
 
     private:
         void MarkChangedAndRecalculate_();
@@ -45,6 +48,7 @@ namespace stratus {
         glm::mat3 rotation_ = glm::mat3(1.0f);
         glm::vec3 position_ = glm::vec3(0.0f);
         glm::mat4 transform_ = glm::mat4(1.0f);
+        Affine3x4 affine_;
     };
 
     ENTITY_COMPONENT_STRUCT(GlobalTransformComponent)
@@ -57,6 +61,7 @@ namespace stratus {
 
     private:
         void SetGlobalTransform_(const glm::mat4&);
+        void SetGlobalTransform_(const Affine3x4&);
 
     private:
         glm::mat4 transform_ = glm::mat4(1.0f);
@@ -70,24 +75,56 @@ namespace stratus {
         std::vector<glm::mat4> transforms;
     };
 
+    // Propagates local transforms down the entity tree. The hierarchy is flattened into an array sorted by
+    // depth (parents always come before their children) which is only rebuilt when the tree changes. Each
+    // level is then updated in parallel, and nodes whose local transform and parent are unchanged are skipped.
     class TransformProcess : public EntityProcess {
         virtual ~TransformProcess();
 
         void Process(const double deltaSeconds) override;
-        void EntitiesAdded(const std::unordered_set<stratus::EntityPtr>&) override;
-        void EntitiesRemoved(const std::unordered_set<stratus::EntityPtr>&) override;
-        void EntityComponentsAdded(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent *>>&) override;
-        void EntityComponentsEnabledDisabled(const std::unordered_set<stratus::EntityPtr>&) override;
+        void EntitiesAdded(const EntityList&) override;
+        void EntitiesRemoved(const EntityList&) override;
+        void EntityComponentsAdded(const EntityComponentsAddedList&) override;
+        void EntityComponentsEnabledDisabled(const EntityList&) override;
+        EntityComponentMask GetComponentMask() const override;
+        EntityComponentAccess GetComponentAccess() const override;
+
+    public:
+        // Levels with fewer nodes than this are processed on the calling thread
+        static constexpr size_t MinParallelLevelSize = 1024;
+        static constexpr size_t ParallelGrainSize = 256;
+
+    private:
+        struct Node_ {
+            // Index into nodes_, or -1 for roots
+            int32_t parent;
+            LocalTransformComponent * local;
+            GlobalTransformComponent * global;
+        };
 
     private:
         static bool IsEntityRelevant_(const EntityPtr&);
 
     private:
-        void ProcessNode_(const EntityPtr& p);
+        void RebuildHierarchy_();
+        void ProcessNode_(const size_t index);
 
     private:
-        std::unordered_set<EntityPtr> rootNodes_;
-        // For quick access without needing to query the entity
-        std::unordered_map<EntityPtr, std::vector<EntityComponent *>> components_;
+        SparseHandleMap<EntityPtr, Entity> rootNodes_;
+        // Entities with both transform components enabled
+        SparseHandleMap<EntityPtr, Entity> entities_;
+        // Entities which haven't had their global transform computed yet
+        SparseHandleMap<EntityPtr, Entity> pending_;
+        bool hierarchyChanged_ = false;
+        // Flattened hierarchy sorted by depth - level i is [levelOffsets_[i], levelOffsets_[i + 1])
+        std::vector<Node_> nodes_;
+        std::vector<size_t> levelOffsets_;
+        // Global transform of each node - kept here so children don't need to convert their parent's glm::mat4
+        std::vector<Affine3x4> globals_;
+        // Set if a node's global transform was recomputed this frame
+        std::vector<uint8_t> dirty_;
+        // Forces nodes to be recomputed the first time they're processed
+        std::vector<uint8_t> forced_;
+        bool hasForced_ = false;
     };
 }
\ No newline at end of file
@@ -57,7 +57,8 @@ namespace stratus {
 
     Window::Window() : Window(1920, 1080) {}
     
-    Window::Window(uint32_t width, uint32_t height) {
+    Window::Window(uint32_t width, uint32_t height, const bool headless)
+        : headless_(headless) {
         SetWindowDims(width, height);
     }
 
@@ -66,6 +67,11 @@ namespace stratus {
         // graphics backend to some extent
         CHECK_IS_APPLICATION_THREAD();
 
+        if (headless_) {
+            STRATUS_LOG << "Running headless - skipping SDL window creation" << std::endl;
+            return true;
+        }
+
         STRATUS_LOG << "Initializing SDL video" << std::endl;
         if (SDL_Init(SDL_INIT_VIDEO) != 0) {
             STRATUS_ERROR << "Unable to initialize sdl2" << std::endl;
@@ -97,11 +103,18 @@ namespace stratus {
         resized_ = false;
         if (width_ != prevWidth_ || height_ != prevHeight_) {
             resized_ = true;
-            SDL_SetWindowSize(window_, width_, height_);
+            if (!headless_) SDL_SetWindowSize(window_, width_, height_);
         }
         prevWidth_ = width_;
         prevHeight_ = height_;
 
+        // No window means no input events
+        if (headless_) {
+            std::vector<SDL_Event> inputEvents;
+            InputManager::Instance()->SetInputData_(inputEvents, mouse_);
+            return SystemStatus::SYSTEM_CONTINUE;
+        }
+
         // Collect window input events
         std::vector<SDL_Event> inputEvents;
         SDL_Event e;
@@ -52,7 +52,8 @@ namespace stratus {
 
     SYSTEM_MODULE_CLASS(Window)
     private:
-        Window(uint32_t width, uint32_t height);
+        // A headless window never touches SDL - it only tracks dimensions
+        Window(uint32_t width, uint32_t height, const bool headless = false);
 
         bool Initialize() override;
         SystemStatus Update(const double deltaSeconds) override;
@@ -71,12 +72,13 @@ namespace stratus {
 
     private:
         mutable std::shared_mutex m_;
-        SDL_Window * window_;
-        MouseState mouse_;
+        SDL_Window * window_ = nullptr;
+        MouseState mouse_ = MouseState{0, 0, 0};
         uint32_t width_ = 0;
         uint32_t height_ = 0;
         uint32_t prevWidth_ = 0;
         uint32_t prevHeight_ = 0;
         bool resized_ = false;
+        bool headless_ = false;
     };
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+namespace stratus {
+    // Chase-Lev work stealing deque. The thread which owns the deque pushes and pops from
+    // the bottom (LIFO) while any other thread is allowed to steal from the top (FIFO).
+    //
+    // Only trivially copyable elements are supported (in practice this is meant for pointers)
+    // since a thief can read a slot before finding out that it lost the race for it.
+    //
+    // See "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Nardelli)
+    template<typename E>
+    class WorkStealingDeque {
+        static_assert(std::is_trivially_copyable<E>::value);
+
+        // Circular buffer whose capacity is always a power of 2
+        struct Array_ {
+            Array_(const int64_t capacity)
+                : capacity(capacity), mask(capacity - 1), data(new std::atomic<E>[capacity]) {}
+
+            E Get(const int64_t index) const {
+                return data[index & mask].load(std::memory_order_relaxed);
+            }
+
+            void Put(const int64_t index, const E& elem) {
+                data[index & mask].store(elem, std::memory_order_relaxed);
+            }
+
+            const int64_t capacity;
+            const int64_t mask;
+            std::unique_ptr<std::atomic<E>[]> data;
+        };
+
+    public:
+        WorkStealingDeque(const int64_t initialCapacity = 1024) {
+            int64_t capacity = 1;
+            while (capacity < initialCapacity) capacity <<= 1;
+            arrays_.push_back(std::make_unique<Array_>(capacity));
+            array_.store(arrays_.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque(WorkStealingDeque&&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+        ~WorkStealingDeque() = default;
+
+        // Owner thread only
+        void Push(const E& elem) {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            const int64_t top = top_.load(std::memory_order_acquire);
+            Array_ * array = array_.load(std::memory_order_relaxed);
+            if (bottom - top > array->capacity - 1) {
+                array = Grow_(array, bottom, top);
+            }
+            array->Put(bottom, elem);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // Owner thread only - returns false if the deque was empty
+        bool Pop(E& out) {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            Array_ * array = array_.load(std::memory_order_relaxed);
+            bottom_.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = top_.load(std::memory_order_relaxed);
+
+            bool success = false;
+            if (top <= bottom) {
+                out = array->Get(bottom);
+                success = true;
+                // Last element - race against thieves for it
+                if (top == bottom) {
+                    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                        success = false;
+                    }
+                    bottom_.store(bottom + 1, std::memory_order_relaxed);
+                }
+            }
+            else {
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return success;
+        }
+
+        // Any thread - returns false if the deque was empty or another thread won the race
+        bool Steal(E& out) {
+            int64_t top = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = bottom_.load(std::memory_order_acquire);
+            if (top >= bottom) return false;
+
+            Array_ * array = array_.load(std::memory_order_acquire);
+            E elem = array->Get(top);
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return false;
+            }
+
+            out = elem;
+            return true;
+        }
+
+        // Approximate when called from a thread other than the owner
+        size_t Size() const {
+            const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            const int64_t top = top_.load(std::memory_order_relaxed);
+            return bottom > top ? size_t(bottom - top) : 0;
+        }
+
+        bool Empty() const {
+            return Size() == 0;
+        }
+
+    private:
+        Array_ * Grow_(Array_ * old, const int64_t bottom, const int64_t top) {
+            auto array = std::make_unique<Array_>(old->capacity * 2);
+            for (int64_t i = top; i < bottom; ++i) {
+                array->Put(i, old->Get(i));
+            }
+            Array_ * result = array.get();
+            // Old arrays are kept alive until destruction since thieves may still be reading from them
+            arrays_.push_back(std::move(array));
+            array_.store(result, std::memory_order_release);
+            return result;
+        }
+
+    private:
+        alignas(64) std::atomic<int64_t> top_{0};
+        alignas(64) std::atomic<int64_t> bottom_{0};
+        std::atomic<Array_ *> array_;
+        // Only modified by the owner thread
+        std::vector<std::unique_ptr<Array_>> arrays_;
+    };
+}
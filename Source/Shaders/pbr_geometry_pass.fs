@@ -78,11 +78,16 @@ vec4 calculateStructureOutput(float z) {
 // }
 
 vec3 calculateNormal(in Material material, in vec2 texCoords) {
-    vec3 normal = texture(material.normalMap, texCoords).rgb;
     // Normals generally have values from [-1, 1], but inside
     // an OpenGL texture they are transformed to [0, 1]. To convert
     // them back, we multiply by 2 and subtract 1.
-    normal = normalize(normal * 2.0 - vec3(1.0)); // [0, 1] -> [-1, 1]
+    //
+    // Only x and y are read since cooked normal maps (BC5) drop z. Tangent space
+    // normals always point out of the surface so z can be rebuilt from them.
+    vec3 normal;
+    normal.xy = texture(material.normalMap, texCoords).rg * 2.0 - vec2(1.0); // [0, 1] -> [-1, 1]
+    normal.z = sqrt(max(1.0 - dot(normal.xy, normal.xy), 0.0));
+    normal = normalize(normal);
     // fsTbnMatrix goes from tangent space (defined by coordinate system of normal map)
     // to object space, and then model no translate moves to world space without translating
     normal = normalize(fsTbnMatrix * normal);
@@ -0,0 +1,107 @@
+#include <vector>
+
+#include "StratusPoolAllocator.h"
+#include "StratusStackAllocator.h"
+#include "Benchmark.h"
+
+// Roughly the size of a small component
+struct AllocatorPayload {
+    float values[16];
+};
+
+// Allocates Arg() objects and then frees all of them
+static void PoolAllocatorAllocate(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    stratus::PoolAllocator<AllocatorPayload> allocator;
+    std::vector<AllocatorPayload *> ptrs(count);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < count; ++i) ptrs[i] = allocator.AllocateConstruct();
+        for (size_t i = 0; i < count; ++i) allocator.DestroyDeallocate(ptrs[i]);
+        stratus::benchmark::DoNotOptimize(ptrs.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+static void ConcurrentPoolAllocatorAllocate(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    stratus::ConcurrentPoolAllocator<AllocatorPayload> allocator;
+    std::vector<AllocatorPayload *> ptrs(count);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < count; ++i) ptrs[i] = allocator.AllocateConstruct();
+        for (size_t i = 0; i < count; ++i) allocator.DestroyDeallocate(ptrs[i]);
+        stratus::benchmark::DoNotOptimize(ptrs.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+// What components are allocated with
+static void ThreadCachedPoolAllocatorAllocate(stratus::benchmark::State& state) {
+    typedef stratus::ThreadCachedPoolAllocator<AllocatorPayload> Allocator;
+    const size_t count = size_t(state.Arg());
+    std::vector<AllocatorPayload *> ptrs(count);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < count; ++i) ptrs[i] = Allocator::AllocateConstruct();
+        for (size_t i = 0; i < count; ++i) Allocator::DestroyDeallocate(ptrs[i]);
+        stratus::benchmark::DoNotOptimize(ptrs.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+// Baseline for the pool allocators
+static void NewDeleteAllocate(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    std::vector<AllocatorPayload *> ptrs(count);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < count; ++i) ptrs[i] = new AllocatorPayload();
+        for (size_t i = 0; i < count; ++i) delete ptrs[i];
+        stratus::benchmark::DoNotOptimize(ptrs.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+static void StackAllocatorAllocate(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    stratus::StackAllocator allocator(count * sizeof(AllocatorPayload));
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < count; ++i) {
+            stratus::benchmark::DoNotOptimize(allocator.Allocate(sizeof(AllocatorPayload)));
+        }
+        allocator.Deallocate();
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+// Builds a vector of Arg() ints per iteration, bulk freeing between iterations like a frame would
+static void StackBasedPoolAllocatorVector(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    // Growing the vector leaves the old buffers on the stack so reserve enough for every reallocation
+    auto allocator = stratus::MakeUnsafe<stratus::StackAllocator>(4 * count * sizeof(int) + 1024);
+    while (state.KeepRunning()) {
+        {
+            std::vector<int, stratus::StackBasedPoolAllocator<int>> vec{stratus::StackBasedPoolAllocator<int>(allocator)};
+            for (size_t i = 0; i < count; ++i) vec.push_back(int(i));
+            stratus::benchmark::DoNotOptimize(vec.data());
+        }
+        allocator->Deallocate();
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+// Baseline for StackBasedPoolAllocator
+static void StdVector(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    while (state.KeepRunning()) {
+        std::vector<int> vec;
+        for (size_t i = 0; i < count; ++i) vec.push_back(int(i));
+        stratus::benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+STRATUS_BENCHMARK("PoolAllocator/Allocate", PoolAllocatorAllocate)->Arg(64)->Arg(4096);
+STRATUS_BENCHMARK("ConcurrentPoolAllocator/Allocate", ConcurrentPoolAllocatorAllocate)->Arg(64)->Arg(4096);
+STRATUS_BENCHMARK("ThreadCachedPoolAllocator/Allocate", ThreadCachedPoolAllocatorAllocate)->Arg(64)->Arg(4096);
+STRATUS_BENCHMARK("NewDelete/Allocate", NewDeleteAllocate)->Arg(64)->Arg(4096);
+STRATUS_BENCHMARK("StackAllocator/Allocate", StackAllocatorAllocate)->Arg(64)->Arg(4096);
+STRATUS_BENCHMARK("StackBasedPoolAllocator/VectorPushBack", StackBasedPoolAllocatorVector)->Arg(64)->Arg(4096);
+STRATUS_BENCHMARK("StdVector/PushBack", StdVector)->Arg(64)->Arg(4096);
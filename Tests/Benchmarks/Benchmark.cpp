@@ -0,0 +1,356 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+namespace stratus {
+namespace benchmark {
+    volatile const void * doNotOptimizeSink_ = nullptr;
+
+    // Function benchmarks stop growing their iteration count here
+    static constexpr uint64_t MaxIterations = 1000000000;
+    // Frame benchmarks warm up for this many frames before measuring and always measure at least MinFrames
+    static constexpr size_t WarmupFrames = 10;
+    static constexpr size_t MinFrames = 60;
+    static constexpr size_t MaxFrames = 100000;
+
+    static std::vector<std::unique_ptr<Benchmark>>& GetRegistry() {
+        static std::vector<std::unique_ptr<Benchmark>> registry;
+        return registry;
+    }
+
+    Benchmark * RegisterBenchmark(const std::string& name, const std::function<void (State&)>& function) {
+        GetRegistry().push_back(std::make_unique<Benchmark>());
+        GetRegistry().back()->name = name;
+        GetRegistry().back()->function = function;
+        return GetRegistry().back().get();
+    }
+
+    Benchmark * RegisterFrameBenchmark(const std::string& name, const std::function<std::unique_ptr<FrameBenchmark> ()>& create) {
+        GetRegistry().push_back(std::make_unique<Benchmark>());
+        GetRegistry().back()->name = name;
+        GetRegistry().back()->createFrameBenchmark = create;
+        return GetRegistry().back().get();
+    }
+
+    static bool StartsWith(const std::string& str, const std::string& prefix) {
+        return str.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    bool Runner::ParseArgs(const int numArgs, const char ** args) {
+        for (int i = 1; i < numArgs; ++i) {
+            const std::string arg(args[i]);
+            const size_t equals = arg.find('=');
+            const std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+
+            if (StartsWith(arg, "--benchmark_filter=")) {
+                options_.filter = value;
+            }
+            else if (StartsWith(arg, "--benchmark_out=")) {
+                options_.out = value;
+            }
+            else if (StartsWith(arg, "--benchmark_repetitions=")) {
+                options_.repetitions = std::max<size_t>(1, size_t(std::stoul(value)));
+            }
+            else if (StartsWith(arg, "--benchmark_min_time=")) {
+                options_.minTime = std::stod(value);
+            }
+            else if (arg == "--benchmark_list_tests") {
+                options_.list = true;
+            }
+            else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                std::cerr << "Supported: --benchmark_filter=<regex> --benchmark_out=<file.json> "
+                          << "--benchmark_repetitions=<n> --benchmark_min_time=<seconds> --benchmark_list_tests" << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<Runner::Instance_> Runner::Instances_(const bool frameBenchmarks) const {
+        const std::regex filter(options_.filter);
+        std::vector<Instance_> instances;
+        for (const auto& benchmark : GetRegistry()) {
+            if ((benchmark->createFrameBenchmark != nullptr) != frameBenchmarks) continue;
+
+            std::vector<int64_t> args = benchmark->args;
+            if (args.size() == 0) args.push_back(0);
+            for (const int64_t arg : args) {
+                const std::string name = benchmark->args.size() == 0 ? benchmark->name : benchmark->name + "/" + std::to_string(arg);
+                if (!std::regex_search(name, filter)) continue;
+                instances.push_back(Instance_{benchmark.get(), name, arg});
+            }
+        }
+        return instances;
+    }
+
+    void Runner::ListBenchmarks() const {
+        for (const auto& instance : Instances_(false)) std::cout << instance.name << std::endl;
+        for (const auto& instance : Instances_(true)) std::cout << instance.name << std::endl;
+    }
+
+    void Runner::RunFunctionBenchmarks() {
+        for (const auto& instance : Instances_(false)) {
+            RunFunctionBenchmark_(instance);
+        }
+    }
+
+    void Runner::RunFunctionBenchmark_(const Instance_& instance) {
+        std::cout << "Running " << instance.name << std::endl;
+
+        std::vector<Result> runs;
+        for (size_t repetition = 0; repetition < options_.repetitions; ++repetition) {
+            // Keep growing the iteration count until a run takes at least minTime
+            uint64_t iterations = 1;
+            while (true) {
+                State state(instance.arg, iterations);
+                instance.benchmark->function(state);
+
+                const double seconds = state.RealNanoseconds() / 1e9;
+                if (seconds >= options_.minTime || iterations >= MaxIterations) {
+                    Result result;
+                    result.name = instance.name;
+                    result.runName = instance.name;
+                    result.runType = "iteration";
+                    result.repetitionIndex = repetition;
+                    result.iterations = state.Iterations();
+                    result.realNanoseconds = state.RealNanoseconds() / double(state.Iterations());
+                    result.cpuNanoseconds = state.CpuNanoseconds() / double(state.Iterations());
+                    result.itemsPerSecond = seconds > 0.0 ? double(state.ItemsProcessed()) / seconds : 0.0;
+                    result.counters = state.Counters();
+                    runs.push_back(result);
+                    break;
+                }
+
+                // Same growth strategy as Google Benchmark
+                const double multiplier = seconds <= options_.minTime / 10.0 ? 10.0 : 1.4 * options_.minTime / seconds;
+                iterations = std::min(MaxIterations, std::max(iterations + 1, uint64_t(double(iterations) * multiplier)));
+            }
+        }
+
+        AddAggregates_(instance.name, runs);
+    }
+
+    static double Percentile(const std::vector<double>& sorted, const double percentile) {
+        const size_t index = size_t(std::ceil(percentile * double(sorted.size()))) - 1;
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    bool Runner::RunFrameBenchmarks() {
+        if (!frameInstancesCollected_) {
+            frameInstances_ = Instances_(true);
+            frameInstancesCollected_ = true;
+        }
+
+        FrameState_& f = frame_;
+        if (f.measuring) {
+            f.frameNanoseconds.push_back(std::chrono::duration<double, std::nano>(Clock::now() - f.lastFrame).count());
+            f.cpuNanoseconds += 1e9 * double(std::clock() - f.lastCpu) / double(CLOCKS_PER_SEC);
+
+            const double total = std::accumulate(f.frameNanoseconds.begin(), f.frameNanoseconds.end(), 0.0);
+            const size_t frames = f.frameNanoseconds.size();
+            if ((frames >= MinFrames && total >= options_.minTime * 1e9) || frames >= MaxFrames) {
+                const Instance_& instance = frameInstances_[f.instance];
+                std::vector<double> sorted = f.frameNanoseconds;
+                std::sort(sorted.begin(), sorted.end());
+
+                Result result;
+                result.name = instance.name;
+                result.runName = instance.name;
+                result.runType = "iteration";
+                result.repetitionIndex = f.repetition;
+                result.iterations = frames;
+                result.realNanoseconds = total / double(frames);
+                result.cpuNanoseconds = f.cpuNanoseconds / double(frames);
+                result.hasPercentiles = true;
+                result.p50Nanoseconds = Percentile(sorted, 0.50);
+                result.p95Nanoseconds = Percentile(sorted, 0.95);
+                result.p99Nanoseconds = Percentile(sorted, 0.99);
+                currentRuns_.push_back(result);
+
+                f.current->Teardown();
+                f.current.reset();
+                f.measuring = false;
+
+                ++f.repetition;
+                if (f.repetition >= options_.repetitions) {
+                    AddAggregates_(instance.name, currentRuns_);
+                    currentRuns_.clear();
+                    f.repetition = 0;
+                    ++f.instance;
+                }
+            }
+        }
+
+        if (f.current == nullptr) {
+            if (f.instance >= frameInstances_.size()) return false;
+
+            const Instance_& instance = frameInstances_[f.instance];
+            if (f.repetition == 0) std::cout << "Running " << instance.name << std::endl;
+            f.current = instance.benchmark->createFrameBenchmark();
+            f.current->Setup(instance.arg);
+            f.warmupFramesLeft = WarmupFrames;
+            f.frameNanoseconds.clear();
+            f.cpuNanoseconds = 0.0;
+        }
+
+        if (f.warmupFramesLeft > 0) {
+            --f.warmupFramesLeft;
+            f.measuring = f.warmupFramesLeft == 0;
+        }
+
+        f.current->Frame();
+        // Frame() itself is not part of the measurement
+        f.lastFrame = Clock::now();
+        f.lastCpu = std::clock();
+        return true;
+    }
+
+    void Runner::AddAggregates_(const std::string& name, const std::vector<Result>& runs) {
+        results_.insert(results_.end(), runs.begin(), runs.end());
+        if (runs.size() < 2) return;
+
+        const auto aggregate = [&name, &runs](const std::string& aggregateName, const std::function<double (std::vector<double>)>& reduce) {
+            const auto collect = [&runs](const std::function<double (const Result&)>& field) {
+                std::vector<double> values;
+                for (const Result& run : runs) values.push_back(field(run));
+                return values;
+            };
+
+            Result result = runs[0];
+            result.name = name + "_" + aggregateName;
+            result.runType = "aggregate";
+            result.aggregateName = aggregateName;
+            result.iterations = runs.size();
+            result.realNanoseconds = reduce(collect([](const Result& r) { return r.realNanoseconds; }));
+            result.cpuNanoseconds = reduce(collect([](const Result& r) { return r.cpuNanoseconds; }));
+            result.itemsPerSecond = reduce(collect([](const Result& r) { return r.itemsPerSecond; }));
+            result.p50Nanoseconds = reduce(collect([](const Result& r) { return r.p50Nanoseconds; }));
+            result.p95Nanoseconds = reduce(collect([](const Result& r) { return r.p95Nanoseconds; }));
+            result.p99Nanoseconds = reduce(collect([](const Result& r) { return r.p99Nanoseconds; }));
+            for (size_t i = 0; i < result.counters.size(); ++i) {
+                result.counters[i].second = reduce(collect([i](const Result& r) {
+                    return i < r.counters.size() ? r.counters[i].second : 0.0;
+                }));
+            }
+            return result;
+        };
+
+        const auto mean = [](std::vector<double> values) {
+            return std::accumulate(values.begin(), values.end(), 0.0) / double(values.size());
+        };
+
+        const auto median = [](std::vector<double> values) {
+            std::sort(values.begin(), values.end());
+            const size_t middle = values.size() / 2;
+            return values.size() % 2 == 0 ? (values[middle - 1] + values[middle]) / 2.0 : values[middle];
+        };
+
+        const auto stddev = [mean](std::vector<double> values) {
+            const double average = mean(values);
+            double sum = 0.0;
+            for (const double value : values) sum += (value - average) * (value - average);
+            return std::sqrt(sum / double(values.size() - 1));
+        };
+
+        results_.push_back(aggregate("mean", mean));
+        results_.push_back(aggregate("median", median));
+        results_.push_back(aggregate("stddev", stddev));
+    }
+
+    static void WriteEscaped(std::ostream& out, const std::string& str) {
+        out << '"';
+        for (const char c : str) {
+            if (c == '"' || c == '\\') out << '\\' << c;
+            else out << c;
+        }
+        out << '"';
+    }
+
+    bool Runner::Report() const {
+        std::cout << std::endl << std::left << std::setw(56) << "Benchmark"
+                  << std::right << std::setw(16) << "Time (ns)"
+                  << std::setw(16) << "CPU (ns)"
+                  << std::setw(14) << "Iterations" << std::endl;
+        std::cout << std::string(102, '-') << std::endl;
+        for (const Result& result : results_) {
+            std::cout << std::left << std::setw(56) << result.name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(16) << result.realNanoseconds
+                      << std::setw(16) << result.cpuNanoseconds
+                      << std::setw(14) << result.iterations;
+            if (result.hasPercentiles) {
+                std::cout << "   p50/p95/p99 " << std::setprecision(3) << result.p50Nanoseconds / 1e6
+                          << "/" << result.p95Nanoseconds / 1e6 << "/" << result.p99Nanoseconds / 1e6 << " ms";
+            }
+            else if (result.itemsPerSecond > 0.0) {
+                std::cout << "   " << std::setprecision(2) << result.itemsPerSecond / 1e6 << "M items/s";
+            }
+            for (const auto& counter : result.counters) {
+                std::cout << "   " << counter.first << "=" << std::setprecision(2) << counter.second;
+            }
+            std::cout << std::endl;
+        }
+
+        std::ofstream out(options_.out, std::ios::out | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Unable to write " << options_.out << std::endl;
+            return false;
+        }
+
+        const std::time_t now = std::time(nullptr);
+        out << std::setprecision(17);
+        out << "{\n  \"context\": {\n";
+        out << "    \"date\": \"" << std::put_time(std::localtime(&now), "%Y-%m-%dT%H:%M:%S") << "\",\n";
+        out << "    \"executable\": \"StratusEngineBenchmarks\",\n";
+        out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#if defined(NDEBUG)
+        out << "    \"library_build_type\": \"release\",\n";
+#else
+        out << "    \"library_build_type\": \"debug\",\n";
+#endif
+        out << "    \"repetitions\": " << options_.repetitions << ",\n";
+        out << "    \"min_time\": " << options_.minTime << "\n";
+        out << "  },\n  \"benchmarks\": [";
+
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& result = results_[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\n";
+            out << "      \"name\": "; WriteEscaped(out, result.name); out << ",\n";
+            out << "      \"run_name\": "; WriteEscaped(out, result.runName); out << ",\n";
+            out << "      \"run_type\": \"" << result.runType << "\",\n";
+            if (result.runType == "aggregate") {
+                out << "      \"aggregate_name\": \"" << result.aggregateName << "\",\n";
+            }
+            out << "      \"repetitions\": " << options_.repetitions << ",\n";
+            out << "      \"repetition_index\": " << result.repetitionIndex << ",\n";
+            out << "      \"iterations\": " << result.iterations << ",\n";
+            out << "      \"real_time\": " << result.realNanoseconds << ",\n";
+            out << "      \"cpu_time\": " << result.cpuNanoseconds << ",\n";
+            if (result.itemsPerSecond > 0.0) {
+                out << "      \"items_per_second\": " << result.itemsPerSecond << ",\n";
+            }
+            for (const auto& counter : result.counters) {
+                out << "      "; WriteEscaped(out, counter.first); out << ": " << counter.second << ",\n";
+            }
+            if (result.hasPercentiles) {
+                out << "      \"p50_time\": " << result.p50Nanoseconds << ",\n";
+                out << "      \"p95_time\": " << result.p95Nanoseconds << ",\n";
+                out << "      \"p99_time\": " << result.p99Nanoseconds << ",\n";
+            }
+            out << "      \"time_unit\": \"ns\"\n    }";
+        }
+
+        out << "\n  ]\n}\n";
+        std::cout << std::endl << "Wrote " << results_.size() << " results to " << options_.out << std::endl;
+        return out.good();
+    }
+}
+}
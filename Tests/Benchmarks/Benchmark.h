@@ -0,0 +1,226 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Small benchmark harness modeled after Google Benchmark. Results are written out as JSON
+// using the same layout as Google Benchmark's --benchmark_out so that existing comparison
+// tooling (e.g. compare.py) can be pointed at two runs.
+//
+// Function benchmarks:
+//
+//      static void PoolAllocate(stratus::benchmark::State& state) {
+//          while (state.KeepRunning()) { ... }
+//      }
+//      STRATUS_BENCHMARK("PoolAllocator/Allocate", PoolAllocate)->Arg(64)->Arg(1024);
+//
+// Frame benchmarks (see FrameBenchmark) time whole headless engine frames instead.
+namespace stratus {
+namespace benchmark {
+    typedef std::chrono::high_resolution_clock Clock;
+
+    class State {
+    public:
+        State(const int64_t arg, const uint64_t maxIterations)
+            : arg_(arg), maxIterations_(maxIterations) {}
+
+        // Returns true until the requested number of iterations has run. Timing starts on the first call.
+        bool KeepRunning() {
+            if (iterations_ == 0) ResumeTiming();
+            if (iterations_ < maxIterations_) {
+                ++iterations_;
+                return true;
+            }
+            PauseTiming();
+            return false;
+        }
+
+        // Argument passed with Benchmark::Arg (0 if there were none)
+        int64_t Arg() const { return arg_; }
+        uint64_t Iterations() const { return iterations_; }
+
+        // Excludes setup and teardown work done inside of the loop
+        void PauseTiming() {
+            if (!running_) return;
+            realNanoseconds_ += std::chrono::duration<double, std::nano>(Clock::now() - realStart_).count();
+            cpuNanoseconds_ += 1e9 * double(std::clock() - cpuStart_) / double(CLOCKS_PER_SEC);
+            running_ = false;
+        }
+
+        void ResumeTiming() {
+            if (running_) return;
+            running_ = true;
+            realStart_ = Clock::now();
+            cpuStart_ = std::clock();
+        }
+
+        // Used to report items per second
+        void SetItemsProcessed(const uint64_t items) { itemsProcessed_ = items; }
+        uint64_t ItemsProcessed() const { return itemsProcessed_; }
+
+        // Extra values reported alongside the timings (e.g. memory usage). Written to the JSON the same
+        // way Google Benchmark writes user counters.
+        void SetCounter(const std::string& name, const double value) {
+            for (auto& counter : counters_) {
+                if (counter.first == name) {
+                    counter.second = value;
+                    return;
+                }
+            }
+            counters_.push_back(std::make_pair(name, value));
+        }
+        const std::vector<std::pair<std::string, double>>& Counters() const { return counters_; }
+
+        double RealNanoseconds() const { return realNanoseconds_; }
+        // Process CPU time, so it includes any worker threads which were busy
+        double CpuNanoseconds() const { return cpuNanoseconds_; }
+
+    private:
+        int64_t arg_;
+        uint64_t maxIterations_;
+        uint64_t iterations_ = 0;
+        uint64_t itemsProcessed_ = 0;
+        std::vector<std::pair<std::string, double>> counters_;
+        bool running_ = false;
+        Clock::time_point realStart_;
+        std::clock_t cpuStart_ = 0;
+        double realNanoseconds_ = 0.0;
+        double cpuNanoseconds_ = 0.0;
+    };
+
+    // Benchmarks which need the engine to run between iterations. Every iteration is one complete
+    // headless engine frame (all engine modules plus the application), measured from one call to
+    // Application::Update to the next.
+    struct FrameBenchmark {
+        virtual ~FrameBenchmark() = default;
+        // Called on the application thread before warming up
+        virtual void Setup(const int64_t arg) = 0;
+        // Called once at the start of every frame
+        virtual void Frame() {}
+        virtual void Teardown() = 0;
+    };
+
+    struct Benchmark {
+        std::string name;
+        std::function<void (State&)> function;
+        std::function<std::unique_ptr<FrameBenchmark> ()> createFrameBenchmark;
+        std::vector<int64_t> args;
+
+        Benchmark * Arg(const int64_t arg) {
+            args.push_back(arg);
+            return this;
+        }
+    };
+
+    Benchmark * RegisterBenchmark(const std::string& name, const std::function<void (State&)>& function);
+    Benchmark * RegisterFrameBenchmark(const std::string& name, const std::function<std::unique_ptr<FrameBenchmark> ()>& create);
+
+    // Prevents the compiler from optimizing away a value that is never used
+    template<typename T>
+    inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        extern volatile const void * doNotOptimizeSink_;
+        doNotOptimizeSink_ = &value;
+#endif
+    }
+
+    struct Options {
+        // Only benchmarks whose name matches this regex are run
+        std::string filter = ".*";
+        // JSON results file
+        std::string out = "StratusEngineBenchmarks.json";
+        size_t repetitions = 1;
+        // Minimum seconds each benchmark (or each repetition of it) runs for
+        double minTime = 0.5;
+        bool list = false;
+    };
+
+    struct Result {
+        std::string name;
+        std::string runName;
+        // "iteration" or "aggregate"
+        std::string runType;
+        std::string aggregateName;
+        size_t repetitionIndex = 0;
+        uint64_t iterations = 0;
+        // Per iteration
+        double realNanoseconds = 0.0;
+        double cpuNanoseconds = 0.0;
+        double itemsPerSecond = 0.0;
+        std::vector<std::pair<std::string, double>> counters;
+        // Only set for frame benchmarks
+        bool hasPercentiles = false;
+        double p50Nanoseconds = 0.0;
+        double p95Nanoseconds = 0.0;
+        double p99Nanoseconds = 0.0;
+    };
+
+    // Runs every registered benchmark which passes the filter. Function benchmarks all run at once
+    // while frame benchmarks are advanced by one step per engine frame.
+    class Runner {
+    public:
+        // Returns false if an argument wasn't recognized
+        bool ParseArgs(const int numArgs, const char ** args);
+        const Options& GetOptions() const { return options_; }
+
+        void ListBenchmarks() const;
+        void RunFunctionBenchmarks();
+        // Call once per frame - returns false once every frame benchmark has finished
+        bool RunFrameBenchmarks();
+
+        // Prints a summary table and writes the JSON file. Returns false if the file couldn't be written.
+        bool Report() const;
+
+    private:
+        struct Instance_ {
+            const Benchmark * benchmark;
+            std::string name;
+            int64_t arg;
+        };
+
+        struct FrameState_ {
+            size_t instance = 0;
+            size_t repetition = 0;
+            std::unique_ptr<FrameBenchmark> current;
+            size_t warmupFramesLeft = 0;
+            bool measuring = false;
+            Clock::time_point lastFrame;
+            std::clock_t lastCpu = 0;
+            double cpuNanoseconds = 0.0;
+            std::vector<double> frameNanoseconds;
+        };
+
+        std::vector<Instance_> Instances_(const bool frameBenchmarks) const;
+        void RunFunctionBenchmark_(const Instance_&);
+        void AddAggregates_(const std::string& name, const std::vector<Result>& runs);
+
+        Options options_;
+        std::vector<Instance_> frameInstances_;
+        FrameState_ frame_;
+        bool frameInstancesCollected_ = false;
+        std::vector<Result> results_;
+        std::vector<Result> currentRuns_;
+    };
+}
+}
+
+#define STRATUS_BENCHMARK_CONCAT_IMPL_(a, b) a##b
+#define STRATUS_BENCHMARK_CONCAT_(a, b) STRATUS_BENCHMARK_CONCAT_IMPL_(a, b)
+
+#define STRATUS_BENCHMARK(name, function)                                                           \
+    static stratus::benchmark::Benchmark * STRATUS_BENCHMARK_CONCAT_(benchmark_, __LINE__) =       \
+        stratus::benchmark::RegisterBenchmark(name, function)
+
+#define STRATUS_FRAME_BENCHMARK(name, type)                                                         \
+    static stratus::benchmark::Benchmark * STRATUS_BENCHMARK_CONCAT_(benchmark_, __LINE__) =       \
+        stratus::benchmark::RegisterFrameBenchmark(name, []() {                                     \
+            return std::unique_ptr<stratus::benchmark::FrameBenchmark>(new type());                 \
+        })
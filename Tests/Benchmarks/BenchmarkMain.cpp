@@ -0,0 +1,58 @@
+#include <iostream>
+#include <vector>
+
+#include "StratusEngine.h"
+#include "StratusApplication.h"
+#include "StratusLog.h"
+#include "Benchmark.h"
+
+static stratus::benchmark::Runner runner;
+
+// Function benchmarks run on the first frame once every engine module is up. Frame benchmarks
+// then take over and the engine shuts down once the last one finishes.
+class BenchmarkApplication : public stratus::Application {
+public:
+    virtual ~BenchmarkApplication() = default;
+
+    const char * GetAppName() const override {
+        return "StratusEngineBenchmarks";
+    }
+
+    virtual bool Initialize() override {
+        // Frame benchmarks measure how fast frames can go, not the frame limiter
+        INSTANCE(Engine)->SetMaxFrameRate(1000000);
+        return true; // success
+    }
+
+    virtual stratus::SystemStatus Update(const double deltaSeconds) override {
+        if (!ranFunctionBenchmarks_) {
+            runner.RunFunctionBenchmarks();
+            ranFunctionBenchmarks_ = true;
+        }
+
+        if (runner.RunFrameBenchmarks()) return stratus::SystemStatus::SYSTEM_CONTINUE;
+        return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+    }
+
+    virtual void Shutdown() override {
+        STRATUS_LOG << "Benchmarks finished" << std::endl;
+    }
+
+private:
+    bool ranFunctionBenchmarks_ = false;
+};
+
+int main(int numArgs, char ** argList) {
+    if (!runner.ParseArgs(numArgs, (const char **)argList)) return 1;
+
+    if (runner.GetOptions().list) {
+        runner.ListBenchmarks();
+        return 0;
+    }
+
+    // Benchmarks always run headless so that results don't depend on the GPU or driver
+    std::vector<const char *> args{ argList[0], "--headless" };
+    STRATUS_INLINE_ENTRY_POINT(BenchmarkApplication, int(args.size()), args.data());
+
+    return runner.Report() ? 0 : 1;
+}
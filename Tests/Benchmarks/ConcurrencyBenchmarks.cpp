@@ -0,0 +1,93 @@
+#include <atomic>
+#include <vector>
+
+#include "StratusConcurrentHashMap.h"
+#include "StratusThread.h"
+#include "StratusTaskSystem.h"
+#include "Benchmark.h"
+
+static void ConcurrentHashMapInsert(stratus::benchmark::State& state) {
+    const int count = int(state.Arg());
+    while (state.KeepRunning()) {
+        stratus::ConcurrentHashMap<int, int> map;
+        for (int i = 0; i < count; ++i) map.Insert(std::make_pair(i, i));
+        stratus::benchmark::DoNotOptimize(map.Size());
+    }
+    state.SetItemsProcessed(state.Iterations() * uint64_t(count));
+}
+
+static void ConcurrentHashMapFind(stratus::benchmark::State& state) {
+    const int count = int(state.Arg());
+    stratus::ConcurrentHashMap<int, int> map;
+    for (int i = 0; i < count; ++i) map.Insert(std::make_pair(i, i));
+
+    while (state.KeepRunning()) {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) sum += map.Find(i)->second;
+        stratus::benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.Iterations() * uint64_t(count));
+}
+
+// Queues Arg() functions onto a thread and waits for all of them to run
+static void ThreadDispatch(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    stratus::Thread thread("BenchmarkThread", true);
+    std::atomic<size_t> executed(0);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < count; ++i) {
+            thread.Queue([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+        }
+        thread.DispatchAndSynchronize();
+    }
+    thread.Dispose();
+    stratus::benchmark::DoNotOptimize(executed.load());
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+// Schedules Arg() tasks and waits for all of them to finish
+static void TaskSystemSchedule(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    std::atomic<size_t> executed(0);
+    while (state.KeepRunning()) {
+        executed.store(0);
+        for (size_t i = 0; i < count; ++i) {
+            INSTANCE(TaskSystem)->ScheduleTask([&executed]() { executed.fetch_add(1); });
+        }
+        INSTANCE(TaskSystem)->Join([&executed, count]() { return executed.load() == count; });
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+// Same as TaskSystem/Schedule without an Async per task
+static void TaskSystemExecute(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    std::atomic<size_t> executed(0);
+    while (state.KeepRunning()) {
+        executed.store(0);
+        for (size_t i = 0; i < count; ++i) {
+            INSTANCE(TaskSystem)->Execute([&executed]() { executed.fetch_add(1); });
+        }
+        INSTANCE(TaskSystem)->Join([&executed, count]() { return executed.load() == count; });
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+static void TaskSystemParallelFor(stratus::benchmark::State& state) {
+    const size_t count = size_t(state.Arg());
+    std::vector<float> values(count, 1.0f);
+    while (state.KeepRunning()) {
+        INSTANCE(TaskSystem)->ParallelFor(0, count, 0, [&values](const size_t i) {
+            values[i] = values[i] * 0.5f + 1.0f;
+        });
+        stratus::benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * count);
+}
+
+STRATUS_BENCHMARK("ConcurrentHashMap/Insert", ConcurrentHashMapInsert)->Arg(1024)->Arg(65536);
+STRATUS_BENCHMARK("ConcurrentHashMap/Find", ConcurrentHashMapFind)->Arg(1024)->Arg(65536);
+STRATUS_BENCHMARK("Thread/Dispatch", ThreadDispatch)->Arg(1)->Arg(1024);
+STRATUS_BENCHMARK("TaskSystem/Schedule", TaskSystemSchedule)->Arg(1)->Arg(1024);
+STRATUS_BENCHMARK("TaskSystem/Execute", TaskSystemExecute)->Arg(1)->Arg(1024);
+STRATUS_BENCHMARK("TaskSystem/ParallelFor", TaskSystemParallelFor)->Arg(4096)->Arg(1048576);
@@ -0,0 +1,347 @@
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "StratusEngine.h"
+#include "StratusEntityManager.h"
+#include "StratusEntityArchetype.h"
+#include "StratusTransformComponent.h"
+#include "StratusRendererFrontend.h"
+#include "StratusResourceManager.h"
+#include "StratusCamera.h"
+#include "StratusPrefab.h"
+#include "Benchmark.h"
+
+ENTITY_COMPONENT_STRUCT(BenchmarkHealthComponent)
+    BenchmarkHealthComponent() = default;
+    BenchmarkHealthComponent(const BenchmarkHealthComponent&) = default;
+    float health = 100.0f;
+};
+
+ENTITY_COMPONENT_STRUCT(BenchmarkVelocityComponent)
+    BenchmarkVelocityComponent() = default;
+    BenchmarkVelocityComponent(const BenchmarkVelocityComponent&) = default;
+    glm::vec3 velocity = glm::vec3(0.0f);
+};
+
+static std::vector<stratus::EntityPtr> CreateLookupEntities(const size_t count) {
+    std::vector<stratus::EntityPtr> entities;
+    for (size_t i = 0; i < count; ++i) {
+        auto entity = stratus::CreateTransformEntity();
+        entity->Components().AttachComponent<BenchmarkHealthComponent>();
+        entity->Components().AttachComponent<BenchmarkVelocityComponent>();
+        entities.push_back(entity);
+    }
+    return entities;
+}
+
+// Looks up 3 components per entity
+static void GetComponentLookup(stratus::benchmark::State& state) {
+    const auto entities = CreateLookupEntities(size_t(state.Arg()));
+    while (state.KeepRunning()) {
+        float sum = 0.0f;
+        for (const auto& entity : entities) {
+            sum += stratus::GetComponent<BenchmarkHealthComponent>(entity)->health;
+            sum += stratus::GetComponent<BenchmarkVelocityComponent>(entity)->velocity.x;
+            sum += stratus::GetComponent<stratus::GlobalTransformComponent>(entity) != nullptr ? 1.0f : 0.0f;
+        }
+        stratus::benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.Iterations() * entities.size() * 3);
+}
+
+// Same lookups done the way EntityComponentSet used to: build the typeid name, hash it into a
+// per-entity map and dynamic_cast the result. Kept as a baseline for GetComponent.
+template<typename E>
+static E * GetComponentByTypeName(const std::unordered_map<std::string, stratus::EntityComponent *>& components) {
+    const std::string name = ClassName<E>();
+    auto it = components.find(name);
+    return it != components.end() ? dynamic_cast<E *>(it->second) : nullptr;
+}
+
+static void GetComponentByTypeNameLookup(stratus::benchmark::State& state) {
+    const auto entities = CreateLookupEntities(size_t(state.Arg()));
+    std::vector<std::unordered_map<std::string, stratus::EntityComponent *>> tables(entities.size());
+    for (size_t i = 0; i < entities.size(); ++i) {
+        for (const auto& pair : entities[i]->Components().GetAllComponents()) {
+            tables[i].insert(std::make_pair(pair.component->TypeName(), pair.component));
+        }
+    }
+
+    while (state.KeepRunning()) {
+        float sum = 0.0f;
+        for (const auto& table : tables) {
+            sum += GetComponentByTypeName<BenchmarkHealthComponent>(table)->health;
+            sum += GetComponentByTypeName<BenchmarkVelocityComponent>(table)->velocity.x;
+            sum += GetComponentByTypeName<stratus::GlobalTransformComponent>(table) != nullptr ? 1.0f : 0.0f;
+        }
+        stratus::benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.Iterations() * entities.size() * 3);
+}
+
+// Visits every entity with health + velocity - per entity lookups vs an archetype query
+static void GetComponentIterate(stratus::benchmark::State& state) {
+    const auto entities = CreateLookupEntities(size_t(state.Arg()));
+    while (state.KeepRunning()) {
+        for (const auto& entity : entities) {
+            auto health = stratus::GetComponent<BenchmarkHealthComponent>(entity);
+            auto velocity = stratus::GetComponent<BenchmarkVelocityComponent>(entity);
+            if (health == nullptr || velocity == nullptr) continue;
+            velocity->velocity.x += health->health * 0.001f;
+        }
+    }
+    state.SetItemsProcessed(state.Iterations() * entities.size());
+}
+
+static void ArchetypeForEach(stratus::benchmark::State& state) {
+    const auto entities = CreateLookupEntities(size_t(state.Arg()));
+    stratus::ArchetypeStorage storage;
+    for (const auto& entity : entities) storage.Update(entity);
+
+    while (state.KeepRunning()) {
+        storage.ForEach<BenchmarkHealthComponent, BenchmarkVelocityComponent>(
+            [](const stratus::EntityPtr&, BenchmarkHealthComponent * health, BenchmarkVelocityComponent * velocity) {
+                velocity->velocity.x += health->health * 0.001f;
+            }
+        );
+    }
+    state.SetItemsProcessed(state.Iterations() * entities.size());
+}
+
+// Root with 4 children, each with 5 components - roughly what a small loaded model looks like
+static stratus::EntityPtr CreatePropTree() {
+    auto root = stratus::CreateTransformEntity();
+    for (auto& child : CreateLookupEntities(4)) {
+        child->Components().AttachComponent<stratus::StaticObjectComponent>();
+        root->AttachChildNode(child);
+    }
+    return root;
+}
+
+static void EntityCopy(stratus::benchmark::State& state) {
+    const auto root = CreatePropTree();
+    std::vector<stratus::EntityPtr> copies;
+    while (state.KeepRunning()) {
+        for (int64_t i = 0; i < state.Arg(); ++i) copies.push_back(root->Copy());
+        state.PauseTiming();
+        copies.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.Iterations() * state.Arg());
+}
+
+static void PrefabInstantiate(stratus::benchmark::State& state) {
+    const auto prefab = stratus::Prefab::Create(CreatePropTree());
+    while (state.KeepRunning()) {
+        auto instances = prefab->Instantiate(size_t(state.Arg()));
+        state.PauseTiming();
+        instances.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.Iterations() * state.Arg());
+}
+
+STRATUS_BENCHMARK("EntityComponentSet/GetComponent", GetComponentLookup)->Arg(4096);
+STRATUS_BENCHMARK("EntityComponentSet/GetComponentByTypeName", GetComponentByTypeNameLookup)->Arg(4096);
+STRATUS_BENCHMARK("EntityComponentSet/Iterate", GetComponentIterate)->Arg(4096)->Arg(262144);
+STRATUS_BENCHMARK("ArchetypeStorage/ForEach", ArchetypeForEach)->Arg(4096)->Arg(262144);
+STRATUS_BENCHMARK("Entity/Copy", EntityCopy)->Arg(10000);
+STRATUS_BENCHMARK("Prefab/Instantiate", PrefabInstantiate)->Arg(10000);
+
+// EntityManager::Update and TransformProcess are driven by the engine, so these time whole
+// headless frames. Compare against "Engine/EmptyFrame" to see how much the entities add.
+
+struct EmptyFrameBenchmark : public stratus::benchmark::FrameBenchmark {
+    void Setup(const int64_t) override {}
+    void Teardown() override {}
+};
+
+// N entities with only a transform which never change
+struct EntityManagerUpdateBenchmark : public stratus::benchmark::FrameBenchmark {
+    void Setup(const int64_t count) override {
+        for (int64_t i = 0; i < count; ++i) {
+            auto entity = stratus::CreateTransformEntity();
+            INSTANCE(EntityManager)->AddEntity(entity);
+            entities_.push_back(entity);
+        }
+    }
+
+    void Teardown() override {
+        for (const auto& entity : entities_) INSTANCE(EntityManager)->RemoveEntity(entity);
+        entities_.clear();
+    }
+
+private:
+    std::vector<stratus::EntityPtr> entities_;
+};
+
+// Every frame spawns N new transform entities and removes the ones spawned the frame before,
+// so the add/remove notifications dominate
+struct EntityManagerSpawnBenchmark : public stratus::benchmark::FrameBenchmark {
+    void Setup(const int64_t count) override {
+        count_ = size_t(count);
+    }
+
+    void Frame() override {
+        for (const auto& entity : entities_) INSTANCE(EntityManager)->RemoveEntity(entity);
+        entities_.clear();
+        for (size_t i = 0; i < count_; ++i) {
+            auto entity = stratus::CreateTransformEntity();
+            INSTANCE(EntityManager)->AddEntity(entity);
+            entities_.push_back(entity);
+        }
+    }
+
+    void Teardown() override {
+        for (const auto& entity : entities_) INSTANCE(EntityManager)->RemoveEntity(entity);
+        entities_.clear();
+    }
+
+private:
+    size_t count_ = 0;
+    std::vector<stratus::EntityPtr> entities_;
+};
+
+// N roots with ChildrenPerRoot children each. Every root moves every frame so the whole
+// hierarchy has to be recomputed.
+struct TransformPropagateBenchmark : public stratus::benchmark::FrameBenchmark {
+    static constexpr size_t ChildrenPerRoot = 7;
+
+    void Setup(const int64_t count) override {
+        for (int64_t i = 0; i < count; ++i) {
+            auto root = stratus::CreateTransformEntity();
+            for (size_t c = 0; c < ChildrenPerRoot; ++c) {
+                auto child = stratus::CreateTransformEntity();
+                stratus::GetComponent<stratus::LocalTransformComponent>(child)->SetLocalPosition(glm::vec3(float(c), 0.0f, 0.0f));
+                root->AttachChildNode(child);
+            }
+            INSTANCE(EntityManager)->AddEntity(root);
+            roots_.push_back(root);
+        }
+    }
+
+    void Frame() override {
+        ++frame_;
+        for (size_t i = 0; i < roots_.size(); ++i) {
+            auto transform = stratus::GetComponent<stratus::LocalTransformComponent>(roots_[i]);
+            transform->SetLocalPosition(glm::vec3(float(i), float(frame_ % 64), 0.0f));
+        }
+    }
+
+    void Teardown() override {
+        for (const auto& root : roots_) INSTANCE(EntityManager)->RemoveEntity(root);
+        roots_.clear();
+    }
+
+private:
+    std::vector<stratus::EntityPtr> roots_;
+    size_t frame_ = 0;
+};
+
+// Large imported scenes tend to have one of two shapes: deep (San Miguel has groups nested many levels
+// down) or wide (Bistro is mostly a few nodes with thousands of mesh children). Both take N total nodes.
+struct TransformHierarchyBenchmark : public stratus::benchmark::FrameBenchmark {
+    void Teardown() override {
+        for (const auto& root : roots_) INSTANCE(EntityManager)->RemoveEntity(root);
+        roots_.clear();
+        moving_.clear();
+    }
+
+    void Frame() override {
+        ++frame_;
+        for (size_t i = 0; i < moving_.size(); ++i) {
+            auto transform = stratus::GetComponent<stratus::LocalTransformComponent>(moving_[i]);
+            transform->SetLocalPosition(glm::vec3(float(i), float(frame_ % 64), 0.0f));
+        }
+    }
+
+protected:
+    static stratus::EntityPtr CreateNode_(const size_t index) {
+        auto node = stratus::CreateTransformEntity();
+        stratus::GetComponent<stratus::LocalTransformComponent>(node)->SetLocalPosition(glm::vec3(float(index % 16), 1.0f, 0.0f));
+        return node;
+    }
+
+    void AddRoots_() {
+        for (const auto& root : roots_) INSTANCE(EntityManager)->AddEntity(root);
+    }
+
+    std::vector<stratus::EntityPtr> roots_;
+    // Nodes whose local transform changes every frame
+    std::vector<stratus::EntityPtr> moving_;
+    size_t frame_ = 0;
+};
+
+// Chains ChainLength nodes deep. Every root moves so everything is recomputed.
+struct TransformDeepBenchmark : public TransformHierarchyBenchmark {
+    static constexpr size_t ChainLength = 64;
+
+    void Setup(const int64_t count) override {
+        for (size_t i = 0; i < size_t(count) / ChainLength; ++i) {
+            auto root = CreateNode_(0);
+            auto parent = root;
+            for (size_t d = 1; d < ChainLength; ++d) {
+                auto child = CreateNode_(d);
+                parent->AttachChildNode(child);
+                parent = child;
+            }
+            roots_.push_back(root);
+            moving_.push_back(root);
+        }
+        AddRoots_();
+    }
+};
+
+// NumRoots roots sharing N children between them. With MoveRoots everything is recomputed, otherwise
+// only one in every 256 children changes and the rest of the hierarchy should be skipped.
+template<bool MoveRoots>
+struct TransformWideBenchmark : public TransformHierarchyBenchmark {
+    static constexpr size_t NumRoots = 4;
+
+    void Setup(const int64_t count) override {
+        for (size_t i = 0; i < NumRoots; ++i) {
+            auto root = CreateNode_(i);
+            for (size_t c = 0; c < size_t(count) / NumRoots; ++c) {
+                auto child = CreateNode_(c);
+                root->AttachChildNode(child);
+                if (!MoveRoots && (c % 256) == 0) moving_.push_back(child);
+            }
+            roots_.push_back(root);
+            if (MoveRoots) moving_.push_back(root);
+        }
+        AddRoots_();
+    }
+};
+
+// N cubes in view of a camera - includes the renderer frontend's CPU work
+struct RendererFrontendUpdateBenchmark : public stratus::benchmark::FrameBenchmark {
+    void Setup(const int64_t count) override {
+        INSTANCE(RendererFrontend)->SetCamera(stratus::CameraPtr(new stratus::Camera(true, true)));
+        for (int64_t i = 0; i < count; ++i) {
+            auto cube = INSTANCE(ResourceManager)->CreateCube();
+            auto transform = stratus::GetComponent<stratus::LocalTransformComponent>(cube);
+            transform->SetLocalPosition(glm::vec3(float(i % 64) * 3.0f, 0.0f, float(i / 64) * 3.0f));
+            INSTANCE(EntityManager)->AddEntity(cube);
+            cubes_.push_back(cube);
+        }
+    }
+
+    void Teardown() override {
+        for (const auto& cube : cubes_) INSTANCE(EntityManager)->RemoveEntity(cube);
+        cubes_.clear();
+        INSTANCE(RendererFrontend)->SetCamera(nullptr);
+    }
+
+private:
+    std::vector<stratus::EntityPtr> cubes_;
+};
+
+STRATUS_FRAME_BENCHMARK("Engine/EmptyFrame", EmptyFrameBenchmark);
+STRATUS_FRAME_BENCHMARK("EntityManager/Update", EntityManagerUpdateBenchmark)->Arg(1024)->Arg(16384);
+STRATUS_FRAME_BENCHMARK("EntityManager/Spawn", EntityManagerSpawnBenchmark)->Arg(1024)->Arg(16384);
+STRATUS_FRAME_BENCHMARK("TransformProcess/Propagate", TransformPropagateBenchmark)->Arg(128)->Arg(2048);
+STRATUS_FRAME_BENCHMARK("TransformProcess/Deep", TransformDeepBenchmark)->Arg(16384)->Arg(131072);
+STRATUS_FRAME_BENCHMARK("TransformProcess/Wide", TransformWideBenchmark<true>)->Arg(16384)->Arg(131072);
+STRATUS_FRAME_BENCHMARK("TransformProcess/WideMostlyStatic", TransformWideBenchmark<false>)->Arg(16384)->Arg(131072);
+STRATUS_FRAME_BENCHMARK("RendererFrontend/Update", RendererFrontendUpdateBenchmark)->Arg(256)->Arg(4096);
@@ -0,0 +1,201 @@
+#include <random>
+#include <vector>
+
+#include "StratusMath.h"
+#include "StratusAffine.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include "Benchmark.h"
+
+static constexpr size_t NumFrustumTests = 4096;
+
+// Same plane extraction as RendererFrontend
+static std::vector<glm::vec4> MakeFrustumPlanes() {
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 vpt = glm::transpose(projection * view);
+    return std::vector<glm::vec4>{
+        (vpt[3] + vpt[0]),
+        (vpt[3] - vpt[0]),
+        (vpt[3] + vpt[1]),
+        (vpt[3] - vpt[1]),
+        (vpt[3] + vpt[2]),
+        (vpt[3] - vpt[2])
+    };
+}
+
+// Fixed seed so that every run tests the same points (roughly half of which are visible)
+static std::vector<glm::vec3> MakePoints() {
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<float> distribution(-400.0f, 400.0f);
+    std::vector<glm::vec3> points(NumFrustumTests);
+    for (auto& point : points) point = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+    return points;
+}
+
+static void AabbInFrustum(stratus::benchmark::State& state) {
+    const auto planes = MakeFrustumPlanes();
+    std::vector<stratus::GpuAABB> aabbs;
+    for (const auto& point : MakePoints()) {
+        stratus::GpuAABB aabb;
+        aabb.vmin = glm::vec4(point - glm::vec3(2.0f), 1.0f);
+        aabb.vmax = glm::vec4(point + glm::vec3(2.0f), 1.0f);
+        aabbs.push_back(aabb);
+    }
+
+    while (state.KeepRunning()) {
+        size_t visible = 0;
+        for (const auto& aabb : aabbs) visible += stratus::IsAabbInFrustum(aabb, planes) ? 1 : 0;
+        stratus::benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(state.Iterations() * aabbs.size());
+}
+
+static void SphereInFrustum(stratus::benchmark::State& state) {
+    const auto planes = MakeFrustumPlanes();
+    const auto points = MakePoints();
+    while (state.KeepRunning()) {
+        size_t visible = 0;
+        for (const auto& point : points) visible += stratus::IsSphereInFrustum(point, 2.0f, planes) ? 1 : 0;
+        stratus::benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(state.Iterations() * points.size());
+}
+
+static void PointInFrustum(stratus::benchmark::State& state) {
+    const auto planes = MakeFrustumPlanes();
+    const auto points = MakePoints();
+    while (state.KeepRunning()) {
+        size_t visible = 0;
+        for (const auto& point : points) visible += stratus::IsPointInFrustum(point, planes) ? 1 : 0;
+        stratus::benchmark::DoNotOptimize(visible);
+    }
+    state.SetItemsProcessed(state.Iterations() * points.size());
+}
+
+// Random transforms for the affine benchmarks - each glm version is the code path it replaced
+static std::vector<glm::mat4> MakeTransforms(const size_t count) {
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    std::vector<glm::mat4> transforms(count);
+    for (auto& transform : transforms) {
+        const auto rotation = stratus::Rotation(
+            stratus::Degrees(distribution(generator) * 9.0f), stratus::Degrees(distribution(generator) * 9.0f), stratus::Degrees(distribution(generator) * 9.0f)
+        );
+        transform = stratus::Affine3x4::FromTRS(
+            glm::vec3(1.0f + std::abs(distribution(generator))), rotation.asMat3(), glm::vec3(distribution(generator), distribution(generator), distribution(generator))
+        ).ToMat4();
+    }
+    return transforms;
+}
+
+static void Mat4ComposeTRS(stratus::benchmark::State& state) {
+    const glm::vec3 scale(2.0f);
+    const glm::mat3 rotation = stratus::Rotation(stratus::Degrees(30.0f), stratus::Degrees(45.0f), stratus::Degrees(60.0f)).asMat3();
+    std::vector<glm::mat4> out(size_t(state.Arg()));
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            auto S = glm::mat4(1.0f);
+            stratus::matScale(S, scale);
+            auto R = glm::mat4(1.0f);
+            stratus::matInset(R, rotation);
+            auto T = glm::mat4(1.0f);
+            stratus::matTranslate(T, glm::vec3(float(i), 0.0f, 0.0f));
+            out[i] = T * R * S;
+        }
+        stratus::benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * out.size());
+}
+
+static void AffineComposeTRS(stratus::benchmark::State& state) {
+    const glm::vec3 scale(2.0f);
+    const glm::mat3 rotation = stratus::Rotation(stratus::Degrees(30.0f), stratus::Degrees(45.0f), stratus::Degrees(60.0f)).asMat3();
+    std::vector<glm::mat4> out(size_t(state.Arg()));
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            stratus::Affine3x4::FromTRS(scale, rotation, glm::vec3(float(i), 0.0f, 0.0f)).ToMat4(out[i]);
+        }
+        stratus::benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * out.size());
+}
+
+// Every transform is multiplied by the one before it, like a parent/child chain
+static void Mat4Multiply(stratus::benchmark::State& state) {
+    const auto transforms = MakeTransforms(size_t(state.Arg()));
+    std::vector<glm::mat4> out(transforms.size());
+    while (state.KeepRunning()) {
+        for (size_t i = 1; i < transforms.size(); ++i) out[i] = transforms[i - 1] * transforms[i];
+        stratus::benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * (transforms.size() - 1));
+}
+
+static void AffineMultiply(stratus::benchmark::State& state) {
+    std::vector<stratus::Affine3x4> transforms;
+    for (const auto& transform : MakeTransforms(size_t(state.Arg()))) transforms.push_back(stratus::Affine3x4::FromMat4(transform));
+    std::vector<stratus::Affine3x4> out(transforms.size());
+    while (state.KeepRunning()) {
+        for (size_t i = 1; i < transforms.size(); ++i) out[i] = transforms[i - 1] * transforms[i];
+        stratus::benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * (transforms.size() - 1));
+}
+
+static std::vector<stratus::GpuAABB> MakeAabbs() {
+    std::vector<stratus::GpuAABB> aabbs;
+    for (const auto& point : MakePoints()) {
+        stratus::GpuAABB aabb;
+        aabb.vmin = glm::vec4(point - glm::vec3(2.0f), 1.0f);
+        aabb.vmax = glm::vec4(point + glm::vec3(2.0f), 1.0f);
+        aabbs.push_back(aabb);
+    }
+    return aabbs;
+}
+
+// Transforms all 8 corners like RendererFrontend's TransformAabb used to
+static void Mat4TransformAabbCorners(stratus::benchmark::State& state) {
+    const auto aabbs = MakeAabbs();
+    const auto transform = MakeTransforms(1)[0];
+    std::vector<stratus::GpuAABB> out(aabbs.size());
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < aabbs.size(); ++i) {
+            const glm::vec4 vmin = aabbs[i].vmin.ToVec4();
+            const glm::vec4 vmax = aabbs[i].vmax.ToVec4();
+            glm::vec3 lo(std::numeric_limits<float>::max());
+            glm::vec3 hi(-std::numeric_limits<float>::max());
+            for (int corner = 0; corner < 8; ++corner) {
+                const glm::vec3 p = glm::vec3(transform * glm::vec4(
+                    (corner & 1) ? vmax.x : vmin.x, (corner & 2) ? vmax.y : vmin.y, (corner & 4) ? vmax.z : vmin.z, 1.0f
+                ));
+                lo = glm::min(lo, p);
+                hi = glm::max(hi, p);
+            }
+            out[i].vmin = glm::vec4(lo, 1.0f);
+            out[i].vmax = glm::vec4(hi, 1.0f);
+        }
+        stratus::benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * aabbs.size());
+}
+
+static void AffineTransformAabbs(stratus::benchmark::State& state) {
+    const auto aabbs = MakeAabbs();
+    const auto transform = stratus::Affine3x4::FromMat4(MakeTransforms(1)[0]);
+    std::vector<stratus::GpuAABB> out(aabbs.size());
+    while (state.KeepRunning()) {
+        stratus::TransformAabbs(transform, aabbs.data(), out.data(), aabbs.size());
+        stratus::benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * aabbs.size());
+}
+
+STRATUS_BENCHMARK("Math/IsAabbInFrustum", AabbInFrustum);
+STRATUS_BENCHMARK("Math/IsSphereInFrustum", SphereInFrustum);
+STRATUS_BENCHMARK("Math/IsPointInFrustum", PointInFrustum);
+STRATUS_BENCHMARK("Math/Mat4ComposeTRS", Mat4ComposeTRS)->Arg(4096);
+STRATUS_BENCHMARK("Math/Affine3x4ComposeTRS", AffineComposeTRS)->Arg(4096);
+STRATUS_BENCHMARK("Math/Mat4Multiply", Mat4Multiply)->Arg(4096);
+STRATUS_BENCHMARK("Math/Affine3x4Multiply", AffineMultiply)->Arg(4096);
+STRATUS_BENCHMARK("Math/Mat4TransformAabbCorners", Mat4TransformAabbCorners);
+STRATUS_BENCHMARK("Math/Affine3x4TransformAabbs", AffineTransformAabbs);
@@ -0,0 +1,134 @@
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+
+#include "StratusRenderComponents.h"
+#include "StratusMeshCache.h"
+#include "Benchmark.h"
+
+// Builds a (resolution x resolution) quad grid with a bumpy surface so that LOD generation
+// has real work to do. Everything is deterministic so runs can be compared.
+static stratus::MeshPtr CreateGridMesh(const size_t resolution) {
+    stratus::MeshPtr mesh = stratus::Mesh::Create();
+    const size_t verticesPerSide = resolution + 1;
+    for (size_t z = 0; z < verticesPerSide; ++z) {
+        for (size_t x = 0; x < verticesPerSide; ++x) {
+            const float u = float(x) / float(resolution);
+            const float v = float(z) / float(resolution);
+            const float height = 0.05f * std::sin(u * 37.0f) * std::cos(v * 23.0f);
+            mesh->AddVertex(glm::vec3(u, height, v));
+            mesh->AddUV(glm::vec2(u, v));
+            mesh->AddNormal(glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+    }
+
+    for (size_t z = 0; z < resolution; ++z) {
+        for (size_t x = 0; x < resolution; ++x) {
+            const uint32_t i = uint32_t(z * verticesPerSide + x);
+            const uint32_t below = i + uint32_t(verticesPerSide);
+            mesh->AddIndex(i);
+            mesh->AddIndex(below);
+            mesh->AddIndex(i + 1);
+            mesh->AddIndex(i + 1);
+            mesh->AddIndex(below);
+            mesh->AddIndex(below + 1);
+        }
+    }
+
+    return mesh;
+}
+
+// Includes tangent/bitangent generation since the grid doesn't provide them
+static void MeshPackCpuData(stratus::benchmark::State& state) {
+    const size_t resolution = size_t(state.Arg());
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        stratus::MeshPtr mesh = CreateGridMesh(resolution);
+        state.ResumeTiming();
+
+        mesh->PackCpuData();
+
+        state.PauseTiming();
+        stratus::Mesh::Destroy(mesh);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.Iterations() * (resolution + 1) * (resolution + 1));
+}
+
+static void MeshGenerateLODs(stratus::benchmark::State& state) {
+    const size_t resolution = size_t(state.Arg());
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        stratus::MeshPtr mesh = CreateGridMesh(resolution);
+        state.ResumeTiming();
+
+        mesh->GenerateLODs();
+
+        state.PauseTiming();
+        stratus::Mesh::Destroy(mesh);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.Iterations() * resolution * resolution * 2);
+}
+
+// What a model load costs per mesh without the cache: filling in the vertex arrays (a stand-in for
+// reading them out of Assimp, whose own parsing and post-processing is not included) and then
+// packing, bounds and LODs
+static void MeshCookedLoadCold(stratus::benchmark::State& state) {
+    const size_t resolution = size_t(state.Arg());
+    while (state.KeepRunning()) {
+        stratus::MeshPtr mesh = CreateGridMesh(resolution);
+        mesh->ProcessCpuData();
+
+        state.PauseTiming();
+        stratus::Mesh::Destroy(mesh);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.Iterations() * (resolution + 1) * (resolution + 1));
+}
+
+// The same mesh read back from a cooked file. With keepMapped nothing is copied out of the file until
+// the upload, which isn't part of this benchmark.
+static void MeshCookedLoad(stratus::benchmark::State& state, const bool keepMapped) {
+    const size_t resolution = size_t(state.Arg());
+    const std::string file = (std::filesystem::temp_directory_path() / ("StratusBenchmarkGrid" + std::to_string(resolution) + ".smc")).string();
+    const stratus::MeshCacheStamp stamp{"Grid", resolution, 0};
+    {
+        stratus::CookedModel model;
+        model.materials.push_back(stratus::CookedMaterial());
+        model.meshes.push_back(CreateGridMesh(resolution));
+        model.meshes[0]->ProcessCpuData();
+        model.nodes.push_back(stratus::CookedNode{-1, true, {stratus::CookedNodeMesh{0, 0, glm::mat4(1.0f)}}});
+        if (!stratus::MeshCache::Write(file, stamp, 0, model)) {
+            throw std::runtime_error("Unable to write " + file);
+        }
+    }
+
+    while (state.KeepRunning()) {
+        stratus::CookedModel model;
+        if (!stratus::MeshCache::Read(file, stamp, 0, model, keepMapped)) {
+            throw std::runtime_error("Unable to read " + file);
+        }
+
+        state.PauseTiming();
+        model = stratus::CookedModel();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.Iterations() * (resolution + 1) * (resolution + 1));
+
+    std::filesystem::remove(file);
+}
+
+static void MeshCookedLoadCached(stratus::benchmark::State& state) {
+    MeshCookedLoad(state, false);
+}
+
+static void MeshCookedLoadMapped(stratus::benchmark::State& state) {
+    MeshCookedLoad(state, true);
+}
+
+STRATUS_BENCHMARK("Mesh/PackCpuData", MeshPackCpuData)->Arg(32)->Arg(256);
+STRATUS_BENCHMARK("Mesh/GenerateLODs", MeshGenerateLODs)->Arg(32)->Arg(256);
+STRATUS_BENCHMARK("Mesh/CookedLoad/Cold", MeshCookedLoadCold)->Arg(32)->Arg(256);
+STRATUS_BENCHMARK("Mesh/CookedLoad/Cached", MeshCookedLoadCached)->Arg(32)->Arg(256);
+STRATUS_BENCHMARK("Mesh/CookedLoad/Mapped", MeshCookedLoadMapped)->Arg(32)->Arg(256);
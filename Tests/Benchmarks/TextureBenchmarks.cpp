@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "StratusTextureDecodeQueue.h"
+#include "StratusTextureCache.h"
+#include "StratusTaskSystem.h"
+#include "Benchmark.h"
+
+// Decoded bytes which currently exist, along with the peak and the time-weighted average over the load
+class DecodedBytesTracker {
+public:
+    DecodedBytesTracker() : start_(stratus::benchmark::Clock::now()), last_(start_) {}
+
+    void Add(const double bytes) {
+        std::unique_lock<std::mutex> ul(mutex_);
+        Advance_();
+        current_ += bytes;
+        peak_ = std::max(peak_, current_);
+    }
+
+    double Peak() const {
+        std::unique_lock<std::mutex> ul(mutex_);
+        return peak_;
+    }
+
+    double Average() {
+        std::unique_lock<std::mutex> ul(mutex_);
+        Advance_();
+        const double seconds = std::chrono::duration<double>(last_ - start_).count();
+        return seconds > 0.0 ? integral_ / seconds : current_;
+    }
+
+private:
+    void Advance_() {
+        const auto now = stratus::benchmark::Clock::now();
+        integral_ += current_ * std::chrono::duration<double>(now - last_).count();
+        last_ = now;
+    }
+
+    mutable std::mutex mutex_;
+    stratus::benchmark::Clock::time_point start_;
+    stratus::benchmark::Clock::time_point last_;
+    double current_ = 0.0;
+    double peak_ = 0.0;
+    double integral_ = 0.0;
+};
+
+struct DecodedTexture {
+    stratus::TextureHandle handle;
+    std::vector<uint8_t> pixels;
+};
+
+// Stand-in for stbi_load - allocates the whole image up front and then fills in every pixel
+static std::unique_ptr<DecodedTexture> DecodeSyntheticTexture(const stratus::TextureHandle handle, const size_t bytes, DecodedBytesTracker& tracker) {
+    auto texture = std::make_unique<DecodedTexture>();
+    texture->handle = handle;
+    texture->pixels.resize(bytes);
+    tracker.Add(double(bytes));
+
+    uint32_t state = uint32_t(handle.Integer()) | 1;
+    for (size_t i = 0; i + 4 <= bytes; i += 4) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        std::memcpy(&texture->pixels[i], &state, 4);
+    }
+    return texture;
+}
+
+// Loads a scene's worth of RGBA8 textures (512x512 up to 2048x2048) the same way ResourceManager does:
+// decodes run on task threads and this thread uploads whatever is ready once per frame, standing in for the
+// application thread. Arg() is the decode budget in MB, with 0 meaning no budget at all.
+//
+// PeakMB is the most decoded data that existed at once and SteadyMB is the average over the whole load.
+static void TextureDecodeBudget(stratus::benchmark::State& state) {
+    static constexpr size_t numTextures = 48;
+    static constexpr size_t megabyte = 1024 * 1024;
+    static constexpr auto frameTime = std::chrono::milliseconds(8);
+    const size_t sizes[] = {1 * megabyte, 4 * megabyte, 16 * megabyte};
+    const size_t budget = state.Arg() > 0 ? size_t(state.Arg()) * megabyte : std::numeric_limits<size_t>::max();
+
+    std::vector<uint8_t> staging(16 * megabyte);
+    double peak = 0.0;
+    double steady = 0.0;
+    while (state.KeepRunning()) {
+        DecodedBytesTracker tracker;
+        stratus::TextureDecodeQueue queue(budget);
+        std::mutex readyMutex;
+        std::vector<std::unique_ptr<DecodedTexture>> ready;
+
+        for (size_t i = 0; i < numTextures; ++i) {
+            const size_t bytes = sizes[i % 3];
+            const auto handle = stratus::TextureHandle::NextHandle();
+            queue.Submit(handle, bytes, 0, [handle, bytes, &tracker, &readyMutex, &ready]() {
+                INSTANCE(TaskSystem)->Execute([handle, bytes, &tracker, &readyMutex, &ready]() {
+                    auto texture = DecodeSyntheticTexture(handle, bytes, tracker);
+                    std::unique_lock<std::mutex> ul(readyMutex);
+                    ready.push_back(std::move(texture));
+                });
+            });
+        }
+
+        // Uploads only happen once per frame since the application thread spends the rest of it on other work
+        size_t uploaded = 0;
+        auto nextFrame = stratus::benchmark::Clock::now();
+        while (uploaded < numTextures) {
+            std::this_thread::sleep_until(nextFrame);
+            nextFrame += frameTime;
+
+            std::vector<std::unique_ptr<DecodedTexture>> batch;
+            {
+                std::unique_lock<std::mutex> ul(readyMutex);
+                batch.swap(ready);
+            }
+
+            for (auto& texture : batch) {
+                std::memcpy(staging.data(), texture->pixels.data(), texture->pixels.size());
+                stratus::benchmark::DoNotOptimize(staging[texture->pixels.size() - 1]);
+                const auto handle = texture->handle;
+                const double bytes = double(texture->pixels.size());
+                texture.reset();
+                tracker.Add(-bytes);
+                queue.Release(handle);
+                ++uploaded;
+            }
+        }
+
+        peak = std::max(peak, tracker.Peak());
+        steady += tracker.Average();
+    }
+
+    state.SetItemsProcessed(state.Iterations() * numTextures);
+    state.SetCounter("PeakMB", peak / double(megabyte));
+    state.SetCounter("SteadyMB", steady / double(state.Iterations()) / double(megabyte));
+}
+
+STRATUS_BENCHMARK("Texture/DecodeBudget", TextureDecodeBudget)->Arg(0)->Arg(64)->Arg(256);
+
+// Cooks a 1024x1024 texture into a full block compressed mip chain. Arg() is the TextureUsage. Ratio is how
+// much smaller the cooked chain is than the uncompressed RGBA8 level 0 (before the driver adds its own mips).
+static void TextureCook(stratus::benchmark::State& state) {
+    static constexpr uint32_t size = 1024;
+    const auto usage = stratus::TextureUsage(state.Arg());
+
+    std::vector<uint8_t> rgba(size_t(size) * size * 4);
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            uint8_t * pixel = &rgba[(size_t(y) * size + x) * 4];
+            pixel[0] = uint8_t(x);
+            pixel[1] = uint8_t(y);
+            pixel[2] = uint8_t((x ^ y) & 0xFF);
+            pixel[3] = 255;
+        }
+    }
+
+    size_t cookedBytes = 0;
+    while (state.KeepRunning()) {
+        stratus::CookedTexture cooked;
+        stratus::TextureCache::Cook(rgba.data(), size, size, usage, true, cooked);
+        cookedBytes = 0;
+        for (const auto& level : cooked.levels) cookedBytes += level.size();
+        stratus::benchmark::DoNotOptimize(cookedBytes);
+    }
+
+    state.SetItemsProcessed(state.Iterations() * size * size);
+    state.SetCounter("Ratio", double(rgba.size()) / double(std::max<size_t>(1, cookedBytes)));
+}
+
+STRATUS_BENCHMARK("Texture/Cook", TextureCook)->Arg(int(stratus::TextureUsage::COLOR))->Arg(int(stratus::TextureUsage::NORMAL_MAP))->Arg(int(stratus::TextureUsage::SINGLE_CHANNEL));
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <unordered_set>
 #include <random>
+#include <stdexcept>
 
 #include "StratusEngine.h"
 #include "StratusApplication.h"
@@ -12,6 +13,10 @@
 #include "StratusEntityProcess.h"
 #include "StratusEntity.h"
 #include "StratusEntityCommon.h"
+#include "StratusEntityArchetype.h"
+#include "StratusPrefab.h"
+#include "StratusApplicationThread.h"
+#include <atomic>
 
 ENTITY_COMPONENT_STRUCT(ExampleComponent)
     const void * ptr = nullptr;
@@ -77,7 +82,7 @@ TEST_CASE("Stratus Entity Test", "[stratus_entity_test]") {
             STRATUS_LOG << "Process " << deltaSeconds << std::endl;
         }
 
-        void EntitiesAdded(const std::unordered_set<stratus::EntityPtr>& e) override {
+        void EntitiesAdded(const stratus::EntityList& e) override {
             numEntitiesAdded += e.size();
             for (stratus::EntityPtr ptr : e) {
                 ptrs.push_back(ptr);
@@ -100,11 +105,11 @@ TEST_CASE("Stratus Entity Test", "[stratus_entity_test]") {
             }
         }
 
-        void EntitiesRemoved(const std::unordered_set<stratus::EntityPtr>& e) override {
+        void EntitiesRemoved(const stratus::EntityList& e) override {
             numEntitiesRemoved += e.size();
         }
 
-        void EntityComponentsAdded(const std::unordered_map<stratus::EntityPtr, std::vector<stratus::EntityComponent*>>& added) override {
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList& added) override {
             for (auto entry : added) {
                 // Don't process if we've handled it before
                 if (seen.find(entry.first) != seen.end()) continue;
@@ -123,7 +128,7 @@ TEST_CASE("Stratus Entity Test", "[stratus_entity_test]") {
             }
         }
 
-        void EntityComponentsEnabledDisabled(const std::unordered_set<stratus::EntityPtr>& changed) override {
+        void EntityComponentsEnabledDisabled(const stratus::EntityList& changed) override {
             componentsEnabledDisabledCalled = true;
             for (auto ptr : changed) {
                 if (ptr != disabledComponent || 
@@ -191,4 +196,637 @@ TEST_CASE("Stratus Entity Test", "[stratus_entity_test]") {
     REQUIRE(processCalled);
     REQUIRE(componentsEnabledDisabledCalled);
     REQUIRE_FALSE(processRanIntoIssues);
-}
\ No newline at end of file
+}
+
+ENTITY_COMPONENT_STRUCT(SecondExampleComponent)
+    SecondExampleComponent() = default;
+    SecondExampleComponent(const SecondExampleComponent&) = default;
+    int value = 5;
+};
+
+TEST_CASE("Stratus Entity Component Type Id Test", "[stratus_entity_test]") {
+    // Ids are dense, unique per type and the same every time they're asked for
+    REQUIRE(ExampleComponent::STypeId() != SecondExampleComponent::STypeId());
+    REQUIRE(ExampleComponent::STypeId() == stratus::GetComponentTypeId<ExampleComponent>());
+    REQUIRE(ExampleComponent().TypeId() == ExampleComponent::STypeId());
+
+    auto entity = stratus::Entity::Create();
+    REQUIRE(stratus::GetComponent<SecondExampleComponent>(entity) == nullptr);
+
+    // Attach in the opposite order of the ids to make sure lookups don't depend on attach order
+    entity->Components().AttachComponent<SecondExampleComponent>();
+    entity->Components().AttachComponent<ExampleComponent>();
+    entity->Components().AttachComponent<ExampleComponent>();
+
+    REQUIRE(entity->Components().GetAllComponents().size() == 2);
+    REQUIRE(stratus::GetComponent<SecondExampleComponent>(entity)->value == 5);
+    REQUIRE(stratus::GetComponent<ExampleComponent>(entity) != nullptr);
+
+    entity->Components().DisableComponent<SecondExampleComponent>();
+    REQUIRE(stratus::GetComponentStatus<SecondExampleComponent>(entity) == stratus::EntityComponentStatus::COMPONENT_DISABLED);
+    REQUIRE(stratus::GetComponentStatus<ExampleComponent>(entity) == stratus::EntityComponentStatus::COMPONENT_ENABLED);
+
+    auto byName = entity->Components().GetComponentByName(SecondExampleComponent::STypeName());
+    REQUIRE(byName.component == stratus::GetComponent<SecondExampleComponent>(entity));
+    REQUIRE(byName.status == stratus::EntityComponentStatus::COMPONENT_DISABLED);
+
+    auto copy = entity->Copy();
+    REQUIRE(stratus::GetComponent<SecondExampleComponent>(copy) != stratus::GetComponent<SecondExampleComponent>(entity));
+    REQUIRE(stratus::GetComponent<SecondExampleComponent>(copy)->value == 5);
+}
+
+TEST_CASE("Stratus Entity Archetype Storage Test", "[stratus_entity_test]") {
+    stratus::ArchetypeStorage storage;
+
+    std::vector<stratus::EntityPtr> both;
+    std::vector<stratus::EntityPtr> exampleOnly;
+    for (int i = 0; i < 10; ++i) {
+        auto e = stratus::Entity::Create();
+        e->Components().AttachComponent<ExampleComponent>();
+        e->Components().AttachComponent<SecondExampleComponent>();
+        stratus::GetComponent<SecondExampleComponent>(e)->value = i;
+        storage.Update(e);
+        both.push_back(e);
+    }
+    for (int i = 0; i < 5; ++i) {
+        auto e = stratus::Entity::Create();
+        e->Components().AttachComponent<ExampleComponent>();
+        storage.Update(e);
+        exampleOnly.push_back(e);
+    }
+
+    REQUIRE(storage.NumEntities() == 15);
+    REQUIRE(storage.NumArchetypes() == 2);
+    REQUIRE(storage.Count<ExampleComponent>() == 15);
+    REQUIRE(storage.Count<SecondExampleComponent, ExampleComponent>() == 10);
+    REQUIRE(storage.Count<>() == 15);
+
+    int sum = 0;
+    storage.ForEach<SecondExampleComponent, ExampleComponent>([&sum](const stratus::EntityPtr& e, SecondExampleComponent * second, ExampleComponent * example) {
+        REQUIRE(second == stratus::GetComponent<SecondExampleComponent>(e));
+        REQUIRE(example == stratus::GetComponent<ExampleComponent>(e));
+        sum += second->value;
+    });
+    REQUIRE(sum == 45);
+
+    // Removing from the middle keeps the rest of the rows intact
+    storage.Remove(both[3]);
+    REQUIRE_FALSE(storage.Contains(both[3]));
+    sum = 0;
+    storage.ForEach<SecondExampleComponent>([&sum](const stratus::EntityPtr& e, SecondExampleComponent * second) {
+        REQUIRE(second == stratus::GetComponent<SecondExampleComponent>(e));
+        sum += second->value;
+    });
+    REQUIRE(sum == 42);
+
+    // Disabled components don't count so the entity changes archetype
+    both[0]->Components().DisableComponent<SecondExampleComponent>();
+    storage.Update(both[0]);
+    REQUIRE(storage.Count<SecondExampleComponent>() == 8);
+    REQUIRE(storage.Count<ExampleComponent>() == 14);
+
+    exampleOnly[0]->Components().AttachComponent<SecondExampleComponent>();
+    storage.Update(exampleOnly[0]);
+    REQUIRE(storage.Count<SecondExampleComponent>() == 9);
+    REQUIRE(storage.NumEntities() == 14);
+
+    storage.Clear();
+    REQUIRE(storage.NumEntities() == 0);
+    REQUIRE(storage.Count<ExampleComponent>() == 0);
+}
+
+TEST_CASE("Stratus Entity ForEach Test", "[stratus_entity_test]") {
+    static constexpr int numEntities = 5000;
+    static size_t forEachCount;
+    static size_t parallelForEachCount;
+    static bool componentsMatched;
+    static size_t countAfterRemove;
+    forEachCount = 0;
+    parallelForEachCount = 0;
+    componentsMatched = true;
+    countAfterRemove = 0;
+
+    class ForEachTest : public stratus::Application {
+    public:
+        virtual ~ForEachTest() = default;
+
+        const char * GetAppName() const override {
+            return "ForEachTest";
+        }
+
+        bool Initialize() override {
+            for (int i = 0; i < numEntities; ++i) {
+                auto e = stratus::Entity::Create();
+                e->Components().AttachComponent<SecondExampleComponent>();
+                if (i % 2 == 0) e->Components().AttachComponent<ExampleComponent>();
+                INSTANCE(EntityManager)->AddEntity(e);
+                entities.push_back(e);
+            }
+            return true; // success
+        }
+
+        stratus::SystemStatus Update(const double deltaSeconds) override {
+            // EntityManager has already run once by the time the application updates
+            if (INSTANCE(Engine)->FrameCount() == 1) {
+                INSTANCE(EntityManager)->ForEach<SecondExampleComponent>([](const stratus::EntityPtr& e, SecondExampleComponent * c) {
+                    if (c != stratus::GetComponent<SecondExampleComponent>(e)) componentsMatched = false;
+                    ++forEachCount;
+                });
+
+                std::atomic<size_t> count(0);
+                INSTANCE(EntityManager)->ParallelForEach<ExampleComponent, SecondExampleComponent>(
+                    [&count](const stratus::EntityPtr& e, ExampleComponent * example, SecondExampleComponent * second) {
+                        if (example != stratus::GetComponent<ExampleComponent>(e)) componentsMatched = false;
+                        count.fetch_add(1);
+                    }
+                );
+                parallelForEachCount = count.load();
+
+                for (auto& e : entities) INSTANCE(EntityManager)->RemoveEntity(e);
+                return stratus::SystemStatus::SYSTEM_CONTINUE;
+            }
+
+            countAfterRemove = INSTANCE(EntityManager)->Count<SecondExampleComponent>();
+            return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+        }
+
+        void Shutdown() override {
+            entities.clear();
+        }
+
+        std::vector<stratus::EntityPtr> entities;
+    };
+
+    STRATUS_INLINE_ENTRY_POINT(ForEachTest, numArgs, argList);
+
+    REQUIRE(forEachCount == numEntities);
+    REQUIRE(parallelForEachCount == numEntities / 2);
+    REQUIRE(componentsMatched);
+    REQUIRE(countAfterRemove == 0);
+}
+
+TEST_CASE("Stratus Entity Changed Since Test", "[stratus_entity_test]") {
+    static constexpr int numEntities = 1000;
+    static size_t changedCount;
+    static bool oldFrameRejected;
+    static bool componentsMatched;
+    changedCount = 0;
+    oldFrameRejected = false;
+    componentsMatched = true;
+
+    class ChangedSinceTest : public stratus::Application {
+    public:
+        virtual ~ChangedSinceTest() = default;
+
+        const char * GetAppName() const override {
+            return "ChangedSinceTest";
+        }
+
+        bool Initialize() override {
+            for (int i = 0; i < numEntities; ++i) {
+                auto e = stratus::Entity::Create();
+                e->Components().AttachComponent<ExampleComponent>();
+                INSTANCE(EntityManager)->AddEntity(e);
+                entities.push_back(e);
+            }
+            return true; // success
+        }
+
+        stratus::SystemStatus Update(const double deltaSeconds) override {
+            if (INSTANCE(Engine)->FrameCount() == 1) {
+                for (int i = 0; i < numEntities; i += 2) {
+                    // Changing twice in one frame should only be reported once
+                    stratus::GetComponent<ExampleComponent>(entities[i])->MarkChanged();
+                    stratus::GetComponent<ExampleComponent>(entities[i])->MarkChanged();
+                }
+                // Removed entities are skipped
+                INSTANCE(EntityManager)->RemoveEntity(entities[0]);
+                return stratus::SystemStatus::SYSTEM_CONTINUE;
+            }
+
+            const uint64_t since = INSTANCE(Engine)->FrameCount() - 1;
+            INSTANCE(EntityManager)->ForEachChangedSince<ExampleComponent>(since, [](const stratus::EntityPtr& e, ExampleComponent * c) {
+                if (c != stratus::GetComponent<ExampleComponent>(e)) componentsMatched = false;
+                ++changedCount;
+            });
+
+            // Nothing was recorded before the entity manager started
+            oldFrameRejected = !INSTANCE(EntityManager)->ForEachChangedSince<ExampleComponent>(0, [](const stratus::EntityPtr&, ExampleComponent *) {});
+
+            for (auto& e : entities) INSTANCE(EntityManager)->RemoveEntity(e);
+            return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+        }
+
+        void Shutdown() override {
+            entities.clear();
+        }
+
+        std::vector<stratus::EntityPtr> entities;
+    };
+
+    STRATUS_INLINE_ENTRY_POINT(ChangedSinceTest, numArgs, argList);
+
+    REQUIRE(changedCount == numEntities / 2 - 1);
+    REQUIRE(oldFrameRejected);
+    REQUIRE(componentsMatched);
+}
+
+TEST_CASE("Stratus Entity Component Mask Test", "[stratus_entity_test]") {
+    stratus::EntityComponentMask empty;
+    REQUIRE(empty.Empty());
+
+    auto mask = stratus::EntityComponentMask::Of<SecondExampleComponent>();
+    REQUIRE_FALSE(mask.Empty());
+    REQUIRE(mask.Contains(SecondExampleComponent::STypeId()));
+    REQUIRE_FALSE(mask.Contains(ExampleComponent::STypeId()));
+
+    auto entity = stratus::Entity::Create();
+    entity->Components().AttachComponent<ExampleComponent>();
+    REQUIRE_FALSE(mask.Matches(entity->Components()));
+
+    // Disabled components still match so that processes hear about them being disabled
+    entity->Components().AttachComponent<SecondExampleComponent>();
+    entity->Components().DisableComponent<SecondExampleComponent>();
+    REQUIRE(mask.Matches(entity->Components()));
+
+    // Any one of the components is enough
+    mask.Add(ExampleComponent::STypeId());
+    auto other = stratus::Entity::Create();
+    other->Components().AttachComponent<ExampleComponent>();
+    REQUIRE(mask.Matches(other->Components()));
+}
+
+TEST_CASE("Stratus Prefab Test", "[stratus_entity_test]") {
+    static constexpr size_t numInstances = 100;
+
+    auto root = stratus::Entity::Create();
+    root->Components().AttachComponent<ExampleComponent>();
+    for (int i = 0; i < 3; ++i) {
+        auto child = stratus::Entity::Create();
+        child->Components().AttachComponent<SecondExampleComponent>();
+        stratus::GetComponent<SecondExampleComponent>(child)->value = i;
+        root->AttachChildNode(child);
+    }
+    auto grandchild = stratus::Entity::Create();
+    grandchild->Components().AttachComponent<ExampleComponent>();
+    grandchild->Components().AttachComponent<SecondExampleComponent>();
+    grandchild->Components().DisableComponent<SecondExampleComponent>();
+    root->GetChildNodes()[1]->AttachChildNode(grandchild);
+
+    auto prefab = stratus::Prefab::Create(root);
+    REQUIRE(prefab->NumNodes() == 5);
+
+    // Changes to the source after the prefab is created don't show up in instances
+    stratus::GetComponent<SecondExampleComponent>(root->GetChildNodes()[0])->value = 100;
+
+    const auto instances = prefab->Instantiate(numInstances);
+    REQUIRE(instances.size() == numInstances);
+
+    std::unordered_set<const stratus::EntityComponent *> components;
+    for (const auto& instance : instances) {
+        REQUIRE(instance != root);
+        REQUIRE(instance->GetParentNode() == nullptr);
+        REQUIRE_FALSE(instance->IsInWorld());
+        REQUIRE(instance->GetChildNodes().size() == 3);
+        REQUIRE(components.insert(stratus::GetComponent<ExampleComponent>(instance)).second);
+
+        for (int i = 0; i < 3; ++i) {
+            const auto& child = instance->GetChildNodes()[i];
+            REQUIRE(child->GetParentNode() == instance);
+            REQUIRE(stratus::GetComponent<SecondExampleComponent>(child)->value == i);
+            REQUIRE(components.insert(stratus::GetComponent<SecondExampleComponent>(child)).second);
+        }
+
+        const auto& copy = instance->GetChildNodes()[1]->GetChildNodes()[0];
+        REQUIRE(copy->GetParentNode() == instance->GetChildNodes()[1]);
+        REQUIRE(stratus::GetComponentStatus<ExampleComponent>(copy) == stratus::EntityComponentStatus::COMPONENT_ENABLED);
+        REQUIRE(stratus::GetComponentStatus<SecondExampleComponent>(copy) == stratus::EntityComponentStatus::COMPONENT_DISABLED);
+        REQUIRE(copy->Components().GetAllComponents().size() == 2);
+    }
+
+    auto single = prefab->Instantiate();
+    REQUIRE(single->GetChildNodes().size() == 3);
+    REQUIRE(prefab->Instantiate(0).size() == 0);
+}
+
+TEST_CASE("Stratus Entity Component Access Test", "[stratus_entity_test]") {
+    using stratus::EntityComponentAccess;
+
+    const auto readsExample = EntityComponentAccess().Reads<ExampleComponent>();
+    const auto writesExample = EntityComponentAccess().Writes<ExampleComponent>();
+    const auto writesSecond = EntityComponentAccess().Reads<ExampleComponent>().Writes<SecondExampleComponent>();
+
+    // Readers never conflict with each other
+    REQUIRE_FALSE(readsExample.ConflictsWith(readsExample));
+    REQUIRE(readsExample.ConflictsWith(writesExample));
+    REQUIRE(writesExample.ConflictsWith(readsExample));
+    REQUIRE(writesExample.ConflictsWith(writesExample));
+    REQUIRE_FALSE(readsExample.ConflictsWith(writesSecond));
+    REQUIRE(writesExample.ConflictsWith(writesSecond));
+
+    // Declaring nothing conflicts with nothing, while exclusive conflicts with everything
+    REQUIRE_FALSE(EntityComponentAccess().ConflictsWith(writesExample));
+    REQUIRE(EntityComponentAccess::Exclusive().IsExclusive());
+    REQUIRE(EntityComponentAccess::Exclusive().ConflictsWith(EntityComponentAccess()));
+    REQUIRE(EntityComponentAccess().ConflictsWith(EntityComponentAccess::Exclusive()));
+}
+
+TEST_CASE("Stratus Entity Process Schedule Test", "[stratus_entity_test]") {
+    static constexpr uint64_t numFrames = 10;
+    static std::atomic<uint64_t> writerFrame;
+    static std::atomic<bool> readerSawWrite;
+    static std::atomic<bool> exclusiveOnApplicationThread;
+    static std::vector<stratus::EntityProcessTiming> timings;
+    writerFrame = 0;
+    readerSawWrite = true;
+    exclusiveOnApplicationThread = true;
+    timings.clear();
+
+    struct WriterProcess : public stratus::EntityProcess {
+        void Process(const double) override {
+            INSTANCE(EntityManager)->ForEach<SecondExampleComponent>([](const stratus::EntityPtr&, SecondExampleComponent * c) {
+                c->value += 1;
+            });
+            writerFrame.store(stratus::Engine::CurrentFrame());
+        }
+        void EntitiesAdded(const stratus::EntityList&) override {}
+        void EntitiesRemoved(const stratus::EntityList&) override {}
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList&) override {}
+        void EntityComponentsEnabledDisabled(const stratus::EntityList&) override {}
+        stratus::EntityComponentAccess GetComponentAccess() const override {
+            return stratus::EntityComponentAccess().Writes<SecondExampleComponent>();
+        }
+    };
+
+    // Doesn't conflict with the writer so it can run alongside it
+    struct IndependentProcess : public stratus::EntityProcess {
+        void Process(const double) override {}
+        void EntitiesAdded(const stratus::EntityList&) override {}
+        void EntitiesRemoved(const stratus::EntityList&) override {}
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList&) override {}
+        void EntityComponentsEnabledDisabled(const stratus::EntityList&) override {}
+        stratus::EntityComponentAccess GetComponentAccess() const override {
+            return stratus::EntityComponentAccess().Writes<ExampleComponent>();
+        }
+    };
+
+    // Registered after the writer so it has to wait for it
+    struct ReaderProcess : public stratus::EntityProcess {
+        void Process(const double) override {
+            if (writerFrame.load() != stratus::Engine::CurrentFrame()) readerSawWrite = false;
+        }
+        void EntitiesAdded(const stratus::EntityList&) override {}
+        void EntitiesRemoved(const stratus::EntityList&) override {}
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList&) override {}
+        void EntityComponentsEnabledDisabled(const stratus::EntityList&) override {}
+        stratus::EntityComponentAccess GetComponentAccess() const override {
+            return stratus::EntityComponentAccess().Reads<SecondExampleComponent>();
+        }
+    };
+
+    // Doesn't declare its access
+    struct ExclusiveProcess : public stratus::EntityProcess {
+        void Process(const double) override {
+            if (!stratus::ApplicationThread::Instance()->CurrentIsApplicationThread()) exclusiveOnApplicationThread = false;
+        }
+        void EntitiesAdded(const stratus::EntityList&) override {}
+        void EntitiesRemoved(const stratus::EntityList&) override {}
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList&) override {}
+        void EntityComponentsEnabledDisabled(const stratus::EntityList&) override {}
+    };
+
+    class ScheduleTest : public stratus::Application {
+    public:
+        virtual ~ScheduleTest() = default;
+
+        const char * GetAppName() const override {
+            return "ScheduleTest";
+        }
+
+        bool Initialize() override {
+            INSTANCE(EntityManager)->RegisterEntityProcess<WriterProcess>();
+            INSTANCE(EntityManager)->RegisterEntityProcess<IndependentProcess>();
+            INSTANCE(EntityManager)->RegisterEntityProcess<ReaderProcess>();
+            INSTANCE(EntityManager)->RegisterEntityProcess<ExclusiveProcess>();
+            for (int i = 0; i < 100; ++i) {
+                auto e = stratus::Entity::Create();
+                e->Components().AttachComponent<SecondExampleComponent>();
+                INSTANCE(EntityManager)->AddEntity(e);
+                entities.push_back(e);
+            }
+            return true; // success
+        }
+
+        stratus::SystemStatus Update(const double deltaSeconds) override {
+            if (INSTANCE(Engine)->FrameCount() < numFrames) return stratus::SystemStatus::SYSTEM_CONTINUE;
+            timings = INSTANCE(Engine)->GetEntityProcessTimings();
+            for (auto& e : entities) INSTANCE(EntityManager)->RemoveEntity(e);
+            return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+        }
+
+        void Shutdown() override {
+            entities.clear();
+        }
+
+        std::vector<stratus::EntityPtr> entities;
+    };
+
+    STRATUS_INLINE_ENTRY_POINT(ScheduleTest, numArgs, argList);
+
+    REQUIRE(readerSawWrite);
+    REQUIRE(exclusiveOnApplicationThread);
+
+    const auto find = [](const char * name) {
+        for (const auto& timing : timings) {
+            if (std::string(timing.name) == name) return timing;
+        }
+        FAIL("Missing timing for " << name);
+        return stratus::EntityProcessTiming{};
+    };
+
+    const auto writer = find(typeid(WriterProcess).name());
+    const auto independent = find(typeid(IndependentProcess).name());
+    const auto reader = find(typeid(ReaderProcess).name());
+    const auto exclusive = find(typeid(ExclusiveProcess).name());
+    REQUIRE(writer.wave == independent.wave);
+    REQUIRE(reader.wave > writer.wave);
+    REQUIRE(exclusive.wave > reader.wave);
+    for (const auto& timing : timings) {
+        REQUIRE(timing.seconds >= 0.0);
+        // Nothing shares a wave with an exclusive process
+        if (std::string(timing.name) != exclusive.name) REQUIRE(timing.wave != exclusive.wave);
+    }
+}
+
+TEST_CASE("Stratus Entity Process Exception Test", "[stratus_entity_test]") {
+    static constexpr uint64_t throwFrame = 3;
+    static std::atomic<bool> reachedEnd;
+    static std::atomic<bool> applicationShutdown;
+    reachedEnd = false;
+    applicationShutdown = false;
+
+    // Doesn't conflict with the other process so the two share a wave and run on task threads
+    struct ThrowingProcess : public stratus::EntityProcess {
+        void Process(const double) override {
+            if (stratus::Engine::CurrentFrame() == throwFrame) throw std::runtime_error("ThrowingProcess failure");
+        }
+        void EntitiesAdded(const stratus::EntityList&) override {}
+        void EntitiesRemoved(const stratus::EntityList&) override {}
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList&) override {}
+        void EntityComponentsEnabledDisabled(const stratus::EntityList&) override {}
+        stratus::EntityComponentAccess GetComponentAccess() const override {
+            return stratus::EntityComponentAccess().Writes<ExampleComponent>();
+        }
+    };
+
+    struct OtherProcess : public stratus::EntityProcess {
+        void Process(const double) override {}
+        void EntitiesAdded(const stratus::EntityList&) override {}
+        void EntitiesRemoved(const stratus::EntityList&) override {}
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList&) override {}
+        void EntityComponentsEnabledDisabled(const stratus::EntityList&) override {}
+        stratus::EntityComponentAccess GetComponentAccess() const override {
+            return stratus::EntityComponentAccess().Writes<SecondExampleComponent>();
+        }
+    };
+
+    class ExceptionTest : public stratus::Application {
+    public:
+        virtual ~ExceptionTest() = default;
+
+        const char * GetAppName() const override {
+            return "ExceptionTest";
+        }
+
+        bool Initialize() override {
+            INSTANCE(EntityManager)->RegisterEntityProcess<ThrowingProcess>();
+            INSTANCE(EntityManager)->RegisterEntityProcess<OtherProcess>();
+            return true; // success
+        }
+
+        stratus::SystemStatus Update(const double deltaSeconds) override {
+            if (INSTANCE(Engine)->FrameCount() < throwFrame * 2) return stratus::SystemStatus::SYSTEM_CONTINUE;
+            reachedEnd = true;
+            return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+        }
+
+        void Shutdown() override {
+            applicationShutdown = true;
+        }
+    };
+
+    // The exception comes out of the entry point on this thread after the engine has shut down
+    REQUIRE_THROWS_WITH(STRATUS_INLINE_ENTRY_POINT(ExceptionTest, numArgs, argList), "ThrowingProcess failure");
+    REQUIRE_FALSE(reachedEnd);
+    REQUIRE(applicationShutdown);
+}
+
+TEST_CASE("Stratus Entity Process Thread Rules Test", "[stratus_entity_test]") {
+    static constexpr uint64_t numFrames = 10;
+    static constexpr size_t numEntities = 100;
+    static std::vector<stratus::EntityHandle> handles;
+    static std::atomic<size_t> lookupFailures;
+    static std::atomic<size_t> changedSinceCalls;
+    static std::atomic<size_t> changedSinceThrows;
+    static std::atomic<size_t> exclusiveChangedSince;
+    handles.clear();
+    lookupFailures = 0;
+    changedSinceCalls = 0;
+    changedSinceThrows = 0;
+    exclusiveChangedSince = 0;
+
+    // Everything a process which declares its access is allowed to read, wherever it ends up running
+    struct LookupProcess : public stratus::EntityProcess {
+        LookupProcess(const stratus::EntityComponentAccess& access) : access(access) {}
+
+        void Process(const double) override {
+            auto entities = INSTANCE(EntityManager);
+            for (const auto& handle : handles) {
+                if (!entities->ContainsEntity(handle) || entities->GetEntity(handle) == nullptr) ++lookupFailures;
+            }
+            size_t visited = 0;
+            entities->ForEach<SecondExampleComponent>([&visited](const stratus::EntityPtr&, SecondExampleComponent *) { ++visited; });
+            if (visited != numEntities || entities->Count<SecondExampleComponent>() != numEntities) ++lookupFailures;
+            entities->GetProcessTimings();
+
+            ++changedSinceCalls;
+            try {
+                entities->ForEachChangedSince<SecondExampleComponent>(stratus::Engine::CurrentFrame(), [](const stratus::EntityPtr&, SecondExampleComponent *) {});
+            }
+            catch (const std::runtime_error&) {
+                ++changedSinceThrows;
+            }
+        }
+        void EntitiesAdded(const stratus::EntityList&) override {}
+        void EntitiesRemoved(const stratus::EntityList&) override {}
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList&) override {}
+        void EntityComponentsEnabledDisabled(const stratus::EntityList&) override {}
+        stratus::EntityComponentAccess GetComponentAccess() const override {
+            return access;
+        }
+
+        stratus::EntityComponentAccess access;
+    };
+
+    struct ExclusiveProcess : public stratus::EntityProcess {
+        void Process(const double) override {
+            if (INSTANCE(EntityManager)->ForEachChangedSince<SecondExampleComponent>(stratus::Engine::CurrentFrame(), [](const stratus::EntityPtr&, SecondExampleComponent *) {})) {
+                ++exclusiveChangedSince;
+            }
+        }
+        void EntitiesAdded(const stratus::EntityList&) override {}
+        void EntitiesRemoved(const stratus::EntityList&) override {}
+        void EntityComponentsAdded(const stratus::EntityComponentsAddedList&) override {}
+        void EntityComponentsEnabledDisabled(const stratus::EntityList&) override {}
+    };
+
+    class ThreadRulesTest : public stratus::Application {
+    public:
+        virtual ~ThreadRulesTest() = default;
+
+        const char * GetAppName() const override {
+            return "ThreadRulesTest";
+        }
+
+        bool Initialize() override {
+            using stratus::EntityComponentAccess;
+            // The first two share a wave and run on task threads, the third has a wave to itself and so runs
+            // on the application thread
+            INSTANCE(EntityManager)->RegisterEntityProcess<LookupProcess>(EntityComponentAccess().Writes<ExampleComponent>());
+            INSTANCE(EntityManager)->RegisterEntityProcess<LookupProcess>(EntityComponentAccess().Reads<SecondExampleComponent>());
+            INSTANCE(EntityManager)->RegisterEntityProcess<LookupProcess>(EntityComponentAccess().Reads<ExampleComponent>());
+            INSTANCE(EntityManager)->RegisterEntityProcess<ExclusiveProcess>();
+            for (size_t i = 0; i < numEntities; ++i) {
+                auto e = stratus::Entity::Create();
+                e->Components().AttachComponent<SecondExampleComponent>();
+                INSTANCE(EntityManager)->AddEntity(e);
+                entities.push_back(e);
+            }
+            return true; // success
+        }
+
+        stratus::SystemStatus Update(const double deltaSeconds) override {
+            // Handles are given out during the first entity manager update. The entities stay in the world
+            // until the end so every lookup is expected to succeed.
+            if (handles.size() == 0 && entities[0]->IsInWorld()) {
+                for (const auto& e : entities) handles.push_back(e->GetHandle());
+            }
+            if (INSTANCE(Engine)->FrameCount() < numFrames) return stratus::SystemStatus::SYSTEM_CONTINUE;
+            return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+        }
+
+        void Shutdown() override {
+            entities.clear();
+        }
+
+        std::vector<stratus::EntityPtr> entities;
+    };
+
+    STRATUS_INLINE_ENTRY_POINT(ThreadRulesTest, numArgs, argList);
+
+    REQUIRE(lookupFailures == 0);
+    // Fails every time rather than only when it lands on a task thread
+    REQUIRE(changedSinceCalls > 0);
+    REQUIRE(changedSinceThrows == changedSinceCalls);
+    REQUIRE(exclusiveChangedSince > 0);
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include "StratusEngine.h"
+#include "StratusApplication.h"
+#include "StratusLog.h"
+#include "StratusCommon.h"
+#include "StratusWindow.h"
+#include "StratusGraphicsDriver.h"
+#include "StratusGpuBuffer.h"
+#include "StratusRendererFrontend.h"
+#include "StratusResourceManager.h"
+#include "StratusEntityManager.h"
+#include "StratusTransformComponent.h"
+#include "StratusCamera.h"
+#include "IntegrationMain.h"
+
+TEST_CASE( "Stratus Headless Frame Loop", "[stratus_headless_test]" ) {
+    static bool headless;
+    static bool noWindow;
+    static size_t framesRun;
+    static double totalFrameSeconds;
+    headless = false;
+    noWindow = false;
+    framesRun = 0;
+    totalFrameSeconds = 0.0;
+
+    static constexpr size_t numFrames = 120;
+    static constexpr size_t numCubes = 256;
+
+    class HeadlessTest : public stratus::Application {
+    public:
+        virtual ~HeadlessTest() = default;
+
+        const char * GetAppName() const override {
+            return "HeadlessTest";
+        }
+
+        virtual bool Initialize() override {
+            INSTANCE(RendererFrontend)->SetCamera(stratus::CameraPtr(new stratus::Camera(true, true)));
+
+            for (size_t i = 0; i < numCubes; ++i) {
+                auto cube = INSTANCE(ResourceManager)->CreateCube();
+                auto transform = stratus::GetComponent<stratus::LocalTransformComponent>(cube);
+                transform->SetLocalPosition(glm::vec3(float(i % 16) * 3.0f, 0.0f, float(i / 16) * 3.0f));
+                INSTANCE(EntityManager)->AddEntity(cube);
+            }
+
+            return true; // success
+        }
+
+        virtual stratus::SystemStatus Update(const double deltaSeconds) override {
+            headless = INSTANCE(Engine)->IsHeadless() && stratus::GraphicsDriver::IsHeadless();
+            noWindow = INSTANCE(Window)->GetWindowObject() == nullptr;
+
+            // The first frame's delta includes startup
+            if (framesRun > 0) totalFrameSeconds += deltaSeconds;
+            ++framesRun;
+
+            if (framesRun < numFrames) return stratus::SystemStatus::SYSTEM_CONTINUE;
+            return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+        }
+
+        virtual void Shutdown() override {
+            STRATUS_LOG << "Successfully entered HeadlessTest::ShutDown()" << std::endl;
+        }
+    };
+
+    // Headless regardless of how the tests were launched
+    std::vector<const char *> args(argList, argList + numArgs);
+    args.push_back("--headless");
+
+    const auto before = stratus::GpuBuffer::GetNullStatistics();
+    STRATUS_INLINE_ENTRY_POINT(HeadlessTest, int(args.size()), args.data());
+    const auto after = stratus::GpuBuffer::GetNullStatistics();
+
+    REQUIRE(headless);
+    REQUIRE(noWindow);
+    REQUIRE(framesRun == numFrames);
+
+    // Buffers were still created and written to, just never sent to a GPU
+    REQUIRE(after.buffersCreated > before.buffersCreated);
+    REQUIRE(after.bytesCopiedToGpu > before.bytesCopiedToGpu);
+
+    std::cout << "Headless average frame time: " << (1000.0 * totalFrameSeconds / double(numFrames - 1)) << " ms" << std::endl;
+    std::cout << "Null GpuBuffer totals: " << (after.buffersCreated - before.buffersCreated) << " buffers, "
+              << (after.bytesCopiedToGpu - before.bytesCopiedToGpu) << " bytes copied, "
+              << (after.binds - before.binds) << " binds" << std::endl;
+}
@@ -2,6 +2,8 @@
 #define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include <catch2/catch_all.hpp>
 #include "IntegrationMain.h"
+#include <string>
+#include <vector>
 
 int numArgs;
 char ** argList;
@@ -12,7 +14,14 @@ int main(int argc, char** argv) {
     // writing to session.configData() here sets defaults
     // this is the preferred way to set them
 
-    int returnCode = session.applyCommandLine(argc, argv);
+    // Engine arguments such as --headless are passed through to the tests but Catch
+    // would reject them
+    std::vector<char *> catchArgs;
+    for (int i = 0; i < argc; ++i) {
+        if (std::string(argv[i]) != "--headless") catchArgs.push_back(argv[i]);
+    }
+
+    int returnCode = session.applyCommandLine(int(catchArgs.size()), catchArgs.data());
     if (returnCode != 0) { // Indicates a command line error
         return returnCode;
     }
@@ -0,0 +1,320 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "StratusEngine.h"
+#include "StratusApplication.h"
+#include "StratusLog.h"
+#include "StratusCommon.h"
+#include "StratusThread.h"
+#include "StratusTaskSystem.h"
+#include "StratusTaskGraph.h"
+#include "IntegrationMain.h"
+
+typedef std::chrono::high_resolution_clock Clock_;
+
+// Reproduces the scheduler which TaskSystem used before work stealing: every task is assigned
+// to the least loaded thread (found by sorting all threads under a global lock) and only starts
+// when Dispatch is called. To give it the best possible case Dispatch is pumped continuously
+// rather than once per frame.
+struct LegacyScheduler_ {
+    LegacyScheduler_(const size_t numThreads) {
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.push_back(std::make_unique<stratus::Thread>("LegacyThread#" + std::to_string(i + 1), true));
+            working.push_back(std::make_unique<std::atomic<size_t>>(0));
+        }
+    }
+
+    void Schedule(const stratus::Thread::ThreadFunction& function) {
+        auto ul = std::unique_lock<std::mutex>(m);
+        std::vector<std::pair<size_t, size_t>> workLoads;
+        for (size_t i = 0; i < threads.size(); ++i) {
+            workLoads.push_back(std::make_pair(i, working[i]->load()));
+        }
+        std::sort(workLoads.begin(), workLoads.end(), [](const auto& a, const auto& b) {
+            return a.second < b.second;
+        });
+        const size_t index = workLoads[0].first;
+        working[index]->fetch_add(1);
+        std::atomic<size_t> * counter = working[index].get();
+        threads[index]->Queue([function, counter]() {
+            function();
+            counter->fetch_sub(1);
+        });
+    }
+
+    void Pump() {
+        for (auto& thread : threads) {
+            if (thread->Idle()) thread->Dispatch();
+        }
+    }
+
+    std::mutex m;
+    std::vector<std::unique_ptr<stratus::Thread>> threads;
+    std::vector<std::unique_ptr<std::atomic<size_t>>> working;
+};
+
+struct SchedulerResults_ {
+    double avgLatencyUsec = 0.0;
+    double maxLatencyUsec = 0.0;
+    double tasksPerSecond = 0.0;
+};
+
+// Schedule is called to submit a task and Pump is called while waiting for work to finish
+template<typename Schedule, typename Pump>
+static SchedulerResults_ MeasureScheduler(Schedule schedule, Pump pump, const size_t latencySamples, const size_t throughputTasks) {
+    SchedulerResults_ results;
+
+    // Latency: time from submitting a single task until it begins executing
+    for (size_t i = 0; i < latencySamples; ++i) {
+        std::atomic<bool> started(false);
+        Clock_::time_point startTime;
+        const auto submitTime = Clock_::now();
+        schedule([&started, &startTime]() {
+            startTime = Clock_::now();
+            started.store(true);
+        });
+        while (!started.load()) pump();
+
+        const double latency = std::chrono::duration<double, std::micro>(startTime - submitTime).count();
+        results.avgLatencyUsec += latency;
+        results.maxLatencyUsec = std::max(results.maxLatencyUsec, latency);
+    }
+    results.avgLatencyUsec /= double(latencySamples);
+
+    // Throughput: fan out many small tasks and wait for all of them
+    std::atomic<size_t> completed(0);
+    const auto start = Clock_::now();
+    for (size_t i = 0; i < throughputTasks; ++i) {
+        schedule([&completed]() {
+            volatile size_t work = 0;
+            for (size_t j = 0; j < 256; ++j) work = work + j;
+            completed.fetch_add(1);
+        });
+    }
+    while (completed.load() < throughputTasks) pump();
+    const double seconds = std::chrono::duration<double>(Clock_::now() - start).count();
+    results.tasksPerSecond = double(throughputTasks) / seconds;
+
+    return results;
+}
+
+TEST_CASE( "Stratus TaskSystem Benchmark", "[stratus_task_system_benchmark]" ) {
+    static bool failed;
+    failed = false;
+
+    class TaskSystemBenchmark : public stratus::Application {
+    public:
+        virtual ~TaskSystemBenchmark() = default;
+
+        const char * GetAppName() const override {
+            return "TaskSystemBenchmark";
+        }
+
+        bool Initialize() override {
+            return true; // success
+        }
+
+        stratus::SystemStatus Update(const double deltaSeconds) override {
+            const size_t latencySamples = 1000;
+            const size_t throughputTasks = 100000;
+
+            auto tasks = INSTANCE(TaskSystem);
+            const auto current = MeasureScheduler(
+                [tasks](const stratus::Thread::ThreadFunction& f) { tasks->ScheduleTask(f); },
+                []() {},
+                latencySamples,
+                throughputTasks
+            );
+
+            LegacyScheduler_ legacy(tasks->Size());
+            const auto previous = MeasureScheduler(
+                [&legacy](const stratus::Thread::ThreadFunction& f) { legacy.Schedule(f); },
+                [&legacy]() { legacy.Pump(); },
+                latencySamples,
+                throughputTasks
+            );
+
+            STRATUS_LOG << "Work stealing: avg latency " << current.avgLatencyUsec << " usec, max latency "
+                << current.maxLatencyUsec << " usec, " << current.tasksPerSecond << " tasks/sec" << std::endl;
+            STRATUS_LOG << "Least loaded (legacy): avg latency " << previous.avgLatencyUsec << " usec, max latency "
+                << previous.maxLatencyUsec << " usec, " << previous.tasksPerSecond << " tasks/sec" << std::endl;
+
+            if (current.tasksPerSecond <= 0.0) failed = true;
+
+            return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+        }
+
+        void Shutdown() override {
+        }
+    };
+
+    STRATUS_INLINE_ENTRY_POINT(TaskSystemBenchmark, numArgs, argList);
+
+    REQUIRE_FALSE(failed);
+}
+
+TEST_CASE( "Stratus TaskSystem ParallelFor and TaskGraph", "[stratus_task_system_parallel_for_graph]" ) {
+    static bool failed;
+    failed = false;
+
+    class TaskGraphTest : public stratus::Application {
+    public:
+        virtual ~TaskGraphTest() = default;
+
+        const char * GetAppName() const override {
+            return "TaskGraphTest";
+        }
+
+        bool Initialize() override {
+            return true; // success
+        }
+
+        stratus::SystemStatus Update(const double deltaSeconds) override {
+            if (graph_ != nullptr) {
+                // OnComplete callback is queued onto this thread once the graph finishes
+                if (!callbackExecuted_) return stratus::SystemStatus::SYSTEM_CONTINUE;
+                if (!CheckOrder_()) failed = true;
+                return stratus::SystemStatus::SYSTEM_SHUTDOWN;
+            }
+
+            auto tasks = INSTANCE(TaskSystem);
+
+            // Every index must be visited exactly once
+            std::vector<std::atomic<size_t>> visited(100000);
+            for (auto& v : visited) v.store(0);
+            const auto start = Clock_::now();
+            tasks->ParallelFor(0, visited.size(), 0, [&visited](const size_t i) {
+                visited[i].fetch_add(1);
+            });
+            const double msec = std::chrono::duration<double, std::milli>(Clock_::now() - start).count();
+            STRATUS_LOG << "ParallelFor over " << visited.size() << " elements took " << msec << " msec" << std::endl;
+            for (const auto& v : visited) {
+                if (v.load() != 1) failed = true;
+            }
+
+            // ParallelFor from inside of a task must not deadlock since the join helps execute work
+            std::atomic<size_t> nestedTotal(0);
+            std::vector<stratus::Async<void>> waiting;
+            for (size_t i = 0; i < tasks->Size() * 2; ++i) {
+                waiting.push_back(tasks->ScheduleTask([tasks, &nestedTotal]() {
+                    tasks->ParallelFor(0, 1000, 1, [&nestedTotal](const size_t) { nestedTotal.fetch_add(1); });
+                }));
+            }
+            tasks->Join([&waiting]() {
+                for (const auto& as : waiting) {
+                    if (!as.Completed()) return false;
+                }
+                return true;
+            });
+            if (nestedTotal.load() != tasks->Size() * 2 * 1000) failed = true;
+
+            // Exceptions have to come back out on the calling thread instead of terminating a task thread
+            bool caught = false;
+            std::atomic<size_t> numCalls(0);
+            try {
+                tasks->ParallelFor(0, 10000, 1, [&numCalls](const size_t i) {
+                    numCalls.fetch_add(1);
+                    if (i == 5000) throw std::runtime_error("ParallelFor failure");
+                });
+            }
+            catch (const std::runtime_error&) {
+                caught = true;
+            }
+            // Nothing can still be calling the function after ParallelFor has returned
+            const size_t callsAfterThrow = numCalls.load();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (!caught || numCalls.load() != callsAfterThrow) failed = true;
+
+            stratus::TaskGraph failing;
+            std::atomic<bool> successorRan(false);
+            const auto thrower = failing.AddTask([]() { throw std::runtime_error("TaskGraph failure"); });
+            failing.AddTask([&successorRan]() { successorRan.store(true); }, {thrower});
+            caught = false;
+            try {
+                failing.RunAndWait();
+            }
+            catch (const std::runtime_error&) {
+                caught = true;
+            }
+            if (!caught || !failing.Failed() || successorRan.load()) failed = true;
+
+            // Nothing waits on Execute so its exceptions are logged and dropped. The task threads have to keep
+            // going, and the task can't stay counted as active or Shutdown would never finish.
+            std::atomic<size_t> afterThrow(0);
+            tasks->Execute([]() { throw std::runtime_error("Execute failure"); });
+            for (size_t i = 0; i < tasks->Size() * 4; ++i) {
+                tasks->Execute([&afterThrow]() { afterThrow.fetch_add(1); });
+            }
+            tasks->Join([&afterThrow, &tasks]() { return afterThrow.load() == tasks->Size() * 4; });
+
+            // Waiting on ParallelFor or a TaskGraph from the application thread must never run unrelated tasks
+            // (they land in the shared queue which it would otherwise take from first)
+            const auto self = std::this_thread::get_id();
+            std::atomic<size_t> unrelatedOnCaller(0);
+            std::atomic<size_t> unrelatedDone(0);
+            const size_t numUnrelated = 2000;
+            for (size_t i = 0; i < numUnrelated; ++i) {
+                tasks->Execute([self, &unrelatedOnCaller, &unrelatedDone]() {
+                    if (std::this_thread::get_id() == self) unrelatedOnCaller.fetch_add(1);
+                    volatile size_t work = 0;
+                    for (size_t j = 0; j < 2000; ++j) work = work + j;
+                    unrelatedDone.fetch_add(1);
+                });
+            }
+            std::atomic<size_t> related(0);
+            tasks->ParallelFor(0, 1000, 1, [&related](const size_t) { related.fetch_add(1); });
+            stratus::TaskGraph waited;
+            for (size_t i = 0; i < 50; ++i) waited.AddTask([&related]() { related.fetch_add(1); });
+            waited.RunAndWait();
+            tasks->Join([&unrelatedDone, numUnrelated]() { return unrelatedDone.load() == numUnrelated; });
+            if (related.load() != 1050 || unrelatedOnCaller.load() != 0) failed = true;
+
+            // Diamond: 0 -> (1, 2) -> 3, then a continuation after everything
+            graph_ = std::make_unique<stratus::TaskGraph>();
+            const auto a = graph_->AddTask(Record_(0));
+            const auto b = graph_->AddTask(Record_(1), {a});
+            const auto c = graph_->AddTask(Record_(2), {a});
+            graph_->AddTask(Record_(3), {b, c});
+            graph_->AddContinuation(Record_(4));
+            graph_->OnComplete([this]() { callbackExecuted_ = true; });
+            graph_->Run();
+
+            return stratus::SystemStatus::SYSTEM_CONTINUE;
+        }
+
+        void Shutdown() override {
+        }
+
+    private:
+        stratus::Thread::ThreadFunction Record_(const int id) {
+            return [this, id]() {
+                auto ul = std::unique_lock<std::mutex>(m_);
+                order_.push_back(id);
+            };
+        }
+
+        bool CheckOrder_() {
+            auto ul = std::unique_lock<std::mutex>(m_);
+            if (order_.size() != 5) return false;
+            // 1 and 2 can run in either order
+            return order_[0] == 0 && order_[3] == 3 && order_[4] == 4;
+        }
+
+    private:
+        std::unique_ptr<stratus::TaskGraph> graph_;
+        std::mutex m_;
+        std::vector<int> order_;
+        bool callbackExecuted_ = false;
+    };
+
+    STRATUS_INLINE_ENTRY_POINT(TaskGraphTest, numArgs, argList);
+
+    REQUIRE_FALSE(failed);
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "StratusAffine.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+static bool ApproxEquals(const float a, const float b) {
+	return std::fabs(a - b) <= 1e-4f * std::max(1.0f, std::max(std::fabs(a), std::fabs(b)));
+}
+
+static bool ApproxEquals(const glm::mat4& a, const glm::mat4& b) {
+	for (int c = 0; c < 4; ++c) {
+		for (int r = 0; r < 4; ++r) {
+			if (!ApproxEquals(a[c][r], b[c][r])) return false;
+		}
+	}
+	return true;
+}
+
+static bool ApproxEquals(const glm::vec3& a, const glm::vec3& b) {
+	return ApproxEquals(a.x, b.x) && ApproxEquals(a.y, b.y) && ApproxEquals(a.z, b.z);
+}
+
+struct RandomTransform {
+	glm::vec3 scale;
+	glm::mat3 rotation;
+	glm::vec3 position;
+	glm::mat4 matrix;
+};
+
+static RandomTransform MakeRandomTransform(std::mt19937& generator) {
+	std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+	std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+	RandomTransform result;
+	result.scale = glm::vec3(scale(generator), scale(generator), scale(generator));
+	result.rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), angle(generator), glm::normalize(glm::vec3(1.0f, angle(generator), 0.5f))));
+	result.position = glm::vec3(position(generator), position(generator), position(generator));
+	result.matrix = glm::translate(glm::mat4(1.0f), result.position) * glm::mat4(result.rotation) * glm::scale(glm::mat4(1.0f), result.scale);
+	return result;
+}
+
+TEST_CASE( "Stratus Affine3x4 Matches glm", "[stratus_affine_test]" ) {
+	std::cout << "Beginning stratus::Affine3x4 glm comparison test" << std::endl;
+
+	REQUIRE(stratus::Affine3x4().ToMat4() == glm::mat4(1.0f));
+
+	std::mt19937 generator(1234);
+	for (int i = 0; i < 1000; ++i) {
+		const auto a = MakeRandomTransform(generator);
+		const auto b = MakeRandomTransform(generator);
+
+		const auto affineA = stratus::Affine3x4::FromTRS(a.scale, a.rotation, a.position);
+		const auto affineB = stratus::Affine3x4::FromTRS(b.scale, b.rotation, b.position);
+		REQUIRE(ApproxEquals(affineA.ToMat4(), a.matrix));
+
+		// Round trip doesn't lose anything
+		REQUIRE(stratus::Affine3x4::FromMat4(a.matrix).ToMat4() == a.matrix);
+
+		REQUIRE(ApproxEquals((affineA * affineB).ToMat4(), a.matrix * b.matrix));
+
+		const glm::vec3 point(float(i) - 500.0f, 3.0f, -float(i));
+		REQUIRE(ApproxEquals(affineA.TransformPoint(point), glm::vec3(a.matrix * glm::vec4(point, 1.0f))));
+	}
+}
+
+TEST_CASE( "Stratus Affine3x4 Bounds", "[stratus_affine_test]" ) {
+	std::cout << "Beginning stratus::Affine3x4 bounds test" << std::endl;
+
+	std::mt19937 generator(4321);
+	std::uniform_real_distribution<float> distribution(-50.0f, 50.0f);
+
+	std::vector<stratus::GpuAABB> aabbs(257);
+	for (auto& aabb : aabbs) {
+		const glm::vec3 a(distribution(generator), distribution(generator), distribution(generator));
+		const glm::vec3 b(distribution(generator), distribution(generator), distribution(generator));
+		aabb.vmin = glm::vec4(glm::min(a, b), 1.0f);
+		aabb.vmax = glm::vec4(glm::max(a, b), 1.0f);
+	}
+
+	const auto transform = MakeRandomTransform(generator);
+	const auto affine = stratus::Affine3x4::FromMat4(transform.matrix);
+
+	// Transforming every corner gives the exact bounds
+	std::vector<stratus::GpuAABB> transformed(aabbs.size());
+	stratus::TransformAabbs(affine, aabbs.data(), transformed.data(), aabbs.size());
+	for (size_t i = 0; i < aabbs.size(); ++i) {
+		const glm::vec4 vmin = aabbs[i].vmin.ToVec4();
+		const glm::vec4 vmax = aabbs[i].vmax.ToVec4();
+		glm::vec3 expectedMin(std::numeric_limits<float>::max());
+		glm::vec3 expectedMax(-std::numeric_limits<float>::max());
+		for (int corner = 0; corner < 8; ++corner) {
+			const glm::vec4 p(
+				(corner & 1) ? vmax.x : vmin.x,
+				(corner & 2) ? vmax.y : vmin.y,
+				(corner & 4) ? vmax.z : vmin.z,
+				1.0f
+			);
+			const glm::vec3 q = glm::vec3(transform.matrix * p);
+			expectedMin = glm::min(expectedMin, q);
+			expectedMax = glm::max(expectedMax, q);
+		}
+
+		REQUIRE(ApproxEquals(glm::vec3(transformed[i].vmin.ToVec4()), expectedMin));
+		REQUIRE(ApproxEquals(glm::vec3(transformed[i].vmax.ToVec4()), expectedMax));
+		REQUIRE(transformed[i].vmin.v[3] == 1.0f);
+		REQUIRE(transformed[i].vmax.v[3] == 1.0f);
+
+		const auto single = stratus::TransformAabb(affine, aabbs[i]);
+		REQUIRE(glm::vec3(single.vmin.ToVec4()) == glm::vec3(transformed[i].vmin.ToVec4()));
+		REQUIRE(glm::vec3(single.vmax.ToVec4()) == glm::vec3(transformed[i].vmax.ToVec4()));
+	}
+
+	// Input and output can be the same
+	stratus::TransformAabbs(affine, aabbs.data(), aabbs.data(), aabbs.size());
+	for (size_t i = 0; i < aabbs.size(); ++i) {
+		REQUIRE(glm::vec3(aabbs[i].vmin.ToVec4()) == glm::vec3(transformed[i].vmin.ToVec4()));
+	}
+
+	// Point bounds through an index buffer
+	std::vector<glm::vec3> points;
+	std::vector<uint32_t> indices;
+	for (uint32_t i = 0; i < 1000; ++i) {
+		points.push_back(glm::vec3(distribution(generator), distribution(generator), distribution(generator)));
+		// Every other point is left out
+		if (i % 2 == 0) indices.push_back(i);
+	}
+
+	glm::vec3 expectedMin(std::numeric_limits<float>::max());
+	glm::vec3 expectedMax(-std::numeric_limits<float>::max());
+	for (const uint32_t index : indices) {
+		const glm::vec3 q = glm::vec3(transform.matrix * glm::vec4(points[index], 1.0f));
+		expectedMin = glm::min(expectedMin, q);
+		expectedMax = glm::max(expectedMax, q);
+	}
+
+	glm::vec3 vmin;
+	glm::vec3 vmax;
+	stratus::CalculateTransformedBounds(affine, points.data(), indices.data(), indices.size(), vmin, vmax);
+	REQUIRE(ApproxEquals(vmin, expectedMin));
+	REQUIRE(ApproxEquals(vmax, expectedMax));
+}
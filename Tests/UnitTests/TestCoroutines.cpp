@@ -0,0 +1,112 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <stdexcept>
+
+#include "StratusThread.h"
+#include "StratusAsync.h"
+#include "StratusCoroutine.h"
+
+TEST_CASE( "Stratus Async Promise Test", "[stratus_async_promise_test]" ) {
+	std::cout << "Beginning stratus::AsyncPromise test" << std::endl;
+
+	stratus::Thread thread("Main", false);
+	thread.Queue([]() {
+		stratus::AsyncPromise<int> promise;
+		stratus::Async<int> async = promise.GetAsync();
+		REQUIRE(async.Completed() == false);
+
+		int seen = 0;
+		async.OnComplete([&seen, async]() { seen = async.Get(); });
+		REQUIRE(seen == 0);
+
+		promise.SetValue(std::make_shared<int>(7));
+		REQUIRE(async.CompleteAndValid() == true);
+		REQUIRE(seen == 7);
+
+		stratus::AsyncPromise<void> failed;
+		failed.SetFailed("failure");
+		REQUIRE(failed.GetAsync().Failed() == true);
+		REQUIRE(failed.GetAsync().ExceptionMessage() == "failure");
+	});
+	thread.Dispatch();
+}
+
+#if defined(STRATUS_COROUTINES_ENABLED)
+
+static stratus::Task<int> ComputeOn(stratus::Thread& worker, stratus::Thread& main, std::atomic<int>& stage) {
+	// Starts on whichever thread called us
+	stage.store(1);
+
+	co_await stratus::ResumeOn(worker);
+	REQUIRE(stratus::Thread::Current() == worker);
+	stage.store(2);
+
+	stratus::Async<int> computed(worker, []() { return new int(20); });
+	stratus::Async<int> result = co_await computed;
+	REQUIRE(result.CompleteAndValid() == true);
+
+	co_await stratus::ResumeOn(main);
+	REQUIRE(stratus::Thread::Current() == main);
+	stage.store(3);
+
+	co_return result.Get() + 1;
+}
+
+static stratus::Task<void> Fails(stratus::Thread& worker) {
+	co_await stratus::ResumeOn(worker);
+	throw std::runtime_error("coroutine failed");
+}
+
+static stratus::Task<int> AwaitsTask(stratus::Thread& worker, stratus::Thread& main, std::atomic<int>& stage) {
+	stratus::Async<int> inner = co_await ComputeOn(worker, main, stage);
+	co_return inner.Get() * 2;
+}
+
+TEST_CASE( "Stratus Coroutine Test", "[stratus_coroutine_test]" ) {
+	std::cout << "Beginning stratus::Task coroutine test" << std::endl;
+
+	stratus::Thread main("Main", false);
+	stratus::Thread worker("Worker", true);
+
+	const auto pump = [&main, &worker](const auto& done) {
+		for (int i = 0; i < 1000000 && !done(); ++i) {
+			worker.DispatchAndSynchronize();
+			main.Dispatch();
+		}
+	};
+
+	std::atomic<int> stage(0);
+	stratus::Task<int> task;
+	main.Queue([&]() { task = ComputeOn(worker, main, stage); });
+	main.Dispatch();
+
+	// Runs up until the first co_await before returning
+	REQUIRE(stage.load() == 1);
+	REQUIRE(task.Completed() == false);
+
+	pump([&task]() { return task.Completed(); });
+	REQUIRE(stage.load() == 3);
+	REQUIRE(task.CompleteAndValid() == true);
+	REQUIRE(task.Get() == 21);
+
+	// Exceptions fail the Task rather than escaping
+	stratus::Task<void> failed;
+	main.Queue([&]() { failed = Fails(worker); });
+	main.Dispatch();
+	pump([&failed]() { return failed.Completed(); });
+	REQUIRE(failed.Failed() == true);
+	REQUIRE(failed.ExceptionMessage() == "coroutine failed");
+
+	// Tasks can await other tasks
+	stratus::Task<int> outer;
+	main.Queue([&]() { outer = AwaitsTask(worker, main, stage); });
+	main.Dispatch();
+	pump([&outer]() { return outer.Completed(); });
+	REQUIRE(outer.CompleteAndValid() == true);
+	REQUIRE(outer.Get() == 42);
+}
+
+#endif
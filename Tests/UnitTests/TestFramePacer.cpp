@@ -0,0 +1,127 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+
+#include "StratusFramePacer.h"
+
+TEST_CASE( "Stratus FramePacer Percentiles", "[stratus_frame_pacer_test]" ) {
+	std::cout << "Beginning stratus::FramePacer percentile test" << std::endl;
+
+	stratus::FramePacer pacer(60);
+	REQUIRE(pacer.GetPercentiles().p99Seconds == 0.0);
+
+	// 1 ms through 100 ms in a shuffled order
+	for (size_t i = 0; i < 100; ++i) {
+		const double ms = double((i * 37) % 100 + 1);
+		pacer.RecordFrame(ms / 1000.0, ms / 1000.0);
+	}
+
+	auto percentiles = pacer.GetPercentiles();
+	REQUIRE(percentiles.p50Seconds == 50.0 / 1000.0);
+	REQUIRE(percentiles.p95Seconds == 95.0 / 1000.0);
+	REQUIRE(percentiles.p99Seconds == 99.0 / 1000.0);
+
+	// Only the most recent frames count
+	for (size_t i = 0; i < stratus::FramePacer::HistorySize; ++i) {
+		pacer.RecordFrame(0.010, 0.005);
+	}
+	percentiles = pacer.GetPercentiles();
+	REQUIRE(percentiles.p50Seconds == 10.0 / 1000.0);
+	REQUIRE(percentiles.p99Seconds == 10.0 / 1000.0);
+}
+
+TEST_CASE( "Stratus FramePacer Wait", "[stratus_frame_pacer_test]" ) {
+	std::cout << "Beginning stratus::FramePacer wait test" << std::endl;
+
+	typedef stratus::FramePacer::Clock Clock;
+	const uint32_t frameRate = 100;
+	const size_t numFrames = 50;
+	const auto period = std::chrono::microseconds(1000000 / frameRate);
+	stratus::FramePacer pacer(frameRate);
+
+	const std::clock_t cpuStart = std::clock();
+	const auto start = Clock::now();
+	auto prevFrameStart = start;
+	for (size_t i = 0; i < numFrames; ++i) {
+		const auto frameStart = pacer.WaitUntilNextFrame(prevFrameStart);
+		// Never early
+		REQUIRE(frameStart - prevFrameStart >= period);
+		pacer.RecordFrame(std::chrono::duration<double>(frameStart - prevFrameStart).count(), 0.0);
+		prevFrameStart = frameStart;
+	}
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	const double cpuSeconds = double(std::clock() - cpuStart) / double(CLOCKS_PER_SEC);
+
+	REQUIRE(seconds >= double(numFrames) / double(frameRate));
+	const auto percentiles = pacer.GetPercentiles();
+	REQUIRE(percentiles.p50Seconds >= 1.0 / double(frameRate));
+
+	// Most of the wait should have been spent asleep
+	std::cout << "FramePacer at " << frameRate << " fps: p50 " << percentiles.p50Seconds * 1000.0 << " ms, p99 "
+		<< percentiles.p99Seconds * 1000.0 << " ms, CPU busy " << (100.0 * cpuSeconds / seconds) << "%, sleep overshoot "
+		<< pacer.GetSleepOvershootSeconds() * 1000.0 << " ms" << std::endl;
+
+	// Already past the deadline means no wait at all
+	const auto late = Clock::now() - period * 2;
+	REQUIRE(pacer.WaitUntilNextFrame(late) - late < period * 3);
+}
+
+TEST_CASE( "Stratus FramePacer Sleep Overshoot", "[stratus_frame_pacer_test]" ) {
+	std::cout << "Beginning stratus::FramePacer sleep overshoot test" << std::endl;
+
+	stratus::FramePacer pacer(60);
+	// Assumes 1 ms until anything has been measured
+	REQUIRE(pacer.GetSleepOvershootSeconds() == 0.001);
+
+	// The first sample replaces the initial guess
+	pacer.RecordSleepOvershoot(0.0002);
+	REQUIRE(std::abs(pacer.GetSleepOvershootSeconds() - 0.0002) < 1e-9);
+
+	// A long run of slow wakeups pulls it up...
+	for (size_t i = 0; i < 1000; ++i) pacer.RecordSleepOvershoot(0.005);
+	REQUIRE(std::abs(pacer.GetSleepOvershootSeconds() - 0.005) < 1e-6);
+
+	// ...but it still comes back down quickly once they stop instead of remembering the whole run
+	for (size_t i = 0; i < 100; ++i) pacer.RecordSleepOvershoot(0.0001);
+	REQUIRE(pacer.GetSleepOvershootSeconds() < 0.0002);
+
+	// Noisy wakeups leave extra margin on top of the mean
+	for (size_t i = 0; i < 100; ++i) pacer.RecordSleepOvershoot(i % 2 == 0 ? 0.0 : 0.002);
+	REQUIRE(pacer.GetSleepOvershootSeconds() > 0.0015);
+
+	// Negative measurements (clock jitter) count as no overshoot
+	for (size_t i = 0; i < 1000; ++i) pacer.RecordSleepOvershoot(-0.001);
+	REQUIRE(pacer.GetSleepOvershootSeconds() >= 0.0);
+	REQUIRE(pacer.GetSleepOvershootSeconds() < 1e-6);
+}
+
+TEST_CASE( "Stratus FramePacer Adaptive", "[stratus_frame_pacer_test]" ) {
+	std::cout << "Beginning stratus::FramePacer adaptive test" << std::endl;
+
+	stratus::FramePacer pacer(120);
+	pacer.SetAdaptive(true);
+	REQUIRE(pacer.GetTargetFrameRate() == 120);
+
+	// Frames which take 20 ms of work can't hold 120 fps so the target backs off
+	for (size_t i = 0; i < 60; ++i) pacer.RecordFrame(0.020, 0.020);
+	const uint32_t backedOff = pacer.GetTargetFrameRate();
+	REQUIRE(backedOff < 50);
+	REQUIRE(backedOff >= stratus::FramePacer::MinAdaptiveFrameRate);
+
+	// Climbs back up once frames get cheap again, but never past the max
+	for (size_t i = 0; i < stratus::FramePacer::HistorySize; ++i) pacer.RecordFrame(0.008, 0.002);
+	REQUIRE(pacer.GetTargetFrameRate() == 120);
+
+	// Turning adaptive pacing off always restores the max
+	for (size_t i = 0; i < stratus::FramePacer::HistorySize; ++i) pacer.RecordFrame(0.050, 0.050);
+	REQUIRE(pacer.GetTargetFrameRate() < 120);
+	pacer.SetAdaptive(false);
+	REQUIRE(pacer.GetTargetFrameRate() == 120);
+
+	// Work above the minimum frame rate's budget still never drops below it
+	pacer.SetAdaptive(true);
+	for (size_t i = 0; i < 60; ++i) pacer.RecordFrame(0.200, 0.200);
+	REQUIRE(pacer.GetTargetFrameRate() == stratus::FramePacer::MinAdaptiveFrameRate);
+}
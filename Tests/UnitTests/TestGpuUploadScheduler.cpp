@@ -0,0 +1,234 @@
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "StratusGpuUploadScheduler.h"
+
+static constexpr size_t MB = 1024 * 1024;
+
+static bool ApproxEquals(const double a, const double b) {
+	return std::abs(a - b) < 1e-6;
+}
+
+// Uploads advance this instead of taking real time so that budgets can be tested exactly
+struct FakeClock {
+	double now = 0.0;
+
+	stratus::GpuUploadScheduler::ClockFunction Function() {
+		return [this]() { return now; };
+	}
+};
+
+static stratus::GpuUploadScheduler::UploadFunction MakeUpload(FakeClock& clock, std::vector<int>& order, const int id, const size_t bytes, const double seconds) {
+	return [&clock, &order, id, bytes, seconds]() {
+		clock.now += seconds;
+		order.push_back(id);
+		return bytes;
+	};
+}
+
+static stratus::GpuAABB MakeAABB(const glm::vec3& vmin, const glm::vec3& vmax) {
+	stratus::GpuAABB aabb;
+	aabb.vmin = stratus::GpuVec(glm::vec4(vmin, 1.0f));
+	aabb.vmax = stratus::GpuVec(glm::vec4(vmax, 1.0f));
+	return aabb;
+}
+
+// Budget which never gets in the way unless a test wants it to
+static stratus::GpuUploadBudget LargeBudget() {
+	stratus::GpuUploadBudget budget;
+	budget.targetFrameSeconds = 1.0;
+	budget.minSeconds = 1.0;
+	budget.maxSeconds = 1.0;
+	budget.maxBytes = 1024 * MB;
+	return budget;
+}
+
+TEST_CASE( "Stratus Gpu Upload Scheduler Ordering Test", "[stratus_gpu_upload_scheduler_test]" ) {
+	std::cout << "Stratus Gpu Upload Scheduler Ordering Test" << std::endl;
+
+	FakeClock clock;
+	stratus::GpuUploadScheduler scheduler(LargeBudget(), clock.Function());
+	std::vector<int> order;
+
+	// Everything with x < 0 is outside of the frustum
+	const std::vector<glm::vec4> planes(6, glm::vec4(1.0f, 0.0f, 0.0f, 0.0f));
+	scheduler.SetViewer(glm::vec3(0.0f), planes);
+
+	scheduler.Submit(MakeAABB(glm::vec3(-20.0f), glm::vec3(-19.0f)), MB, 0, MakeUpload(clock, order, 0, MB, 0.001));
+	scheduler.Submit(MakeAABB(glm::vec3(50.0f), glm::vec3(51.0f)), MB, 0, MakeUpload(clock, order, 1, MB, 0.001));
+	scheduler.Submit(MakeAABB(glm::vec3(5.0f), glm::vec3(6.0f)), MB, 0, MakeUpload(clock, order, 2, MB, 0.001));
+	scheduler.Submit(MakeAABB(glm::vec3(-2.0f), glm::vec3(-1.0f)), MB, 0, MakeUpload(clock, order, 3, MB, 0.001));
+	scheduler.Submit(MakeAABB(glm::vec3(100.0f), glm::vec3(101.0f)), MB, 5, MakeUpload(clock, order, 4, MB, 0.001));
+	// No bounds counts as visible and right next to the viewer
+	scheduler.Submit(MB, 0, MakeUpload(clock, order, 5, MB, 0.001));
+	scheduler.Submit(MB, 0, MakeUpload(clock, order, 6, MB, 0.001));
+
+	REQUIRE(scheduler.GetStatistics().numPending == 7);
+	REQUIRE(scheduler.ProcessFrame(0.0) == 7);
+	REQUIRE(order == std::vector<int>{4, 5, 6, 2, 1, 3, 0});
+
+	const auto stats = scheduler.GetStatistics();
+	REQUIRE(stats.numPending == 0);
+	REQUIRE(stats.numUploaded == 7);
+	REQUIRE(stats.bytesUploaded == 7 * MB);
+	REQUIRE(stats.totalUploaded == 7);
+	REQUIRE(ApproxEquals(stats.uploadSeconds, 0.007));
+}
+
+TEST_CASE( "Stratus Gpu Upload Scheduler Prioritize Test", "[stratus_gpu_upload_scheduler_test]" ) {
+	std::cout << "Stratus Gpu Upload Scheduler Prioritize Test" << std::endl;
+
+	FakeClock clock;
+	stratus::GpuUploadScheduler scheduler(LargeBudget(), clock.Function());
+	std::vector<int> order;
+
+	scheduler.Submit(MB, 0, MakeUpload(clock, order, 0, MB, 0.001), 10);
+	scheduler.Submit(MB, 0, MakeUpload(clock, order, 1, MB, 0.001), 11);
+	scheduler.Submit(MB, 0, MakeUpload(clock, order, 2, MB, 0.001), 12);
+
+	REQUIRE(scheduler.Prioritize(12, 3));
+	// Never lowers it
+	REQUIRE(scheduler.Prioritize(12, 1));
+	REQUIRE(scheduler.Prioritize(11, 2));
+	REQUIRE_FALSE(scheduler.Prioritize(13, 5));
+	REQUIRE_FALSE(scheduler.Prioritize(stratus::GpuUploadScheduler::NoKey, 5));
+
+	scheduler.ProcessFrame(0.0);
+	REQUIRE(order == std::vector<int>{2, 1, 0});
+	// Nothing left to find once they've run
+	REQUIRE_FALSE(scheduler.Prioritize(10, 1));
+}
+
+TEST_CASE( "Stratus Gpu Upload Scheduler Time Budget Test", "[stratus_gpu_upload_scheduler_test]" ) {
+	std::cout << "Stratus Gpu Upload Scheduler Time Budget Test" << std::endl;
+
+	FakeClock clock;
+	stratus::GpuUploadBudget budget;
+	budget.targetFrameSeconds = 0.016;
+	budget.minSeconds = 0.002;
+	budget.maxSeconds = 0.008;
+	budget.maxBytes = 1024 * MB;
+	stratus::GpuUploadScheduler scheduler(budget, clock.Function());
+	std::vector<int> order;
+
+	// Kept just under 1ms so that sums of them never land exactly on a budget
+	const double uploadSeconds = 0.00099;
+	for (int i = 0; i < 20; ++i) {
+		scheduler.Submit(MB, 0, MakeUpload(clock, order, i, MB, uploadSeconds));
+	}
+
+	// Starts at the minimum and nothing is known about the cost yet, so the first upload runs and the
+	// second is predicted to fit
+	REQUIRE(scheduler.ProcessFrame(0.0) == 2);
+	REQUIRE(ApproxEquals(scheduler.GetStatistics().timeBudgetSeconds, 0.002));
+	REQUIRE(ApproxEquals(scheduler.GetStatistics().secondsPerMegabyte, uploadSeconds));
+
+	// Plenty of room left in the last frame so the budget grows a bit at a time
+	double previousBudget = 0.002;
+	for (int frame = 0; frame < 2; ++frame) {
+		scheduler.ProcessFrame(0.005);
+		const auto stats = scheduler.GetStatistics();
+		REQUIRE(stats.timeBudgetSeconds > previousBudget);
+		REQUIRE(stats.uploadSeconds <= stats.timeBudgetSeconds + 1e-9);
+		REQUIRE(stats.numUploaded >= 1);
+		previousBudget = stats.timeBudgetSeconds;
+	}
+
+	// A slow frame cuts it back right away (to the minimum here since there's no room left at all)
+	scheduler.ProcessFrame(0.030);
+	auto stats = scheduler.GetStatistics();
+	REQUIRE(ApproxEquals(stats.timeBudgetSeconds, 0.002));
+	REQUIRE(stats.numUploaded == 2);
+
+	// Never grows past the maximum
+	for (int i = 0; i < 100; ++i) {
+		scheduler.Submit(MB, 0, MakeUpload(clock, order, 100 + i, MB, uploadSeconds));
+	}
+	for (int frame = 0; frame < 5; ++frame) {
+		scheduler.ProcessFrame(0.001);
+	}
+	stats = scheduler.GetStatistics();
+	REQUIRE(ApproxEquals(stats.timeBudgetSeconds, 0.008));
+	REQUIRE(stats.numUploaded == 8);
+}
+
+TEST_CASE( "Stratus Gpu Upload Scheduler First Upload Always Runs Test", "[stratus_gpu_upload_scheduler_test]" ) {
+	std::cout << "Stratus Gpu Upload Scheduler First Upload Always Runs Test" << std::endl;
+
+	FakeClock clock;
+	stratus::GpuUploadBudget budget;
+	budget.minSeconds = 0.001;
+	budget.maxSeconds = 0.001;
+	budget.maxBytes = MB;
+	stratus::GpuUploadScheduler scheduler(budget, clock.Function());
+	std::vector<int> order;
+
+	// Bigger than both budgets
+	scheduler.Submit(16 * MB, 0, MakeUpload(clock, order, 0, 16 * MB, 0.010));
+	scheduler.Submit(16 * MB, 0, MakeUpload(clock, order, 1, 16 * MB, 0.010));
+
+	REQUIRE(scheduler.ProcessFrame(0.0) == 1);
+	REQUIRE(scheduler.ProcessFrame(0.0) == 1);
+	REQUIRE(order == std::vector<int>{0, 1});
+	REQUIRE(scheduler.ProcessFrame(0.0) == 0);
+}
+
+TEST_CASE( "Stratus Gpu Upload Scheduler Byte Budget Test", "[stratus_gpu_upload_scheduler_test]" ) {
+	std::cout << "Stratus Gpu Upload Scheduler Byte Budget Test" << std::endl;
+
+	FakeClock clock;
+	stratus::GpuUploadBudget budget = LargeBudget();
+	budget.maxBytes = 4 * MB;
+	stratus::GpuUploadScheduler scheduler(budget, clock.Function());
+	std::vector<int> order;
+
+	for (int i = 0; i < 12; ++i) {
+		scheduler.Submit(MB, 0, MakeUpload(clock, order, i, MB, 0.0001));
+	}
+
+	REQUIRE(scheduler.ProcessFrame(0.0) == 4);
+	REQUIRE(scheduler.GetStatistics().byteBudget == 4 * MB);
+
+	// Uploads which couldn't wait come out of the next frame's budget
+	scheduler.ChargeImmediate(MB);
+	scheduler.ChargeImmediate(MB);
+	REQUIRE(scheduler.ProcessFrame(0.0) == 2);
+	auto stats = scheduler.GetStatistics();
+	REQUIRE(stats.byteBudget == 2 * MB);
+	REQUIRE(stats.immediateBytes == 2 * MB);
+
+	// Only for one frame
+	REQUIRE(scheduler.ProcessFrame(0.0) == 4);
+	REQUIRE(scheduler.GetStatistics().immediateBytes == 0);
+
+	// Even charging more than the whole budget lets one upload through
+	scheduler.ChargeImmediate(64 * MB);
+	REQUIRE(scheduler.ProcessFrame(0.0) == 1);
+	REQUIRE(scheduler.GetStatistics().byteBudget == 0);
+	REQUIRE(order.size() == 11);
+	REQUIRE(scheduler.GetStatistics().totalBytesUploaded == 11 * MB);
+}
+
+TEST_CASE( "Stratus Gpu Upload Scheduler Clear Test", "[stratus_gpu_upload_scheduler_test]" ) {
+	std::cout << "Stratus Gpu Upload Scheduler Clear Test" << std::endl;
+
+	FakeClock clock;
+	stratus::GpuUploadScheduler scheduler(LargeBudget(), clock.Function());
+	std::vector<int> order;
+
+	// Uploads are free to submit more uploads
+	scheduler.Submit(MB, 0, [&]() {
+		scheduler.Submit(MB, 0, MakeUpload(clock, order, 1, MB, 0.0));
+		order.push_back(0);
+		return MB;
+	});
+	REQUIRE(scheduler.ProcessFrame(0.0) == 1);
+	REQUIRE(scheduler.GetStatistics().numPending == 1);
+
+	scheduler.Clear();
+	REQUIRE(scheduler.GetStatistics().numPending == 0);
+	REQUIRE(scheduler.ProcessFrame(0.0) == 0);
+	REQUIRE(order == std::vector<int>{0});
+}
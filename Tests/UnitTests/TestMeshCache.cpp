@@ -0,0 +1,111 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <filesystem>
+#include <string>
+
+#include "StratusMeshCache.h"
+#include "StratusFilesystem.h"
+
+static stratus::MeshPtr CreateCookedQuadMesh(const float height) {
+	stratus::MeshPtr mesh = stratus::Mesh::Create();
+	const glm::vec3 positions[] = {
+		glm::vec3(0.0f, height, 0.0f), glm::vec3(1.0f, height, 0.0f), glm::vec3(1.0f, height, 1.0f), glm::vec3(0.0f, height, 1.0f)
+	};
+	for (const auto& position : positions) {
+		mesh->AddVertex(position);
+		mesh->AddUV(glm::vec2(position.x, position.z));
+		mesh->AddNormal(glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+	for (uint32_t index : {0, 1, 2, 2, 3, 0}) mesh->AddIndex(index);
+	mesh->SetFaceCulling(stratus::RenderFaceCulling::CULLING_NONE);
+	mesh->ProcessCpuData();
+	return mesh;
+}
+
+TEST_CASE( "Stratus MeshCache round trip", "[stratus_mesh_cache_test]" ) {
+	std::cout << "Beginning stratus::MeshCache round trip test" << std::endl;
+
+	const auto directory = std::filesystem::temp_directory_path() / "StratusMeshCacheTest";
+	std::filesystem::remove_all(directory);
+	const std::string first = (directory / "first.smc").string();
+	const std::string second = (directory / "second.smc").string();
+	const stratus::MeshCacheStamp stamp{"Models/quad.obj", 1234, 5678};
+	const uint64_t importKey = 42;
+
+	{
+		stratus::CookedModel model;
+		stratus::CookedMaterial material;
+		material.flags = stratus::CookedMaterial::HAS_DIFFUSE;
+		material.diffuseColor = glm::vec4(0.25f, 0.5f, 0.75f, 1.0f);
+		material.normalMap = "Models/quad_normal.png";
+		model.materials.push_back(material);
+
+		model.meshes.push_back(CreateCookedQuadMesh(0.0f));
+		model.meshes.push_back(CreateCookedQuadMesh(1.0f));
+		model.nodes.push_back(stratus::CookedNode{-1, false, {}});
+		model.nodes.push_back(stratus::CookedNode{0, true, {stratus::CookedNodeMesh{0, 0, glm::mat4(1.0f)}}});
+		model.nodes.push_back(stratus::CookedNode{1, true, {stratus::CookedNodeMesh{1, 0, glm::mat4(2.0f)}}});
+		REQUIRE(stratus::MeshCache::Write(first, stamp, importKey, model));
+	}
+
+	stratus::CookedModel model;
+	// Anything different about the source or import settings means the file can't be used
+	stratus::MeshCacheStamp modified = stamp;
+	modified.lastModified += 1;
+	REQUIRE_FALSE(stratus::MeshCache::Read(first, modified, importKey, model));
+	REQUIRE_FALSE(stratus::MeshCache::Read(first, stamp, importKey + 1, model));
+	REQUIRE_FALSE(stratus::MeshCache::Read(second, stamp, importKey, model));
+	REQUIRE(model.meshes.size() == 0);
+
+	REQUIRE(stratus::MeshCache::Read(first, stamp, importKey, model));
+	REQUIRE(model.materials.size() == 1);
+	REQUIRE(model.materials[0].diffuseColor == glm::vec4(0.25f, 0.5f, 0.75f, 1.0f));
+	REQUIRE(model.materials[0].normalMap == "Models/quad_normal.png");
+	REQUIRE(model.materials[0].diffuseMap.empty());
+	REQUIRE(model.nodes.size() == 3);
+	REQUIRE(model.nodes[2].parent == 1);
+	REQUIRE_FALSE(model.nodes[0].renderable);
+	REQUIRE(model.nodes[2].meshes[0].transform == glm::mat4(2.0f));
+	REQUIRE(model.meshes.size() == 2);
+	REQUIRE(model.meshes[1]->GetFaceCulling() == stratus::RenderFaceCulling::CULLING_NONE);
+
+	// Cooking what was read back gives the exact same file
+	REQUIRE(stratus::MeshCache::Write(second, stamp, importKey, model));
+	REQUIRE(stratus::Filesystem::ReadBinary(first) == stratus::Filesystem::ReadBinary(second));
+
+	// Mapped meshes point into the file but describe exactly the same model
+	{
+		stratus::CookedModel mapped;
+		REQUIRE(stratus::MeshCache::Read(first, stamp, importKey, mapped, true));
+		REQUIRE(mapped.meshes.size() == 2);
+		REQUIRE(stratus::MeshCache::Write(second, stamp, importKey, mapped));
+		REQUIRE(stratus::Filesystem::ReadBinary(first) == stratus::Filesystem::ReadBinary(second));
+	}
+
+	// A truncated file is rejected rather than partially read
+	std::filesystem::resize_file(second, std::filesystem::file_size(second) - 1);
+	stratus::CookedModel truncated;
+	REQUIRE_FALSE(stratus::MeshCache::Read(second, stamp, importKey, truncated));
+	REQUIRE(truncated.meshes.size() == 0);
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST_CASE( "Stratus MeshCache paths", "[stratus_mesh_cache_test]" ) {
+	const std::string original = stratus::MeshCache::GetDirectory();
+
+	stratus::MeshCache::SetDirectory("Cooked");
+	const std::string path = stratus::MeshCache::CookedPath("Models/a/quad.obj", 1);
+	REQUIRE(std::filesystem::path(path).parent_path() == std::filesystem::path("Cooked"));
+	REQUIRE(path == stratus::MeshCache::CookedPath("Models/a/quad.obj", 1));
+	REQUIRE(path != stratus::MeshCache::CookedPath("Models/b/quad.obj", 1));
+	REQUIRE(path != stratus::MeshCache::CookedPath("Models/a/quad.obj", 2));
+
+	stratus::MeshCache::SetDirectory("");
+	REQUIRE(stratus::MeshCache::CookedPath("Models/a/quad.obj", 1).empty());
+
+	stratus::MeshCacheStamp stamp;
+	REQUIRE_FALSE(stratus::MeshCache::GetStamp("ThisFileDoesNotExist.obj", stamp));
+
+	stratus::MeshCache::SetDirectory(original);
+}
@@ -0,0 +1,208 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <functional>
+
+#include "StratusMpscQueue.h"
+#include "StratusInlineFunction.h"
+
+TEST_CASE( "Inline function storage", "[inline_function]" ) {
+	std::cout << "Starting inline function test" << std::endl;
+
+	size_t counter = 0;
+	stratus::InlineFunction<48> small([&counter]() { ++counter; });
+	REQUIRE(small.IsInline() == true);
+	small();
+	REQUIRE(counter == 1);
+
+	// Too large for the buffer so it has to go on the heap
+	struct Large { size_t data[16]; };
+	Large large{};
+	large.data[15] = 5;
+	stratus::InlineFunction<48> big([&counter, large]() { counter += large.data[15]; });
+	REQUIRE(big.IsInline() == false);
+	big();
+	REQUIRE(counter == 6);
+
+	// Moving transfers ownership and leaves the source empty
+	stratus::InlineFunction<48> moved(std::move(small));
+	REQUIRE(static_cast<bool>(small) == false);
+	REQUIRE(static_cast<bool>(moved) == true);
+	moved();
+	REQUIRE(counter == 7);
+
+	moved = std::move(big);
+	REQUIRE(moved.IsInline() == false);
+	moved();
+	REQUIRE(counter == 12);
+
+	// Captured state must be destroyed exactly once
+	auto shared = std::make_shared<int>(0);
+	{
+		stratus::InlineFunction<48> a([shared]() {});
+		stratus::InlineFunction<48> b(std::move(a));
+		REQUIRE(shared.use_count() == 2);
+	}
+	REQUIRE(shared.use_count() == 1);
+}
+
+TEST_CASE( "MPSC queue single thread", "[mpsc_queue_single]" ) {
+	std::cout << "Starting MPSC queue test with a single thread" << std::endl;
+
+	stratus::MpscQueue<size_t> queue;
+	size_t value = 0;
+	REQUIRE(queue.Empty() == true);
+	REQUIRE(queue.Pop(value) == false);
+
+	// Run a few rounds to make sure recycled nodes behave the same as new ones
+	const size_t numElements = 10000;
+	for (size_t round = 0; round < 3; ++round) {
+		for (size_t i = 0; i < numElements; ++i) {
+			queue.Push(i);
+		}
+
+		for (size_t i = 0; i < numElements; ++i) {
+			REQUIRE(queue.Pop(value) == true);
+			REQUIRE(value == i);
+		}
+
+		REQUIRE(queue.Empty() == true);
+		REQUIRE(queue.Pop(value) == false);
+	}
+
+	// Nodes are recycled so capacity should not have grown past the first round
+	const size_t capacity = queue.Capacity();
+	REQUIRE(capacity >= numElements);
+	for (size_t i = 0; i < numElements; ++i) queue.Push(i);
+	for (size_t i = 0; i < numElements; ++i) queue.Pop(value);
+	REQUIRE(queue.Capacity() == capacity);
+}
+
+TEST_CASE( "MPSC queue multi threaded", "[mpsc_queue_multi]" ) {
+	const size_t numProducers = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+	std::cout << "Starting MPSC queue test with " << numProducers << " producers" << std::endl;
+
+	stratus::MpscQueue<uint64_t> queue;
+	const uint64_t elementsPerProducer = 200000;
+	std::atomic<bool> start(false);
+
+	std::vector<std::thread> producers;
+	for (uint64_t p = 0; p < numProducers; ++p) {
+		producers.push_back(std::thread([&queue, &start, p, elementsPerProducer]() {
+			while (!start.load()) std::this_thread::yield();
+			for (uint64_t i = 0; i < elementsPerProducer; ++i) {
+				// Upper bits hold the producer so that per-producer ordering can be checked
+				queue.Push((p << 32) | i);
+			}
+		}));
+	}
+
+	start.store(true);
+
+	// Each producer's elements must come out in the order they were pushed
+	std::vector<uint64_t> nextExpected(numProducers, 0);
+	const uint64_t total = numProducers * elementsPerProducer;
+	uint64_t received = 0;
+	size_t outOfOrder = 0;
+	uint64_t value;
+	while (received < total) {
+		if (!queue.Pop(value)) continue;
+		const uint64_t producer = value >> 32;
+		const uint64_t index = value & 0xFFFFFFFF;
+		if (index != nextExpected[producer]) ++outOfOrder;
+		nextExpected[producer] = index + 1;
+		++received;
+	}
+
+	for (auto& th : producers) th.join();
+
+	REQUIRE(outOfOrder == 0);
+	REQUIRE(queue.Pop(value) == false);
+	for (const uint64_t next : nextExpected) {
+		REQUIRE(next == elementsPerProducer);
+	}
+}
+
+typedef std::chrono::high_resolution_clock Clock_;
+
+// Runs numProducers threads which each enqueue functions while the calling thread dequeues and
+// executes them. Returns the number of functions which went through the queue per second.
+template<typename Push, typename Drain>
+static double MeasureQueueThroughput(const size_t numProducers, const size_t perProducer, Push push, Drain drain) {
+	std::atomic<size_t> executed(0);
+	std::atomic<bool> start(false);
+
+	std::vector<std::thread> producers;
+	for (size_t p = 0; p < numProducers; ++p) {
+		producers.push_back(std::thread([&push, &executed, &start, perProducer]() {
+			while (!start.load()) std::this_thread::yield();
+			for (size_t i = 0; i < perProducer; ++i) {
+				// Captures a typical amount of state (too much for std::function to store inline)
+				const size_t payload[3] = { i, i + 1, i + 2 };
+				push([&executed, payload]() { executed.fetch_add(payload[1] - payload[0], std::memory_order_relaxed); });
+			}
+		}));
+	}
+
+	const size_t total = numProducers * perProducer;
+	const auto begin = Clock_::now();
+	start.store(true);
+	while (executed.load(std::memory_order_relaxed) < total) drain();
+	const double seconds = std::chrono::duration<double>(Clock_::now() - begin).count();
+
+	for (auto& th : producers) th.join();
+	return double(total) / seconds;
+}
+
+TEST_CASE( "MPSC queue throughput", "[mpsc_queue_throughput]" ) {
+	const size_t maxProducers = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+	const size_t perProducer = 200000;
+	std::cout << "Starting MPSC queue throughput test with 1 to " << maxProducers << " producers" << std::endl;
+
+	std::vector<size_t> producerCounts;
+	for (size_t count = 1; count < maxProducers; count *= 2) producerCounts.push_back(count);
+	producerCounts.push_back(maxProducers);
+
+	for (const size_t numProducers : producerCounts) {
+		// Lock-free queue with inline task storage
+		stratus::MpscQueue<stratus::InlineFunction<48>> queue;
+		const double lockFree = MeasureQueueThroughput(numProducers, perProducer,
+			[&queue](auto&& function) { queue.Push(stratus::InlineFunction<48>(function)); },
+			[&queue]() {
+				stratus::InlineFunction<48> function;
+				while (queue.Pop(function)) function();
+			}
+		);
+
+		// What Thread::Queue used to do: wrap in a temporary vector, lock, copy into the front queue
+		std::mutex mutex;
+		std::vector<std::function<void()>> front;
+		std::vector<std::function<void()>> back;
+		const double locked = MeasureQueueThroughput(numProducers, perProducer,
+			[&mutex, &front](auto&& function) {
+				const std::vector<std::function<void()>> functions{function};
+				std::unique_lock<std::mutex> ul(mutex);
+				for (const auto& f : functions) front.push_back(f);
+			},
+			[&mutex, &front, &back]() {
+				{
+					std::unique_lock<std::mutex> ul(mutex);
+					for (const auto& function : front) back.push_back(function);
+					front.clear();
+				}
+				for (const auto& function : back) function();
+				back.clear();
+			}
+		);
+
+		std::cout << numProducers << " producers: lock-free " << (lockFree / 1000000.0) << " M/sec, mutex "
+			<< (locked / 1000000.0) << " M/sec" << std::endl;
+
+		REQUIRE(lockFree > 0.0);
+	}
+	std::cout << std::endl;
+}
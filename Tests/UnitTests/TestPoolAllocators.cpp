@@ -3,6 +3,8 @@
 #include <unordered_set>
 #include <chrono>
 #include <any>
+#include <atomic>
+#include <thread>
 
 #include "StratusPoolAllocator.h"
 
@@ -197,4 +199,96 @@ static void ThreadSafePoolAllocatorTest() {
 TEST_CASE( "Stratus Pool Allocators Test", "[stratus_pool_allocators_test]" ) {
     PoolAllocatorTest();
     ThreadSafePoolAllocatorTest();
-}
\ No newline at end of file
+}
+
+struct CachedPoolPayload {
+    int64_t value;
+    int64_t padding[3];
+
+    CachedPoolPayload(const int64_t value) : value(value) {}
+};
+
+typedef stratus::ThreadCachedPoolAllocator<CachedPoolPayload> CachedPool;
+
+// Every thread allocates count payloads, checks them and frees them again. Threads either all run at once
+// or one at a time. Returns how many payloads didn't hold the expected value (Catch assertions aren't
+// thread safe so the caller checks).
+static size_t CachedPoolRoundTrip(const int64_t numThreads, const int64_t count, const bool concurrent = true) {
+    std::atomic<size_t> errors(0);
+    const auto roundTrip = [count, &errors](const int64_t th) {
+        std::vector<CachedPoolPayload *> ptrs;
+        ptrs.reserve(count);
+        for (int64_t i = 0; i < count; ++i) ptrs.push_back(CachedPool::AllocateConstruct(th * count + i));
+        for (int64_t i = 0; i < count; ++i) {
+            if (ptrs[i]->value != th * count + i) errors.fetch_add(1);
+            CachedPool::DestroyDeallocate(ptrs[i]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int64_t th = 0; th < numThreads; ++th) {
+        threads.push_back(std::thread(roundTrip, th));
+        if (!concurrent) threads.back().join();
+    }
+    for (auto& th : threads) {
+        if (th.joinable()) th.join();
+    }
+    return errors.load();
+}
+
+TEST_CASE( "Stratus Thread Cached Pool Allocator Test", "[stratus_pool_allocators_test]" ) {
+    // Slots come back out of the cache before they go back to the shared pool
+    auto a = CachedPool::AllocateConstruct(int64_t(1));
+    CachedPool::DestroyDeallocate(a);
+    auto b = CachedPool::AllocateConstruct(int64_t(2));
+    REQUIRE(a == b);
+    REQUIRE(b->value == 2);
+    CachedPool::DestroyDeallocate(b);
+
+    std::unordered_set<CachedPoolPayload *> unique;
+    std::vector<CachedPoolPayload *> ptrs;
+    for (int64_t i = 0; i < 1000; ++i) {
+        ptrs.push_back(CachedPool::AllocateConstruct(i));
+        REQUIRE(unique.insert(ptrs.back()).second);
+        REQUIRE(uintptr_t(ptrs.back()) % alignof(CachedPoolPayload) == 0);
+    }
+
+    // Free everything the main thread allocated on other threads
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> threads;
+    for (size_t th = 0; th < 4; ++th) {
+        threads.push_back(std::thread([&ptrs, &errors, th]() {
+            for (size_t i = th; i < ptrs.size(); i += 4) {
+                if (ptrs[i]->value != int64_t(i)) errors.fetch_add(1);
+                CachedPool::DestroyDeallocate(ptrs[i]);
+            }
+        }));
+    }
+    for (auto& th : threads) th.join();
+    REQUIRE(errors.load() == 0);
+
+    // With one thread at a time every round peaks at the same usage. If exiting threads held on to their
+    // cached slots, each round would lose up to a full cache of them and capacity would keep growing.
+    REQUIRE(CachedPoolRoundTrip(1, 1000, false) == 0);
+    const auto settled = CachedPool::Stats();
+    REQUIRE(CachedPoolRoundTrip(32, 1000, false) == 0);
+    REQUIRE(CachedPool::Stats().capacity == settled.capacity);
+
+    // How much the concurrent rounds need depends on how the threads interleave, so only correctness
+    // and the shared pool traffic are checked
+    REQUIRE(CachedPoolRoundTrip(8, 100000) == 0);
+    const auto first = CachedPool::Stats();
+    REQUIRE(first.refills > settled.refills);
+    REQUIRE(first.returns > settled.returns);
+    REQUIRE(first.capacity >= 100000);
+
+    REQUIRE(CachedPoolRoundTrip(8, 100000) == 0);
+    const auto second = CachedPool::Stats();
+    REQUIRE(second.refills > first.refills);
+
+    bool found = false;
+    for (const auto& stats : stratus::GetThreadCachedPoolStats()) {
+        if (std::string(stats.name) == typeid(CachedPoolPayload).name()) found = true;
+    }
+    REQUIRE(found);
+}
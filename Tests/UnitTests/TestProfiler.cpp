@@ -0,0 +1,109 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+#include "StratusProfiler.h"
+
+static std::string ReadTrace(const std::string& file) {
+	std::ifstream in(file);
+	std::stringstream contents;
+	contents << in.rdbuf();
+	return contents.str();
+}
+
+static size_t CountOccurrences(const std::string& str, const std::string& pattern) {
+	size_t count = 0;
+	for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + pattern.size())) {
+		++count;
+	}
+	return count;
+}
+
+TEST_CASE( "Stratus Profiler Test", "[stratus_profiler_test]" ) {
+	std::cout << "Beginning stratus::Profiler test" << std::endl;
+
+	const std::string file = "StratusProfilerTest.json";
+	stratus::Profiler::SetEnabled(true);
+	stratus::Profiler::Clear();
+
+	// Each thread records nested zones into its own buffer while the main thread dumps
+	const size_t numThreads = 4;
+	const size_t zonesPerThread = 1000;
+	std::atomic<bool> start(false);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < numThreads; ++i) {
+		threads.push_back(std::thread([&start, i, zonesPerThread]() {
+			stratus::Profiler::SetCurrentThreadName("ProfilerTestThread" + std::to_string(i));
+			while (!start.load()) std::this_thread::yield();
+			for (size_t z = 0; z < zonesPerThread / 2; ++z) {
+				STRATUS_PROFILE_SCOPE("Outer");
+				STRATUS_PROFILE_SCOPE("Inner");
+			}
+		}));
+	}
+
+	start.store(true);
+	// Dumping while threads are recording has to be safe
+	REQUIRE(stratus::Profiler::WriteChromeTrace(file) == true);
+	for (auto& th : threads) th.join();
+
+	REQUIRE(stratus::Profiler::WriteChromeTrace(file) == true);
+	std::string trace = ReadTrace(file);
+	REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+	for (size_t i = 0; i < numThreads; ++i) {
+		REQUIRE(trace.find("ProfilerTestThread" + std::to_string(i)) != std::string::npos);
+	}
+	REQUIRE(CountOccurrences(trace, "\"name\":\"Outer\"") == numThreads * zonesPerThread / 2);
+	REQUIRE(CountOccurrences(trace, "\"name\":\"Inner\"") == numThreads * zonesPerThread / 2);
+
+	// Once full the oldest zones get overwritten. The very oldest slot is always treated as if it's
+	// in the middle of being overwritten, so one less than the buffer size is kept.
+	stratus::Profiler::Clear();
+	const size_t extra = 100;
+	for (size_t i = 0; i < stratus::Profiler::ZonesPerThread + extra; ++i) {
+		stratus::Profiler::Record("Wrapped", i, i + 1);
+	}
+	REQUIRE(stratus::Profiler::WriteChromeTrace(file) == true);
+	trace = ReadTrace(file);
+	REQUIRE(CountOccurrences(trace, "\"name\":\"Wrapped\"") == stratus::Profiler::ZonesPerThread - 1);
+	REQUIRE(trace.find("\"ts\":0.100,") == std::string::npos);
+	REQUIRE(trace.find("\"ts\":0.101,") != std::string::npos);
+
+	// Nothing is recorded while disabled
+	stratus::Profiler::Clear();
+	stratus::Profiler::SetEnabled(false);
+	{
+		STRATUS_PROFILE_SCOPE("Disabled");
+	}
+	stratus::Profiler::SetEnabled(true);
+	REQUIRE(stratus::Profiler::WriteChromeTrace(file) == true);
+	trace = ReadTrace(file);
+	REQUIRE(trace.find("Disabled") == std::string::npos);
+
+	// Measure how much a scope costs
+	const size_t numScopes = 1000000;
+	auto begin = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < numScopes; ++i) {
+		STRATUS_PROFILE_SCOPE("Overhead");
+	}
+	const double enabledNs = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - begin).count() / numScopes;
+
+	stratus::Profiler::SetEnabled(false);
+	begin = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < numScopes; ++i) {
+		STRATUS_PROFILE_SCOPE("Overhead");
+	}
+	const double disabledNs = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - begin).count() / numScopes;
+	stratus::Profiler::SetEnabled(true);
+
+	std::cout << "Profile scope cost: " << enabledNs << " ns enabled, " << disabledNs << " ns disabled" << std::endl;
+
+	stratus::Profiler::Clear();
+	std::remove(file.c_str());
+}
@@ -0,0 +1,126 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <random>
+
+#include "StratusSlotMap.h"
+
+struct SlotMapTag {};
+typedef stratus::GenerationalHandle<SlotMapTag> SlotMapHandle;
+
+TEST_CASE( "Slot map insert/remove/find", "[slot_map]" ) {
+	std::cout << "Starting slot map test" << std::endl;
+
+	stratus::SlotMap<std::string, SlotMapTag> map;
+	REQUIRE(map.Empty());
+	REQUIRE_FALSE(map.Contains(SlotMapHandle::Null()));
+
+	const auto a = map.Insert("a");
+	const auto b = map.Insert("b");
+	const auto c = map.Insert("c");
+	REQUIRE(a);
+	REQUIRE(a != b);
+	REQUIRE(map.Size() == 3);
+	REQUIRE(*map.Find(b) == "b");
+
+	// Removing from the middle moves the last value into the hole but handles stay valid
+	REQUIRE(map.Remove(a));
+	REQUIRE_FALSE(map.Remove(a));
+	REQUIRE_FALSE(map.Contains(a));
+	REQUIRE(map.Find(a) == nullptr);
+	REQUIRE(*map.Find(b) == "b");
+	REQUIRE(*map.Find(c) == "c");
+	REQUIRE(map.Size() == 2);
+
+	// The freed slot is reused with a new generation so the old handle stays stale
+	const auto d = map.Insert("d");
+	REQUIRE(d.Index() == a.Index());
+	REQUIRE(d.Generation() != a.Generation());
+	REQUIRE_FALSE(map.Contains(a));
+	REQUIRE(*map.Find(d) == "d");
+
+	// Dense arrays line up
+	for (size_t i = 0; i < map.Size(); ++i) {
+		REQUIRE(*map.Find(map.Handles()[i]) == map.Values()[i]);
+	}
+
+	map.Clear();
+	REQUIRE(map.Empty());
+	REQUIRE_FALSE(map.Contains(b));
+	REQUIRE_FALSE(map.Contains(d));
+	const auto e = map.Insert("e");
+	REQUIRE_FALSE(map.Contains(b));
+	REQUIRE(*map.Find(e) == "e");
+}
+
+TEST_CASE( "Slot map random operations", "[slot_map]" ) {
+	stratus::SlotMap<int, SlotMapTag> map;
+	stratus::SparseHandleMap<int, SlotMapTag> sparse;
+	std::vector<std::pair<SlotMapHandle, int>> live;
+	std::vector<SlotMapHandle> dead;
+
+	std::mt19937 rng(1234);
+	for (int i = 0; i < 10000; ++i) {
+		if (live.size() == 0 || rng() % 3 != 0) {
+			const auto handle = map.Insert(i);
+			REQUIRE(sparse.Insert(handle, i));
+			live.push_back(std::make_pair(handle, i));
+		}
+		else {
+			const size_t index = rng() % live.size();
+			const auto handle = live[index].first;
+			REQUIRE(map.Remove(handle));
+			REQUIRE(sparse.Remove(handle));
+			dead.push_back(handle);
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+
+	REQUIRE(map.Size() == live.size());
+	REQUIRE(sparse.Size() == live.size());
+	for (const auto& entry : live) {
+		REQUIRE(*map.Find(entry.first) == entry.second);
+		REQUIRE(*sparse.Find(entry.first) == entry.second);
+	}
+	for (const auto& handle : dead) {
+		REQUIRE_FALSE(map.Contains(handle));
+		REQUIRE_FALSE(sparse.Contains(handle));
+	}
+
+	std::unordered_set<int> values(map.begin(), map.end());
+	REQUIRE(values.size() == live.size());
+}
+
+TEST_CASE( "Sparse handle map", "[slot_map]" ) {
+	stratus::SlotMap<int, SlotMapTag> owner;
+	stratus::SparseHandleMap<std::string, SlotMapTag> map;
+
+	const auto a = owner.Insert(1);
+	const auto b = owner.Insert(2);
+	REQUIRE_FALSE(map.Insert(SlotMapHandle::Null(), "null"));
+	REQUIRE(map.Insert(a, "a"));
+	REQUIRE_FALSE(map.Insert(a, "a again"));
+	REQUIRE(map.Insert(b, "b"));
+	REQUIRE(*map.Find(a) == "a");
+
+	// A newer handle for the same slot replaces the stale entry
+	owner.Remove(a);
+	const auto c = owner.Insert(3);
+	REQUIRE(c.Index() == a.Index());
+	REQUIRE(map.Insert(c, "c"));
+	REQUIRE(map.Size() == 2);
+	REQUIRE_FALSE(map.Contains(a));
+	REQUIRE_FALSE(map.Remove(a));
+	REQUIRE(*map.Find(c) == "c");
+
+	REQUIRE(map.Remove(b));
+	REQUIRE(map.Size() == 1);
+	REQUIRE(map.Handles()[0] == c);
+
+	map.Clear();
+	REQUIRE(map.Empty());
+	REQUIRE_FALSE(map.Contains(c));
+}
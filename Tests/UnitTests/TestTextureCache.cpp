@@ -0,0 +1,296 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "StratusTextureCache.h"
+#include "StratusBlockCompression.h"
+
+// Reference decoders following the BC1/BC4 specs, used to check what the encoders produce
+static void DecodeBC1Block(const uint8_t * in, uint8_t * rgba) {
+	const uint16_t c0 = uint16_t(in[0] | (in[1] << 8));
+	const uint16_t c1 = uint16_t(in[2] | (in[3] << 8));
+	int palette[4][3];
+	const auto expand = [](const uint16_t c, int * out) {
+		out[0] = ((c >> 11) & 31) * 255 / 31;
+		out[1] = ((c >> 5) & 63) * 255 / 63;
+		out[2] = (c & 31) * 255 / 31;
+	};
+	expand(c0, palette[0]);
+	expand(c1, palette[1]);
+	for (int c = 0; c < 3; ++c) {
+		if (c0 > c1) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		else {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+
+	const uint32_t indices = uint32_t(in[4]) | (uint32_t(in[5]) << 8) | (uint32_t(in[6]) << 16) | (uint32_t(in[7]) << 24);
+	for (int i = 0; i < 16; ++i) {
+		const int index = (indices >> (2 * i)) & 3;
+		for (int c = 0; c < 3; ++c) rgba[i * 4 + c] = uint8_t(palette[index][c]);
+		rgba[i * 4 + 3] = 255;
+	}
+}
+
+static void DecodeBC4Block(const uint8_t * in, uint8_t * values) {
+	int palette[8];
+	palette[0] = in[0];
+	palette[1] = in[1];
+	if (palette[0] > palette[1]) {
+		for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * palette[0] + i * palette[1]) / 7;
+	}
+	else {
+		for (int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * palette[0] + i * palette[1]) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	uint64_t indices = 0;
+	for (int i = 0; i < 6; ++i) indices |= uint64_t(in[2 + i]) << (8 * i);
+	for (int i = 0; i < 16; ++i) values[i] = uint8_t(palette[(indices >> (3 * i)) & 7]);
+}
+
+// Smooth gradients - roughly what real textures look like inside a 4x4 block
+static std::vector<uint8_t> CreateGradientImage(const uint32_t width, const uint32_t height) {
+	std::vector<uint8_t> rgba(size_t(width) * height * 4);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			uint8_t * pixel = &rgba[(size_t(y) * width + x) * 4];
+			pixel[0] = uint8_t(x * 255 / std::max(1u, width - 1));
+			pixel[1] = uint8_t(y * 255 / std::max(1u, height - 1));
+			pixel[2] = uint8_t((x + y) * 255 / std::max(1u, width + height - 2));
+			pixel[3] = 255;
+		}
+	}
+	return rgba;
+}
+
+static std::vector<uint8_t> ReadBlock(const std::vector<uint8_t>& rgba, const uint32_t width, const uint32_t bx, const uint32_t by) {
+	std::vector<uint8_t> block(64);
+	for (uint32_t y = 0; y < 4; ++y) {
+		std::memcpy(&block[y * 16], &rgba[((size_t(by) * 4 + y) * width + bx * 4) * 4], 16);
+	}
+	return block;
+}
+
+TEST_CASE( "Stratus block compression", "[stratus_texture_cache_test]" ) {
+	std::cout << "Beginning stratus block compression test" << std::endl;
+
+	REQUIRE(stratus::IsBlockCompressed(stratus::TextureComponentFormat::BC1_SRGB));
+	REQUIRE(stratus::IsBlockCompressed(stratus::TextureComponentFormat::BC5_RG));
+	REQUIRE_FALSE(stratus::IsBlockCompressed(stratus::TextureComponentFormat::RGBA));
+
+	// Partial blocks still take up a whole block
+	REQUIRE(stratus::BlockCompressedSizeBytes(stratus::TextureComponentFormat::BC1_RGB, 1, 1) == 8);
+	REQUIRE(stratus::BlockCompressedSizeBytes(stratus::TextureComponentFormat::BC1_RGB, 5, 4) == 16);
+	REQUIRE(stratus::BlockCompressedSizeBytes(stratus::TextureComponentFormat::BC3_RGBA, 8, 8) == 64);
+	REQUIRE(stratus::BlockCompressedSizeBytes(stratus::TextureComponentFormat::BC4_RED, 8, 8) == 32);
+	REQUIRE(stratus::BlockCompressedSizeBytes(stratus::TextureComponentFormat::BC5_RG, 8, 8) == 64);
+
+	const uint32_t size = 64;
+	const auto image = CreateGradientImage(size, size);
+
+	const auto bc1 = stratus::CompressImage(stratus::TextureComponentFormat::BC1_RGB, image.data(), size, size);
+	const auto bc4 = stratus::CompressImage(stratus::TextureComponentFormat::BC4_RED, image.data(), size, size);
+	REQUIRE(bc1.size() == stratus::BlockCompressedSizeBytes(stratus::TextureComponentFormat::BC1_RGB, size, size));
+	REQUIRE(bc4.size() == stratus::BlockCompressedSizeBytes(stratus::TextureComponentFormat::BC4_RED, size, size));
+
+	int maxBC1Error = 0;
+	int maxBC4Error = 0;
+	for (uint32_t by = 0; by < size / 4; ++by) {
+		for (uint32_t bx = 0; bx < size / 4; ++bx) {
+			const auto block = ReadBlock(image, size, bx, by);
+			const size_t index = by * (size / 4) + bx;
+
+			uint8_t rgba[64];
+			DecodeBC1Block(&bc1[index * 8], rgba);
+			for (int i = 0; i < 16; ++i) {
+				for (int c = 0; c < 3; ++c) maxBC1Error = std::max(maxBC1Error, std::abs(int(rgba[i * 4 + c]) - int(block[i * 4 + c])));
+			}
+
+			uint8_t red[16];
+			DecodeBC4Block(&bc4[index * 8], red);
+			for (int i = 0; i < 16; ++i) maxBC4Error = std::max(maxBC4Error, std::abs(int(red[i]) - int(block[i * 4])));
+		}
+	}
+
+	// 565 endpoints with 4 colors per block vs 8 bit endpoints with 8 values per block
+	REQUIRE(maxBC1Error <= 24);
+	REQUIRE(maxBC4Error <= 6);
+
+	// A solid block should come back (almost) exactly
+	std::vector<uint8_t> solid(64);
+	for (int i = 0; i < 16; ++i) {
+		solid[i * 4 + 0] = 200; solid[i * 4 + 1] = 100; solid[i * 4 + 2] = 50; solid[i * 4 + 3] = 255;
+	}
+	uint8_t solidBC1[8], solidBC4[8], decoded[64], decodedRed[16];
+	stratus::CompressBC1Block(solid.data(), solidBC1);
+	stratus::CompressBC4Block(solid.data(), 0, solidBC4);
+	DecodeBC1Block(solidBC1, decoded);
+	DecodeBC4Block(solidBC4, decodedRed);
+	for (int i = 0; i < 16; ++i) {
+		REQUIRE(std::abs(int(decoded[i * 4 + 0]) - 200) <= 4);
+		REQUIRE(std::abs(int(decoded[i * 4 + 1]) - 100) <= 2);
+		REQUIRE(std::abs(int(decoded[i * 4 + 2]) - 50) <= 4);
+		REQUIRE(decodedRed[i] == 200);
+	}
+}
+
+TEST_CASE( "Stratus block compression downsampling", "[stratus_texture_cache_test]" ) {
+	// 2x2 -> 1x1 averages all 4 pixels
+	const uint8_t linear[] = {
+		0, 0, 0, 0,         255, 255, 255, 255,
+		255, 255, 255, 255, 0, 0, 0, 0
+	};
+	auto result = stratus::DownsampleImage(linear, 2, 2, false, false);
+	REQUIRE(result.size() == 4);
+	for (int c = 0; c < 4; ++c) REQUIRE(std::abs(int(result[c]) - 128) <= 1);
+
+	// Averaging in linear space makes the sRGB result brighter, but alpha is never sRGB
+	result = stratus::DownsampleImage(linear, 2, 2, true, false);
+	REQUIRE(result[0] > 160);
+	REQUIRE(std::abs(int(result[3]) - 128) <= 1);
+
+	// Two opposing normals leave nothing behind, which falls back to straight up
+	const uint8_t normals[] = {
+		255, 128, 128, 255,   0, 128, 128, 255,
+		255, 128, 128, 255,   0, 128, 128, 255
+	};
+	result = stratus::DownsampleImage(normals, 2, 2, false, true);
+	REQUIRE(std::abs(int(result[0]) - 128) <= 1);
+	REQUIRE(std::abs(int(result[1]) - 128) <= 1);
+	REQUIRE(result[2] == 255);
+
+	// Odd sizes round down but never go below 1
+	const auto image = CreateGradientImage(5, 1);
+	result = stratus::DownsampleImage(image.data(), 5, 1, false, false);
+	REQUIRE(result.size() == 2 * 1 * 4);
+}
+
+TEST_CASE( "Stratus TextureCache cook", "[stratus_texture_cache_test]" ) {
+	auto image = CreateGradientImage(37, 20);
+
+	stratus::CookedTexture cooked;
+	REQUIRE_FALSE(stratus::TextureCache::Cook(image.data(), 37, 20, stratus::TextureUsage::GENERIC, false, cooked));
+
+	REQUIRE(stratus::TextureCache::Cook(image.data(), 37, 20, stratus::TextureUsage::COLOR, true, cooked));
+	REQUIRE(cooked.format == stratus::TextureComponentFormat::BC1_SRGB);
+	REQUIRE(cooked.width == 37);
+	REQUIRE(cooked.height == 20);
+	// 37x20, 18x10, 9x5, 4x2, 2x1, 1x1
+	REQUIRE(cooked.levels.size() == 6);
+	for (size_t level = 0; level < cooked.levels.size(); ++level) {
+		const uint32_t width = std::max(1u, 37u >> level);
+		const uint32_t height = std::max(1u, 20u >> level);
+		REQUIRE(cooked.levels[level].size() == stratus::BlockCompressedSizeBytes(cooked.format, width, height));
+	}
+
+	// Any transparency switches to BC3
+	image[3] = 128;
+	REQUIRE(stratus::TextureCache::Cook(image.data(), 37, 20, stratus::TextureUsage::COLOR, false, cooked));
+	REQUIRE(cooked.format == stratus::TextureComponentFormat::BC3_RGBA);
+
+	REQUIRE(stratus::TextureCache::Cook(image.data(), 37, 20, stratus::TextureUsage::NORMAL_MAP, false, cooked));
+	REQUIRE(cooked.format == stratus::TextureComponentFormat::BC5_RG);
+
+	REQUIRE(stratus::TextureCache::Cook(image.data(), 37, 20, stratus::TextureUsage::SINGLE_CHANNEL, false, cooked));
+	REQUIRE(cooked.format == stratus::TextureComponentFormat::BC4_RED);
+	REQUIRE(cooked.levels.size() == 6);
+}
+
+TEST_CASE( "Stratus TextureCache round trip", "[stratus_texture_cache_test]" ) {
+	std::cout << "Beginning stratus::TextureCache round trip test" << std::endl;
+
+	const auto directory = std::filesystem::temp_directory_path() / "StratusTextureCacheTest";
+	std::filesystem::remove_all(directory);
+	const std::string first = (directory / "first.stc").string();
+	const std::string second = (directory / "second.stc").string();
+	const uint64_t sourceHash = 1234;
+	const uint64_t cookKey = stratus::TextureCache::CookKey(stratus::TextureUsage::NORMAL_MAP, false);
+
+	const auto image = CreateGradientImage(64, 32);
+	stratus::CookedTexture cooked;
+	REQUIRE(stratus::TextureCache::Cook(image.data(), 64, 32, stratus::TextureUsage::NORMAL_MAP, false, cooked));
+	REQUIRE(stratus::TextureCache::Write(first, sourceHash, cookKey, cooked));
+
+	// Anything different about the source or cook settings means the file can't be used
+	stratus::CookedTexture read;
+	REQUIRE_FALSE(stratus::TextureCache::Read(first, sourceHash + 1, cookKey, read));
+	REQUIRE_FALSE(stratus::TextureCache::Read(first, sourceHash, stratus::TextureCache::CookKey(stratus::TextureUsage::NORMAL_MAP, true), read));
+	REQUIRE_FALSE(stratus::TextureCache::Read(second, sourceHash, cookKey, read));
+	REQUIRE(read.levels.size() == 0);
+
+	REQUIRE(stratus::TextureCache::Read(first, sourceHash, cookKey, read));
+	REQUIRE(read.format == cooked.format);
+	REQUIRE(read.width == cooked.width);
+	REQUIRE(read.height == cooked.height);
+	REQUIRE(read.levels == cooked.levels);
+
+	// Truncated files are rejected rather than read past the end
+	const auto fileSize = std::filesystem::file_size(first);
+	std::filesystem::copy_file(first, second);
+	std::filesystem::resize_file(second, fileSize - 1);
+	REQUIRE_FALSE(stratus::TextureCache::Read(second, sourceHash, cookKey, read));
+	std::filesystem::resize_file(second, 16);
+	REQUIRE_FALSE(stratus::TextureCache::Read(second, sourceHash, cookKey, read));
+
+	// As are files with anything extra on the end
+	std::filesystem::remove(second);
+	std::filesystem::copy_file(first, second);
+	{
+		std::ofstream out(second, std::ios::binary | std::ios::app);
+		out.put(0);
+	}
+	REQUIRE_FALSE(stratus::TextureCache::Read(second, sourceHash, cookKey, read));
+
+	// Source hashes only depend on contents
+	const std::string source = (directory / "source.bin").string();
+	{
+		std::ofstream out(source, std::ios::binary);
+		out << "not really an image";
+	}
+	uint64_t hashA, hashB;
+	REQUIRE(stratus::TextureCache::HashSource(source, hashA));
+	REQUIRE(stratus::TextureCache::HashSource(source, hashB));
+	REQUIRE(hashA == hashB);
+	{
+		std::ofstream out(source, std::ios::binary);
+		out << "not really an image!";
+	}
+	REQUIRE(stratus::TextureCache::HashSource(source, hashB));
+	REQUIRE(hashA != hashB);
+	REQUIRE_FALSE(stratus::TextureCache::HashSource((directory / "missing.png").string(), hashB));
+
+	// Writing somewhere that can't be created fails quietly rather than logging, which would throw off a
+	// stratus::Thread
+	REQUIRE_FALSE(stratus::TextureCache::Write((directory / "source.bin" / "blocked.stc").string(), sourceHash, cookKey, cooked));
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST_CASE( "Stratus TextureCache paths", "[stratus_texture_cache_test]" ) {
+	const std::string original = stratus::TextureCache::GetDirectory();
+	const uint64_t color = stratus::TextureCache::CookKey(stratus::TextureUsage::COLOR, true);
+	const uint64_t normal = stratus::TextureCache::CookKey(stratus::TextureUsage::NORMAL_MAP, false);
+
+	stratus::TextureCache::SetDirectory("Cooked");
+	const std::string path = stratus::TextureCache::CookedPath("Textures/a/brick.png", 1, color);
+	REQUIRE(std::filesystem::path(path).parent_path() == std::filesystem::path("Cooked"));
+	REQUIRE(path == stratus::TextureCache::CookedPath("Textures/a/brick.png", 1, color));
+	REQUIRE(path != stratus::TextureCache::CookedPath("Textures/a/brick.png", 2, color));
+	REQUIRE(path != stratus::TextureCache::CookedPath("Textures/a/brick.png", 1, normal));
+
+	stratus::TextureCache::SetDirectory("");
+	REQUIRE(stratus::TextureCache::CookedPath("Textures/a/brick.png", 1, color).empty());
+
+	stratus::TextureCache::SetDirectory(original);
+}
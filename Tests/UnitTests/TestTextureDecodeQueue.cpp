@@ -0,0 +1,100 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <vector>
+
+#include "StratusTextureDecodeQueue.h"
+
+TEST_CASE( "Stratus TextureDecodeQueue budget", "[stratus_texture_decode_queue_test]" ) {
+	std::cout << "Beginning stratus::TextureDecodeQueue budget test" << std::endl;
+
+	stratus::TextureDecodeQueue queue(100);
+	std::vector<stratus::TextureHandle> started;
+	const auto submit = [&queue, &started](const size_t bytes, const int priority) {
+		const auto handle = stratus::TextureHandle::NextHandle();
+		queue.Submit(handle, bytes, priority, [&started, handle]() { started.push_back(handle); });
+		return handle;
+	};
+
+	const auto a = submit(60, 0);
+	const auto b = submit(30, 0);
+	// Doesn't fit so it has to wait, and so does everything behind it
+	const auto c = submit(20, 0);
+	const auto d = submit(5, 0);
+	REQUIRE(started == std::vector<stratus::TextureHandle>{a, b});
+
+	auto stats = queue.GetStatistics();
+	REQUIRE(stats.inFlightBytes == 90);
+	REQUIRE(stats.numInFlight == 2);
+	REQUIRE(stats.numPending == 2);
+
+	queue.Release(a);
+	REQUIRE(started == std::vector<stratus::TextureHandle>{a, b, c, d});
+	REQUIRE(queue.GetStatistics().inFlightBytes == 55);
+
+	// Releasing twice or releasing something which never started does nothing
+	queue.Release(a);
+	queue.Release(stratus::TextureHandle::NextHandle());
+	REQUIRE(queue.GetStatistics().inFlightBytes == 55);
+
+	// Anything larger than the whole budget waits until nothing else is in flight
+	const auto e = submit(500, 0);
+	REQUIRE(started.size() == 4);
+	queue.Release(b);
+	queue.Release(c);
+	REQUIRE(started.size() == 4);
+	queue.Release(d);
+	REQUIRE(started.back() == e);
+
+	stats = queue.GetStatistics();
+	REQUIRE(stats.inFlightBytes == 500);
+	REQUIRE(stats.peakInFlightBytes == 500);
+	queue.Release(e);
+	queue.ResetPeak();
+	REQUIRE(queue.GetStatistics().peakInFlightBytes == 0);
+}
+
+TEST_CASE( "Stratus TextureDecodeQueue priority", "[stratus_texture_decode_queue_test]" ) {
+	stratus::TextureDecodeQueue queue(10);
+	std::vector<stratus::TextureHandle> started;
+	const auto submit = [&queue, &started](const size_t bytes, const int priority) {
+		const auto handle = stratus::TextureHandle::NextHandle();
+		queue.Submit(handle, bytes, priority, [&started, handle]() { started.push_back(handle); });
+		return handle;
+	};
+
+	// Fills the budget so everything after it queues up
+	const auto blocker = submit(10, 0);
+	const auto low = submit(10, 0);
+	const auto high = submit(10, 5);
+	const auto bumped = submit(10, 0);
+	const auto highLater = submit(10, 5);
+
+	// Priority is only ever raised
+	REQUIRE(queue.Prioritize(bumped, 5));
+	REQUIRE(queue.Prioritize(high, 1));
+	REQUIRE_FALSE(queue.Prioritize(blocker, 10));
+
+	// Same priority goes in submission order
+	const std::vector<stratus::TextureHandle> expected{blocker, high, bumped, highLater, low};
+	for (size_t i = 0; i < expected.size(); ++i) {
+		REQUIRE(started.size() == i + 1);
+		REQUIRE(started.back() == expected[i]);
+		queue.Release(started.back());
+	}
+
+	// Raising the budget starts whatever now fits
+	const auto x = submit(10, 0);
+	const auto y = submit(10, 0);
+	REQUIRE(started.back() == x);
+	queue.SetBudget(20);
+	REQUIRE(started.back() == y);
+
+	// Cleared decodes never start
+	const auto z = submit(10, 0);
+	queue.Clear();
+	queue.Release(x);
+	queue.Release(y);
+	REQUIRE(started.back() == y);
+	REQUIRE_FALSE(queue.Prioritize(z, 1));
+	REQUIRE(queue.GetStatistics().numPending == 0);
+}
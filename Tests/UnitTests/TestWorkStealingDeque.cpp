@@ -0,0 +1,103 @@
+#include <catch2/catch_all.hpp>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "StratusWorkStealingDeque.h"
+
+TEST_CASE( "Work stealing deque single thread", "[work_stealing_deque_single]" ) {
+	std::cout << "Starting work stealing deque test with a single thread" << std::endl;
+
+	// Start small to force the deque to grow
+	stratus::WorkStealingDeque<size_t> deque(4);
+
+	REQUIRE(deque.Empty() == true);
+
+	size_t value = 0;
+	REQUIRE(deque.Pop(value) == false);
+	REQUIRE(deque.Steal(value) == false);
+
+	const size_t numElements = 1000;
+	for (size_t i = 0; i < numElements; ++i) {
+		deque.Push(i);
+	}
+
+	REQUIRE(deque.Size() == numElements);
+
+	// Owner pops LIFO, thieves steal FIFO
+	REQUIRE(deque.Pop(value) == true);
+	REQUIRE(value == numElements - 1);
+	REQUIRE(deque.Steal(value) == true);
+	REQUIRE(value == 0);
+
+	for (size_t i = numElements - 2; i > 0; --i) {
+		REQUIRE(deque.Pop(value) == true);
+		REQUIRE(value == i);
+	}
+
+	REQUIRE(deque.Empty() == true);
+	REQUIRE(deque.Pop(value) == false);
+}
+
+TEST_CASE( "Work stealing deque multi threaded", "[work_stealing_deque_multi]" ) {
+	const size_t numThieves = std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1;
+	std::cout << "Starting work stealing deque test with 1 owner and " << numThieves << " thieves" << std::endl;
+
+	stratus::WorkStealingDeque<size_t> deque(16);
+
+	const size_t numElements = 1000000;
+	// Every element must be received exactly once between the owner and all thieves
+	std::vector<std::atomic<uint32_t>> received(numElements);
+	for (auto& r : received) r.store(0);
+	std::atomic<size_t> totalReceived(0);
+	std::atomic<bool> done(false);
+
+	auto start = std::chrono::system_clock::now();
+
+	std::vector<std::thread> thieves;
+	for (size_t i = 0; i < numThieves; ++i) {
+		thieves.push_back(std::thread([&deque, &received, &totalReceived, &done]() {
+			size_t value;
+			while (!done.load()) {
+				if (deque.Steal(value)) {
+					received[value].fetch_add(1);
+					totalReceived.fetch_add(1);
+				}
+			}
+		}));
+	}
+
+	size_t value;
+	for (size_t i = 0; i < numElements; ++i) {
+		deque.Push(i);
+		// Mix in some owner pops so that the owner and thieves race for the last element
+		if (i % 3 == 0 && deque.Pop(value)) {
+			received[value].fetch_add(1);
+			totalReceived.fetch_add(1);
+		}
+	}
+
+	while (deque.Pop(value)) {
+		received[value].fetch_add(1);
+		totalReceived.fetch_add(1);
+	}
+
+	while (totalReceived.load() < numElements) {
+		std::this_thread::yield();
+	}
+
+	done.store(true);
+	for (auto& th : thieves) th.join();
+	auto end = std::chrono::system_clock::now();
+
+	REQUIRE(totalReceived.load() == numElements);
+	size_t duplicates = 0;
+	for (const auto& r : received) {
+		if (r.load() != 1) ++duplicates;
+	}
+	REQUIRE(duplicates == 0);
+
+	std::cout << "Multi threaded test completed in " << (std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()) << " msec" << std::endl << std::endl;
+}
@@ -2,6 +2,9 @@
 #include <iostream>
 #include <memory>
 #include <vector>
+#include <chrono>
+#include <ctime>
+#include <thread>
 
 #include "StratusThread.h"
 #include "StratusAsync.h"
@@ -153,4 +156,132 @@ TEST_CASE( "Stratus Async Test", "[stratus_async_test]" ) {
     REQUIRE(called.load() == true);
     REQUIRE(computeVoid.Completed() == true);
     REQUIRE(computeVoid.Failed() == false);
-}
\ No newline at end of file
+}
+
+TEST_CASE( "Stratus Async Continuation Test", "[stratus_async_continuation_test]" ) {
+    std::cout << "Beginning stratus::Async continuation test" << std::endl;
+
+    stratus::Thread thread(true);
+
+    // Continuations run on the thread which completes the Async with no polling needed
+    stratus::Async<int> first(thread, []() { return new int(10); });
+    stratus::Async<int> second = first.Then([](stratus::Async<int> as) {
+        return new int(as.Get() * 2);
+    });
+    stratus::Async<void> third = second.Then([](stratus::Async<int> as) {
+        if (as.Get() != 20) throw std::runtime_error("Unexpected value");
+    });
+
+    REQUIRE(first.Completed() == false);
+    REQUIRE(second.Completed() == false);
+    REQUIRE(third.Completed() == false);
+
+    thread.DispatchAndSynchronize();
+
+    REQUIRE(first.Get() == 10);
+    REQUIRE(second.Completed() == true);
+    REQUIRE(second.Get() == 20);
+    REQUIRE(third.CompleteAndValid() == true);
+
+    // Adding a continuation to a completed Async runs it immediately
+    bool ranImmediately = false;
+    first.Then([&ranImmediately](stratus::Async<int>) { ranImmediately = true; });
+    REQUIRE(ranImmediately == true);
+
+    // Exceptions thrown by a continuation fail the resulting Async
+    stratus::Async<void> failed = first.Then([](stratus::Async<int>) {
+        throw std::runtime_error("Continuation failed");
+    });
+    REQUIRE(failed.Failed() == true);
+    REQUIRE(failed.ExceptionMessage() == "Continuation failed");
+
+    // WhenAll completes once everything in the group is done
+    std::vector<stratus::Async<int>> group;
+    for (int i = 0; i < 100; ++i) {
+        group.push_back(stratus::Async<int>(thread, [i]() { return new int(i); }));
+    }
+    stratus::Async<void> all = stratus::WhenAll(group);
+    REQUIRE(all.Completed() == false);
+    thread.DispatchAndSynchronize();
+    REQUIRE(all.CompleteAndValid() == true);
+
+    // Any failure in the group fails WhenAll
+    group.push_back(stratus::Async<int>(thread, []() { return (int *)nullptr; }));
+    all = stratus::WhenAll(group);
+    thread.DispatchAndSynchronize();
+    REQUIRE(all.Completed() == true);
+    REQUIRE(all.Failed() == true);
+
+    REQUIRE(stratus::WhenAll(std::vector<stratus::Async<int>>()).CompleteAndValid() == true);
+
+    // Shared state is pooled so creating many small Asyncs should be cheap
+    const size_t numAsync = 100000;
+    std::atomic<size_t> counter(0);
+    std::vector<stratus::Async<void>> many;
+    many.reserve(numAsync);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < numAsync; ++i) {
+        many.push_back(stratus::Async<void>(thread, [&counter]() { counter.fetch_add(1); }));
+    }
+    auto chained = stratus::WhenAll(many);
+    thread.DispatchAndSynchronize();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    REQUIRE(counter.load() == numAsync);
+    REQUIRE(chained.CompleteAndValid() == true);
+    std::cout << "Created and completed " << numAsync << " Async<void> in "
+        << std::chrono::duration<double, std::milli>(end - start).count() << " msec" << std::endl;
+}
+
+TEST_CASE( "Stratus Thread Idle Test", "[stratus_thread_idle_test]" ) {
+    std::cout << "Beginning stratus::Thread idle test" << std::endl;
+
+    const size_t numThreads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+    std::vector<std::unique_ptr<stratus::Thread>> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.push_back(std::make_unique<stratus::Thread>(true));
+    }
+
+    // With nothing queued every thread should park itself rather than spin
+    const auto wallStart = std::chrono::steady_clock::now();
+    const auto cpuStart = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    const auto cpuEnd = std::clock();
+    const auto wallEnd = std::chrono::steady_clock::now();
+
+    const double cpuMsec = 1000.0 * double(cpuEnd - cpuStart) / double(CLOCKS_PER_SEC);
+    const double wallMsec = std::chrono::duration<double, std::milli>(wallEnd - wallStart).count();
+    std::cout << numThreads << " idle threads used " << cpuMsec << " msec of CPU over " << wallMsec << " msec" << std::endl;
+#if !defined(_WIN32)
+    // std::clock measures process CPU time everywhere except Windows where it is wall time
+    REQUIRE(cpuMsec < 0.1 * wallMsec);
+#endif
+
+    for (auto& thread : threads) {
+        const auto stats = thread->GetIdleStatistics();
+        REQUIRE(stats.parkedNanoseconds > stats.spinNanoseconds);
+        REQUIRE(stats.IdleCpuRatio() < 0.1);
+    }
+
+    // Dispatch latency: time from Dispatch until the function starts running on a parked thread
+    stratus::Thread& thread = *threads[0];
+    const size_t numSamples = 200;
+    double totalLatencyUsec = 0.0;
+    for (size_t i = 0; i < numSamples; ++i) {
+        std::chrono::steady_clock::time_point started;
+        thread.Queue([&started]() {
+            started = std::chrono::steady_clock::now();
+        });
+        const auto dispatched = std::chrono::steady_clock::now();
+        thread.DispatchAndSynchronize();
+        totalLatencyUsec += std::chrono::duration<double, std::micro>(started - dispatched).count();
+        // Give the thread time to park again
+        if (i % 10 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const double avgLatencyUsec = totalLatencyUsec / double(numSamples);
+    const auto stats = thread.GetIdleStatistics();
+    std::cout << "Average dispatch latency " << avgLatencyUsec << " usec (" << stats.spinWakeups << " spin wakeups, "
+        << stats.parkedWakeups << " parked wakeups)" << std::endl;
+    REQUIRE(avgLatencyUsec < 5000.0);
+}